@@ -10,6 +10,7 @@
 #include "compresseduidescription.h"
 #include "vstgui/uidescription/xmlparser.h"
 #include "vstgui/uidescription/cstream.h"
+#include "vstgui/uidescription/uiattributes.h"
 
 #include <zlib.h>
 
@@ -36,30 +37,57 @@ protected:
 };
 
 //-----------------------------------------------------------------------------
-class ZLibOutputStream : public OutputStream
-{
-public:
-	ZLibOutputStream (ByteOrder byteOrder = kNativeByteOrder);
-	~ZLibOutputStream ();
+static int64_t kUIDescIdentifier = 0x7072637365646975LL; // 8 byte identifier
+static int64_t kUIDescSectionsIdentifier = 0x6373637365646975LL; // 8 byte identifier
 
-	bool open (OutputStream& stream, int32_t compressionLevel = 6);
-	bool close ();
+//-----------------------------------------------------------------------------
+static bool compressSection (const std::string& data, std::vector<Bytef>& compressedData)
+{
+	uLongf compressedSize = compressBound (static_cast<uLong> (data.size ()));
+	compressedData.resize (compressedSize);
+	if (compress2 (compressedData.data (), &compressedSize,
+				   reinterpret_cast<const Bytef*> (data.data ()), static_cast<uLong> (data.size ()),
+				   Z_DEFAULT_COMPRESSION) != Z_OK)
+		return false;
+	compressedData.resize (compressedSize);
+	return true;
+}
 
-	bool operator<< (const std::string& str) VSTGUI_OVERRIDE_VMETHOD
-	{
-		return writeRaw (str.c_str (), static_cast<uint32_t> (str.size ())) == str.size ();
-	}
-	uint32_t writeRaw (const void* buffer, uint32_t size) VSTGUI_OVERRIDE_VMETHOD;
+//-----------------------------------------------------------------------------
+static bool uncompressSection (const std::vector<Bytef>& compressedData, uint32_t size,
+							   std::string& data)
+{
+	data.resize (size);
+	if (size == 0)
+		return true;
+	uLongf uncompressedSize = size;
+	if (uncompress (reinterpret_cast<Bytef*> (&data[0]), &uncompressedSize, compressedData.data (),
+					static_cast<uLong> (compressedData.size ())) != Z_OK)
+		return false;
+	return uncompressedSize == size;
+}
 
-protected:
-	z_streamp zstream;
-	OutputStream* stream;
-	void* internalBuffer;
-	uint32_t internalBufferSize;
-};
+//-----------------------------------------------------------------------------
+static bool readCompressedData (InputStream& stream, uint32_t compressedSize, uint32_t size,
+								std::string& data)
+{
+	std::vector<Bytef> compressedData (compressedSize);
+	if (compressedSize &&
+		stream.readRaw (compressedData.data (), compressedSize) != compressedSize)
+		return false;
+	return uncompressSection (compressedData, size, data);
+}
 
 //-----------------------------------------------------------------------------
-static int64_t kUIDescIdentifier = 0x7072637365646975LL; // 8 byte identifier
+static bool writeCompressedData (OutputStream& stream, const std::string& data)
+{
+	std::vector<Bytef> compressedData;
+	if (!compressSection (data, compressedData))
+		return false;
+	uint32_t compressedSize = static_cast<uint32_t> (compressedData.size ());
+	return (stream << compressedSize) && (stream << static_cast<uint32_t> (data.size ())) &&
+		   stream.writeRaw (compressedData.data (), compressedSize) == compressedSize;
+}
 
 //-----------------------------------------------------------------------------
 CompressedUIDescription::CompressedUIDescription (const CResourceDescription& compressedUIDescFile)
@@ -78,7 +106,9 @@ bool CompressedUIDescription::parse ()
 	{
 		int64_t identifier;
 		static_cast<InputStream&> (resStream) >> identifier;
-		if (identifier == kUIDescIdentifier)
+		if (identifier == kUIDescSectionsIdentifier)
+			return parseSections (resStream);
+		else if (identifier == kUIDescIdentifier)
 		{
 			ZLibInputStream zin;
 			if (zin.open (resStream))
@@ -98,24 +128,128 @@ bool CompressedUIDescription::parse ()
 	return result;
 }
 
+//-----------------------------------------------------------------------------
+/*	After the identifier follow the uint32_t compressed and uncompressed size of the index, the
+	compressed index and the compressed sections in the order of the index. The index contains:
+		UIAttributes of the root node, uint32_t number of sections
+		per section: uint32_t compressed size, uint32_t size, int8_t is template
+					 and for a template its UIAttributes
+*/
+bool CompressedUIDescription::parseSections (CResourceInputStream& stream)
+{
+	InputStream& input = stream;
+	uint32_t indexCompressedSize, indexSize;
+	std::string index;
+	if (!(input >> indexCompressedSize) || !(input >> indexSize) ||
+		!readCompressedData (input, indexCompressedSize, indexSize, index))
+		return false;
+	CMemoryStream indexStream (reinterpret_cast<const int8_t*> (index.data ()),
+							   static_cast<uint32_t> (index.size ()), true, kLittleEndianByteOrder);
+	InputStream& indexInput = indexStream;
+	UIAttributes rootAttributes;
+	uint32_t numSections;
+	if (!rootAttributes.restore (indexStream) || !(indexInput >> numSections))
+		return false;
+
+	createRootNode (rootAttributes);
+	sectionLocations.clear ();
+	int64_t offset = stream.tell ();
+	for (uint32_t i = 0; i < numSections; ++i)
+	{
+		SectionLocation location;
+		int8_t isTemplate;
+		if (!(indexInput >> location.compressedSize) || !(indexInput >> location.size) ||
+			!(indexInput >> isTemplate))
+			return false;
+		location.offset = offset;
+		offset += location.compressedSize;
+		sectionLocations.push_back (location);
+		if (isTemplate)
+		{
+			// inflated the first time the template is needed, see readDeferredTemplate
+			UIAttributes templateAttributes;
+			if (!templateAttributes.restore (indexStream))
+				return false;
+			addDeferredTemplate (templateAttributes, i);
+			continue;
+		}
+		std::string xml;
+		if (!readSection (stream, i, xml) || !parseSection (xml))
+			return false;
+	}
+	completeParsing ();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool CompressedUIDescription::readSection (CResourceInputStream& stream, uint32_t sectionIndex,
+										   std::string& xml) const
+{
+	if (sectionIndex >= sectionLocations.size ())
+		return false;
+	const SectionLocation& location = sectionLocations[sectionIndex];
+	if (stream.seek (location.offset, SeekableStream::kSeekSet) != location.offset)
+		return false;
+	return readCompressedData (stream, location.compressedSize, location.size, xml);
+}
+
+//-----------------------------------------------------------------------------
+bool CompressedUIDescription::readDeferredTemplate (uint32_t sectionIndex, std::string& xml) const
+{
+	CResourceInputStream resStream (kLittleEndianByteOrder);
+	if (!resStream.open (xmlFile))
+		return false;
+	return readSection (resStream, sectionIndex, xml);
+}
+
+//-----------------------------------------------------------------------------
+bool CompressedUIDescription::writeSections (OutputStream& stream, int32_t flags)
+{
+	UIAttributes rootAttributes;
+	SectionList sections;
+	if (!saveSections (rootAttributes, sections, flags))
+		return false;
+	CMemoryStream indexStream (1024, 1024, true, kLittleEndianByteOrder);
+	OutputStream& indexOutput = indexStream;
+	if (!rootAttributes.store (indexStream) ||
+		!(indexOutput << static_cast<uint32_t> (sections.size ())))
+		return false;
+	std::vector<std::vector<Bytef>> compressedSections (sections.size ());
+	for (size_t i = 0; i < sections.size (); ++i)
+	{
+		if (!compressSection (sections[i].xml, compressedSections[i]))
+			return false;
+		UIAttributes* templateAttributes = sections[i].templateAttributes;
+		if (!(indexOutput << static_cast<uint32_t> (compressedSections[i].size ())) ||
+			!(indexOutput << static_cast<uint32_t> (sections[i].xml.size ())) ||
+			!(indexOutput << static_cast<int8_t> (templateAttributes ? 1 : 0)))
+			return false;
+		if (templateAttributes && !templateAttributes->store (indexStream))
+			return false;
+	}
+	std::string index (reinterpret_cast<const char*> (indexStream.getBuffer ()),
+					   static_cast<size_t> (indexStream.tell ()));
+	if (!(stream << kUIDescSectionsIdentifier) || !writeCompressedData (stream, index))
+		return false;
+	for (const auto& compressedSection : compressedSections)
+	{
+		uint32_t size = static_cast<uint32_t> (compressedSection.size ());
+		if (stream.writeRaw (compressedSection.data (), size) != size)
+			return false;
+	}
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 bool CompressedUIDescription::save (UTF8StringPtr filename, int32_t flags)
 {
 	bool result = false;
 	CFileStream fileStream;
 	if (fileStream.open (filename, CFileStream::kWriteMode | CFileStream::kBinaryMode |
-									   CFileStream::kTruncateMode),
-		kLittleEndianByteOrder)
+									   CFileStream::kTruncateMode,
+						 kLittleEndianByteOrder))
 	{
-		static_cast<OutputStream&> (fileStream) << kUIDescIdentifier;
-		ZLibOutputStream zout;
-		if (zout.open (fileStream))
-		{
-			if (saveToStream (zout, flags))
-			{
-				result = zout.close ();
-			}
-		}
+		result = writeSections (fileStream, flags);
 	}
 	if (result)
 	{
@@ -124,8 +258,8 @@ bool CompressedUIDescription::save (UTF8StringPtr filename, int32_t flags)
 		xmlFileName.append (".xml");
 		CFileStream xmlFileStream;
 		if (xmlFileStream.open (xmlFileName.c_str (),
-								CFileStream::kWriteMode | CFileStream::kTruncateMode),
-			kLittleEndianByteOrder)
+								CFileStream::kWriteMode | CFileStream::kTruncateMode,
+								kLittleEndianByteOrder))
 		{
 			saveToStream (xmlFileStream, flags);
 		}
@@ -216,110 +350,5 @@ uint32_t ZLibInputStream::readRaw (void* buffer, uint32_t size)
 	return size;
 }
 
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-ZLibOutputStream::ZLibOutputStream (ByteOrder byteOrder)
-: OutputStream (byteOrder)
-, zstream (nullptr)
-, stream (nullptr)
-, internalBuffer (nullptr)
-, internalBufferSize (0)
-{
-}
-
-//-----------------------------------------------------------------------------
-ZLibOutputStream::~ZLibOutputStream () { close (); }
-
-//-----------------------------------------------------------------------------
-bool ZLibOutputStream::open (OutputStream& _stream, int32_t compressionLevel)
-{
-	if (zstream != nullptr || stream != nullptr)
-		return false;
-	stream = &_stream;
-
-	internalBufferSize = 1024;
-	internalBuffer = malloc (internalBufferSize);
-
-	zstream = static_cast<z_streamp> (malloc (sizeof (z_stream)));
-	memset (zstream, 0, sizeof (z_stream));
-
-	if (deflateInit (zstream, compressionLevel) != Z_OK)
-	{
-		free (zstream);
-		zstream = nullptr;
-		return false;
-	}
-	return true;
-}
-
-//-----------------------------------------------------------------------------
-bool ZLibOutputStream::close ()
-{
-	bool result = true;
-	if (zstream)
-	{
-		zstream->next_in = 0;
-		zstream->avail_in = 0;
-		while (true)
-		{
-			zstream->next_out = static_cast<Bytef*> (internalBuffer);
-			zstream->avail_out = internalBufferSize;
-			int zres = deflate (zstream, Z_FINISH);
-			if (zres != Z_OK && zres != Z_BUF_ERROR && zres != Z_STREAM_END)
-			{
-				result = false;
-				break;
-			}
-			else if (zstream->avail_out != internalBufferSize)
-			{
-				uint32_t written =
-					stream->writeRaw (internalBuffer, internalBufferSize - zstream->avail_out);
-				if (written != internalBufferSize - zstream->avail_out)
-				{
-					result = false;
-					break;
-				}
-			}
-			if (zres == Z_STREAM_END)
-				break;
-		}
-		deflateEnd (zstream);
-		free (zstream);
-		zstream = nullptr;
-	}
-	if (internalBuffer)
-	{
-		free (internalBuffer);
-		internalBuffer = nullptr;
-	}
-	return result;
-}
-
-//-----------------------------------------------------------------------------
-uint32_t ZLibOutputStream::writeRaw (const void* buffer, uint32_t size)
-{
-	zstream->next_in = const_cast<Bytef*> (static_cast<const Bytef*> (buffer));
-	zstream->avail_in = size;
-	while (zstream->avail_in > 0)
-	{
-		zstream->next_out = static_cast<Bytef*> (internalBuffer);
-		zstream->avail_out = internalBufferSize;
-		int zres = deflate (zstream, Z_NO_FLUSH);
-		if (zres == Z_STREAM_ERROR)
-		{
-			return -1;
-		}
-		if (zstream->avail_out != internalBufferSize)
-		{
-			uint32_t written =
-				stream->writeRaw (internalBuffer, internalBufferSize - zstream->avail_out);
-			if (written != internalBufferSize - zstream->avail_out)
-				return -1;
-		}
-	}
-	return size;
-}
-
 //------------------------------------------------------------------------
 } // namespace
@@ -15,7 +15,16 @@
 //------------------------------------------------------------------------
 namespace VSTGUI {
 
+class CResourceInputStream;
+
 //------------------------------------------------------------------------
+/** A UIDescription saved with zlib compression.
+
+	The file starts with an index followed by the sections of the description, every resource group
+	and every template is compressed on its own. The resource groups are inflated when the file is
+	parsed, a template is inflated the first time it is needed. Files compressed as one stream and
+	uncompressed files are parsed, too.
+*/
 class CompressedUIDescription : public UIDescription
 {
 public:
@@ -24,6 +33,20 @@ public:
 	bool parse () VSTGUI_OVERRIDE_VMETHOD;
 	bool save (UTF8StringPtr filename,
 			   int32_t flags = kWriteWindowsResourceFile) VSTGUI_OVERRIDE_VMETHOD;
+
+protected:
+	bool parseSections (CResourceInputStream& stream);
+	bool writeSections (OutputStream& stream, int32_t flags);
+	bool readSection (CResourceInputStream& stream, uint32_t sectionIndex, std::string& xml) const;
+	bool readDeferredTemplate (uint32_t sectionIndex, std::string& xml) const VSTGUI_OVERRIDE_VMETHOD;
+
+	struct SectionLocation
+	{
+		int64_t offset;
+		uint32_t compressedSize;
+		uint32_t size;
+	};
+	std::vector<SectionLocation> sectionLocations;
 };
 
 //------------------------------------------------------------------------
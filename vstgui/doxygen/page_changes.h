@@ -25,6 +25,28 @@ It's recommended to start new projects with version 4 while old projects should
 - new Control : VSTGUI::CSegmentButton
 - add support for adding a custom view to the split view separator
 - transformation matrix support in VSTGUI::CDrawContext
+- VSTGUI::BitmapFilter::Pipeline runs a chain of bitmap filters without creating a bitmap per filter, the standard filters process large bitmaps on a pool of threads which VSTGUI::BitmapFilter::Standard::stopWorkerThreads ends
+- row access in VSTGUI::CBitmapPixelAccess and the VSTGUI::PixelSpan functions for converting, premultiplying and blending rows of pixels
+- VSTGUI::CBitmapCache shares the bitmaps of UIDescription instances and can release unused scale variants to meet a memory budget
+- VSTGUI::UIDescription::setAsyncBitmapDecoding decodes the bitmaps on background threads after parsing, VSTGUI::CBitmap::setDeferredLoader lets a bitmap be used before its platform bitmap is loaded
+- VSTGUI::CBitmap::setScaledFramesCacheEnabled keeps the frames of filmstrips resampled to the scale factor they are drawn with, optionally on a background thread, the Scale Area bitmap filter averages the covered pixels when making bitmaps smaller
+- VSTGUI::CFilmstripBitmap keeps the frames of a filmstrip compressed in memory and decodes only the drawn frames
+- VSTGUI::BitmapCodec encodes and decodes bitmaps in the lossless QOI format, VSTGUI::UIDescription::kWriteImagesAsQOI embeds the images of a saved UIDescription in it
+- VSTGUI::CResourcePack maps a single file containing the bitmaps and UIDescription files, VSTGUI::UIDescription::setResourcePack loads them from it. The pack is created with tools/resourcepacker
+- VSTGUI::CBitmapAtlas packs small bitmaps into a few large atlas bitmaps which they draw from, VSTGUI::UIDescription::setBitmapAtlasEnabled packs the small bitmaps of an UIDescription
+- VSTGUI::CBitmapCache shares bitmaps with the same content between UIDescription instances, a shared bitmap is copied when its pixels are accessed
+- VSTGUI::UIDescription::setSharedParsingEnabled parses a file only once per process, the other instances copy the parsed nodes
+- VSTGUI::UIDescription::kWriteCompiledFormat saves a compiled binary file which is loaded without the XML parser, tools/uidesccompiler converts UIDescription files
+- VSTGUI::UIDescription looks up templates by name and caches their structure, so that creating a template view again does not walk the template nodes
+- VSTGUI::UIDescription::setPrototypeCloningEnabled creates the views of a template by copying a prototype, only the controller hooks run for each copy
+- VSTGUI::UIAttributes keeps its names and values in a process wide string table and shares the storage of identical attribute sets
+- VSTGUI::UIDescription::calculateStringValue compiles an expression only once and keeps its result until a control tag it depends on is changed
+- VSTGUI::UIAttributes keeps the numbers, points and rects parsed from its values, so that they are not parsed again for each view created from them
+- VSTGUI::UIDescription looks up the names of colors, fonts, bitmaps, gradients and control tags with hashed indexes which are rebuilt after a change
+- VSTGUI::UIDescription::parseAsync parses the description on a worker thread and VSTGUI::UIDescription::createViewIncrementally creates the views of a template in time slices behind a placeholder view
+- VSTGUI::UIDescriptionProfiler records the time spent in parsing, expressions, bitmaps, fonts, controller callbacks and view creators per template and view class, see VSTGUI::UIDescription::setProfiler
+- VSTGUI::UIDescription::save only creates the XML text again for the nodes changed since the last save and keeps the embedded image data while the bitmap is unchanged
+- VSTGUI::CompressedUIDescription compresses each resource group and template of a description on its own behind an index, the templates are only inflated when they are needed. VSTGUI::UIDescription can defer parsing a template for such formats
 - alternative c++11 callback functions for VSTGUI::CFileSelector::run(), VSTGUI::CVSTGUITimer, VSTGUI::CParamDisplay::setValueToStringFunction, VSTGUI::CTextEdit::setStringToValueFunction and VSTGUI::CCommandMenuItem::setActions
 
 Note: All current deprecated methods will be removed in the next version. So make sure that your code compiles with VSTGUI_ENABLE_DEPRECATED_METHODS=0
@@ -33,10 +33,21 @@
 //-----------------------------------------------------------------------------
 
 #include "cbitmap.h"
+#include "cbitmapcache.h"
 #include "cdrawcontext.h"
 #include "ccolor.h"
+#include "cbitmapfilter.h"
+#include "cgraphicstransform.h"
 #include "platform/iplatformbitmap.h"
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <list>
+
+#if VSTGUI_HAS_FUNCTIONAL
+	#include <atomic>
+	#include <thread>
+#endif
 
 namespace VSTGUI {
 
@@ -67,12 +78,16 @@ CBitmap* bitmap2 = new CBitmap ("RealFileName.png"); // string
 */
 //-----------------------------------------------------------------------------
 CBitmap::CBitmap ()
+: cache (0)
+, scaledFrames (0)
 {
 }
 
 //-----------------------------------------------------------------------------
 CBitmap::CBitmap (const CResourceDescription& desc)
 : resourceDesc (desc)
+, cache (0)
+, scaledFrames (0)
 {
 	SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create ());
 	if (platformBitmap && platformBitmap->load (desc))
@@ -83,6 +98,8 @@ CBitmap::CBitmap (const CResourceDescription& desc)
 
 //-----------------------------------------------------------------------------
 CBitmap::CBitmap (CCoord width, CCoord height)
+: cache (0)
+, scaledFrames (0)
 {
 	CPoint p (width, height);
 	bitmaps.push_back (owned (IPlatformBitmap::create (&p)));
@@ -90,13 +107,20 @@ CBitmap::CBitmap (CCoord width, CCoord height)
 
 //-----------------------------------------------------------------------------
 CBitmap::CBitmap (IPlatformBitmap* platformBitmap)
+: cache (0)
+, scaledFrames (0)
 {
 	bitmaps.push_back (platformBitmap);
 }
 
 //-----------------------------------------------------------------------------
-CBitmap::~CBitmap ()
+CBitmap::CBitmap (const CResourceDescription& desc, IPlatformBitmap* platformBitmap)
+: resourceDesc (desc)
+, cache (0)
+, scaledFrames (0)
 {
+	if (platformBitmap)
+		bitmaps.push_back (platformBitmap);
 }
 
 //-----------------------------------------------------------------------------
@@ -112,6 +136,8 @@ void CBitmap::draw (CDrawContext* context, const CRect& rect, const CPoint& offs
 //-----------------------------------------------------------------------------
 CCoord CBitmap::getWidth () const
 {
+	if (atlas)
+		return atlasRect.getWidth ();
 	if (getPlatformBitmap ())
 		return getPlatformBitmap ()->getSize ().x / getPlatformBitmap ()->getScaleFactor ();
 	return 0;
@@ -120,6 +146,8 @@ CCoord CBitmap::getWidth () const
 //-----------------------------------------------------------------------------
 CCoord CBitmap::getHeight () const
 {
+	if (atlas)
+		return atlasRect.getHeight ();
 	if (getPlatformBitmap ())
 		return getPlatformBitmap ()->getSize ().y / getPlatformBitmap ()->getScaleFactor ();
 	return 0;
@@ -128,21 +156,32 @@ CCoord CBitmap::getHeight () const
 //-----------------------------------------------------------------------------
 IPlatformBitmap* CBitmap::getPlatformBitmap () const
 {
+	if (atlas)
+		const_cast<CBitmap*> (this)->leaveAtlas ();
+	loadDeferred ();
 	return bitmaps.empty () ? 0 : bitmaps[0];
 }
 
 //-----------------------------------------------------------------------------
 void CBitmap::setPlatformBitmap (IPlatformBitmap* bitmap)
 {
+	atlas = 0;
 	if (bitmaps.empty ())
 		bitmaps.push_back (bitmap);
 	else
+	{
+		if (cache)
+			cache->platformBitmapReplaced (this, bitmaps[0]);
 		bitmaps[0] = bitmap;
+	}
+	clearScaledFrames ();
 }
 
 //-----------------------------------------------------------------------------
 bool CBitmap::addBitmap (IPlatformBitmap* platformBitmap)
 {
+	if (atlas)
+		leaveAtlas ();
 	double scaleFactor = platformBitmap->getScaleFactor ();
 	CPoint size (getWidth (), getHeight ());
 	CPoint bitmapSize = platformBitmap->getSize ();
@@ -161,11 +200,144 @@ bool CBitmap::addBitmap (IPlatformBitmap* platformBitmap)
 		}
 	VSTGUI_RANGE_BASED_FOR_LOOP_END
 	bitmaps.push_back (platformBitmap);
+	clearScaledFrames ();
 	return true;
 }
 
 //-----------------------------------------------------------------------------
 IPlatformBitmap* CBitmap::getBestPlatformBitmapForScaleFactor (double scaleFactor) const
+{
+	if (atlas)
+		const_cast<CBitmap*> (this)->leaveAtlas ();
+	if (deferredLoader)
+		return 0;
+	if (cache)
+		return cache->getBestPlatformBitmap (const_cast<CBitmap*> (this), scaleFactor);
+	return findBestPlatformBitmap (scaleFactor);
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmap::setAtlas (CBitmap* newAtlas, const CRect& rect)
+{
+	if (newAtlas == 0)
+	{
+		atlas = 0;
+		return true;
+	}
+	if (newAtlas == this || newAtlas->getAtlas () || deferredLoader || cache || bitmaps.size () > 1)
+		return false;
+	if (!bitmaps.empty () && (rect.getWidth () != getWidth () || rect.getHeight () != getHeight ()))
+	{
+		vstgui_assert (false, "wrong atlas rect size");
+		return false;
+	}
+	atlas = newAtlas;
+	atlasRect = rect;
+	bitmaps.clear ();
+	clearScaledFrames ();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmap::mapToAtlas (const CRect& dest, const CPoint& offset, CRect& atlasDest, CPoint& atlasOffset) const
+{
+	if (atlas == 0)
+		return false;
+	// the part of dest the bitmap covers, the atlas has other bitmaps around it
+	atlasDest = dest;
+	atlasDest.bound (CRect (dest.left - offset.x, dest.top - offset.y, dest.left - offset.x + atlasRect.getWidth (), dest.top - offset.y + atlasRect.getHeight ()));
+	if (atlasDest.isEmpty ())
+		return false;
+	atlasOffset (atlasRect.left + offset.x + atlasDest.left - dest.left, atlasRect.top + offset.y + atlasDest.top - dest.top);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::leaveAtlas ()
+{
+	SharedPointer<CBitmap> source = atlas;
+	atlas = 0;
+	IPlatformBitmap* sourceBitmap = source->getPlatformBitmap ();
+	if (sourceBitmap == 0)
+		return;
+	double scaleFactor = sourceBitmap->getScaleFactor ();
+	CRect pixelRect (atlasRect);
+	pixelRect.left *= scaleFactor;
+	pixelRect.top *= scaleFactor;
+	pixelRect.right *= scaleFactor;
+	pixelRect.bottom *= scaleFactor;
+	pixelRect.makeIntegral ();
+	CPoint size (pixelRect.getWidth (), pixelRect.getHeight ());
+	SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create (&size));
+	if (platformBitmap == 0)
+		return;
+	platformBitmap->setScaleFactor (scaleFactor);
+	SharedPointer<CBitmap> copy = owned (new CBitmap (platformBitmap));
+	SharedPointer<CBitmapPixelAccess> src = owned (CBitmapPixelAccess::create (source, true, false));
+	SharedPointer<CBitmapPixelAccess> dst = owned (CBitmapPixelAccess::create (copy));
+	if (src == 0 || dst == 0 || pixelRect.left < 0 || pixelRect.top < 0 || pixelRect.right > src->getBitmapWidth () || pixelRect.bottom > src->getBitmapHeight ())
+		return;
+	uint32_t left = static_cast<uint32_t> (pixelRect.left);
+	uint32_t top = static_cast<uint32_t> (pixelRect.top);
+	for (uint32_t y = 0; y < dst->getBitmapHeight (); y++)
+		PixelSpan::convert (src->getRow (top + y) + left, dst->getRow (y), dst->getBitmapWidth (), src->getPixelFormat (), dst->getPixelFormat ());
+	src = 0;
+	dst = 0;
+	bitmaps.push_back (platformBitmap);
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmap::unsharePlatformBitmap ()
+{
+	if (cache == 0 || bitmaps.empty ())
+		return true;
+	SharedPointer<IPlatformBitmap> source = bitmaps[0];
+	SharedPointer<IPlatformBitmap> platformBitmap;
+	if (cache->needsCopyForWrite (this, source))
+	{
+		// copy the pixels before the cache entry is released, the bitmap stays cached when the copy fails
+		CPoint size = source->getSize ();
+		platformBitmap = owned (IPlatformBitmap::create (&size));
+		if (platformBitmap == 0)
+			return false;
+		platformBitmap->setScaleFactor (source->getScaleFactor ());
+		SharedPointer<CBitmap> sourceBitmap = owned (new CBitmap (source));
+		SharedPointer<CBitmap> copy = owned (new CBitmap (platformBitmap));
+		SharedPointer<CBitmapPixelAccess> src = owned (CBitmapPixelAccess::create (sourceBitmap, true, false));
+		SharedPointer<CBitmapPixelAccess> dst = owned (CBitmapPixelAccess::create (copy));
+		if (src == 0 || dst == 0)
+			return false;
+		for (uint32_t y = 0; y < dst->getBitmapHeight (); y++)
+			PixelSpan::convert (src->getRow (y), dst->getRow (y), dst->getBitmapWidth (), src->getPixelFormat (), dst->getPixelFormat ());
+	}
+	cache->releaseForWrite (this, source);
+	if (platformBitmap)
+	{
+		bitmaps[0] = platformBitmap;
+		clearScaledFrames ();
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::setDeferredLoader (IDeferredLoader* loader)
+{
+	deferredLoader = loader;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::loadDeferred () const
+{
+	if (deferredLoader)
+	{
+		SharedPointer<IDeferredLoader> loader = deferredLoader;
+		deferredLoader = 0;
+		loader->loadNow (const_cast<CBitmap*> (this));
+	}
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* CBitmap::findBestPlatformBitmap (double scaleFactor) const
 {
 	if (bitmaps.empty ())
 		return 0;
@@ -184,6 +356,227 @@ IPlatformBitmap* CBitmap::getBestPlatformBitmapForScaleFactor (double scaleFacto
 	return bestBitmap;
 }
 
+/// @cond ignore
+//-----------------------------------------------------------------------------
+class CBitmap::ScaledFrames
+{
+public:
+	ScaledFrames (CBitmap* bitmap, bool resampleInBackground) : bitmap (bitmap), resampleInBackground (resampleInBackground) {}
+	~ScaledFrames () { clear (); }
+
+	CBitmap* get (double scaleFactor, CCoord frameHeight);
+	void clear ();
+	bool resamplesInBackground () const { return resampleInBackground; }
+
+private:
+	// frames with at least this many pixels are resampled in the background
+	enum { kBackgroundMinPixels = 512 * 512, kMaxScaleFactors = 2 };
+
+#if VSTGUI_HAS_FUNCTIONAL
+	struct Job
+	{
+		SharedPointer<CBitmap> input;
+		SharedPointer<CBitmap> output;
+		IdStringPtr filterName;
+		CPoint size;
+		std::atomic<bool> done;
+		std::thread thread;
+	};
+#endif
+
+	struct Entry
+	{
+		double scaleFactor;
+		SharedPointer<CBitmap> frames;
+#if VSTGUI_HAS_FUNCTIONAL
+		Job* job;
+#endif
+	};
+	typedef std::list<Entry> EntryList;
+
+	static bool isIntegral (CCoord value) { return std::abs (value - std::floor (value + 0.5)) < 0.0001; }
+	static SharedPointer<CBitmap> resample (CBitmap* input, IdStringPtr filterName, const CPoint& size, int32_t threadCount);
+	static SharedPointer<CBitmap> makeFrames (CBitmap* resampled, double scaleFactor);
+	void finishJob (Entry& entry);
+
+	CBitmap* bitmap;
+	bool resampleInBackground;
+	EntryList entries; // most recently used first
+};
+
+//-----------------------------------------------------------------------------
+CBitmap* CBitmap::ScaledFrames::get (double scaleFactor, CCoord frameHeight)
+{
+	for (EntryList::iterator it = entries.begin (); it != entries.end (); ++it)
+	{
+		if (it->scaleFactor != scaleFactor)
+			continue;
+		if (it != entries.begin ())
+			entries.splice (entries.begin (), entries, it);
+#if VSTGUI_HAS_FUNCTIONAL
+		if (it->job)
+		{
+			if (!it->job->done)
+				return 0;
+			finishJob (*it);
+		}
+#endif
+		return it->frames;
+	}
+
+	IPlatformBitmap* source = bitmap->getBestPlatformBitmapForScaleFactor (scaleFactor);
+	if (source == 0 || source->getScaleFactor () == scaleFactor)
+		return 0;
+	CPoint size (bitmap->getWidth () * scaleFactor, bitmap->getHeight () * scaleFactor);
+	// frames must start on whole pixels, otherwise neighbouring frames would bleed into each other
+	if (frameHeight <= 0. || !isIntegral (frameHeight * scaleFactor) || !isIntegral (size.x) || !isIntegral (size.y))
+		return 0;
+	size (std::floor (size.x + 0.5), std::floor (size.y + 0.5));
+
+	Entry entry;
+	entry.scaleFactor = scaleFactor;
+	IdStringPtr filterName = source->getScaleFactor () > scaleFactor ? BitmapFilter::Standard::kScaleArea : BitmapFilter::Standard::kScaleBilinear;
+	SharedPointer<CBitmap> input = owned (new CBitmap (source));
+#if VSTGUI_HAS_FUNCTIONAL
+	entry.job = 0;
+	if (resampleInBackground && size.x * size.y >= kBackgroundMinPixels)
+	{
+		// the job works on a copy, so that the source is not accessed while it is drawn
+		SharedPointer<CBitmap> copy = owned (new CBitmap (source->getSize ().x, source->getSize ().y));
+		SharedPointer<CBitmapPixelAccess> src = owned (CBitmapPixelAccess::create (input, true, false));
+		SharedPointer<CBitmapPixelAccess> dst = owned (CBitmapPixelAccess::create (copy));
+		if (src && dst && src->getPixelFormat () == dst->getPixelFormat ())
+		{
+			for (uint32_t y = 0; y < src->getBitmapHeight (); y++)
+				memcpy (dst->getRow (y), src->getRow (y), src->getBitmapWidth () * 4);
+			src = 0;
+			dst = 0;
+			Job* job = new Job;
+			job->input = copy;
+			job->filterName = filterName;
+			job->size = size;
+			job->done = false;
+			job->thread = std::thread ([job] () {
+				job->output = resample (job->input, job->filterName, job->size, 1);
+				job->input = 0;
+				job->done = true;
+			});
+			entry.job = job;
+		}
+	}
+	if (entry.job == 0)
+#endif
+		entry.frames = makeFrames (resample (input, filterName, size, 0), scaleFactor);
+	entries.push_front (entry);
+	while (entries.size () > kMaxScaleFactors)
+	{
+#if VSTGUI_HAS_FUNCTIONAL
+		finishJob (entries.back ());
+#endif
+		entries.pop_back ();
+	}
+	return entries.front ().frames;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::ScaledFrames::clear ()
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	for (EntryList::iterator it = entries.begin (); it != entries.end (); ++it)
+		finishJob (*it);
+#endif
+	entries.clear ();
+}
+
+#if VSTGUI_HAS_FUNCTIONAL
+//-----------------------------------------------------------------------------
+void CBitmap::ScaledFrames::finishJob (Entry& entry)
+{
+	if (entry.job == 0)
+		return;
+	entry.job->thread.join ();
+	entry.frames = makeFrames (entry.job->output, entry.scaleFactor);
+	delete entry.job;
+	entry.job = 0;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+SharedPointer<CBitmap> CBitmap::ScaledFrames::resample (CBitmap* input, IdStringPtr filterName, const CPoint& size, int32_t threadCount)
+{
+	SharedPointer<BitmapFilter::IFilter> filter = owned (BitmapFilter::Factory::getInstance ().createFilter (filterName));
+	if (filter == 0)
+		return 0;
+	filter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, BitmapFilter::Property (input));
+	filter->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, size.x, size.y));
+	filter->setProperty (BitmapFilter::Standard::Property::kThreadCount, BitmapFilter::Property (threadCount));
+	if (!filter->run ())
+		return 0;
+	return dynamic_cast<CBitmap*> (filter->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ());
+}
+
+//-----------------------------------------------------------------------------
+SharedPointer<CBitmap> CBitmap::ScaledFrames::makeFrames (CBitmap* resampled, double scaleFactor)
+{
+	if (resampled == 0 || resampled->getPlatformBitmap () == 0)
+		return 0;
+	resampled->getPlatformBitmap ()->setScaleFactor (scaleFactor);
+	return owned (new CBitmap (resampled->getPlatformBitmap ()));
+}
+/// @endcond
+
+//-----------------------------------------------------------------------------
+CBitmap::~CBitmap ()
+{
+	// defined after CBitmap::ScaledFrames, so that its destructor waits for the background jobs
+	delete scaledFrames;
+	if (cache)
+		cache->bitmapDestroyed (this);
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::setScaledFramesCacheEnabled (bool state, bool resampleInBackground)
+{
+	if (state && scaledFrames && scaledFrames->resamplesInBackground () == resampleInBackground)
+		return;
+	delete scaledFrames;
+	scaledFrames = state ? new ScaledFrames (this, resampleInBackground) : 0;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::clearScaledFrames ()
+{
+	if (scaledFrames)
+		scaledFrames->clear ();
+}
+
+//-----------------------------------------------------------------------------
+CBitmap* CBitmap::getScaledFrames (double scaleFactor, CCoord frameHeight)
+{
+	if (scaledFrames == 0 || deferredLoader)
+		return 0;
+	return scaledFrames->get (scaleFactor, frameHeight);
+}
+
+//-----------------------------------------------------------------------------
+void CBitmap::drawFrame (CDrawContext* context, const CRect& rect, const CPoint& offset, CCoord frameHeight, float alpha)
+{
+	if (scaledFrames)
+	{
+		// only an uniform scale of the context can be resampled up front
+		const CGraphicsTransform& t = context->getCurrentTransform ();
+		if (t.m12 == 0. && t.m21 == 0. && t.m11 == t.m22 && t.m11 > 0.)
+		{
+			if (CBitmap* frames = getScaledFrames (context->getScaleFactor () * t.m11, frameHeight))
+			{
+				frames->draw (context, rect, offset, alpha);
+				return;
+			}
+		}
+	}
+	draw (context, rect, offset, alpha);
+}
+
 //-----------------------------------------------------------------------------
 // CNinePartTiledBitmap Implementation
 //-----------------------------------------------------------------------------
@@ -228,6 +621,13 @@ CNinePartTiledBitmap::CNinePartTiledBitmap (IPlatformBitmap* platformBitmap, con
 {
 }
 
+//-----------------------------------------------------------------------------
+CNinePartTiledBitmap::CNinePartTiledBitmap (const CResourceDescription& desc, IPlatformBitmap* platformBitmap, const CNinePartTiledDescription& offsets)
+: CBitmap (desc, platformBitmap)
+, offsets (offsets)
+{
+}
+
 //-----------------------------------------------------------------------------
 CNinePartTiledBitmap::~CNinePartTiledBitmap ()
 {
@@ -236,6 +636,8 @@ CNinePartTiledBitmap::~CNinePartTiledBitmap ()
 //-----------------------------------------------------------------------------
 void CNinePartTiledBitmap::draw (CDrawContext* inContext, const CRect& inDestRect, const CPoint& offset, float inAlpha)
 {
+	if (isLoadDeferred ())
+		return;
 	inContext->drawBitmapNinePartTiled (this, inDestRect, offsets, inAlpha);
 }
 
@@ -252,6 +654,7 @@ CBitmapPixelAccess::CBitmapPixelAccess ()
 , maxY (0)
 , x (0)
 , y (0)
+, alphaPremultiplied (true)
 {
 }
 
@@ -263,10 +666,11 @@ CBitmapPixelAccess::~CBitmapPixelAccess ()
 }
 
 //------------------------------------------------------------------------
-void CBitmapPixelAccess::init (CBitmap* _bitmap, IPlatformBitmapPixelAccess* _pixelAccess)
+void CBitmapPixelAccess::init (CBitmap* _bitmap, IPlatformBitmapPixelAccess* _pixelAccess, bool _alphaPremultiplied)
 {
 	bitmap = _bitmap;
 	pixelAccess = _pixelAccess;
+	alphaPremultiplied = _alphaPremultiplied;
 	address = currentPos = pixelAccess->getAddress ();
 	bytesPerRow = pixelAccess->getBytesPerRow ();
 	maxX = (uint32_t)(bitmap->getPlatformBitmap ()->getSize ().x)-1;
@@ -299,10 +703,13 @@ public:
 /// @endcond
 
 //------------------------------------------------------------------------
-CBitmapPixelAccess* CBitmapPixelAccess::create (CBitmap* bitmap, bool alphaPremultiplied)
+CBitmapPixelAccess* CBitmapPixelAccess::create (CBitmap* bitmap, bool alphaPremultiplied, bool writeAccess)
 {
 	if (bitmap == 0 || bitmap->getPlatformBitmap () == 0)
 		return 0;
+	// a platform bitmap shared via the cache is copied before its pixels are changed
+	if (writeAccess && !bitmap->unsharePlatformBitmap ())
+		return 0;
 	IPlatformBitmapPixelAccess* pixelAccess = bitmap->getPlatformBitmap ()->lockPixels (alphaPremultiplied);
 	if (pixelAccess == 0)
 		return 0;
@@ -315,9 +722,22 @@ CBitmapPixelAccess* CBitmapPixelAccess::create (CBitmap* bitmap, bool alphaPremu
 		case IPlatformBitmapPixelAccess::kBGRA: result = new CBitmapPixelAccessOrder<2,1,0,3> (); break;
 	}
 	if (result)
-		result->init (bitmap, pixelAccess);
+		result->init (bitmap, pixelAccess, alphaPremultiplied);
 	return result;
 }
 
+//------------------------------------------------------------------------
+PixelSpan::Format CBitmapPixelAccess::getPixelFormat () const
+{
+	switch (pixelAccess->getPixelFormat ())
+	{
+		case IPlatformBitmapPixelAccess::kARGB: return PixelSpan::kARGB;
+		case IPlatformBitmapPixelAccess::kRGBA: return PixelSpan::kRGBA;
+		case IPlatformBitmapPixelAccess::kABGR: return PixelSpan::kABGR;
+		case IPlatformBitmapPixelAccess::kBGRA: return PixelSpan::kBGRA;
+	}
+	return PixelSpan::kARGB;
+}
+
 } // namespace VSTGUI
 
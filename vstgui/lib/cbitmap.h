@@ -39,6 +39,7 @@
 #include "cpoint.h"
 #include "crect.h"
 #include "cresourcedescription.h"
+#include "cpixelspan.h"
 #include <vector>
 
 namespace VSTGUI {
@@ -53,6 +54,7 @@ public:
 	CBitmap (const CResourceDescription& desc);				///< Create a pixmap from a resource identifier.
 	CBitmap (CCoord width, CCoord height);					///< Create a pixmap with a given size.
 	CBitmap (IPlatformBitmap* platformBitmap);
+	CBitmap (const CResourceDescription& desc, IPlatformBitmap* platformBitmap);	///< Create a pixmap for a resource identifier from an already loaded platform bitmap, which may be 0 if it is set later.
 	~CBitmap ();
 
 	//-----------------------------------------------------------------------------
@@ -61,10 +63,10 @@ public:
 	//@{
 	virtual void draw (CDrawContext* context, const CRect& rect, const CPoint& offset = CPoint (0, 0), float alpha = 1.f);
 
-	CCoord getWidth () const;		///< get the width of the image
-	CCoord getHeight () const;		///< get the height of the image
+	virtual CCoord getWidth () const;		///< get the width of the image
+	virtual CCoord getHeight () const;		///< get the height of the image
 
-	bool isLoaded () const { return getPlatformBitmap () ? true : false; }	///< check if image is loaded
+	bool isLoaded () const { return (atlas || getPlatformBitmap ()) ? true : false; }	///< check if image is loaded
 
 	const CResourceDescription& getResourceDescription () const { return resourceDesc; }
 
@@ -75,15 +77,86 @@ public:
 	IPlatformBitmap* getBestPlatformBitmapForScaleFactor (double scaleFactor) const;
 	//@}
 
+	//-----------------------------------------------------------------------------
+	/// @name Deferred Loading
+	/// @brief A bitmap can be handed out before its platform bitmap is loaded, for example while it is decoded on another thread.
+	//-----------------------------------------------------------------------------
+	//@{
+	class IDeferredLoader : public CBaseObject
+	{
+	public:
+		/** called when the platform bitmap is needed before the loader has set it, must set it via setPlatformBitmap before returning */
+		virtual void loadNow (CBitmap* bitmap) = 0;
+	};
+
+	/** while a loader is set, drawing the bitmap draws nothing and getPlatformBitmap, getWidth and getHeight wait for the loader */
+	void setDeferredLoader (IDeferredLoader* loader);
+	bool isLoadDeferred () const { return deferredLoader != 0; }
+	//@}
+
+	//-----------------------------------------------------------------------------
+	/// @name Scaled Frames
+	/// @brief Filmstrips (see IMultiBitmapControl) drawn at a scale factor none of their platform bitmaps has, for example
+	/// in a zoomed frame, can keep their frames resampled to that scale factor, so that drawing a frame is a plain copy.
+	//-----------------------------------------------------------------------------
+	//@{
+	/** enable the cache of scaled frames. It is shared by everyone drawing this bitmap and cleared when a platform bitmap is set or added.
+		With resampleInBackground large filmstrips are resampled on a background thread, which creates the platform bitmap of the
+		frames there. Not every platform bitmap implementation is safe to create off the main thread, so this is opt-in. */
+	void setScaledFramesCacheEnabled (bool state, bool resampleInBackground = false);
+	bool isScaledFramesCacheEnabled () const { return scaledFrames != 0; }
+	/** draw one frame of a filmstrip whose frames are frameHeight high, the offset selects the frame like in draw.
+		Draws the scaled frames if the cache is enabled and they are available for the scale factor of the context. */
+	void drawFrame (CDrawContext* context, const CRect& rect, const CPoint& offset, CCoord frameHeight, float alpha = 1.f);
+	/** the frames resampled to scaleFactor. If large filmstrips are resampled in the background, 0 is returned until that is done.
+		Also returns 0 if the cache is disabled, a platform bitmap has this scale factor or the frames can't be resampled to
+		whole pixels. */
+	CBitmap* getScaledFrames (double scaleFactor, CCoord frameHeight);
+	//@}
+
+	//-----------------------------------------------------------------------------
+	/// @name Atlas
+	/// @brief A bitmap can be a part of a larger atlas bitmap (see CBitmapAtlas). It then has no platform bitmap of its own
+	/// and draws its part of the atlas, so that many small bitmaps share one platform bitmap.
+	//-----------------------------------------------------------------------------
+	//@{
+	/** let the bitmap draw the rect of atlas instead of its platform bitmap, which is released. The rect is in the coordinates of
+		the atlas and must have the size of the bitmap. Fails if the bitmap has a deferred loader, is part of a CBitmapCache or has
+		more than one platform bitmap. Asking the bitmap for its platform bitmap copies its part of the atlas into a new platform bitmap
+		and removes it from the atlas again. */
+	bool setAtlas (CBitmap* atlas, const CRect& rect);
+	CBitmap* getAtlas () const { return atlas; }
+	const CRect& getAtlasRect () const { return atlasRect; }
+	/** the rect and offset to draw from the atlas for drawing the bitmap into dest with offset, returns false if nothing is visible */
+	bool mapToAtlas (const CRect& dest, const CPoint& offset, CRect& atlasDest, CPoint& atlasOffset) const;
+	//@}
+
 //-----------------------------------------------------------------------------
 	CLASS_METHODS_NOCOPY(CBitmap, CBaseObject)
 protected:
+	friend class CBitmapCache;
+	friend class CBitmapAtlas;
+	friend class CBitmapPixelAccess;
+
 	CBitmap ();
 
+	class ScaledFrames;
+
+	IPlatformBitmap* findBestPlatformBitmap (double scaleFactor) const;
+	void loadDeferred () const;
+	void clearScaledFrames ();
+	void leaveAtlas ();
+	bool unsharePlatformBitmap ();
+
 	CResourceDescription resourceDesc;
 	typedef SharedPointer<IPlatformBitmap> BitmapPointer;
 	typedef std::vector<BitmapPointer> BitmapVector;
 	BitmapVector bitmaps;
+	CBitmapCache* cache;
+	mutable SharedPointer<IDeferredLoader> deferredLoader;
+	ScaledFrames* scaledFrames;
+	SharedPointer<CBitmap> atlas;
+	CRect atlasRect;
 };
 
 //-----------------------------------------------------------------------------
@@ -145,6 +218,7 @@ class CNinePartTiledBitmap : public CBitmap
 public:
 	CNinePartTiledBitmap (const CResourceDescription& desc, const CNinePartTiledDescription& offsets);
 	CNinePartTiledBitmap (IPlatformBitmap* platformBitmap, const CNinePartTiledDescription& offsets);
+	CNinePartTiledBitmap (const CResourceDescription& desc, IPlatformBitmap* platformBitmap, const CNinePartTiledDescription& offsets);
 	~CNinePartTiledBitmap ();
 	
 	//-----------------------------------------------------------------------------
@@ -184,16 +258,29 @@ public:
 	inline uint32_t getBitmapWidth () const { return maxX+1; }
 	inline uint32_t getBitmapHeight () const { return maxY+1; }
 
+	//-----------------------------------------------------------------------------
+	/// @name Row Access
+	/// @brief Bulk access to the pixels, use the PixelSpan functions to process the rows.
+	//-----------------------------------------------------------------------------
+	//@{
+	/** pixels of row y, getBitmapWidth () pixels in the format of getPixelFormat () */
+	inline uint32_t* getRow (uint32_t y) const { return reinterpret_cast<uint32_t*> (address + y * bytesPerRow); }
+	inline uint32_t getBytesPerRow () const { return bytesPerRow; }
+	PixelSpan::Format getPixelFormat () const;
+	inline bool isAlphaPremultiplied () const { return alphaPremultiplied; }
+	//@}
+
 	inline IPlatformBitmapPixelAccess* getPlatformBitmapPixelAccess () const { return pixelAccess; }
 	/** create an accessor.
 		can return 0 if platform implementation does not support this.
-		result needs to be forgotten before the CBitmap reflects the change to the pixels */
-	static CBitmapPixelAccess* create (CBitmap* bitmap, bool alphaPremultiplied = true);
+		result needs to be forgotten before the CBitmap reflects the change to the pixels.
+		With writeAccess a platform bitmap shared via the CBitmapCache is copied first, pass false if the pixels are only read */
+	static CBitmapPixelAccess* create (CBitmap* bitmap, bool alphaPremultiplied = true, bool writeAccess = true);
 //-----------------------------------------------------------------------------
 protected:
 	CBitmapPixelAccess ();
 	~CBitmapPixelAccess ();
-	void init (CBitmap* bitmap, IPlatformBitmapPixelAccess* pixelAccess);
+	void init (CBitmap* bitmap, IPlatformBitmapPixelAccess* pixelAccess, bool alphaPremultiplied);
 
 	CBitmap* bitmap;
 	IPlatformBitmapPixelAccess* pixelAccess;
@@ -204,6 +291,7 @@ protected:
 	uint32_t maxY;
 	uint32_t x;
 	uint32_t y;
+	bool alphaPremultiplied;
 };
 
 //------------------------------------------------------------------------
@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "cbitmapatlas.h"
+#include "cpixelspan.h"
+#include "platform/iplatformbitmap.h"
+#include <algorithm>
+#include <cmath>
+
+namespace VSTGUI {
+
+//-----------------------------------------------------------------------------
+CBitmapAtlas::CBitmapAtlas (uint32_t pageSize, uint32_t maxBitmapSize)
+: pageSize (pageSize)
+, maxBitmapSize (maxBitmapSize)
+{
+}
+
+//-----------------------------------------------------------------------------
+CBitmapAtlas::~CBitmapAtlas ()
+{
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapAtlas::add (CBitmap* bitmap)
+{
+	if (bitmap == 0 || bitmap->atlas || bitmap->deferredLoader || bitmap->cache || bitmap->bitmaps.size () != 1)
+		return false;
+	IPlatformBitmap* platformBitmap = bitmap->bitmaps[0];
+	CPoint size = platformBitmap->getSize ();
+	// the border around every bitmap is one point wide
+	uint32_t border = static_cast<uint32_t> (std::ceil (platformBitmap->getScaleFactor ()));
+	if (size.x <= 0 || size.y <= 0 || size.x > maxBitmapSize || size.y > maxBitmapSize || size.x + 2 * border > pageSize || size.y + 2 * border > pageSize)
+		return false;
+	for (ItemVector::const_iterator it = bitmaps.begin (), end = bitmaps.end (); it != end; ++it)
+	{
+		if (it->bitmap == bitmap)
+			return false;
+	}
+	Item item;
+	item.bitmap = bitmap;
+	item.width = static_cast<uint32_t> (size.x);
+	item.height = static_cast<uint32_t> (size.y);
+	item.scaleFactor = platformBitmap->getScaleFactor ();
+	item.page = 0;
+	item.x = 0;
+	item.y = 0;
+	bitmaps.push_back (item);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapAtlas::compareItems (const Item& a, const Item& b)
+{
+	if (a.scaleFactor != b.scaleFactor)
+		return a.scaleFactor < b.scaleFactor;
+	if (a.height != b.height)
+		return a.height > b.height;
+	return a.width > b.width;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapAtlas::pack ()
+{
+	if (bitmaps.empty ())
+		return true;
+	std::stable_sort (bitmaps.begin (), bitmaps.end (), compareItems);
+
+	// place the bitmaps in rows, the highest first, so that the rows waste little space
+	std::vector<CPoint> pageSizes;
+	std::vector<double> pageScaleFactors;
+	uint32_t rowX = 0;
+	uint32_t rowY = 0;
+	uint32_t rowHeight = 0;
+	for (ItemVector::iterator it = bitmaps.begin (), end = bitmaps.end (); it != end; ++it)
+	{
+		// positions are multiples of the scale factor, so that every bitmap starts on a whole point
+		uint32_t unit = it->scaleFactor == std::floor (it->scaleFactor) ? static_cast<uint32_t> (it->scaleFactor) : 1;
+		uint32_t border = static_cast<uint32_t> (std::ceil (it->scaleFactor));
+		uint32_t cellWidth = (it->width + 2 * border + unit - 1) / unit * unit;
+		uint32_t cellHeight = (it->height + 2 * border + unit - 1) / unit * unit;
+		if (pageSizes.empty () || pageScaleFactors.back () != it->scaleFactor)
+		{
+			pageSizes.push_back (CPoint (0, 0));
+			pageScaleFactors.push_back (it->scaleFactor);
+			rowX = rowY = rowHeight = 0;
+		}
+		if (rowX + cellWidth > pageSize)
+		{
+			rowY += rowHeight;
+			rowX = rowHeight = 0;
+		}
+		if (rowY + cellHeight > pageSize)
+		{
+			pageSizes.push_back (CPoint (0, 0));
+			pageScaleFactors.push_back (it->scaleFactor);
+			rowX = rowY = rowHeight = 0;
+		}
+		it->page = static_cast<uint32_t> (pages.size () + pageSizes.size () - 1);
+		it->x = rowX + border;
+		it->y = rowY + border;
+		rowX += cellWidth;
+		rowHeight = std::max (rowHeight, cellHeight);
+		CPoint& usedSize = pageSizes.back ();
+		usedSize.x = std::max<CCoord> (usedSize.x, rowX);
+		usedSize.y = std::max<CCoord> (usedSize.y, rowY + rowHeight);
+	}
+
+	PageVector newPages;
+	for (size_t i = 0; i < pageSizes.size (); i++)
+	{
+		SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create (&pageSizes[i]));
+		if (platformBitmap == 0)
+			return false;
+		platformBitmap->setScaleFactor (pageScaleFactors[i]);
+		newPages.push_back (owned (new CBitmap (platformBitmap)));
+	}
+	pages.insert (pages.end (), newPages.begin (), newPages.end ());
+
+	std::vector<bool> copied (bitmaps.size (), false);
+	for (size_t i = 0; i < bitmaps.size ();)
+	{
+		uint32_t page = bitmaps[i].page;
+		SharedPointer<CBitmapPixelAccess> dst = owned (CBitmapPixelAccess::create (pages[page]));
+		for (; i < bitmaps.size () && bitmaps[i].page == page; i++)
+			copied[i] = dst && copyToPage (bitmaps[i], dst);
+	}
+	for (size_t i = 0; i < bitmaps.size (); i++)
+	{
+		if (!copied[i])
+			continue;
+		const Item& item = bitmaps[i];
+		CRect rect (item.x, item.y, item.x + item.width, item.y + item.height);
+		rect.left /= item.scaleFactor;
+		rect.top /= item.scaleFactor;
+		rect.right /= item.scaleFactor;
+		rect.bottom /= item.scaleFactor;
+		item.bitmap->setAtlas (pages[item.page], rect);
+	}
+	bitmaps.clear ();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapAtlas::copyToPage (const Item& item, CBitmapPixelAccess* dst) const
+{
+	SharedPointer<CBitmapPixelAccess> src = owned (CBitmapPixelAccess::create (item.bitmap, true, false));
+	if (src == 0 || src->getBitmapWidth () != item.width || src->getBitmapHeight () != item.height)
+		return false;
+	uint32_t border = static_cast<uint32_t> (std::ceil (item.scaleFactor));
+	for (int32_t y = -static_cast<int32_t> (border); y < static_cast<int32_t> (item.height + border); y++)
+	{
+		// the edge pixels are repeated into the border
+		uint32_t srcY = static_cast<uint32_t> (std::min (std::max (y, 0), static_cast<int32_t> (item.height) - 1));
+		uint32_t* dstRow = dst->getRow (item.y + y) + item.x;
+		PixelSpan::convert (src->getRow (srcY), dstRow, item.width, src->getPixelFormat (), dst->getPixelFormat ());
+		for (uint32_t i = 1; i <= border; i++)
+		{
+			*(dstRow - i) = dstRow[0];
+			dstRow[item.width - 1 + i] = dstRow[item.width - 1];
+		}
+	}
+	return true;
+}
+
+} // namespace VSTGUI
@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#ifndef __cbitmapatlas__
+#define __cbitmapatlas__
+
+#include "cbitmap.h"
+#include <vector>
+
+namespace VSTGUI {
+
+//-----------------------------------------------------------------------------
+/// @brief Packs small bitmaps into a few large atlas bitmaps
+/// @ingroup new_in_4_3
+/// @details The added bitmaps are packed row by row into pages of at most pageSize * pageSize pixels, one set of pages
+/// per scale factor. pack copies their pixels into the pages and makes every bitmap a part of its page (see CBitmap::setAtlas),
+/// which releases the platform bitmaps of the added bitmaps. Drawing works as before, but all bitmaps of a page share one
+/// platform bitmap.
+///
+/// The pixels at the edges of every bitmap are repeated into a one pixel border around it, so that drawing it scaled does not
+/// blend in its neighbours.
+//-----------------------------------------------------------------------------
+class CBitmapAtlas : public CBaseObject
+{
+public:
+	CBitmapAtlas (uint32_t pageSize = 1024, uint32_t maxBitmapSize = 128);
+	~CBitmapAtlas ();
+
+	/** add a bitmap to be packed. Fails if it is larger than maxBitmapSize pixels in one dimension or it can't be a part of an
+		atlas (see CBitmap::setAtlas). */
+	bool add (CBitmap* bitmap);
+	/** pack the added bitmaps into pages, returns false if a page could not be created */
+	bool pack ();
+
+	uint32_t getNumBitmaps () const { return static_cast<uint32_t> (bitmaps.size ()); }
+	uint32_t getNumPages () const { return static_cast<uint32_t> (pages.size ()); }
+	CBitmap* getPage (uint32_t index) const { return index < pages.size () ? pages[index] : 0; }
+
+	CLASS_METHODS_NOCOPY(CBitmapAtlas, CBaseObject)
+protected:
+	struct Item
+	{
+		SharedPointer<CBitmap> bitmap;
+		uint32_t width;
+		uint32_t height;
+		double scaleFactor;
+		uint32_t page;
+		uint32_t x;
+		uint32_t y;
+	};
+	typedef std::vector<Item> ItemVector;
+	typedef std::vector<SharedPointer<CBitmap> > PageVector;
+
+	static bool compareItems (const Item& a, const Item& b);
+	bool copyToPage (const Item& item, CBitmapPixelAccess* page) const;
+
+	ItemVector bitmaps;
+	PageVector pages;
+	uint32_t pageSize;
+	uint32_t maxBitmapSize;
+};
+
+} // namespace VSTGUI
+
+#endif // __cbitmapatlas__
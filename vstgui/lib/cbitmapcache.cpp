@@ -0,0 +1,565 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "cbitmapcache.h"
+#include "cbitmap.h"
+#include "platform/iplatformbitmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace VSTGUI {
+
+/// @cond ignore
+//-----------------------------------------------------------------------------
+struct CBitmapCache::Entry
+{
+	struct User
+	{
+		CBitmap* bitmap;
+		SharedPointer<ILoader> loader;
+	};
+	typedef std::vector<User> UserVector;
+	typedef std::vector<const CFrame*> FrameVector;
+
+	Key key;
+	SharedPointer<IPlatformBitmap> platformBitmap;
+	double scaleFactor;
+	uint64_t numBytes;
+	UserVector users;
+	EntryList::iterator position;
+	FrameVector usedBy;	// the frames which drew the variant, 0 for no frame
+
+	Entry (const Key& key) : key (key), scaleFactor (key.scaleFactor), numBytes (0) {}
+
+	bool isShared () const { return !key.resource.empty (); }
+};
+/// @endcond
+
+//-----------------------------------------------------------------------------
+bool CBitmapCache::Key::operator< (const Key& other) const
+{
+	if (resource != other.resource)
+		return resource < other.resource;
+	if (scaleFactor != other.scaleFactor)
+		return scaleFactor < other.scaleFactor;
+	return filters < other.filters;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapCache::Key::operator== (const Key& other) const
+{
+	return resource == other.resource && scaleFactor == other.scaleFactor && filters == other.filters;
+}
+
+//-----------------------------------------------------------------------------
+std::string CBitmapCache::Key::makeContentResource (const void* data, uint32_t size)
+{
+	// 64 bit FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	const uint8_t* bytes = static_cast<const uint8_t*> (data);
+	for (uint32_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	char result[40];
+	sprintf (result, "content:%08x%08x:%u", static_cast<uint32_t> (hash >> 32), static_cast<uint32_t> (hash), size);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+CBitmapCache::CBitmapCache ()
+: budget (0)
+, drawingFrame (0)
+{
+}
+
+//-----------------------------------------------------------------------------
+CBitmapCache::~CBitmapCache ()
+{
+	for (BitmapMap::const_iterator it = bitmapMap.begin (), end = bitmapMap.end (); it != end; ++it)
+		const_cast<CBitmap*> (it->first)->cache = 0;
+	for (EntryList::const_iterator it = entries.begin (), end = entries.end (); it != end; ++it)
+		delete *it;
+}
+
+//-----------------------------------------------------------------------------
+CBitmapCache& CBitmapCache::instance ()
+{
+	static CBitmapCache gInstance;
+	return gInstance;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::setBudget (uint64_t numBytes)
+{
+	budget = numBytes;
+	if (budget == 0)
+	{
+		EntryList::iterator it = entries.begin ();
+		while (it != entries.end ())
+		{
+			Entry* entry = *it++;
+			if (entry->users.empty ())
+				removeEntry (entry);
+		}
+	}
+	else
+		purge ();
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::purge ()
+{
+	if (budget == 0)
+		return;
+	EntryList::iterator it = entries.end ();
+	while (statistics.residentBytes > budget && it != entries.begin ())
+	{
+		Entry* entry = *(--it);
+		if (!isEvictable (entry))
+			continue;
+		if (entry->users.empty ())
+		{
+			++it;
+			removeEntry (entry);
+			++statistics.evictions;
+		}
+		else
+			evict (entry);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::resetUsage (const CFrame* frame)
+{
+	for (EntryList::const_iterator it = entries.begin (), end = entries.end (); it != end; ++it)
+	{
+		Entry::FrameVector& usedBy = (*it)->usedBy;
+		if (frame == 0)
+			usedBy.clear ();
+		else
+		{
+			usedBy.erase (std::remove (usedBy.begin (), usedBy.end (), frame), usedBy.end ());
+			usedBy.erase (std::remove (usedBy.begin (), usedBy.end (), static_cast<const CFrame*> (0)), usedBy.end ());
+		}
+	}
+	purge ();
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* CBitmapCache::get (const Key& key)
+{
+	if (key.resource.empty () == false)
+	{
+		KeyMap::const_iterator it = keyMap.find (key);
+		if (it != keyMap.end () && it->second->platformBitmap)
+		{
+			++statistics.hits;
+			touch (it->second);
+			return it->second->platformBitmap;
+		}
+	}
+	++statistics.misses;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapCache::add (CBitmap* bitmap, IPlatformBitmap* platformBitmap, const Key& key, ILoader* loader)
+{
+	if (bitmap == 0 || platformBitmap == 0)
+		return false;
+	if (bitmap->cache && bitmap->cache != this)
+	{
+		vstgui_assert (bitmap->cache == this, "bitmap is used by another cache");
+		return false;
+	}
+	Entry* entry = 0;
+	if (key.resource.empty () == false)
+	{
+		KeyMap::const_iterator it = keyMap.find (key);
+		if (it != keyMap.end ())
+		{
+			entry = it->second;
+			if (entry->platformBitmap && entry->platformBitmap != platformBitmap)
+				return false;
+		}
+	}
+	else
+	{
+		for (EntryList::const_iterator it = entries.begin (), end = entries.end (); it != end; ++it)
+		{
+			if ((*it)->platformBitmap == platformBitmap && (*it)->key == key)
+			{
+				entry = *it;
+				break;
+			}
+		}
+	}
+	if (std::find (bitmap->bitmaps.begin (), bitmap->bitmaps.end (), platformBitmap) == bitmap->bitmaps.end ())
+	{
+		if (bitmap->bitmaps.empty ())
+			bitmap->bitmaps.push_back (platformBitmap);
+		else if (!bitmap->addBitmap (platformBitmap))
+			return false;
+	}
+	if (entry == 0)
+	{
+		entry = new Entry (key);
+		entry->position = entries.insert (entries.begin (), entry);
+		if (entry->isShared ())
+			keyMap.insert (std::make_pair (key, entry));
+	}
+	if (entry->platformBitmap == 0)
+		makeResident (entry, platformBitmap);
+
+	Entry::UserVector::iterator userIt = entry->users.begin ();
+	for (; userIt != entry->users.end (); ++userIt)
+	{
+		if (userIt->bitmap == bitmap)
+			break;
+	}
+	if (userIt == entry->users.end ())
+	{
+		Entry::User user;
+		user.bitmap = bitmap;
+		user.loader = loader;
+		entry->users.push_back (user);
+		bitmapMap[bitmap].push_back (entry);
+	}
+	else
+		userIt->loader = loader;
+	bitmap->cache = this;
+
+	touch (entry);
+	purge ();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::detach (CBitmap* bitmap)
+{
+	BitmapMap::iterator it = bitmapMap.find (bitmap);
+	if (it == bitmapMap.end ())
+		return;
+	EntryVector bitmapEntries (it->second);
+	for (EntryVector::const_iterator eIt = bitmapEntries.begin (), end = bitmapEntries.end (); eIt != end; ++eIt)
+	{
+		if ((*eIt)->platformBitmap == 0)
+		{
+			markUsed (*eIt);
+			reload (*eIt);
+		}
+	}
+	bitmapMap.erase (bitmap);
+	bitmap->cache = 0;
+	for (EntryVector::const_iterator eIt = bitmapEntries.begin (), end = bitmapEntries.end (); eIt != end; ++eIt)
+		removeUser (*eIt, bitmap);
+	purge ();
+}
+
+//-----------------------------------------------------------------------------
+CBitmapCache::Statistics CBitmapCache::getStatistics () const
+{
+	Statistics result (statistics);
+	result.numVariants = static_cast<uint32_t> (entries.size ());
+	for (EntryList::const_iterator it = entries.begin (), end = entries.end (); it != end; ++it)
+	{
+		if ((*it)->platformBitmap)
+			++result.numResidentVariants;
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::resetStatistics ()
+{
+	uint64_t residentBytes = statistics.residentBytes;
+	statistics = Statistics ();
+	statistics.residentBytes = residentBytes;
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* CBitmapCache::getBestPlatformBitmap (CBitmap* bitmap, double scaleFactor)
+{
+	IPlatformBitmap* best = bitmap->findBestPlatformBitmap (scaleFactor);
+	BitmapMap::iterator it = bitmapMap.find (bitmap);
+	if (it == bitmapMap.end ())
+		return best;
+
+	Entry* bestEntry = 0;
+	if (best == 0 || best->getScaleFactor () != scaleFactor)
+	{
+		// a released variant may fit better, use the same rule as CBitmap
+		double bestScaleFactor = best ? best->getScaleFactor () : 0.;
+		double bestDiff = best ? std::abs (scaleFactor - bestScaleFactor) : 0.;
+		for (EntryVector::const_iterator eIt = it->second.begin (), end = it->second.end (); eIt != end; ++eIt)
+		{
+			Entry* entry = *eIt;
+			if (entry->platformBitmap)
+				continue;
+			if (entry->scaleFactor == scaleFactor)
+			{
+				bestEntry = entry;
+				break;
+			}
+			double diff = std::abs (scaleFactor - entry->scaleFactor);
+			if ((best == 0 && bestEntry == 0) || (diff <= bestDiff && entry->scaleFactor > bestScaleFactor))
+			{
+				bestEntry = entry;
+				bestScaleFactor = entry->scaleFactor;
+				bestDiff = diff;
+			}
+		}
+		if (bestEntry)
+		{
+			markUsed (bestEntry);
+			if (reload (bestEntry))
+				best = bestEntry->platformBitmap;
+			else
+			{
+				bestEntry = 0;
+				best = bitmap->findBestPlatformBitmap (scaleFactor);
+			}
+		}
+	}
+	if (bestEntry == 0)
+	{
+		it = bitmapMap.find (bitmap);
+		if (it == bitmapMap.end ())
+			return best;
+		for (EntryVector::const_iterator eIt = it->second.begin (), end = it->second.end (); eIt != end; ++eIt)
+		{
+			if ((*eIt)->platformBitmap == best)
+			{
+				bestEntry = *eIt;
+				break;
+			}
+		}
+	}
+	if (bestEntry)
+	{
+		markUsed (bestEntry);
+		touch (bestEntry);
+		purge ();
+	}
+	return best;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::platformBitmapReplaced (CBitmap* bitmap, IPlatformBitmap* platformBitmap)
+{
+	BitmapMap::iterator it = bitmapMap.find (bitmap);
+	if (it == bitmapMap.end ())
+		return;
+	for (EntryVector::iterator eIt = it->second.begin (); eIt != it->second.end (); ++eIt)
+	{
+		if ((*eIt)->platformBitmap == platformBitmap)
+		{
+			Entry* entry = *eIt;
+			it->second.erase (eIt);
+			if (it->second.empty ())
+			{
+				bitmapMap.erase (it);
+				bitmap->cache = 0;
+			}
+			removeUser (entry, bitmap);
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::bitmapDestroyed (CBitmap* bitmap)
+{
+	BitmapMap::iterator it = bitmapMap.find (bitmap);
+	if (it == bitmapMap.end ())
+		return;
+	EntryVector bitmapEntries (it->second);
+	bitmapMap.erase (it);
+	for (EntryVector::const_iterator eIt = bitmapEntries.begin (), end = bitmapEntries.end (); eIt != end; ++eIt)
+		removeUser (*eIt, bitmap);
+	purge ();
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapCache::needsCopyForWrite (const CBitmap* bitmap, IPlatformBitmap* platformBitmap) const
+{
+	BitmapMap::const_iterator it = bitmapMap.find (bitmap);
+	if (it == bitmapMap.end ())
+		return false;
+	for (EntryVector::const_iterator eIt = it->second.begin (), end = it->second.end (); eIt != end; ++eIt)
+	{
+		const Entry* entry = *eIt;
+		// the same condition as in removeUser, other users or later lookups would see the changed pixels
+		if (entry->platformBitmap == platformBitmap)
+			return entry->users.size () > 1 || (budget != 0 && entry->isShared ());
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::releaseForWrite (CBitmap* bitmap, IPlatformBitmap* platformBitmap)
+{
+	BitmapMap::iterator it = bitmapMap.find (bitmap);
+	if (it == bitmapMap.end ())
+		return;
+	EntryVector& bitmapEntries = it->second;
+	for (EntryVector::iterator eIt = bitmapEntries.begin (); eIt != bitmapEntries.end (); ++eIt)
+	{
+		Entry* entry = *eIt;
+		if (entry->platformBitmap != platformBitmap)
+			continue;
+		bitmapEntries.erase (eIt);
+		removeUser (entry, bitmap);
+		break;
+	}
+	if (bitmapEntries.empty ())
+	{
+		bitmapMap.erase (it);
+		bitmap->cache = 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::touch (Entry* entry)
+{
+	entries.splice (entries.begin (), entries, entry->position);
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::markUsed (Entry* entry)
+{
+	if (std::find (entry->usedBy.begin (), entry->usedBy.end (), drawingFrame) == entry->usedBy.end ())
+		entry->usedBy.push_back (drawingFrame);
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::makeResident (Entry* entry, IPlatformBitmap* platformBitmap)
+{
+	CPoint size = platformBitmap->getSize ();
+	entry->platformBitmap = platformBitmap;
+	entry->scaleFactor = platformBitmap->getScaleFactor ();
+	entry->numBytes = static_cast<uint64_t> (size.x) * static_cast<uint64_t> (size.y) * 4;
+	statistics.residentBytes += entry->numBytes;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapCache::reload (Entry* entry)
+{
+	// the loader may add the variant to the cache itself, so check the entry after every call
+	for (size_t i = 0; i < entry->users.size () && entry->platformBitmap == 0; ++i)
+	{
+		SharedPointer<ILoader> loader = entry->users[i].loader;
+		if (loader == 0)
+			continue;
+		SharedPointer<IPlatformBitmap> platformBitmap = owned (loader->loadPlatformBitmap (entry->key));
+		if (platformBitmap && entry->platformBitmap == 0)
+			makeResident (entry, platformBitmap);
+	}
+	if (entry->platformBitmap == 0)
+		return false;
+	for (Entry::UserVector::const_iterator it = entry->users.begin (), end = entry->users.end (); it != end; ++it)
+	{
+		CBitmap::BitmapVector& bitmaps = it->bitmap->bitmaps;
+		if (std::find (bitmaps.begin (), bitmaps.end (), entry->platformBitmap) == bitmaps.end ())
+			bitmaps.push_back (entry->platformBitmap);
+	}
+	++statistics.reloads;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::evict (Entry* entry)
+{
+	for (Entry::UserVector::const_iterator it = entry->users.begin (), end = entry->users.end (); it != end; ++it)
+	{
+		CBitmap::BitmapVector& bitmaps = it->bitmap->bitmaps;
+		bitmaps.erase (std::remove (bitmaps.begin (), bitmaps.end (), entry->platformBitmap), bitmaps.end ());
+	}
+	statistics.residentBytes -= entry->numBytes;
+	entry->platformBitmap = 0;
+	++statistics.evictions;
+}
+
+//-----------------------------------------------------------------------------
+bool CBitmapCache::isEvictable (Entry* entry) const
+{
+	if (entry->platformBitmap == 0)
+		return false;
+	if (entry->users.empty ())
+		return true;
+	if (!entry->usedBy.empty ())
+		return false;
+	bool hasLoader = false;
+	for (Entry::UserVector::const_iterator it = entry->users.begin (), end = entry->users.end (); it != end; ++it)
+	{
+		// never release the last platform bitmap of a bitmap
+		if (it->bitmap->bitmaps.size () < 2)
+			return false;
+		if (it->loader)
+			hasLoader = true;
+	}
+	return hasLoader;
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::removeUser (Entry* entry, const CBitmap* bitmap)
+{
+	for (Entry::UserVector::iterator it = entry->users.begin (), end = entry->users.end (); it != end; ++it)
+	{
+		if (it->bitmap == bitmap)
+		{
+			entry->users.erase (it);
+			break;
+		}
+	}
+	if (entry->users.empty () && (budget == 0 || entry->platformBitmap == 0 || entry->isShared () == false))
+		removeEntry (entry);
+}
+
+//-----------------------------------------------------------------------------
+void CBitmapCache::removeEntry (Entry* entry)
+{
+	entries.erase (entry->position);
+	if (entry->isShared ())
+		keyMap.erase (entry->key);
+	if (entry->platformBitmap)
+		statistics.residentBytes -= entry->numBytes;
+	delete entry;
+}
+
+} // namespace
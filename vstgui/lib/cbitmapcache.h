@@ -0,0 +1,199 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef __cbitmapcache__
+#define __cbitmapcache__
+
+#include "vstguifwd.h"
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+namespace VSTGUI {
+
+//-----------------------------------------------------------------------------
+/// @brief Memory budgeted cache of the platform bitmaps of CBitmap objects
+/// @ingroup new_in_4_3
+/// @details Every platform bitmap in the cache is a variant of a bitmap resource and is identified by a Key
+/// made of the resource name, the scale factor and a description of the filters applied to it. Bitmaps
+/// with the same key share one platform bitmap.
+///
+/// If a budget is set, platform bitmaps no longer used by any CBitmap stay in the cache for later lookups
+/// and once the resident bytes exceed the budget the least recently used variants are released:
+/// first the ones without CBitmap, then the scale variants no attached CFrame draws with. The usage is tracked
+/// per CFrame, a frame which closes or changes its scale factor only resets the usage of the variants it drew. The last platform
+/// bitmap of a CBitmap and variants added without a loader are never released. A released variant is loaded
+/// again via its ILoader when a draw context asks the CBitmap for it.
+///
+/// Without a budget (the default) platform bitmaps are released as soon as their last CBitmap goes away.
+///
+/// Platform bitmaps in the cache are treated as immutable: creating a CBitmapPixelAccess for a CBitmap removes the
+/// bitmap from the cache and, if other bitmaps share its platform bitmap or the cache keeps it for later lookups,
+/// gives the bitmap a copy of it first (copy on write).
+///
+/// The cache must only be used from the main thread.
+//-----------------------------------------------------------------------------
+class CBitmapCache
+{
+public:
+	//-----------------------------------------------------------------------------
+	struct Key
+	{
+		/** resource name, platform bitmaps with an empty resource name are never shared */
+		std::string resource;
+		double scaleFactor;
+		/** description of the filters applied to the resource */
+		std::string filters;
+
+		Key (const std::string& resource = "", double scaleFactor = 1., const std::string& filters = "")
+		: resource (resource), scaleFactor (scaleFactor), filters (filters) {}
+
+		/** a resource name made of a hash of the data, for bitmaps which are identified by their content */
+		static std::string makeContentResource (const void* data, uint32_t size);
+
+		bool operator< (const Key& other) const;
+		bool operator== (const Key& other) const;
+	};
+
+	//-----------------------------------------------------------------------------
+	class ILoader : public CBaseObject
+	{
+	public:
+		/** load the released variant again, the caller owns the returned platform bitmap */
+		virtual IPlatformBitmap* loadPlatformBitmap (const Key& key) = 0;
+	};
+
+	//-----------------------------------------------------------------------------
+	struct Statistics
+	{
+		uint64_t residentBytes;		///< bytes of all platform bitmaps in memory
+		uint32_t numVariants;		///< number of variants known to the cache
+		uint32_t numResidentVariants;	///< number of variants in memory
+		uint64_t hits;				///< lookups which found a platform bitmap in memory
+		uint64_t misses;			///< lookups which did not find a platform bitmap
+		uint64_t reloads;			///< released variants loaded again on demand
+		uint64_t evictions;			///< variants released to meet the budget
+
+		Statistics () : residentBytes (0), numVariants (0), numResidentVariants (0), hits (0), misses (0), reloads (0), evictions (0) {}
+	};
+
+	CBitmapCache ();
+	~CBitmapCache ();
+
+	/** the cache used by UIDescription and CFrame */
+	static CBitmapCache& instance ();
+
+	//-----------------------------------------------------------------------------
+	/// @name Budget
+	//-----------------------------------------------------------------------------
+	//@{
+	/** set the budget in bytes, 0 means unlimited */
+	void setBudget (uint64_t numBytes);
+	uint64_t getBudget () const { return budget; }
+	/** release variants until the resident bytes are within the budget */
+	void purge ();
+	/** the frame which draws the variants looked up from now on, set by CFrame while it draws */
+	void setDrawingFrame (const CFrame* frame) { drawingFrame = frame; }
+	const CFrame* getDrawingFrame () const { return drawingFrame; }
+	/** mark the variants as unused by frame, called when the frame changes its scale factor or is closed.
+		Variants used while no frame was drawing are reset with every frame, 0 resets the usage of all frames. */
+	void resetUsage (const CFrame* frame = 0);
+	//@}
+
+	//-----------------------------------------------------------------------------
+	/// @name Variants
+	//-----------------------------------------------------------------------------
+	//@{
+	/** lookup the platform bitmap for key, returns 0 if it is not in memory */
+	IPlatformBitmap* get (const Key& key);
+	/** add platformBitmap as the variant key of bitmap.
+		If bitmap does not contain platformBitmap yet, it is added to it.
+		The loader is used to load the variant again after it was released, without loader it is never released.
+		Returns false if the platform bitmap does not fit to the bitmap or the key is used by another platform bitmap. */
+	bool add (CBitmap* bitmap, IPlatformBitmap* platformBitmap, const Key& key, ILoader* loader = 0);
+	/** load all released variants of bitmap and remove the bitmap from the cache */
+	void detach (CBitmap* bitmap);
+	//@}
+
+	//-----------------------------------------------------------------------------
+	/// @name Statistics
+	//-----------------------------------------------------------------------------
+	//@{
+	Statistics getStatistics () const;
+	/** reset the hits, misses, reloads and evictions counters */
+	void resetStatistics ();
+	//@}
+
+//-----------------------------------------------------------------------------
+private:
+	friend class CBitmap;
+
+	CBitmapCache (const CBitmapCache&);
+	CBitmapCache& operator= (const CBitmapCache&);
+
+	struct Entry;
+	typedef std::list<Entry*> EntryList;
+	typedef std::vector<Entry*> EntryVector;
+	typedef std::map<Key, Entry*> KeyMap;
+	typedef std::map<const CBitmap*, EntryVector> BitmapMap;
+
+	// called by CBitmap
+	IPlatformBitmap* getBestPlatformBitmap (CBitmap* bitmap, double scaleFactor);
+	void platformBitmapReplaced (CBitmap* bitmap, IPlatformBitmap* platformBitmap);
+	void bitmapDestroyed (CBitmap* bitmap);
+	bool needsCopyForWrite (const CBitmap* bitmap, IPlatformBitmap* platformBitmap) const;
+	void releaseForWrite (CBitmap* bitmap, IPlatformBitmap* platformBitmap);
+
+	void touch (Entry* entry);
+	void markUsed (Entry* entry);
+	void makeResident (Entry* entry, IPlatformBitmap* platformBitmap);
+	bool reload (Entry* entry);
+	void evict (Entry* entry);
+	bool isEvictable (Entry* entry) const;
+	void removeUser (Entry* entry, const CBitmap* bitmap);
+	void removeEntry (Entry* entry);
+
+	EntryList entries;	// most recently used first
+	KeyMap keyMap;
+	BitmapMap bitmapMap;
+	uint64_t budget;
+	Statistics statistics;
+	const CFrame* drawingFrame;
+};
+
+} // namespace
+
+#endif // __cbitmapcache__
@@ -0,0 +1,423 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "cbitmapcodec.h"
+#include "cbitmap.h"
+#include "cpixelspan.h"
+#include "platform/iplatformbitmap.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace VSTGUI {
+namespace BitmapCodec {
+
+/// @cond ignore
+namespace QOI {
+
+enum {
+	kOpIndex = 0x00,
+	kOpDiff = 0x40,
+	kOpLuma = 0x80,
+	kOpRun = 0xC0,
+	kOpRGB = 0xFE,
+	kOpRGBA = 0xFF,
+	kOpMask = 0xC0,
+
+	kHeaderSize = 14,
+	kMaxRun = 62,
+	kMaxPixels = 400000000
+};
+
+static const uint8_t kMagic[4] = {'q', 'o', 'i', 'f'};
+static const uint8_t kEndMarker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+//-----------------------------------------------------------------------------
+inline uint32_t hash (const uint8_t* p)
+{
+	return (p[0] * 3 + p[1] * 5 + p[2] * 7 + p[3] * 11) % 64;
+}
+
+//-----------------------------------------------------------------------------
+inline uint32_t opLength (uint8_t op)
+{
+	if (op == kOpRGB)
+		return 4;
+	if (op == kOpRGBA)
+		return 5;
+	return (op & kOpMask) == kOpLuma ? 2 : 1;
+}
+
+//-----------------------------------------------------------------------------
+inline void write32 (std::vector<uint8_t>& output, uint32_t value)
+{
+	output.push_back (static_cast<uint8_t> (value >> 24));
+	output.push_back (static_cast<uint8_t> (value >> 16));
+	output.push_back (static_cast<uint8_t> (value >> 8));
+	output.push_back (static_cast<uint8_t> (value));
+}
+
+//-----------------------------------------------------------------------------
+inline uint32_t read32 (const uint8_t* p)
+{
+	return (static_cast<uint32_t> (p[0]) << 24) | (static_cast<uint32_t> (p[1]) << 16) | (static_cast<uint32_t> (p[2]) << 8) | p[3];
+}
+
+//-----------------------------------------------------------------------------
+static bool encode (IPlatformBitmap* platformBitmap, std::vector<uint8_t>& output)
+{
+	SharedPointer<CBitmap> bitmap = owned (new CBitmap (platformBitmap));
+	// QOI stores the color components not multiplied with alpha
+	SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap, false, false));
+	if (accessor == 0)
+		return false;
+	const uint32_t width = accessor->getBitmapWidth ();
+	const uint32_t height = accessor->getBitmapHeight ();
+	if (static_cast<uint64_t> (width) * height > kMaxPixels)
+		return false;
+
+	output.clear ();
+	output.reserve (kHeaderSize + width * height + sizeof (kEndMarker));
+	output.insert (output.end (), kMagic, kMagic + 4);
+	write32 (output, width);
+	write32 (output, height);
+	output.push_back (4); // channels
+	output.push_back (0); // sRGB with linear alpha
+
+	uint8_t index[64][4];
+	memset (index, 0, sizeof (index));
+	uint8_t previous[4] = {0, 0, 0, 255};
+	uint32_t run = 0;
+	std::vector<uint32_t> row (width);
+	const PixelSpan::Format format = accessor->getPixelFormat ();
+	for (uint32_t y = 0; y < height; y++)
+	{
+		PixelSpan::convert (accessor->getRow (y), &row[0], width, format, PixelSpan::kRGBA);
+		const uint8_t* px = reinterpret_cast<const uint8_t*> (&row[0]);
+		for (uint32_t x = 0; x < width; x++, px += 4)
+		{
+			if (memcmp (px, previous, 4) == 0)
+			{
+				if (++run == kMaxRun)
+				{
+					output.push_back (static_cast<uint8_t> (kOpRun | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+			if (run)
+			{
+				output.push_back (static_cast<uint8_t> (kOpRun | (run - 1)));
+				run = 0;
+			}
+			uint32_t h = hash (px);
+			if (memcmp (index[h], px, 4) == 0)
+				output.push_back (static_cast<uint8_t> (kOpIndex | h));
+			else
+			{
+				memcpy (index[h], px, 4);
+				if (px[3] == previous[3])
+				{
+					int8_t vr = static_cast<int8_t> (px[0] - previous[0]);
+					int8_t vg = static_cast<int8_t> (px[1] - previous[1]);
+					int8_t vb = static_cast<int8_t> (px[2] - previous[2]);
+					int8_t vgr = static_cast<int8_t> (vr - vg);
+					int8_t vgb = static_cast<int8_t> (vb - vg);
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+						output.push_back (static_cast<uint8_t> (kOpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+					else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8)
+					{
+						output.push_back (static_cast<uint8_t> (kOpLuma | (vg + 32)));
+						output.push_back (static_cast<uint8_t> ((vgr + 8) << 4 | (vgb + 8)));
+					}
+					else
+					{
+						output.push_back (kOpRGB);
+						output.insert (output.end (), px, px + 3);
+					}
+				}
+				else
+				{
+					output.push_back (kOpRGBA);
+					output.insert (output.end (), px, px + 4);
+				}
+			}
+			memcpy (previous, px, 4);
+		}
+	}
+	if (run)
+		output.push_back (static_cast<uint8_t> (kOpRun | (run - 1)));
+	output.insert (output.end (), kEndMarker, kEndMarker + sizeof (kEndMarker));
+	return true;
+}
+
+} // QOI
+/// @endcond
+
+//-----------------------------------------------------------------------------
+bool isQOI (const void* data, uint32_t size)
+{
+	return data && size >= QOI::kHeaderSize && memcmp (data, QOI::kMagic, 4) == 0;
+}
+
+//-----------------------------------------------------------------------------
+bool createMemoryRepresentation (IPlatformBitmap* bitmap, Format format, void** ptr, uint32_t& size)
+{
+	if (bitmap == 0)
+		return false;
+	if (format == kPNG)
+		return IPlatformBitmap::createMemoryPNGRepresentation (bitmap, ptr, size);
+	std::vector<uint8_t> output;
+	if (!QOI::encode (bitmap, output) || output.size () > 0xFFFFFFFFu)
+		return false;
+	*ptr = std::malloc (output.size ());
+	if (*ptr == 0)
+		return false;
+	memcpy (*ptr, &output[0], output.size ());
+	size = static_cast<uint32_t> (output.size ());
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* createFromMemory (const void* ptr, uint32_t size)
+{
+	if (!isQOI (ptr, size))
+		return IPlatformBitmap::createFromMemory (ptr, size);
+	QOIDecoder decoder;
+	if (!decoder.write (ptr, size) || !decoder.isComplete ())
+		return 0;
+	IPlatformBitmap* result = decoder.getPlatformBitmap ();
+	result->remember ();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* createFromPath (UTF8StringPtr absolutePath)
+{
+	FILE* file = fopen (absolutePath, "rb");
+	if (file == 0)
+		return IPlatformBitmap::createFromPath (absolutePath);
+	uint8_t buffer[64 * 1024];
+	size_t numRead = fread (buffer, 1, QOI::kHeaderSize, file);
+	if (!isQOI (buffer, static_cast<uint32_t> (numRead)))
+	{
+		fclose (file);
+		return IPlatformBitmap::createFromPath (absolutePath);
+	}
+	// decode while reading, so that the file is never in memory as a whole
+	QOIDecoder decoder;
+	bool valid = decoder.write (buffer, static_cast<uint32_t> (numRead));
+	while (valid && !decoder.isComplete () && (numRead = fread (buffer, 1, sizeof (buffer), file)) > 0)
+		valid = decoder.write (buffer, static_cast<uint32_t> (numRead));
+	fclose (file);
+	if (!valid || !decoder.isComplete ())
+		return 0;
+	IPlatformBitmap* result = decoder.getPlatformBitmap ();
+	result->remember ();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+QOIDecoder::QOIDecoder ()
+: state (kHeader)
+, headerSize (0)
+, pendingSize (0)
+, width (0)
+, height (0)
+, x (0)
+, y (0)
+{
+	pixel[0] = pixel[1] = pixel[2] = 0;
+	pixel[3] = 255;
+	memset (index, 0, sizeof (index));
+}
+
+//-----------------------------------------------------------------------------
+QOIDecoder::~QOIDecoder ()
+{
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* QOIDecoder::getPlatformBitmap () const
+{
+	return state == kComplete ? bitmap->getPlatformBitmap () : 0;
+}
+
+//-----------------------------------------------------------------------------
+bool QOIDecoder::write (const void* data, uint32_t size)
+{
+	const uint8_t* p = static_cast<const uint8_t*> (data);
+	const uint8_t* end = p + size;
+	while (p < end)
+	{
+		if (state == kHeader)
+		{
+			uint32_t numBytes = std::min<uint32_t> (QOI::kHeaderSize - headerSize, static_cast<uint32_t> (end - p));
+			memcpy (header + headerSize, p, numBytes);
+			headerSize += numBytes;
+			p += numBytes;
+			if (headerSize == QOI::kHeaderSize && !startPixels ())
+				state = kError;
+		}
+		else if (state == kPixels)
+		{
+			if (pendingSize == 0)
+			{
+				// the longest op has 5 bytes, as long as there are as many left the ops are decoded in place
+				while (state == kPixels && end - p >= 5)
+					p += decodeOp (p);
+				if (state != kPixels)
+					continue;
+			}
+			// collect the bytes of an op which is split between two writes
+			while (p < end)
+			{
+				pending[pendingSize++] = *p++;
+				if (pendingSize == QOI::opLength (pending[0]))
+				{
+					decodeOp (pending);
+					pendingSize = 0;
+					break;
+				}
+			}
+		}
+		else
+			break; // the rest is the end marker
+	}
+	return state != kError;
+}
+
+//-----------------------------------------------------------------------------
+bool QOIDecoder::startPixels ()
+{
+	if (memcmp (header, QOI::kMagic, 4) != 0)
+		return false;
+	width = QOI::read32 (header + 4);
+	height = QOI::read32 (header + 8);
+	if (width == 0 || height == 0 || static_cast<uint64_t> (width) * height > QOI::kMaxPixels)
+		return false;
+	if (header[12] != 3 && header[12] != 4)
+		return false;
+	CPoint size (width, height);
+	SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create (&size));
+	if (platformBitmap == 0)
+		return false;
+	bitmap = owned (new CBitmap (platformBitmap));
+	accessor = owned (CBitmapPixelAccess::create (bitmap, false));
+	if (accessor == 0)
+		return false;
+	row.resize (width);
+	state = kPixels;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t QOIDecoder::decodeOp (const uint8_t* op)
+{
+	const uint8_t b0 = op[0];
+	uint32_t count = 1;
+	if (b0 == QOI::kOpRGB)
+	{
+		pixel[0] = op[1];
+		pixel[1] = op[2];
+		pixel[2] = op[3];
+	}
+	else if (b0 == QOI::kOpRGBA)
+	{
+		memcpy (pixel, op + 1, 4);
+	}
+	else
+	{
+		switch (b0 & QOI::kOpMask)
+		{
+			case QOI::kOpIndex:
+			{
+				memcpy (pixel, index[b0], 4);
+				break;
+			}
+			case QOI::kOpDiff:
+			{
+				pixel[0] += ((b0 >> 4) & 0x03) - 2;
+				pixel[1] += ((b0 >> 2) & 0x03) - 2;
+				pixel[2] += (b0 & 0x03) - 2;
+				break;
+			}
+			case QOI::kOpLuma:
+			{
+				int32_t vg = (b0 & 0x3F) - 32;
+				pixel[0] += vg - 8 + ((op[1] >> 4) & 0x0F);
+				pixel[1] += vg;
+				pixel[2] += vg - 8 + (op[1] & 0x0F);
+				break;
+			}
+			case QOI::kOpRun:
+			{
+				count = (b0 & 0x3F) + 1;
+				break;
+			}
+		}
+	}
+	memcpy (index[QOI::hash (pixel)], pixel, 4);
+	emitPixel (count);
+	return QOI::opLength (b0);
+}
+
+//-----------------------------------------------------------------------------
+void QOIDecoder::emitPixel (uint32_t count)
+{
+	uint32_t value;
+	memcpy (&value, pixel, 4);
+	while (count > 0 && state == kPixels)
+	{
+		uint32_t numPixels = std::min (count, width - x);
+		PixelSpan::fill (&row[x], numPixels, value);
+		x += numPixels;
+		count -= numPixels;
+		if (x == width)
+		{
+			PixelSpan::convert (&row[0], accessor->getRow (y), width, PixelSpan::kRGBA, accessor->getPixelFormat ());
+			x = 0;
+			if (++y == height)
+			{
+				// the bitmap reflects the pixels only after the accessor is released
+				accessor = 0;
+				state = kComplete;
+			}
+		}
+	}
+}
+
+} // namespace BitmapCodec
+} // namespace VSTGUI
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#ifndef __cbitmapcodec__
+#define __cbitmapcodec__
+
+#include "vstguifwd.h"
+#include <vector>
+
+namespace VSTGUI {
+class CBitmapPixelAccess;
+
+//-----------------------------------------------------------------------------
+/** @brief Encoding and decoding of bitmaps in memory and files
+	@ingroup new_in_4_3
+
+	Besides PNG, which is handled by the platform, bitmaps can be stored in the lossless QOI format
+	(see https://qoiformat.org). It compresses about as well as PNG for typical user interface graphics,
+	but decodes many times faster, and is decoded by portable code into any platform bitmap.
+*/
+//-----------------------------------------------------------------------------
+namespace BitmapCodec {
+
+enum Format {
+	kPNG,
+	kQOI
+};
+
+/** check if the data starts with the signature of a QOI image */
+bool isQOI (const void* data, uint32_t size);
+
+/** Create a memory representation of the platform bitmap in the format. The memory could be used by createFromMemory.
+	Caller needs to free the memory in ptr */
+bool createMemoryRepresentation (IPlatformBitmap* bitmap, Format format, void** ptr, uint32_t& size);
+
+/** create a platform bitmap from memory, QOI images are decoded here, all others by IPlatformBitmap::createFromMemory */
+IPlatformBitmap* createFromMemory (const void* ptr, uint32_t size);
+
+/** create a platform bitmap from an absolute path, QOI images are decoded here, all others by IPlatformBitmap::createFromPath */
+IPlatformBitmap* createFromPath (UTF8StringPtr absolutePath);
+
+//-----------------------------------------------------------------------------
+/** @brief Decodes a QOI image which arrives in pieces */
+//-----------------------------------------------------------------------------
+class QOIDecoder
+{
+public:
+	QOIDecoder ();
+	~QOIDecoder ();
+
+	/** decode the next bytes of the image, returns false if the data is invalid */
+	bool write (const void* data, uint32_t size);
+	/** true when all pixels are decoded */
+	bool isComplete () const { return state == kComplete; }
+	/** the decoded bitmap, 0 until all pixels are decoded */
+	IPlatformBitmap* getPlatformBitmap () const;
+
+private:
+	QOIDecoder (const QOIDecoder&);
+	QOIDecoder& operator= (const QOIDecoder&);
+
+	enum State {
+		kHeader,
+		kPixels,
+		kComplete,
+		kError
+	};
+
+	bool startPixels ();
+	uint32_t decodeOp (const uint8_t* op);
+	void emitPixel (uint32_t count);
+
+	State state;
+	uint8_t header[14];
+	uint32_t headerSize;
+	uint8_t pending[5];
+	uint32_t pendingSize;
+	uint8_t pixel[4];
+	uint8_t index[64][4];
+	uint32_t width;
+	uint32_t height;
+	uint32_t x;
+	uint32_t y;
+	std::vector<uint32_t> row;
+	SharedPointer<CBitmap> bitmap;
+	SharedPointer<CBitmapPixelAccess> accessor;
+};
+
+} // namespace BitmapCodec
+
+} // namespace VSTGUI
+
+#endif // __cbitmapcodec__
@@ -38,7 +38,21 @@
 #include "ccolor.h"
 #include "cgraphicspath.h"
 #include "cgraphicstransform.h"
+#include "vstguisimd.h"
 #include <cassert>
+#include <climits>
+#include <algorithm>
+
+#ifndef VSTGUI_BITMAPFILTER_THREADS
+	#define VSTGUI_BITMAPFILTER_THREADS VSTGUI_HAS_FUNCTIONAL
+#endif
+
+#if VSTGUI_BITMAPFILTER_THREADS
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+	#include <chrono>
+#endif
 
 namespace VSTGUI {
 
@@ -204,7 +218,7 @@ double Property::getFloat () const
 CBaseObject* Property::getObject () const
 {
 	vstgui_assert (type == kObject);
-	return *static_cast<CBaseObject**> (value);
+	return value ? *static_cast<CBaseObject**> (value) : 0;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -379,7 +393,11 @@ Property::Type FilterBase::getPropertyType (IdStringPtr name) const
 //----------------------------------------------------------------------------------------------------
 bool FilterBase::registerProperty (IdStringPtr name, const Property& defaultProperty)
 {
-	return insert (std::make_pair (name, defaultProperty)).second;
+	// filters register their output on every run, so an existing property is replaced
+	std::pair<iterator, bool> result = insert (std::make_pair (name, defaultProperty));
+	if (!result.second)
+		result.first->second = defaultProperty;
+	return true;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -395,12 +413,896 @@ CBitmap* FilterBase::getInputBitmap () const
 }
 
 ///@cond ignore
+namespace BitmapFilterPrivate {
+
+//----------------------------------------------------------------------------------------------------
+/** Raw row access to locked pixels.
+	All standard filters work on whole rows of 32 bit pixels. As the pixel format is the same for all
+	bitmaps of one platform, input and output rows can be processed without any color conversion. */
+//----------------------------------------------------------------------------------------------------
+struct PixelRows
+{
+	PixelRows (CBitmapPixelAccess& accessor)
+	: address (accessor.getPlatformBitmapPixelAccess ()->getAddress ())
+	, bytesPerRow (accessor.getPlatformBitmapPixelAccess ()->getBytesPerRow ())
+	, width (accessor.getBitmapWidth ())
+	, height (accessor.getBitmapHeight ())
+	, format (accessor.getPlatformBitmapPixelAccess ()->getPixelFormat ())
+	{}
+
+	uint32_t* row (uint32_t y) const { return reinterpret_cast<uint32_t*> (address + static_cast<size_t> (y) * bytesPerRow); }
+
+	uint8_t* address;
+	uint32_t bytesPerRow;
+	uint32_t width;
+	uint32_t height;
+	IPlatformBitmapPixelAccess::PixelFormat format;
+};
+
+//----------------------------------------------------------------------------------------------------
+/** byte positions of the color components inside a pixel (same as CBitmapPixelAccess uses) */
+//----------------------------------------------------------------------------------------------------
+struct ChannelOrder
+{
+	ChannelOrder (IPlatformBitmapPixelAccess::PixelFormat format)
+	{
+		switch (format)
+		{
+			case IPlatformBitmapPixelAccess::kARGB: red = 1; green = 2; blue = 3; alpha = 0; break;
+			case IPlatformBitmapPixelAccess::kRGBA: red = 0; green = 1; blue = 2; alpha = 3; break;
+			case IPlatformBitmapPixelAccess::kABGR: red = 3; green = 2; blue = 1; alpha = 0; break;
+			case IPlatformBitmapPixelAccess::kBGRA: red = 2; green = 1; blue = 0; alpha = 3; break;
+		}
+	}
+
+	uint32_t pack (const CColor& color) const
+	{
+		uint8_t bytes[4];
+		bytes[red] = color.red;
+		bytes[green] = color.green;
+		bytes[blue] = color.blue;
+		bytes[alpha] = color.alpha;
+		uint32_t result;
+		memcpy (&result, bytes, sizeof (result));
+		return result;
+	}
+
+	uint32_t alphaMask () const
+	{
+		uint8_t bytes[4] = {0, 0, 0, 0};
+		bytes[alpha] = 0xFF;
+		uint32_t result;
+		memcpy (&result, bytes, sizeof (result));
+		return result;
+	}
+
+	uint32_t red;
+	uint32_t green;
+	uint32_t blue;
+	uint32_t alpha;
+};
+
+//----------------------------------------------------------------------------------------------------
+/** creates a bitmap with the same pixel size and scale factor as the input bitmap */
+//----------------------------------------------------------------------------------------------------
+static CBitmap* createBitmapWithSameSize (CBitmap* bitmap)
+{
+	IPlatformBitmap* inputPlatformBitmap = bitmap->getPlatformBitmap ();
+	CPoint size = inputPlatformBitmap->getSize ();
+	SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create (&size));
+	if (platformBitmap == 0)
+		return 0;
+	platformBitmap->setScaleFactor (inputPlatformBitmap->getScaleFactor ());
+	return new CBitmap (platformBitmap);
+}
+
+//----------------------------------------------------------------------------------------------------
+/** A part of a filter which can be split into independent ranges (rows or columns) */
+//----------------------------------------------------------------------------------------------------
+class ParallelTask
+{
+public:
+	virtual ~ParallelTask () {}
+	/** process the items in [begin, end), must not touch anything outside of this range */
+	virtual void process (uint32_t begin, uint32_t end) = 0;
+};
+
+//----------------------------------------------------------------------------------------------------
+/** Splits count items into chunks with a size of a multiple of granularity */
+//----------------------------------------------------------------------------------------------------
+struct ChunkRange
+{
+	ChunkRange (uint32_t count, uint32_t numChunks, uint32_t granularity)
+	: count (count), numChunks (numChunks), granularity (granularity) {}
+
+	uint32_t begin (uint32_t chunk) const
+	{
+		if (chunk >= numChunks)
+			return count;
+		uint64_t units = (static_cast<uint64_t> (count) + granularity - 1) / granularity;
+		return std::min (count, static_cast<uint32_t> (units * chunk / numChunks) * granularity);
+	}
+	uint32_t end (uint32_t chunk) const { return begin (chunk + 1); }
+
+	uint32_t count;
+	uint32_t numChunks;
+	uint32_t granularity;
+};
+
+#if VSTGUI_BITMAPFILTER_THREADS
+//----------------------------------------------------------------------------------------------------
+/** Process wide pool of worker threads shared by all filters.
+	The workers are started on demand and end themselves after being idle for a while, stop ends them
+	explicitly. The pool is never destroyed, joining the workers from a static destructor could deadlock
+	while the library is unloaded. Only one filter can use the pool at a time, if the pool is busy
+	(another thread or a filter called from a worker) run returns false and the caller has to do the
+	work itself. */
+//----------------------------------------------------------------------------------------------------
+class WorkerPool
+{
+public:
+	static WorkerPool& getInstance ()
+	{
+		static WorkerPool* pool = new WorkerPool;
+		return *pool;
+	}
+
+	static uint32_t getNumHardwareThreads ()
+	{
+		uint32_t numThreads = std::thread::hardware_concurrency ();
+		return numThreads ? numThreads : 1;
+	}
+
+	bool run (ParallelTask& task, const ChunkRange& range, uint32_t numThreads)
+	{
+		std::unique_lock<std::mutex> runLock (runMutex, std::try_to_lock);
+		if (!runLock.owns_lock ())
+			return false;
+		std::unique_lock<std::mutex> lock (mutex);
+		removeFinishedWorkers ();
+		while (workers.size () + 1 < numThreads)
+		{
+			Worker* worker = new Worker;
+			workers.push_back (worker);
+			worker->thread = std::thread (&WorkerPool::workerLoop, this, worker);
+		}
+		currentTask = &task;
+		currentRange = &range;
+		nextChunk = 0;
+		pendingChunks = range.numChunks;
+		maxHelpers = numThreads - 1;
+		wakeUp.notify_all ();
+		processChunks (lock);
+		finished.wait (lock, [this] () { return pendingChunks == 0 && numHelpers == 0; });
+		currentTask = nullptr;
+		currentRange = nullptr;
+		nextChunk = pendingChunks = 0;
+		return true;
+	}
+
+	/** waits for a running filter and ends all workers */
+	void stop ()
+	{
+		std::lock_guard<std::mutex> runLock (runMutex);
+		std::vector<Worker*> stoppedWorkers;
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			quit = true;
+			wakeUp.notify_all ();
+			stoppedWorkers.swap (workers);
+		}
+		for (auto& worker : stoppedWorkers)
+		{
+			worker->thread.join ();
+			delete worker;
+		}
+		std::lock_guard<std::mutex> lock (mutex);
+		quit = false;
+	}
+
+private:
+	struct Worker
+	{
+		std::thread thread;
+		bool done = false;
+	};
+
+	WorkerPool () = default;
+	~WorkerPool () = delete;
+
+	bool hasWork () const { return currentRange && nextChunk < currentRange->numChunks; }
+
+	void processChunks (std::unique_lock<std::mutex>& lock)
+	{
+		while (hasWork ())
+		{
+			uint32_t chunk = nextChunk++;
+			lock.unlock ();
+			currentTask->process (currentRange->begin (chunk), currentRange->end (chunk));
+			lock.lock ();
+			--pendingChunks;
+		}
+	}
+
+	void workerLoop (Worker* worker)
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		while (!quit)
+		{
+			if (hasWork () && numHelpers < maxHelpers)
+			{
+				++numHelpers;
+				processChunks (lock);
+				--numHelpers;
+				finished.notify_all ();
+				continue;
+			}
+			if (!wakeUp.wait_for (lock, std::chrono::seconds (kIdleSeconds), [this] () { return quit || (hasWork () && numHelpers < maxHelpers); }))
+				break;
+		}
+		worker->done = true;
+	}
+
+	/** must be called with mutex locked, the finished workers don't need it anymore */
+	void removeFinishedWorkers ()
+	{
+		for (auto it = workers.begin (); it != workers.end ();)
+		{
+			if ((*it)->done)
+			{
+				(*it)->thread.join ();
+				delete *it;
+				it = workers.erase (it);
+			}
+			else
+				++it;
+		}
+	}
+
+	static const int kIdleSeconds = 2;
+
+	std::mutex runMutex;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::condition_variable finished;
+	std::vector<Worker*> workers;
+	ParallelTask* currentTask = nullptr;
+	const ChunkRange* currentRange = nullptr;
+	uint32_t nextChunk = 0;
+	uint32_t pendingChunks = 0;
+	uint32_t numHelpers = 0;
+	uint32_t maxHelpers = 0;
+	bool quit = false;
+};
+#endif // VSTGUI_BITMAPFILTER_THREADS
+
+//----------------------------------------------------------------------------------------------------
+/** Runs task for count items on up to numThreads threads (including the calling one).
+	Items are handed out in chunks with a size of a multiple of granularity. */
+//----------------------------------------------------------------------------------------------------
+static void parallelFor (ParallelTask& task, uint32_t count, uint32_t numThreads, uint32_t granularity = 1)
+{
+#if VSTGUI_BITMAPFILTER_THREADS
+	uint32_t numUnits = (count + granularity - 1) / granularity;
+	numThreads = std::min (numThreads, numUnits);
+	if (numThreads > 1)
+	{
+		// more chunks than threads, so that threads which start later or run slower get less work
+		ChunkRange range (count, std::min (numThreads * 4, numUnits), granularity);
+		if (WorkerPool::getInstance ().run (task, range, numThreads))
+			return;
+	}
+#endif
+	if (count)
+		task.process (0, count);
+}
+
+//----------------------------------------------------------------------------------------------------
+/** number of threads to use for an image with numPixels pixels, threadCount is the value of the
+	Standard::Property::kThreadCount property */
+//----------------------------------------------------------------------------------------------------
+static uint32_t calculateNumThreads (int32_t threadCount, uint64_t numPixels)
+{
+#if VSTGUI_BITMAPFILTER_THREADS
+	enum { kAutoMinPixels = 512 * 512, kMaxThreads = 64 };
+	if (threadCount == 0)
+		return numPixels >= kAutoMinPixels ? std::min<uint32_t> (WorkerPool::getNumHardwareThreads (), kMaxThreads) : 1;
+	return static_cast<uint32_t> (std::max<int32_t> (1, std::min<int32_t> (threadCount, kMaxThreads)));
+#else
+	return 1;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+/** replaces the color part of all pixels with color and keeps the bits of keepMask */
+//----------------------------------------------------------------------------------------------------
+inline void setColorRow (const uint32_t* src, uint32_t* dst, uint32_t count, uint32_t color, uint32_t keepMask)
+{
+	color &= ~keepMask;
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	const __m128i colorVector = _mm_set1_epi32 (static_cast<int> (color));
+	const __m128i keepVector = _mm_set1_epi32 (static_cast<int> (keepMask));
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pixels = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), _mm_or_si128 (_mm_and_si128 (pixels, keepVector), colorVector));
+	}
+#elif VSTGUI_SIMD_NEON
+	const uint32x4_t colorVector = vdupq_n_u32 (color);
+	const uint32x4_t keepVector = vdupq_n_u32 (keepMask);
+	for (; x + 4 <= count; x += 4)
+		vst1q_u32 (dst + x, vorrq_u32 (vandq_u32 (vld1q_u32 (src + x), keepVector), colorVector));
+#endif
+	for (; x < count; ++x)
+		dst[x] = (src[x] & keepMask) | color;
+}
+
+//----------------------------------------------------------------------------------------------------
+/** replaces all pixels which are equal to inputColor with outputColor */
+//----------------------------------------------------------------------------------------------------
+inline void replaceColorRow (const uint32_t* src, uint32_t* dst, uint32_t count, uint32_t inputColor, uint32_t outputColor)
+{
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	const __m128i inputVector = _mm_set1_epi32 (static_cast<int> (inputColor));
+	const __m128i outputVector = _mm_set1_epi32 (static_cast<int> (outputColor));
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pixels = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		__m128i match = _mm_cmpeq_epi32 (pixels, inputVector);
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), _mm_or_si128 (_mm_and_si128 (match, outputVector), _mm_andnot_si128 (match, pixels)));
+	}
+#elif VSTGUI_SIMD_NEON
+	const uint32x4_t inputVector = vdupq_n_u32 (inputColor);
+	const uint32x4_t outputVector = vdupq_n_u32 (outputColor);
+	for (; x + 4 <= count; x += 4)
+	{
+		uint32x4_t pixels = vld1q_u32 (src + x);
+		vst1q_u32 (dst + x, vbslq_u32 (vceqq_u32 (pixels, inputVector), outputVector, pixels));
+	}
+#endif
+	for (; x < count; ++x)
+		dst[x] = src[x] == inputColor ? outputColor : src[x];
+}
+
+//----------------------------------------------------------------------------------------------------
+/** sets the color components of all pixels to the luma value (see CColor::getLuma) */
+//----------------------------------------------------------------------------------------------------
+inline void grayscaleRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order)
+{
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	const __m128i byteMask = _mm_set1_epi32 (0xFF);
+	const __m128i alphaMask = _mm_set1_epi32 (static_cast<int> (order.alphaMask ()));
+	const __m128i redShift = _mm_cvtsi32_si128 (static_cast<int> (order.red * 8));
+	const __m128i greenShift = _mm_cvtsi32_si128 (static_cast<int> (order.green * 8));
+	const __m128i blueShift = _mm_cvtsi32_si128 (static_cast<int> (order.blue * 8));
+	const __m128 redFactor = _mm_set1_ps (0.3f);
+	const __m128 greenFactor = _mm_set1_ps (0.59f);
+	const __m128 blueFactor = _mm_set1_ps (0.11f);
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pixels = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		__m128 red = _mm_cvtepi32_ps (_mm_and_si128 (_mm_srl_epi32 (pixels, redShift), byteMask));
+		__m128 green = _mm_cvtepi32_ps (_mm_and_si128 (_mm_srl_epi32 (pixels, greenShift), byteMask));
+		__m128 blue = _mm_cvtepi32_ps (_mm_and_si128 (_mm_srl_epi32 (pixels, blueShift), byteMask));
+		__m128i luma = _mm_cvttps_epi32 (_mm_add_ps (_mm_add_ps (_mm_mul_ps (red, redFactor), _mm_mul_ps (green, greenFactor)), _mm_mul_ps (blue, blueFactor)));
+		__m128i result = _mm_and_si128 (pixels, alphaMask);
+		result = _mm_or_si128 (result, _mm_sll_epi32 (luma, redShift));
+		result = _mm_or_si128 (result, _mm_sll_epi32 (luma, greenShift));
+		result = _mm_or_si128 (result, _mm_sll_epi32 (luma, blueShift));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), result);
+	}
+#elif VSTGUI_SIMD_NEON
+	const uint32x4_t byteMask = vdupq_n_u32 (0xFF);
+	const uint32x4_t alphaMask = vdupq_n_u32 (order.alphaMask ());
+	const int32x4_t redShift = vdupq_n_s32 (static_cast<int32_t> (order.red * 8));
+	const int32x4_t greenShift = vdupq_n_s32 (static_cast<int32_t> (order.green * 8));
+	const int32x4_t blueShift = vdupq_n_s32 (static_cast<int32_t> (order.blue * 8));
+	const float32x4_t redFactor = vdupq_n_f32 (0.3f);
+	const float32x4_t greenFactor = vdupq_n_f32 (0.59f);
+	const float32x4_t blueFactor = vdupq_n_f32 (0.11f);
+	for (; x + 4 <= count; x += 4)
+	{
+		uint32x4_t pixels = vld1q_u32 (src + x);
+		float32x4_t red = vcvtq_f32_u32 (vandq_u32 (vshlq_u32 (pixels, vnegq_s32 (redShift)), byteMask));
+		float32x4_t green = vcvtq_f32_u32 (vandq_u32 (vshlq_u32 (pixels, vnegq_s32 (greenShift)), byteMask));
+		float32x4_t blue = vcvtq_f32_u32 (vandq_u32 (vshlq_u32 (pixels, vnegq_s32 (blueShift)), byteMask));
+		uint32x4_t luma = vcvtq_u32_f32 (vaddq_f32 (vaddq_f32 (vmulq_f32 (red, redFactor), vmulq_f32 (green, greenFactor)), vmulq_f32 (blue, blueFactor)));
+		uint32x4_t result = vandq_u32 (pixels, alphaMask);
+		result = vorrq_u32 (result, vshlq_u32 (luma, redShift));
+		result = vorrq_u32 (result, vshlq_u32 (luma, greenShift));
+		result = vorrq_u32 (result, vshlq_u32 (luma, blueShift));
+		vst1q_u32 (dst + x, result);
+	}
+#endif
+	for (; x < count; ++x)
+	{
+		const uint8_t* s = reinterpret_cast<const uint8_t*> (src + x);
+		uint8_t* d = reinterpret_cast<uint8_t*> (dst + x);
+		uint8_t luma = CColor (s[order.red], s[order.green], s[order.blue], s[order.alpha]).getLuma ();
+		d[order.alpha] = s[order.alpha];
+		d[order.red] = d[order.green] = d[order.blue] = luma;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+/** divisor for the box blur sums.
+	The SIMD paths replace the division by a multiplication with a 32 bit reciprocal, which is exact
+	as long as sum * radius < 2^32. As a sum is at most 255 * radius this holds for radius <= 4096. */
+//----------------------------------------------------------------------------------------------------
+struct Divisor
+{
+	enum { kMaxReciprocalRadius = 4096 };
+
+	Divisor (uint32_t radius)
+	: radius (radius)
+	, reciprocal (radius <= kMaxReciprocalRadius ? static_cast<uint32_t> ((static_cast<uint64_t> (1) << 32) / radius) + 1 : 0)
+	{}
+
+	uint32_t radius;
+	uint32_t reciprocal;
+};
+
+//----------------------------------------------------------------------------------------------------
+/** per channel sums of pixels, plain c++ */
+//----------------------------------------------------------------------------------------------------
+struct ScalarSum
+{
+	struct Sum { uint32_t v[4]; };
+
+	static Sum zero () { Sum s = {{0, 0, 0, 0}}; return s; }
+	static Sum unpack (uint32_t pixel)
+	{
+		const uint8_t* p = reinterpret_cast<const uint8_t*> (&pixel);
+		Sum s = {{p[0], p[1], p[2], p[3]}};
+		return s;
+	}
+	static Sum add (const Sum& a, const Sum& b)
+	{
+		Sum s = {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+		return s;
+	}
+	static Sum sub (const Sum& a, const Sum& b)
+	{
+		Sum s = {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+		return s;
+	}
+	static Sum load (const uint32_t* p) { Sum s = {{p[0], p[1], p[2], p[3]}}; return s; }
+	static void store (uint32_t* p, const Sum& s) { p[0] = s.v[0]; p[1] = s.v[1]; p[2] = s.v[2]; p[3] = s.v[3]; }
+	static uint32_t divide (const Sum& s, const Divisor& d)
+	{
+		uint32_t result;
+		uint8_t* p = reinterpret_cast<uint8_t*> (&result);
+		for (uint32_t i = 0; i < 4; ++i)
+			p[i] = static_cast<uint8_t> (std::min<uint32_t> (s.v[i] / d.radius, 255));
+		return result;
+	}
+};
+
+#if VSTGUI_SIMD_SSE2
+//----------------------------------------------------------------------------------------------------
+/** per channel sums of pixels, SSE2 */
+//----------------------------------------------------------------------------------------------------
+struct VectorSum
+{
+	typedef __m128i Sum;
+
+	static Sum zero () { return _mm_setzero_si128 (); }
+	static Sum unpack (uint32_t pixel)
+	{
+		const __m128i z = _mm_setzero_si128 ();
+		return _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (static_cast<int> (pixel)), z), z);
+	}
+	static Sum add (Sum a, Sum b) { return _mm_add_epi32 (a, b); }
+	static Sum sub (Sum a, Sum b) { return _mm_sub_epi32 (a, b); }
+	static Sum load (const uint32_t* p) { return _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p)); }
+	static void store (uint32_t* p, Sum s) { _mm_storeu_si128 (reinterpret_cast<__m128i*> (p), s); }
+	static uint32_t divide (Sum s, const Divisor& d)
+	{
+		const __m128i reciprocal = _mm_set1_epi32 (static_cast<int> (d.reciprocal));
+		__m128i even = _mm_srli_epi64 (_mm_mul_epu32 (s, reciprocal), 32);
+		__m128i odd = _mm_mul_epu32 (_mm_srli_epi64 (s, 32), reciprocal);
+		__m128i q = _mm_or_si128 (even, _mm_and_si128 (odd, _mm_set_epi32 (-1, 0, -1, 0)));
+		q = _mm_packs_epi32 (q, q);
+		return static_cast<uint32_t> (_mm_cvtsi128_si32 (_mm_packus_epi16 (q, q)));
+	}
+};
+#elif VSTGUI_SIMD_NEON
+//----------------------------------------------------------------------------------------------------
+/** per channel sums of pixels, NEON */
+//----------------------------------------------------------------------------------------------------
+struct VectorSum
+{
+	typedef uint32x4_t Sum;
+
+	static Sum zero () { return vdupq_n_u32 (0); }
+	static Sum unpack (uint32_t pixel)
+	{
+		return vmovl_u16 (vget_low_u16 (vmovl_u8 (vreinterpret_u8_u32 (vdup_n_u32 (pixel)))));
+	}
+	static Sum add (Sum a, Sum b) { return vaddq_u32 (a, b); }
+	static Sum sub (Sum a, Sum b) { return vsubq_u32 (a, b); }
+	static Sum load (const uint32_t* p) { return vld1q_u32 (p); }
+	static void store (uint32_t* p, Sum s) { vst1q_u32 (p, s); }
+	static uint32_t divide (Sum s, const Divisor& d)
+	{
+		const uint32x2_t reciprocal = vdup_n_u32 (d.reciprocal);
+		uint32x4_t q = vcombine_u32 (vshrn_n_u64 (vmull_u32 (vget_low_u32 (s), reciprocal), 32),
+									  vshrn_n_u64 (vmull_u32 (vget_high_u32 (s), reciprocal), 32));
+		uint16x4_t q16 = vmovn_u32 (q);
+		return vget_lane_u32 (vreinterpret_u32_u8 (vmovn_u16 (vcombine_u16 (q16, q16))), 0);
+	}
+};
+#endif
+
+//----------------------------------------------------------------------------------------------------
+/** Box blur with running sums.
+	Works in place, first on all rows and then on all columns. The output for a pixel is the average
+	of the "radius" pixels ending "radius / 2" pixels after it, pixels before the first one are
+	treated as transparent black and pixels after the last one as copies of the last one. */
+//----------------------------------------------------------------------------------------------------
+class BoxBlurKernel
+{
+public:
+	BoxBlurKernel (uint32_t radius, uint32_t numThreads = 1)
+	: divisor (radius), halfRadius (radius / 2), numThreads (numThreads) {}
+
+	void process (const PixelRows& rows)
+	{
+		if (rows.width == 0 || rows.height == 0)
+			return;
+#if VSTGUI_SIMD_SSE2 || VSTGUI_SIMD_NEON
+		if (divisor.reciprocal)
+		{
+			process<VectorSum> (rows);
+			return;
+		}
+#endif
+		process<ScalarSum> (rows);
+	}
+
+private:
+	// column ranges of different threads should not share cache lines
+	enum { kColumnGranularity = 16 };
+
+	template<typename T>
+	class RowPass : public ParallelTask
+	{
+	public:
+		RowPass (const BoxBlurKernel& kernel, const PixelRows& rows) : kernel (kernel), rows (rows) {}
+		void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
+		{
+			std::vector<uint32_t> line (rows.width);
+			for (uint32_t y = begin; y < end; ++y)
+				kernel.blurRow<T> (rows.row (y), rows.width, line);
+		}
+	private:
+		const BoxBlurKernel& kernel;
+		const PixelRows& rows;
+	};
+
+	template<typename T>
+	class ColumnPass : public ParallelTask
+	{
+	public:
+		ColumnPass (const BoxBlurKernel& kernel, const PixelRows& rows) : kernel (kernel), rows (rows) {}
+		void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
+		{
+			kernel.blurColumns<T> (rows, begin, end - begin);
+		}
+	private:
+		const BoxBlurKernel& kernel;
+		const PixelRows& rows;
+	};
+
+	template<typename T>
+	void process (const PixelRows& rows)
+	{
+		RowPass<T> rowPass (*this, rows);
+		parallelFor (rowPass, rows.height, numThreads);
+		ColumnPass<T> columnPass (*this, rows);
+		parallelFor (columnPass, rows.width, numThreads, kColumnGranularity);
+	}
+
+	template<typename T>
+	void blurRow (uint32_t* row, uint32_t width, std::vector<uint32_t>& line) const
+	{
+		const uint32_t radius = divisor.radius;
+		const uint32_t last = width - 1;
+		std::copy (row, row + width, line.begin ());
+		const uint32_t* src = &line[0];
+		typename T::Sum sum = T::zero ();
+		for (uint32_t i = 0; i < halfRadius; ++i)
+			sum = T::add (sum, T::unpack (src[std::min (i, last)]));
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			sum = T::add (sum, T::unpack (src[std::min (x + halfRadius, last)]));
+			row[x] = T::divide (sum, divisor);
+			if (x + 1 + halfRadius >= radius)
+				sum = T::sub (sum, T::unpack (src[x + 1 + halfRadius - radius]));
+		}
+	}
+
+	/** blurs the columns [firstColumn, firstColumn + width) */
+	template<typename T>
+	void blurColumns (const PixelRows& rows, uint32_t firstColumn, uint32_t width) const
+	{
+		const uint32_t radius = divisor.radius;
+		const uint32_t last = rows.height - 1;
+		// rows which still need to be subtracted from the sums after they were overwritten
+		const uint32_t ringSize = radius - halfRadius;
+		std::vector<uint32_t> sums (static_cast<size_t> (width) * 4, 0);
+		std::vector<uint32_t> ring (static_cast<size_t> (ringSize) * width);
+		for (uint32_t i = 0; i < halfRadius; ++i)
+			addRow<T> (sums, rows.row (std::min (i, last)) + firstColumn, width);
+		for (uint32_t y = 0; y <= last; ++y)
+		{
+			addRow<T> (sums, rows.row (std::min (y + halfRadius, last)) + firstColumn, width);
+			uint32_t* row = rows.row (y) + firstColumn;
+			std::copy (row, row + width, ring.begin () + static_cast<size_t> (y % ringSize) * width);
+			for (uint32_t x = 0; x < width; ++x)
+				row[x] = T::divide (T::load (&sums[x * 4]), divisor);
+			if (y + 1 + halfRadius >= radius)
+				subtractRow<T> (sums, &ring[static_cast<size_t> ((y + 1 + halfRadius - radius) % ringSize) * width], width);
+		}
+	}
+
+	template<typename T>
+	static void addRow (std::vector<uint32_t>& sums, const uint32_t* row, uint32_t width)
+	{
+		uint32_t* s = &sums[0];
+		for (uint32_t x = 0; x < width; ++x, s += 4)
+			T::store (s, T::add (T::load (s), T::unpack (row[x])));
+	}
+
+	template<typename T>
+	static void subtractRow (std::vector<uint32_t>& sums, const uint32_t* row, uint32_t width)
+	{
+		uint32_t* s = &sums[0];
+		for (uint32_t x = 0; x < width; ++x, s += 4)
+			T::store (s, T::sub (T::load (s), T::unpack (row[x])));
+	}
+
+	Divisor divisor;
+	uint32_t halfRadius;
+	uint32_t numThreads;
+};
+
+//----------------------------------------------------------------------------------------------------
+/** bilinear interpolation of the four source pixels of one destination pixel */
+//----------------------------------------------------------------------------------------------------
+inline uint32_t interpolateBilinear (const uint32_t pixels[4], float xDiff, float yDiff)
+{
+	const float xInv = 1.f - xDiff;
+	const float yInv = 1.f - yDiff;
+#if VSTGUI_SIMD_SSE2
+	const __m128i z = _mm_setzero_si128 ();
+	__m128i p01 = _mm_unpacklo_epi8 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (pixels)), z);
+	__m128i p23 = _mm_unpacklo_epi8 (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (pixels + 2)), z);
+	__m128 c0 = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (p01, z));
+	__m128 c1 = _mm_cvtepi32_ps (_mm_unpackhi_epi16 (p01, z));
+	__m128 c2 = _mm_cvtepi32_ps (_mm_unpacklo_epi16 (p23, z));
+	__m128 c3 = _mm_cvtepi32_ps (_mm_unpackhi_epi16 (p23, z));
+	const __m128 vxDiff = _mm_set1_ps (xDiff);
+	const __m128 vyDiff = _mm_set1_ps (yDiff);
+	const __m128 vxInv = _mm_set1_ps (xInv);
+	const __m128 vyInv = _mm_set1_ps (yInv);
+	__m128 r = _mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (_mm_mul_ps (c0, vxInv), vyInv),
+												   _mm_mul_ps (_mm_mul_ps (c1, vxDiff), vyInv)),
+									   _mm_mul_ps (_mm_mul_ps (c2, vyDiff), vxInv)),
+						   _mm_mul_ps (_mm_mul_ps (c3, vxDiff), vyDiff));
+	__m128i q = _mm_cvttps_epi32 (r);
+	q = _mm_packs_epi32 (q, q);
+	return static_cast<uint32_t> (_mm_cvtsi128_si32 (_mm_packus_epi16 (q, q)));
+#else
+	const uint8_t* c0 = reinterpret_cast<const uint8_t*> (pixels);
+	const uint8_t* c1 = reinterpret_cast<const uint8_t*> (pixels + 1);
+	const uint8_t* c2 = reinterpret_cast<const uint8_t*> (pixels + 2);
+	const uint8_t* c3 = reinterpret_cast<const uint8_t*> (pixels + 3);
+	uint32_t result;
+	uint8_t* d = reinterpret_cast<uint8_t*> (&result);
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		float v = c0[i] * xInv * yInv + c1[i] * xDiff * yInv + c2[i] * yDiff * xInv + c3[i] * xDiff * yDiff;
+		d[i] = static_cast<uint8_t> (v);
+	}
+	return result;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------
+/** Interface of the standard filters for running them as part of a Pipeline.
+	A pixel stage maps each pixel independently and is fused with its neighbour pixel stages into one
+	pass, an in place stage works on the whole bitmap and a resample stage needs a new bitmap. */
+//----------------------------------------------------------------------------------------------------
+class IPipelineStage
+{
+public:
+	enum Kind {
+		kPixelStage,
+		kInPlaceStage,
+		kResampleStage
+	};
+
+	virtual ~IPipelineStage () {}
+
+	virtual Kind getStageKind () const = 0;
+	/** read the properties of the filter, returns false if the filter can not run */
+	virtual bool prepareStage (double scaleFactor) = 0;
+
+	/** kPixelStage: process one row, src and dst may be the same. Called concurrently for different rows */
+	virtual void processStageRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order) {}
+	/** kInPlaceStage */
+	virtual void processStageInPlace (const PixelRows& rows, uint32_t numThreads) {}
+	/** kResampleStage */
+	virtual CPoint getStageOutputSize () const { return CPoint (); }
+	virtual void processStageResample (const PixelRows& input, const PixelRows& output, uint32_t numThreads) {}
+};
+
+//----------------------------------------------------------------------------------------------------
+/** runs consecutive pixel stages on each row while it is in the cache */
+//----------------------------------------------------------------------------------------------------
+class PixelStagesTask : public ParallelTask
+{
+public:
+	PixelStagesTask (const std::vector<IPipelineStage*>& stages, const PixelRows& input, const PixelRows& output)
+	: stages (stages), input (input), output (output), order (output.format) {}
+
+	void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
+	{
+		for (uint32_t y = begin; y < end; ++y)
+		{
+			uint32_t* dst = output.row (y);
+			stages[0]->processStageRow (input.row (y), dst, output.width, order);
+			for (size_t i = 1; i < stages.size (); ++i)
+				stages[i]->processStageRow (dst, dst, output.width, order);
+		}
+	}
+private:
+	const std::vector<IPipelineStage*>& stages;
+	const PixelRows& input;
+	const PixelRows& output;
+	ChannelOrder order;
+};
+
+//----------------------------------------------------------------------------------------------------
+/** makes sure that the current bitmap can be written to, by copying it if needed */
+//----------------------------------------------------------------------------------------------------
+static bool makeWritable (SharedPointer<CBitmap>& current, bool& writable)
+{
+	if (writable)
+		return true;
+	SharedPointer<CBitmap> copy = owned (createBitmapWithSameSize (current));
+	if (copy == 0)
+		return false;
+	{
+		SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (current, true, false));
+		SharedPointer<CBitmapPixelAccess> outputAccessor = owned (CBitmapPixelAccess::create (copy));
+		if (inputAccessor == 0 || outputAccessor == 0)
+			return false;
+		PixelRows input (*inputAccessor);
+		PixelRows output (*outputAccessor);
+		for (uint32_t y = 0; y < output.height; ++y)
+			memcpy (output.row (y), input.row (y), output.width * 4);
+	}
+	current = copy;
+	writable = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+static bool runPixelStages (const std::vector<IPipelineStage*>& stages, SharedPointer<CBitmap>& current, bool& writable, int32_t threadCount)
+{
+	SharedPointer<CBitmap> target = current;
+	SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (current, true, writable));
+	if (inputAccessor == 0)
+		return false;
+	SharedPointer<CBitmapPixelAccess> outputAccessor = inputAccessor;
+	if (!writable)
+	{
+		// the first stage reads from the input bitmap and writes to the new one, no copy needed
+		target = owned (createBitmapWithSameSize (current));
+		if (target == 0)
+			return false;
+		outputAccessor = owned (CBitmapPixelAccess::create (target));
+		if (outputAccessor == 0)
+			return false;
+	}
+	PixelRows input (*inputAccessor);
+	PixelRows output (*outputAccessor);
+	vstgui_assert (input.format == output.format);
+	PixelStagesTask task (stages, input, output);
+	parallelFor (task, output.height, calculateNumThreads (threadCount, static_cast<uint64_t> (output.width) * output.height));
+	current = target;
+	writable = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+static bool runInPlaceStage (IPipelineStage* stage, SharedPointer<CBitmap>& current, bool& writable, int32_t threadCount)
+{
+	if (!makeWritable (current, writable))
+		return false;
+	SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (current));
+	if (accessor == 0)
+		return false;
+	PixelRows rows (*accessor);
+	stage->processStageInPlace (rows, calculateNumThreads (threadCount, static_cast<uint64_t> (rows.width) * rows.height));
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+static bool runResampleStage (IPipelineStage* stage, SharedPointer<CBitmap>& current, bool& writable, int32_t threadCount)
+{
+	CPoint size = stage->getStageOutputSize ();
+	SharedPointer<CBitmap> target = owned (new CBitmap (size.x, size.y));
+	{
+		SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (current, true, false));
+		SharedPointer<CBitmapPixelAccess> outputAccessor = owned (CBitmapPixelAccess::create (target));
+		if (inputAccessor == 0 || outputAccessor == 0)
+			return false;
+		PixelRows output (*outputAccessor);
+		stage->processStageResample (PixelRows (*inputAccessor), output, calculateNumThreads (threadCount, static_cast<uint64_t> (output.width) * output.height));
+	}
+	current = target;
+	writable = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+/** runs a filter which is not one of the standard filters */
+//----------------------------------------------------------------------------------------------------
+static bool runFilter (IFilter* filter, SharedPointer<CBitmap>& current, bool& writable)
+{
+	filter->setProperty (Standard::Property::kInputBitmap, Property (current));
+	bool result = false;
+	if (writable && filter->run (true))
+		result = true;
+	else if (filter->run (false))
+	{
+		const Property& outputProperty = filter->getProperty (Standard::Property::kOutputBitmap);
+		CBitmap* output = outputProperty.getType () == Property::kObject ? dynamic_cast<CBitmap*> (outputProperty.getObject ()) : 0;
+		if (output && output != current)
+		{
+			current = output;
+			writable = true;
+			result = true;
+		}
+	}
+	filter->setProperty (Standard::Property::kInputBitmap, Property (Property::kObject));
+	return result;
+}
+
+} // namespace BitmapFilterPrivate
+
 namespace Standard {
 
+using namespace BitmapFilterPrivate;
+
 //----------------------------------------------------------------------------------------------------
+/** base class for the standard filters which all support the Property::kThreadCount property */
 //----------------------------------------------------------------------------------------------------
+class ThreadedFilterBase : public FilterBase
+{
+protected:
+	ThreadedFilterBase (UTF8StringPtr description)
+	: FilterBase (description)
+	{
+		registerProperty (Property::kThreadCount, BitmapFilter::Property ((int32_t)0));
+	}
+
+	uint32_t getNumThreads (const PixelRows& rows) const
+	{
+		return calculateNumThreads (getProperty (Property::kThreadCount).getInteger (), static_cast<uint64_t> (rows.width) * rows.height);
+	}
+};
+
 //----------------------------------------------------------------------------------------------------
-class BoxBlur : public FilterBase
+//----------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------
+class BoxBlur : public ThreadedFilterBase, public IPipelineStage
 {
 public:
 	static IFilter* CreateFunction (IdStringPtr _name)
@@ -410,7 +1312,8 @@ public:
 
 private:
 	BoxBlur ()
-	: FilterBase ("A Box Blur Filter")
+	: ThreadedFilterBase ("A Box Blur Filter")
+	, radius (0)
 	{
 		registerProperty (Property::kInputBitmap, BitmapFilter::Property (BitmapFilter::Property::kObject));
 		registerProperty (Property::kRadius, BitmapFilter::Property ((int32_t)2));
@@ -419,8 +1322,9 @@ private:
 	bool run (bool replace) VSTGUI_OVERRIDE_VMETHOD
 	{
 		CBitmap* inputBitmap = getInputBitmap ();
-		uint32_t radius = static_cast<uint32_t>(static_cast<double>(getProperty (Property::kRadius).getInteger ()) * inputBitmap->getPlatformBitmap ()->getScaleFactor ());
-		if (inputBitmap == 0 || radius == UINT_MAX)
+		if (inputBitmap == 0 || inputBitmap->getPlatformBitmap () == 0)
+			return false;
+		if (!prepareStage (inputBitmap->getPlatformBitmap ()->getScaleFactor ()))
 			return false;
 		if (radius < 2)
 		{
@@ -428,158 +1332,109 @@ private:
 				return true;
 			return false; // TODO: We should just copy the input bitmap to the output bitmap
 		}
+		SharedPointer<CBitmap> outputBitmap;
 		if (replace)
+			outputBitmap = inputBitmap;
+		else
 		{
-			SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap));
-			if (inputAccessor == 0)
+			outputBitmap = owned (createBitmapWithSameSize (inputBitmap));
+			if (outputBitmap == 0)
 				return false;
-			run (*inputAccessor, *inputAccessor, radius);
-			return registerProperty (Property::kOutputBitmap, BitmapFilter::Property (inputBitmap));
 		}
-		SharedPointer<CBitmap> outputBitmap = owned (new CBitmap (inputBitmap->getWidth (), inputBitmap->getHeight ()));
-		if (outputBitmap)
+		SharedPointer<CBitmapPixelAccess> outputAccessor = owned (CBitmapPixelAccess::create (outputBitmap));
+		if (outputAccessor == 0)
+			return false;
+		PixelRows outputRows (*outputAccessor);
+		if (replace == false)
 		{
-			SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap));
-			SharedPointer<CBitmapPixelAccess> outputAccessor = owned (CBitmapPixelAccess::create (outputBitmap));
-			if (inputAccessor == 0 || outputAccessor == 0)
+			SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap, true, false));
+			if (inputAccessor == 0)
 				return false;
-
-			run (*inputAccessor, *outputAccessor, radius);
-			return registerProperty (Property::kOutputBitmap, BitmapFilter::Property (outputBitmap));
+			PixelRows inputRows (*inputAccessor);
+			for (uint32_t y = 0; y < outputRows.height; ++y)
+				memcpy (outputRows.row (y), inputRows.row (y), outputRows.width * 4);
 		}
-		return false;
+		processStageInPlace (outputRows, getNumThreads (outputRows));
+		return registerProperty (Property::kOutputBitmap, BitmapFilter::Property (outputBitmap));
 	}
 
-	inline uint32_t saturate (uint32_t value) { return std::min<uint32_t> (value, 255); }
+	Kind getStageKind () const VSTGUI_OVERRIDE_VMETHOD { return kInPlaceStage; }
 
-	inline void calculate (uint32_t* colors, uint32_t numColors)
+	bool prepareStage (double scaleFactor) VSTGUI_OVERRIDE_VMETHOD
 	{
-		uint32_t lastColor = numColors - 1;
-		uint32_t red = colors[lastColor] & 0x000000FF;
-		uint32_t green = (colors[lastColor] >> 8) & 0x000000FF;
-		uint32_t blue = (colors[lastColor] >> 16) & 0x000000FF;
-		uint32_t alpha = (colors[lastColor] >> 24) & 0x000000FF;
-		for (int64_t i = (int64_t)numColors-2; i >= 0; i--)
-		{
-			red += colors[i] & 0x000000FF;
-			green += (colors[i] >> 8) & 0x000000FF;
-			blue += (colors[i] >> 16) & 0x000000FF;
-			alpha += (colors[i] >> 24) & 0x000000FF;
-			colors[i+1] = colors[i];
-		}
-		colors[0] = saturate (red / numColors) | (saturate (green / numColors) << 8) | (saturate (blue / numColors) << 16) | (saturate (alpha / numColors) << 24);
+		radius = static_cast<uint32_t>(static_cast<double>(getProperty (Property::kRadius).getInteger ()) * scaleFactor);
+		return radius != UINT_MAX;
 	}
 
-	void run (CBitmapPixelAccess& inputAccessor, CBitmapPixelAccess& outputAccessor, uint32_t radius)
+	void processStageInPlace (const PixelRows& rows, uint32_t numThreads) VSTGUI_OVERRIDE_VMETHOD
 	{
-		const uint32_t halfRadius = radius / 2;
-		const uint32_t width = inputAccessor.getBitmapWidth ();
-		const uint32_t height = inputAccessor.getBitmapHeight ();
-		uint32_t x,y,x1,y1;
-		uint32_t stackColors[20];
-		uint32_t* nc;
-		if (radius > 19)
-			nc = new uint32_t[(size_t)radius];
-		else
-			nc = stackColors;
-		for (y = 0; y < height; y++)
-		{
-			memset (nc, 0, sizeof(uint32_t) * (size_t)radius);
-			for (x1 = 0; x1 < radius / 2; x1++)
-			{
-				inputAccessor.setPosition (x1, y);
-				inputAccessor.getValue (nc[0]);
-				calculate (nc, radius);
-			}
-			for (x = 0; x < width - halfRadius; x++, x1++)
-			{
-				inputAccessor.setPosition (x1, y);
-				inputAccessor.getValue (nc[0]);
-				calculate (nc, radius);
-				outputAccessor.setPosition (x, y);
-				outputAccessor.setValue (nc[0]);
-			}
-			for (;x < width; x++, x1++)
-			{
-				nc[0] = nc[1];
-				calculate (nc, radius);
-				outputAccessor.setPosition (x, y);
-				outputAccessor.setValue (nc[0]);
-			}
-		}
-		for (x = 0; x < width; x++)
-		{
-			memset (nc, 0, sizeof(uint32_t) * (size_t)radius);
-			for (y1 = 0; y1 < radius / 2; y1++)
-			{
-				inputAccessor.setPosition (x, y1);
-				inputAccessor.getValue (nc[0]);
-				calculate (nc, radius);
-			}
-			for (y = 0; y < height - halfRadius; y++, y1++)
-			{
-				inputAccessor.setPosition (x, y1);
-				inputAccessor.getValue (nc[0]);
-				calculate (nc, radius);
-				outputAccessor.setPosition (x, y);
-				outputAccessor.setValue (nc[0]);
-			}
-			for (; y < height; y++, y1++)
-			{
-				nc[0] = nc[1];
-				calculate (nc, radius);
-				outputAccessor.setPosition (x, y);
-				outputAccessor.setValue (nc[0]);
-			}
-		}
-		if (radius > 19)
-			delete [] nc;
+		if (radius >= 2)
+			BoxBlurKernel (radius, numThreads).process (rows);
 	}
 
+	uint32_t radius;
 };
 
 //----------------------------------------------------------------------------------------------------
-class ScaleBase : public FilterBase
+class ScaleBase : public ThreadedFilterBase, public IPipelineStage
 {
 protected:
 	ScaleBase (UTF8StringPtr description = "")
-	: FilterBase (description)
+	: ThreadedFilterBase (description)
 	{
 		registerProperty (Property::kInputBitmap, BitmapFilter::Property (BitmapFilter::Property::kObject));
 		registerProperty (Property::kOutputRect, CRect (0, 0, 10, 10));
 	}
-	
+
 	bool run (bool replace) VSTGUI_OVERRIDE_VMETHOD
 	{
 		if (replace)
 			return false;
-		CRect outSize = getProperty (Property::kOutputRect).getRect ();
-		outSize.makeIntegral ();
-		if (outSize.getWidth () <= 0 || outSize.getHeight () <= 0)
+		if (!prepareStage (1.))
 			return false;
 		CBitmap* inputBitmap = getInputBitmap ();
 		if (inputBitmap == 0)
 			return false;
-		SharedPointer<CBitmap> outputBitmap = owned (new CBitmap (outSize.getWidth (), outSize.getHeight ()));
+		SharedPointer<CBitmap> outputBitmap = owned (new CBitmap (outSize.x, outSize.y));
 		if (outputBitmap == 0)
 			return false;
-		
-		SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap));
+
+		SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap, true, false));
 		SharedPointer<CBitmapPixelAccess> outputAccessor = owned (CBitmapPixelAccess::create (outputBitmap));
 		if (inputAccessor == 0 || outputAccessor == 0)
 			return false;
-		process (*inputAccessor, *outputAccessor);
+		PixelRows outputRows (*outputAccessor);
+		processStageResample (PixelRows (*inputAccessor), outputRows, getNumThreads (outputRows));
 		return registerProperty (Property::kOutputBitmap, BitmapFilter::Property (outputBitmap));
 	}
-	
-	virtual void process (CBitmapPixelAccess& originalBitmap, CBitmapPixelAccess& copyBitmap) = 0;
-	
+
+	Kind getStageKind () const VSTGUI_OVERRIDE_VMETHOD { return kResampleStage; }
+
+	bool prepareStage (double scaleFactor) VSTGUI_OVERRIDE_VMETHOD
+	{
+		CRect outputRect = getProperty (Property::kOutputRect).getRect ();
+		outputRect.makeIntegral ();
+		outSize = outputRect.getSize ();
+		return outSize.x > 0 && outSize.y > 0;
+	}
+
+	CPoint getStageOutputSize () const VSTGUI_OVERRIDE_VMETHOD { return outSize; }
+
+	void processStageResample (const PixelRows& input, const PixelRows& output, uint32_t numThreads) VSTGUI_OVERRIDE_VMETHOD
+	{
+		vstgui_assert (input.format == output.format);
+		process (input, output, numThreads);
+	}
+
+	virtual void process (const PixelRows& originalBitmap, const PixelRows& copyBitmap, uint32_t numThreads) = 0;
+
+	CPoint outSize;
 };
 
 //----------------------------------------------------------------------------------------------------
 class ScaleLinear : public ScaleBase
 {
-public:	
+public:
 	static IFilter* CreateFunction (IdStringPtr _name)
 	{
 		return new ScaleLinear ();
@@ -588,48 +1443,62 @@ public:
 private:
 	ScaleLinear () : ScaleBase ("A Linear Scale Filter") {}
 
-	void process (CBitmapPixelAccess& originalBitmap, CBitmapPixelAccess& copyBitmap) VSTGUI_OVERRIDE_VMETHOD
+	class RowTask : public ParallelTask
 	{
-		originalBitmap.setPosition (0, 0);
-		copyBitmap.setPosition (0, 0);
-		
-		uint32_t origWidth = (uint32_t)originalBitmap.getBitmapWidth ();
-		uint32_t origHeight = (uint32_t)originalBitmap.getBitmapHeight ();
-		uint32_t newWidth = (uint32_t)copyBitmap.getBitmapWidth ();
-		uint32_t newHeight = (uint32_t)copyBitmap.getBitmapHeight ();
-		
+	public:
+		RowTask (const PixelRows& originalBitmap, const PixelRows& copyBitmap, const std::vector<uint32_t>& origRows, const std::vector<uint32_t>& origColumns)
+		: originalBitmap (originalBitmap), copyBitmap (copyBitmap), origRows (origRows), origColumns (origColumns) {}
+
+		void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
+		{
+			const uint32_t newWidth = copyBitmap.width;
+			for (uint32_t y = begin; y < end; y++)
+			{
+				uint32_t* copyPixel = copyBitmap.row (y);
+				if (y > begin && origRows[y] == origRows[y - 1])
+				{
+					memcpy (copyPixel, copyBitmap.row (y - 1), newWidth * 4);
+					continue;
+				}
+				const uint32_t* origPixel = originalBitmap.row (origRows[y]);
+				for (uint32_t x = 0; x < newWidth; x++)
+					copyPixel[x] = origPixel[origColumns[x]];
+			}
+		}
+	private:
+		const PixelRows& originalBitmap;
+		const PixelRows& copyBitmap;
+		const std::vector<uint32_t>& origRows;
+		const std::vector<uint32_t>& origColumns;
+	};
+
+	void process (const PixelRows& originalBitmap, const PixelRows& copyBitmap, uint32_t numThreads) VSTGUI_OVERRIDE_VMETHOD
+	{
+		uint32_t origWidth = originalBitmap.width;
+		uint32_t origHeight = originalBitmap.height;
+		uint32_t newWidth = copyBitmap.width;
+		uint32_t newHeight = copyBitmap.height;
+
 		float xRatio = (float)origWidth / (float)newWidth;
 		float yRatio = (float)origHeight / (float)newHeight;
 
-		uint8_t* origAddress = originalBitmap.getPlatformBitmapPixelAccess ()->getAddress ();
-		uint8_t* copyAddress = copyBitmap.getPlatformBitmapPixelAccess ()->getAddress ();
-		uint32_t origBytesPerRow = originalBitmap.getPlatformBitmapPixelAccess ()->getBytesPerRow ();
-		uint32_t copyBytesPerRow = copyBitmap.getPlatformBitmapPixelAccess ()->getBytesPerRow ();
+		// the source columns are the same for every row, so calculate them only once
+		std::vector<uint32_t> origColumns (newWidth);
+		float origX = 0;
+		for (uint32_t x = 0; x < newWidth; x++, origX += xRatio)
+			origColumns[x] = std::min<uint32_t> (static_cast<uint32_t> ((int32_t)origX), origWidth - 1);
 
-		CColor c;
-		int32_t ix;
-		int32_t iy = -1;
-		int32_t* origPixel = 0;
+		// the source rows are accumulated, so calculate them up front to split the rows across threads
+		std::vector<uint32_t> origRows (newHeight);
 		float origY = 0;
-		float origX = 0;
 		for (uint32_t y = 0; y < newHeight; y++, origY += yRatio)
 		{
-			int32_t* copyPixel = (int32_t*)(copyAddress + y * copyBytesPerRow);
-			if (iy != (int32_t)origY)
-				iy = (int32_t)origY;
-			ix = -1;
-			origX = 0;
-			for (uint32_t x = 0; x < newWidth; x++, origX += xRatio, copyPixel++)
-			{
-				if (ix != (int32_t)origX || origPixel == 0)
-				{
-					ix = (int32_t)origX;
-					vstgui_assert (iy >= 0);
-					origPixel = (int32_t*)(origAddress + static_cast<uint32_t> (iy) * origBytesPerRow + ix * 4);
-				}
-				*copyPixel = *origPixel;
-			}
+			vstgui_assert ((int32_t)origY >= 0);
+			origRows[y] = std::min<uint32_t> (static_cast<uint32_t> ((int32_t)origY), origHeight - 1);
 		}
+
+		RowTask task (originalBitmap, copyBitmap, origRows, origColumns);
+		parallelFor (task, newHeight, numThreads);
 	}
 };
 
@@ -645,67 +1514,179 @@ public:
 private:
 	ScaleBiliniear () : ScaleBase ("A Biliniear Scale Filter") {}
 
-	void process (CBitmapPixelAccess& originalBitmap, CBitmapPixelAccess& copyBitmap) VSTGUI_OVERRIDE_VMETHOD
+	class RowTask : public ParallelTask
 	{
-		originalBitmap.setPosition (0, 0);
-		copyBitmap.setPosition (0, 0);
+	public:
+		RowTask (const PixelRows& originalBitmap, const PixelRows& copyBitmap, float yRatio, const std::vector<uint32_t>& columns, const std::vector<float>& xDiffs)
+		: originalBitmap (originalBitmap), copyBitmap (copyBitmap), yRatio (yRatio), columns (columns), xDiffs (xDiffs) {}
 
-		uint32_t origWidth = (uint32_t)originalBitmap.getBitmapWidth ();
-		uint32_t origHeight = (uint32_t)originalBitmap.getBitmapHeight ();
-		uint32_t newWidth = (uint32_t)copyBitmap.getBitmapWidth ();
-		uint32_t newHeight = (uint32_t)copyBitmap.getBitmapHeight ();
+		void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
+		{
+			const uint32_t origWidth = originalBitmap.width;
+			const uint32_t origHeight = originalBitmap.height;
+			const uint32_t newWidth = copyBitmap.width;
+			uint32_t pixels[4];
+			for (uint32_t i = begin; i < end; i++)
+			{
+				uint32_t y = static_cast<uint32_t> (yRatio * i);
+				float yDiff = (yRatio * i) - y;
+				const uint32_t* row0 = originalBitmap.row (y);
+				const uint32_t* row1 = originalBitmap.row (std::min (y + 1, origHeight - 1));
+				uint32_t* copyPixel = copyBitmap.row (i);
+				for (uint32_t j = 0; j < newWidth; j++)
+				{
+					uint32_t x = columns[j];
+					uint32_t x1 = std::min (x + 1, origWidth - 1);
+					pixels[0] = row0[x];
+					pixels[1] = row0[x1];
+					pixels[2] = row1[x];
+					pixels[3] = row1[x1];
+					copyPixel[j] = interpolateBilinear (pixels, xDiffs[j], yDiff);
+				}
+			}
+		}
+	private:
+		const PixelRows& originalBitmap;
+		const PixelRows& copyBitmap;
+		float yRatio;
+		const std::vector<uint32_t>& columns;
+		const std::vector<float>& xDiffs;
+	};
+
+	void process (const PixelRows& originalBitmap, const PixelRows& copyBitmap, uint32_t numThreads) VSTGUI_OVERRIDE_VMETHOD
+	{
+		uint32_t origWidth = originalBitmap.width;
+		uint32_t origHeight = originalBitmap.height;
+		uint32_t newWidth = copyBitmap.width;
+		uint32_t newHeight = copyBitmap.height;
 
 		float xRatio = ((float)(origWidth-1)) / (float)newWidth;
 		float yRatio = ((float)(origHeight-1)) / (float)newHeight;
-		float xDiff, yDiff, r, g, b, a;
-		uint32_t x, y;
-		CColor color[4];
-		CColor result;
 
-		for (uint32_t i = 0; i < newHeight; i++)
+		// the source columns and weights are the same for every row, so calculate them only once
+		std::vector<uint32_t> columns (newWidth);
+		std::vector<float> xDiffs (newWidth);
+		for (uint32_t j = 0; j < newWidth; j++)
 		{
-			y = static_cast<uint32_t> (yRatio * i);
-			yDiff = (yRatio * i) - y;
+			columns[j] = static_cast<uint32_t> (xRatio * j);
+			xDiffs[j] = (xRatio * j) - columns[j];
+		}
+
+		RowTask task (originalBitmap, copyBitmap, yRatio, columns, xDiffs);
+		parallelFor (task, newHeight, numThreads);
+	}
+};
+
+//----------------------------------------------------------------------------------------------------
+class ScaleArea : public ScaleBase
+{
+public:
+	static IFilter* CreateFunction (IdStringPtr _name)
+	{
+		return new ScaleArea ();
+	}
+
+private:
+	ScaleArea () : ScaleBase ("An Area Averaging Scale Filter") {}
+
+	// the source pixels covering an output pixel in one direction and how much of each is covered
+	struct Coverage
+	{
+		std::vector<uint32_t> first;
+		std::vector<uint32_t> offset;
+		std::vector<float> weights;
+
+		void calculate (uint32_t origSize, uint32_t newSize)
+		{
+			first.resize (newSize);
+			offset.resize (newSize + 1);
+			weights.clear ();
+			const double ratio = (double)origSize / (double)newSize;
+			for (uint32_t i = 0; i < newSize; i++)
+			{
+				double start = i * ratio;
+				double end = std::min ((i + 1) * ratio, (double)origSize);
+				first[i] = std::min (static_cast<uint32_t> (start), origSize - 1);
+				offset[i] = static_cast<uint32_t> (weights.size ());
+				for (uint32_t j = first[i]; j < end; j++)
+				{
+					double covered = std::min (end, j + 1.) - std::max (start, (double)j);
+					if (covered <= 0.)
+						break;
+					weights.push_back (static_cast<float> (covered / ratio));
+				}
+				if (offset[i] == weights.size ())
+					weights.push_back (1.f);
+			}
+			offset[newSize] = static_cast<uint32_t> (weights.size ());
+		}
+	};
+
+	class RowTask : public ParallelTask
+	{
+	public:
+		RowTask (const PixelRows& originalBitmap, const PixelRows& copyBitmap, const Coverage& rows, const Coverage& columns)
+		: originalBitmap (originalBitmap), copyBitmap (copyBitmap), rows (rows), columns (columns) {}
 
-			for (uint32_t j = 0; j < newWidth; j++, ++copyBitmap)
+		void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
+		{
+			const uint32_t newWidth = copyBitmap.width;
+			std::vector<float> sums (newWidth * 4);
+			for (uint32_t y = begin; y < end; y++)
 			{
-				x = static_cast<uint32_t> (xRatio * j);
-				xDiff = (xRatio * j) - x;
-				originalBitmap.setPosition (x, y);
-				originalBitmap.getColor (color[0]);
-				originalBitmap.setPosition (x+1, y);
-				originalBitmap.getColor (color[1]);
-				originalBitmap.setPosition (x, y+1);
-				originalBitmap.getColor (color[2]);
-				originalBitmap.setPosition (x+1, y+1);
-				originalBitmap.getColor (color[3]);
-				r = color[0].red * (1.f - xDiff) * (1.f - yDiff) + color[1].red * xDiff * (1.f - yDiff)
-				+ color[2].red * yDiff * (1.f - xDiff) + color[3].red * xDiff * yDiff;
-				g = color[0].green * (1.f - xDiff) * (1.f - yDiff) + color[1].green * xDiff * (1.f - yDiff)
-				+ color[2].green * yDiff * (1.f - xDiff) + color[3].green * xDiff * yDiff;
-				b = color[0].blue * (1.f - xDiff) * (1.f - yDiff) + color[1].blue * xDiff * (1.f - yDiff)
-				+ color[2].blue * yDiff * (1.f - xDiff) + color[3].blue * xDiff * yDiff;
-				a = color[0].alpha * (1.f - xDiff) * (1.f - yDiff) + color[1].alpha * xDiff * (1.f - yDiff)
-				+ color[2].alpha * yDiff * (1.f - xDiff) + color[3].alpha * xDiff * yDiff;
-				result = CColor ((uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a);
-				copyBitmap.setColor (result);
+				std::fill (sums.begin (), sums.end (), 0.f);
+				for (uint32_t r = rows.offset[y]; r < rows.offset[y + 1]; r++)
+				{
+					// the color components are averaged independently, so their order does not matter
+					const uint8_t* origRow = reinterpret_cast<const uint8_t*> (originalBitmap.row (rows.first[y] + (r - rows.offset[y])));
+					const float rowWeight = rows.weights[r];
+					for (uint32_t x = 0; x < newWidth; x++)
+					{
+						float* sum = &sums[x * 4];
+						const uint8_t* origPixel = origRow + columns.first[x] * 4;
+						for (uint32_t c = columns.offset[x]; c < columns.offset[x + 1]; c++, origPixel += 4)
+						{
+							const float weight = rowWeight * columns.weights[c];
+							sum[0] += weight * origPixel[0];
+							sum[1] += weight * origPixel[1];
+							sum[2] += weight * origPixel[2];
+							sum[3] += weight * origPixel[3];
+						}
+					}
+				}
+				uint8_t* copyPixel = reinterpret_cast<uint8_t*> (copyBitmap.row (y));
+				for (uint32_t i = 0; i < newWidth * 4; i++)
+					copyPixel[i] = static_cast<uint8_t> (std::min (sums[i] + 0.5f, 255.f));
 			}
 		}
+	private:
+		const PixelRows& originalBitmap;
+		const PixelRows& copyBitmap;
+		const Coverage& rows;
+		const Coverage& columns;
+	};
+
+	void process (const PixelRows& originalBitmap, const PixelRows& copyBitmap, uint32_t numThreads) VSTGUI_OVERRIDE_VMETHOD
+	{
+		// the coverage of the source columns is the same for every row, so calculate it only once
+		Coverage columns;
+		columns.calculate (originalBitmap.width, copyBitmap.width);
+		Coverage rows;
+		rows.calculate (originalBitmap.height, copyBitmap.height);
+
+		RowTask task (originalBitmap, copyBitmap, rows, columns);
+		parallelFor (task, copyBitmap.height, numThreads);
 	}
 };
 
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
-typedef void (*SimpleFilterProcessFunction) (CColor& color, FilterBase* self);
-
-template<typename SimpleFilterProcessFunction>
-class SimpleFilter : public FilterBase
+class SimpleFilter : public ThreadedFilterBase, public IPipelineStage
 {
 protected:
-	SimpleFilter (UTF8StringPtr description, SimpleFilterProcessFunction function)
-	: FilterBase (description)
-	, processFunction (function)
+	SimpleFilter (UTF8StringPtr description)
+	: ThreadedFilterBase (description)
 	{
 		registerProperty (Property::kInputBitmap, BitmapFilter::Property (BitmapFilter::Property::kObject));
 	}
@@ -715,14 +1696,15 @@ protected:
 		SharedPointer<CBitmap> inputBitmap = getInputBitmap ();
 		if (inputBitmap == 0)
 			return false;
-		SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap));
+		prepare ();
+		SharedPointer<CBitmapPixelAccess> inputAccessor = owned (CBitmapPixelAccess::create (inputBitmap, true, replace));
 		if (inputAccessor == 0)
 			return false;
 		SharedPointer<CBitmap> outputBitmap;
 		SharedPointer<CBitmapPixelAccess> outputAccessor;
 		if (replace == false)
 		{
-			outputBitmap = owned (new CBitmap (inputBitmap->getWidth (), inputBitmap->getHeight ()));
+			outputBitmap = owned (createBitmapWithSameSize (inputBitmap));
 			if (outputBitmap == 0)
 				return false;
 			outputAccessor = owned (CBitmapPixelAccess::create (outputBitmap));
@@ -734,45 +1716,58 @@ protected:
 			outputBitmap = inputBitmap;
 			outputAccessor = inputAccessor;
 		}
-		run (*inputAccessor, *outputAccessor);
+		run (PixelRows (*inputAccessor), PixelRows (*outputAccessor));
 		return registerProperty (Property::kOutputBitmap, BitmapFilter::Property (outputBitmap));
 	}
 
-	void run (CBitmapPixelAccess& inputAccessor, CBitmapPixelAccess& outputAccessor)
+	class RowTask : public ParallelTask
 	{
-		inputAccessor.setPosition (0, 0);
-		outputAccessor.setPosition (0, 0);
-		CColor color;
-		if (&inputAccessor == &outputAccessor)
+	public:
+		RowTask (SimpleFilter& filter, const PixelRows& input, const PixelRows& output)
+		: filter (filter), input (input), output (output), order (output.format) {}
+
+		void process (uint32_t begin, uint32_t end) VSTGUI_OVERRIDE_VMETHOD
 		{
-			do
-			{
-				inputAccessor.getColor (color);
-				processFunction (color, this);
-				outputAccessor.setColor (color);
-			}
-			while (++inputAccessor);
-		}
-		else
-		{
-			do
-			{
-				inputAccessor.getColor (color);
-				processFunction (color, this);
-				outputAccessor.setColor (color);
-				++outputAccessor;
-			}
-			while (++inputAccessor);
+			for (uint32_t y = begin; y < end; ++y)
+				filter.processRow (input.row (y), output.row (y), output.width, order);
 		}
+	private:
+		SimpleFilter& filter;
+		const PixelRows& input;
+		const PixelRows& output;
+		ChannelOrder order;
+	};
+
+	void run (const PixelRows& input, const PixelRows& output)
+	{
+		vstgui_assert (input.format == output.format);
+		RowTask task (*this, input, output);
+		parallelFor (task, output.height, getNumThreads (output));
+	}
+
+	Kind getStageKind () const VSTGUI_OVERRIDE_VMETHOD { return kPixelStage; }
+
+	bool prepareStage (double scaleFactor) VSTGUI_OVERRIDE_VMETHOD
+	{
+		prepare ();
+		return true;
 	}
 
-	SimpleFilterProcessFunction processFunction;
+	void processStageRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order) VSTGUI_OVERRIDE_VMETHOD
+	{
+		processRow (src, dst, count, order);
+	}
+
+	/** read the properties before the rows are processed */
+	virtual void prepare () {}
+	/** process one row of pixels, src and dst may be the same. Called concurrently for different rows */
+	virtual void processRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order) = 0;
 };
 
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
-class SetColor : public SimpleFilter<SimpleFilterProcessFunction>
+class SetColor : public SimpleFilter
 {
 public:
 	static IFilter* CreateFunction (IdStringPtr _name)
@@ -782,35 +1777,31 @@ public:
 
 private:
 	SetColor ()
-	: SimpleFilter<SimpleFilterProcessFunction> ("A Set Color Filter", processSetColor)
+	: SimpleFilter ("A Set Color Filter")
 	{
 		registerProperty (Property::kIgnoreAlphaColorValue, BitmapFilter::Property ((int32_t)1));
 		registerProperty (Property::kInputColor, BitmapFilter::Property (kWhiteCColor));
 	}
 
-	static void processSetColor (CColor& color, FilterBase* obj)
+	void processRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order) VSTGUI_OVERRIDE_VMETHOD
 	{
-		SetColor* filter = static_cast<SetColor*> (obj);
-		if (filter->ignoreAlpha)
-			filter->inputColor.alpha = color.alpha;
-		color = filter->inputColor;
+		setColorRow (src, dst, count, order.pack (inputColor), ignoreAlpha ? order.alphaMask () : 0);
 	}
 
 	bool ignoreAlpha;
 	CColor inputColor;
 
-	bool run (bool replace) VSTGUI_OVERRIDE_VMETHOD
+	void prepare () VSTGUI_OVERRIDE_VMETHOD
 	{
 		inputColor = getProperty (Property::kInputColor).getColor ();
 		ignoreAlpha = getProperty (Property::kIgnoreAlphaColorValue).getInteger () > 0;
-		return SimpleFilter<SimpleFilterProcessFunction>::run (replace);
 	}
 };
 
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
-class Grayscale : public SimpleFilter<SimpleFilterProcessFunction>
+class Grayscale : public SimpleFilter
 {
 public:
 	static IFilter* CreateFunction (IdStringPtr name)
@@ -820,13 +1811,13 @@ public:
 
 private:
 	Grayscale ()
-	: SimpleFilter<SimpleFilterProcessFunction> ("A Grayscale Filter", processGrayscale)
+	: SimpleFilter ("A Grayscale Filter")
 	{
 	}
 
-	static void processGrayscale (CColor& color, FilterBase* obj)
+	void processRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order) VSTGUI_OVERRIDE_VMETHOD
 	{
-		color.red = color.green = color.blue = color.getLuma ();
+		grayscaleRow (src, dst, count, order);
 	}
 
 };
@@ -834,7 +1825,7 @@ private:
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------
-class ReplaceColor : public SimpleFilter<SimpleFilterProcessFunction>
+class ReplaceColor : public SimpleFilter
 {
 public:
 	static IFilter* CreateFunction (IdStringPtr name)
@@ -844,27 +1835,24 @@ public:
 
 private:
 	ReplaceColor ()
-	: SimpleFilter<SimpleFilterProcessFunction> ("A Replace Color Filter", processReplace)
+	: SimpleFilter ("A Replace Color Filter")
 	{
 		registerProperty (Property::kInputColor, BitmapFilter::Property (kWhiteCColor));
 		registerProperty (Property::kOutputColor, BitmapFilter::Property (kTransparentCColor));
 	}
 
-	static void processReplace (CColor& color, FilterBase* obj)
+	void processRow (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& order) VSTGUI_OVERRIDE_VMETHOD
 	{
-		ReplaceColor* filter = static_cast<ReplaceColor*> (obj);
-		if (color == filter->inputColor)
-			color = filter->outputColor;
+		replaceColorRow (src, dst, count, order.pack (inputColor), order.pack (outputColor));
 	}
 
 	CColor inputColor;
 	CColor outputColor;
 
-	bool run (bool replace) VSTGUI_OVERRIDE_VMETHOD
+	void prepare () VSTGUI_OVERRIDE_VMETHOD
 	{
 		inputColor = getProperty (Property::kInputColor).getColor ();
 		outputColor = getProperty (Property::kOutputColor).getColor ();
-		return SimpleFilter<SimpleFilterProcessFunction>::run (replace);
 	}
 
 };
@@ -880,10 +1868,140 @@ void registerStandardFilters (Factory& factory)
 	factory.registerFilter (kReplaceColor, ReplaceColor::CreateFunction);
 	factory.registerFilter (kScaleBilinear, ScaleBiliniear::CreateFunction);
 	factory.registerFilter (kScaleLinear, ScaleLinear::CreateFunction);
+	factory.registerFilter (kScaleArea, ScaleArea::CreateFunction);
+}
+
+//----------------------------------------------------------------------------------------------------
+void stopWorkerThreads ()
+{
+#if VSTGUI_BITMAPFILTER_THREADS
+	WorkerPool::getInstance ().stop ();
+#endif
 }
 
 } // namespace Standard
 
 ///@end cond
 
+//----------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------
+Pipeline::Pipeline ()
+: threadCount (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+Pipeline::~Pipeline ()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+void Pipeline::addFilter (IFilter* filter)
+{
+	if (filter)
+		filters.push_back (filter);
+}
+
+//----------------------------------------------------------------------------------------------------
+IFilter* Pipeline::addFilter (IdStringPtr name)
+{
+	SharedPointer<IFilter> filter = owned (Factory::getInstance ().createFilter (name));
+	if (filter == 0)
+		return 0;
+	filters.push_back (filter);
+	return filter;
+}
+
+//----------------------------------------------------------------------------------------------------
+uint32_t Pipeline::getNumFilters () const
+{
+	return static_cast<uint32_t> (filters.size ());
+}
+
+//----------------------------------------------------------------------------------------------------
+IFilter* Pipeline::getFilter (uint32_t index) const
+{
+	return index < filters.size () ? filters[index] : 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+void Pipeline::removeAllFilters ()
+{
+	filters.clear ();
+}
+
+//----------------------------------------------------------------------------------------------------
+CBitmap* Pipeline::getOutputBitmap () const
+{
+	return outputBitmap;
+}
+
+//----------------------------------------------------------------------------------------------------
+bool Pipeline::run (CBitmap* inputBitmap, bool replaceInputBitmap)
+{
+	using namespace BitmapFilterPrivate;
+
+	outputBitmap = 0;
+	if (inputBitmap == 0 || inputBitmap->getPlatformBitmap () == 0)
+		return false;
+
+	// the bitmap with the result of the previous filter, only written to if writable is true
+	SharedPointer<CBitmap> current (inputBitmap);
+	bool writable = replaceInputBitmap;
+	std::vector<IPipelineStage*> pixelStages;
+	for (size_t index = 0; index < filters.size ();)
+	{
+		IPipelineStage* stage = filters[index].cast<IPipelineStage> ();
+		if (stage == 0)
+		{
+			if (!runFilter (filters[index], current, writable))
+				return false;
+			++index;
+			continue;
+		}
+		double scaleFactor = current->getPlatformBitmap ()->getScaleFactor ();
+		if (!stage->prepareStage (scaleFactor))
+			return false;
+		bool result = false;
+		switch (stage->getStageKind ())
+		{
+			case IPipelineStage::kPixelStage:
+			{
+				pixelStages.clear ();
+				pixelStages.push_back (stage);
+				for (++index; index < filters.size (); ++index)
+				{
+					IPipelineStage* next = filters[index].cast<IPipelineStage> ();
+					if (next == 0 || next->getStageKind () != IPipelineStage::kPixelStage)
+						break;
+					if (!next->prepareStage (scaleFactor))
+						return false;
+					pixelStages.push_back (next);
+				}
+				result = runPixelStages (pixelStages, current, writable, threadCount);
+				break;
+			}
+			case IPipelineStage::kInPlaceStage:
+			{
+				result = runInPlaceStage (stage, current, writable, threadCount);
+				++index;
+				break;
+			}
+			case IPipelineStage::kResampleStage:
+			{
+				result = runResampleStage (stage, current, writable, threadCount);
+				++index;
+				break;
+			}
+		}
+		if (!result)
+			return false;
+	}
+	if (replaceInputBitmap && current != inputBitmap)
+		inputBitmap->setPlatformBitmap (current->getPlatformBitmap ());
+	outputBitmap = replaceInputBitmap ? inputBitmap : static_cast<CBitmap*> (current);
+	return true;
+}
+
 }} // namespaces
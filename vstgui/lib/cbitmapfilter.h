@@ -152,6 +152,7 @@ namespace Standard {
 		Properties:
 			- Property::kInputBitmap
 			- Property::kRadius
+			- Property::kThreadCount
 			- Property::kOutputBitmap
 	*/
 	static const IdStringPtr kBoxBlur = "Box Blur";
@@ -162,6 +163,7 @@ namespace Standard {
 
 		Properties:
 			- Property::kInputBitmap
+			- Property::kThreadCount
 			- Property::kOutputBitmap
 	 */
 	static const IdStringPtr kGrayscale = "Grayscale";
@@ -174,6 +176,7 @@ namespace Standard {
 			- Property::kInputBitmap
 			- Property::kInputColor
 			- Property::kOutputColor
+			- Property::kThreadCount
 			- Property::kOutputBitmap
 	 */
 	static const IdStringPtr kReplaceColor = "Replace Color";
@@ -187,6 +190,7 @@ namespace Standard {
 			- Property::kInputBitmap
 			- Property::kInputColor
 			- Property::kIgnoreAlphaColorValue
+			- Property::kThreadCount
 			- Property::kOutputBitmap
 	 */
 	static const IdStringPtr kSetColor = "Set Color";
@@ -199,6 +203,7 @@ namespace Standard {
 		Properties:
 			- Property::kInputBitmap
 			- Property::kOutputRect
+			- Property::kThreadCount
 			- Property::kOutputBitmap
 	 */
 	static const IdStringPtr kScaleBilinear = "Scale Biliniear";
@@ -211,11 +216,31 @@ namespace Standard {
 		Properties:
 			- Property::kInputBitmap
 			- Property::kOutputRect
+			- Property::kThreadCount
 			- Property::kOutputBitmap
 	 */
 	static const IdStringPtr kScaleLinear = "Scale Linear";
 
-	/** @brief Standard Bitmap Property Names */
+	/** Scale Area Filter Name.
+	 
+		Creates a scaled bitmap of the input bitmap where every pixel is the average of the input pixels
+		it covers. Gives the best results when making bitmaps smaller.
+		Does not work inplace.
+
+		Properties:
+			- Property::kInputBitmap
+			- Property::kOutputRect
+			- Property::kThreadCount
+			- Property::kOutputBitmap
+	 */
+	static const IdStringPtr kScaleArea = "Scale Area";
+
+	/** @brief Standard Bitmap Property Names
+
+		All standard filters support Property::kThreadCount. Large bitmaps are then processed in parts
+		on a shared pool of threads, the result is always the same as with a single thread. In
+		automatic mode only bitmaps with at least 512 x 512 pixels are processed on multiple threads.
+	*/
 	namespace Property {
 	
 		static const IdStringPtr kInputBitmap = "InputBitmap"; ///< [Property::kObject - CBitmap]
@@ -225,9 +250,17 @@ namespace Standard {
 		static const IdStringPtr kOutputColor = "OutputColor"; ///< [Property::kColor]
 		static const IdStringPtr kOutputRect = "OutputRect"; ///< [Property::kRect]
 		static const IdStringPtr kIgnoreAlphaColorValue = "IgnoreAlphaColorValue"; ///< [Property::kInteger]
+		static const IdStringPtr kThreadCount = "ThreadCount"; ///< [Property::kInteger] 0 = automatic (default), 1 = no extra threads, n = at most n threads
 
 	} // namespace Property
 
+	/** end the threads of the shared pool.
+		The threads end themselves after being idle for a while, call this before the library is unloaded
+		to make sure that none is left. Must not be called from a filter or from DllMain or a static destructor,
+		it waits for a running filter and the threads to end. The pool starts new threads when they are needed again.
+		The editors of the plugin-bindings call it when they are destroyed. */
+	void stopWorkerThreads ();
+
 } // namespace Standard
 
 //----------------------------------------------------------------------------------------------------
@@ -255,6 +288,52 @@ private:
 	std::string description;
 };
 
+//----------------------------------------------------------------------------------------------------
+/// @brief Runs a chain of filters on a bitmap
+/// @ingroup new_in_4_3
+/// @details The filters run in the order they were added, each one on the result of the previous one.
+/// The Property::kInputBitmap property of the filters is ignored.
+///
+/// The standard filters don't create a new bitmap per filter. Consecutive Set Color, Grayscale and
+/// Replace Color filters are fused into one pass over the pixels, the Box Blur works in place and only
+/// the scale filters need a bitmap of their own, so at most two bitmaps are in use at the same time.
+/// Other filters are run one after the other via IFilter::run.
+//----------------------------------------------------------------------------------------------------
+class Pipeline
+{
+public:
+	Pipeline ();
+	~Pipeline ();
+
+	/** add a filter to the end of the chain */
+	void addFilter (IFilter* filter);
+	/** create a filter via the Factory and add it to the end of the chain. Returns the filter so that its properties can be set. */
+	IFilter* addFilter (IdStringPtr name);
+	uint32_t getNumFilters () const;
+	IFilter* getFilter (uint32_t index) const;
+	void removeAllFilters ();
+
+	/** number of threads, see Standard::Property::kThreadCount */
+	void setThreadCount (int32_t count) { threadCount = count; }
+	int32_t getThreadCount () const { return threadCount; }
+
+	/** run all filters.
+		If replaceInputBitmap is true, the input bitmap contains the result afterwards, otherwise the input bitmap is not changed.
+		Returns false if one of the filters fails, in this case the input bitmap may be changed if replaceInputBitmap is true. */
+	bool run (CBitmap* inputBitmap, bool replaceInputBitmap = false);
+	/** the result of the last run */
+	CBitmap* getOutputBitmap () const;
+
+private:
+	Pipeline (const Pipeline&);
+	Pipeline& operator= (const Pipeline&);
+
+	typedef std::vector<SharedPointer<IFilter> > FilterList;
+	FilterList filters;
+	SharedPointer<CBitmap> outputBitmap;
+	int32_t threadCount;
+};
+
 } // namespace BitmapFilter
 
 } // namespace
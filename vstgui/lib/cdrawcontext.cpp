@@ -433,6 +433,18 @@ void CDrawContext::fillRectWithBitmap (CBitmap* bitmap, const CRect& srcRect, co
 	}
 }
 
+//-----------------------------------------------------------------------------
+bool CDrawContext::drawBitmapFromAtlas (CBitmap* bitmap, const CRect& dest, const CPoint& offset, float alpha)
+{
+	if (bitmap == 0 || bitmap->getAtlas () == 0)
+		return false;
+	CRect atlasDest;
+	CPoint atlasOffset;
+	if (bitmap->mapToAtlas (dest, offset, atlasDest, atlasOffset))
+		drawBitmap (bitmap->getAtlas (), atlasDest, atlasOffset, alpha);
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 void CDrawContext::drawBitmapNinePartTiled (CBitmap* bitmap, const CRect& dest, const CNinePartTiledDescription& desc, float alpha)
 {
@@ -227,6 +227,10 @@ protected:
 	const CString& getDrawString (UTF8StringPtr string);
 	void clearDrawString ();
 
+	/** for the implementations of drawBitmap: if the bitmap is part of an atlas (see CBitmap::setAtlas), its part of the atlas is drawn
+		and true is returned */
+	bool drawBitmapFromAtlas (CBitmap* bitmap, const CRect& dest, const CPoint& offset, float alpha);
+
 	/// @cond ignore
 	struct CDrawContextState
 	{
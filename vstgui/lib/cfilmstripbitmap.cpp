@@ -0,0 +1,339 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "cfilmstripbitmap.h"
+#include "cdrawcontext.h"
+#include "platform/iplatformbitmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace VSTGUI {
+
+/// @cond ignore
+namespace CFilmstripBitmapPrivate {
+
+// runs shorter than this are stored as literals
+static const uint32_t kMinRunLength = 3;
+
+//-----------------------------------------------------------------------------
+// every token starts with (count << 1) | isRun, a run is followed by one value, literals by count values
+static void encodeRunLength (const uint32_t* values, uint32_t numValues, std::vector<uint32_t>& output)
+{
+	uint32_t i = 0;
+	while (i < numValues)
+	{
+		uint32_t run = 1;
+		while (i + run < numValues && values[i + run] == values[i])
+			run++;
+		if (run >= kMinRunLength)
+		{
+			output.push_back ((run << 1) | 1);
+			output.push_back (values[i]);
+			i += run;
+			continue;
+		}
+		uint32_t start = i;
+		while (i < numValues)
+		{
+			run = 1;
+			while (i + run < numValues && run < kMinRunLength && values[i + run] == values[i])
+				run++;
+			if (run >= kMinRunLength)
+				break;
+			i += run;
+		}
+		output.push_back ((i - start) << 1);
+		output.insert (output.end (), values + start, values + i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// the decoded values are combined with the pixels via xor, as the frames are stored as the difference to the previous frame
+static bool decodeRunLength (const std::vector<uint32_t>& input, uint32_t* pixels, uint32_t numPixels)
+{
+	uint32_t pos = 0;
+	std::vector<uint32_t>::const_iterator it = input.begin ();
+	while (it != input.end ())
+	{
+		uint32_t count = *it >> 1;
+		bool isRun = (*it & 1) != 0;
+		++it;
+		if (count > numPixels - pos || static_cast<uint32_t> (input.end () - it) < (isRun ? 1 : count))
+			return false;
+		if (isRun)
+		{
+			const uint32_t value = *it++;
+			if (value)
+			{
+				for (uint32_t i = 0; i < count; i++)
+					pixels[pos + i] ^= value;
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < count; i++)
+				pixels[pos + i] ^= *it++;
+		}
+		pos += count;
+	}
+	return pos == numPixels;
+}
+
+} // CFilmstripBitmapPrivate
+/// @endcond
+
+//-----------------------------------------------------------------------------
+CFilmstripBitmap::CFilmstripBitmap (IPlatformBitmap* strip, uint32_t numFrames)
+: numFrames (numFrames)
+, frameWidth (0)
+, frameHeight (0)
+, scaleFactor (1.)
+, maxDecodedFrames (4)
+, lastFrameIndex (0)
+{
+	compress (strip);
+}
+
+//-----------------------------------------------------------------------------
+CFilmstripBitmap::CFilmstripBitmap (const CResourceDescription& desc, uint32_t numFrames)
+: numFrames (numFrames)
+, frameWidth (0)
+, frameHeight (0)
+, scaleFactor (1.)
+, maxDecodedFrames (4)
+, lastFrameIndex (0)
+{
+	resourceDesc = desc;
+	SharedPointer<IPlatformBitmap> strip = owned (IPlatformBitmap::create ());
+	if (strip && strip->load (desc))
+		compress (strip);
+}
+
+//-----------------------------------------------------------------------------
+CFilmstripBitmap::~CFilmstripBitmap ()
+{
+}
+
+//-----------------------------------------------------------------------------
+void CFilmstripBitmap::compress (IPlatformBitmap* strip)
+{
+	frames.clear ();
+	if (strip == 0 || numFrames == 0)
+		return;
+	SharedPointer<CBitmap> bitmap = owned (new CBitmap (strip));
+	SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap, true, false));
+	if (accessor == 0)
+		return;
+	vstgui_assert (accessor->getBitmapHeight () % numFrames == 0, "the height of the strip must be a multiple of the number of frames");
+	frameWidth = accessor->getBitmapWidth ();
+	frameHeight = accessor->getBitmapHeight () / numFrames;
+	scaleFactor = strip->getScaleFactor ();
+	if (frameHeight == 0)
+		return;
+
+	const uint32_t numPixels = frameWidth * frameHeight;
+	Pixels previous (numPixels);
+	Pixels current (numPixels);
+	Pixels difference (numPixels);
+	frames.resize (numFrames);
+	for (uint32_t index = 0; index < numFrames; index++)
+	{
+		for (uint32_t y = 0; y < frameHeight; y++)
+			memcpy (&current[y * frameWidth], accessor->getRow (index * frameHeight + y), frameWidth * 4);
+		if (index % kKeyFrameInterval == 0)
+			std::fill (previous.begin (), previous.end (), 0);
+		for (uint32_t i = 0; i < numPixels; i++)
+			difference[i] = current[i] ^ previous[i];
+		CFilmstripBitmapPrivate::encodeRunLength (&difference[0], numPixels, frames[index]);
+		Pixels (frames[index]).swap (frames[index]);
+		previous.swap (current);
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool CFilmstripBitmap::decodeFrame (uint32_t index, Pixels& pixels) const
+{
+	if (index >= frames.size ())
+		return false;
+	// continue from the last decoded frame if it is on the way from the key frame to this one
+	uint32_t keyFrame = index - index % kKeyFrameInterval;
+	uint32_t next = keyFrame;
+	if (!lastFrame.empty () && lastFrameIndex >= keyFrame && lastFrameIndex <= index)
+		next = lastFrameIndex + 1;
+	else
+		lastFrame.assign (frameWidth * frameHeight, 0);
+	for (; next <= index; next++)
+	{
+		if (!CFilmstripBitmapPrivate::decodeRunLength (frames[next], &lastFrame[0], static_cast<uint32_t> (lastFrame.size ())))
+		{
+			lastFrame.clear ();
+			return false;
+		}
+		lastFrameIndex = next;
+	}
+	pixels = lastFrame;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+CCoord CFilmstripBitmap::getFrameHeight () const
+{
+	return frameHeight / scaleFactor;
+}
+
+//-----------------------------------------------------------------------------
+CBitmap* CFilmstripBitmap::getFrame (uint32_t index)
+{
+	for (DecodedFrameList::iterator it = decodedFrames.begin (); it != decodedFrames.end (); ++it)
+	{
+		if (it->first == index)
+		{
+			if (it != decodedFrames.begin ())
+				decodedFrames.splice (decodedFrames.begin (), decodedFrames, it);
+			return it->second;
+		}
+	}
+	Pixels pixels;
+	if (!decodeFrame (index, pixels))
+		return 0;
+	CPoint size (frameWidth, frameHeight);
+	SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create (&size));
+	if (platformBitmap == 0)
+		return 0;
+	platformBitmap->setScaleFactor (scaleFactor);
+	SharedPointer<CBitmap> frame = owned (new CBitmap (platformBitmap));
+	SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (frame));
+	if (accessor == 0)
+		return 0;
+	for (uint32_t y = 0; y < frameHeight; y++)
+		memcpy (accessor->getRow (y), &pixels[y * frameWidth], frameWidth * 4);
+	accessor = 0;
+
+	decodedFrames.push_front (DecodedFrame (index, frame));
+	while (decodedFrames.size () > maxDecodedFrames)
+		decodedFrames.pop_back ();
+	return frame;
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* CFilmstripBitmap::decodeAllFrames () const
+{
+	if (frames.empty ())
+		return 0;
+	CPoint size (frameWidth, frameHeight * numFrames);
+	IPlatformBitmap* platformBitmap = IPlatformBitmap::create (&size);
+	if (platformBitmap == 0)
+		return 0;
+	platformBitmap->setScaleFactor (scaleFactor);
+	SharedPointer<CBitmap> bitmap = owned (new CBitmap (platformBitmap));
+	SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap));
+	Pixels pixels;
+	for (uint32_t index = 0; accessor && index < numFrames; index++)
+	{
+		if (!decodeFrame (index, pixels))
+			break;
+		for (uint32_t y = 0; y < frameHeight; y++)
+			memcpy (accessor->getRow (index * frameHeight + y), &pixels[y * frameWidth], frameWidth * 4);
+	}
+	return platformBitmap;
+}
+
+//-----------------------------------------------------------------------------
+void CFilmstripBitmap::setMaxDecodedFrames (uint32_t count)
+{
+	maxDecodedFrames = std::max<uint32_t> (count, 1);
+	while (decodedFrames.size () > maxDecodedFrames)
+		decodedFrames.pop_back ();
+}
+
+//-----------------------------------------------------------------------------
+void CFilmstripBitmap::releaseDecodedFrames ()
+{
+	decodedFrames.clear ();
+	Pixels ().swap (lastFrame);
+}
+
+//-----------------------------------------------------------------------------
+uint64_t CFilmstripBitmap::getCompressedSize () const
+{
+	uint64_t result = 0;
+	VSTGUI_RANGE_BASED_FOR_LOOP (std::vector<Pixels>, frames, Pixels, frame)
+		result += frame.size () * sizeof (uint32_t);
+	VSTGUI_RANGE_BASED_FOR_LOOP_END
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t CFilmstripBitmap::getDecodedSize () const
+{
+	return (static_cast<uint64_t> (decodedFrames.size ()) * frameWidth * frameHeight + lastFrame.size ()) * sizeof (uint32_t);
+}
+
+//-----------------------------------------------------------------------------
+void CFilmstripBitmap::draw (CDrawContext* context, const CRect& rect, const CPoint& offset, float alpha)
+{
+	const CCoord height = getFrameHeight ();
+	if (height <= 0. || offset.y < 0.)
+		return;
+	// draw every frame the rect shows, usually this is only one
+	CRect frameRect (rect);
+	CCoord y = offset.y;
+	while (frameRect.top < rect.bottom)
+	{
+		uint32_t index = static_cast<uint32_t> (std::floor (y / height));
+		if (index >= numFrames)
+			break;
+		CCoord frameOffset = y - index * height;
+		frameRect.bottom = std::min (rect.bottom, frameRect.top + height - frameOffset);
+		if (CBitmap* frame = getFrame (index))
+			frame->draw (context, frameRect, CPoint (offset.x, frameOffset), alpha);
+		y += frameRect.getHeight ();
+		frameRect.top = frameRect.bottom;
+	}
+}
+
+//-----------------------------------------------------------------------------
+CCoord CFilmstripBitmap::getWidth () const
+{
+	return frameWidth / scaleFactor;
+}
+
+//-----------------------------------------------------------------------------
+CCoord CFilmstripBitmap::getHeight () const
+{
+	return frameHeight * numFrames / scaleFactor;
+}
+
+} // namespace
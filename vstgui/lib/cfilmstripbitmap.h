@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#ifndef __cfilmstripbitmap__
+#define __cfilmstripbitmap__
+
+#include "cbitmap.h"
+#include <list>
+#include <vector>
+
+namespace VSTGUI {
+
+//-----------------------------------------------------------------------------
+/// @brief A filmstrip bitmap which keeps its frames compressed in memory
+/// @ingroup new_in_4_3
+/// @details The frames are stacked vertically like the bitmaps of IMultiBitmapControl expect them. Every frame is
+/// stored run length encoded as the difference to the previous frame, every eighth frame on its own, so that decoding
+/// a frame never needs more than eight frames to be expanded. Filmstrips of knobs, where most of the pixels don't change
+/// from frame to frame, need a fraction of the memory of a CBitmap this way.
+///
+/// Only the frames which are drawn are decoded, the most recently drawn ones are kept decoded (4 by default).
+/// The filmstrip has only one resolution and no platform bitmap, getPlatformBitmap returns 0. Use decodeAllFrames if
+/// the bitmap is needed as a whole.
+//-----------------------------------------------------------------------------
+class CFilmstripBitmap : public CBitmap
+{
+public:
+	/** compress the frames of strip, numFrames frames of the same height */
+	CFilmstripBitmap (IPlatformBitmap* strip, uint32_t numFrames);
+	/** load the strip from a resource and compress its frames */
+	CFilmstripBitmap (const CResourceDescription& desc, uint32_t numFrames);
+	~CFilmstripBitmap ();
+
+	//-----------------------------------------------------------------------------
+	/// @name Frames
+	//-----------------------------------------------------------------------------
+	//@{
+	uint32_t getNumFrames () const { return numFrames; }
+	CCoord getFrameHeight () const;
+	/** the frame as bitmap, decodes it if it is not one of the recently used frames. Returns 0 for an invalid index. */
+	CBitmap* getFrame (uint32_t index);
+	/** decode all frames into one platform bitmap, the caller owns the result */
+	IPlatformBitmap* decodeAllFrames () const;
+
+	/** number of frames kept decoded, at least 1 */
+	void setMaxDecodedFrames (uint32_t count);
+	uint32_t getMaxDecodedFrames () const { return maxDecodedFrames; }
+	/** release the decoded frames */
+	void releaseDecodedFrames ();
+
+	/** bytes used by the compressed frames */
+	uint64_t getCompressedSize () const;
+	/** bytes used by the decoded frames */
+	uint64_t getDecodedSize () const;
+	//@}
+
+	// overrides
+	void draw (CDrawContext* context, const CRect& rect, const CPoint& offset = CPoint (0, 0), float alpha = 1.f) VSTGUI_OVERRIDE_VMETHOD;
+	CCoord getWidth () const VSTGUI_OVERRIDE_VMETHOD;
+	CCoord getHeight () const VSTGUI_OVERRIDE_VMETHOD;
+
+//-----------------------------------------------------------------------------
+	CLASS_METHODS_NOCOPY(CFilmstripBitmap, CBitmap)
+protected:
+	enum { kKeyFrameInterval = 8 };
+
+	typedef std::vector<uint32_t> Pixels;
+	typedef std::pair<uint32_t, SharedPointer<CBitmap> > DecodedFrame;
+	typedef std::list<DecodedFrame> DecodedFrameList;
+
+	void compress (IPlatformBitmap* strip);
+	bool decodeFrame (uint32_t index, Pixels& pixels) const;
+
+	std::vector<Pixels> frames;
+	uint32_t numFrames;
+	uint32_t frameWidth;	// in pixels
+	uint32_t frameHeight;	// in pixels
+	double scaleFactor;
+	uint32_t maxDecodedFrames;
+	DecodedFrameList decodedFrames; // most recently used first
+	mutable Pixels lastFrame;
+	mutable uint32_t lastFrameIndex;
+};
+
+} // namespace
+
+#endif // __cfilmstripbitmap__
@@ -33,6 +33,7 @@
 //-----------------------------------------------------------------------------
 
 #include "cframe.h"
+#include "cbitmapcache.h"
 #include "coffscreencontext.h"
 #include "ctooltipsupport.h"
 #include "itouchevent.h"
@@ -123,6 +124,7 @@ CFrame::~CFrame ()
 
 	pParentFrame = 0;
 	removeAll ();
+	CBitmapCache::instance ().resetUsage (this);
 
 	if (pTooltips)
 	{
@@ -187,6 +189,7 @@ void CFrame::close ()
 	setCursor (kCursorDefault);
 	pParentFrame = 0;
 	removeAll ();
+	CBitmapCache::instance ().resetUsage (this);
 	if (platformFrame)
 	{
 		platformFrame->forget ();
@@ -302,8 +305,12 @@ void CFrame::drawRect (CDrawContext* pContext, const CRect& updateRect)
 	newClip.bound (oldClip);
 	pContext->setClipRect (newClip);
 
-	// draw the background and the children
+	// draw the background and the children, the bitmap variants they draw are marked as used by this frame
+	CBitmapCache& bitmapCache = CBitmapCache::instance ();
+	const CFrame* previousDrawingFrame = bitmapCache.getDrawingFrame ();
+	bitmapCache.setDrawingFrame (this);
 	CViewContainer::drawRect (pContext, updateRect);
+	bitmapCache.setDrawingFrame (previousDrawingFrame);
 
 	pContext->setClipRect (oldClip);
 
@@ -1559,6 +1566,7 @@ void CFrame::platformOnActivate (bool state)
 //-----------------------------------------------------------------------------
 void CFrame::platformScaleFactorChanged ()
 {
+	CBitmapCache::instance ().resetUsage (this);
 	if (pScaleFactorChangedListenerList == 0)
 		return;
 	for (ScaleFactorChangedListenerList::const_iterator it = pScaleFactorChangedListenerList->begin (), end = pScaleFactorChangedListenerList->end (); it != end; it++)
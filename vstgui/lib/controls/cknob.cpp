@@ -762,7 +762,7 @@ void CAnimKnob::draw (CDrawContext *pContext)
 			where.y -= (int32_t)where.y % (int32_t)heightOfOneImage;
 		}
 
-		getDrawBackground ()->draw (pContext, getViewSize (), where);
+		getDrawBackground ()->drawFrame (pContext, getViewSize (), where, heightOfOneImage);
 	}
 	setDirty (false);
 }
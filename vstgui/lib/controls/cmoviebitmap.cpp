@@ -100,7 +100,7 @@ void CMovieBitmap::draw (CDrawContext *pContext)
 
 	if (getDrawBackground ())
 	{
-		getDrawBackground ()->draw (pContext, getViewSize (), where);
+		getDrawBackground ()->drawFrame (pContext, getViewSize (), where, heightOfOneImage);
 	}
 	setDirty (false);
 }
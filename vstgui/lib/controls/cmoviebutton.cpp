@@ -105,7 +105,7 @@ void CMovieButton::draw (CDrawContext *pContext)
 
 	if (getDrawBackground ())
 	{
-		getDrawBackground ()->draw (pContext, getViewSize (), where);
+		getDrawBackground ()->drawFrame (pContext, getViewSize (), where, heightOfOneImage);
 	}
 	buttonState = value;
 
@@ -115,7 +115,7 @@ void CVerticalSwitch::draw (CDrawContext *pContext)
 		// source position in bitmap
 		CPoint where (0, heightOfOneImage * ((int32_t)(norm * (getNumSubPixmaps () - 1) + 0.5f)));
 
-		getDrawBackground ()->draw (pContext, getViewSize (), where);
+		getDrawBackground ()->drawFrame (pContext, getViewSize (), where, heightOfOneImage);
 	}
 	setDirty (false);
 }
@@ -286,7 +286,7 @@ void CHorizontalSwitch::draw (CDrawContext *pContext)
 		// source position in bitmap
 		CPoint where (0, heightOfOneImage * ((int32_t)(norm * (getNumSubPixmaps () - 1) + 0.5f)));
 
-		getDrawBackground ()->draw (pContext, getViewSize (), where);
+		getDrawBackground ()->drawFrame (pContext, getViewSize (), where, heightOfOneImage);
 	}
 	setDirty (false);
 }
@@ -474,7 +474,7 @@ void CRockerSwitch::draw (CDrawContext *pContext)
 
 	if (getDrawBackground ())
 	{
-		getDrawBackground ()->draw (pContext, getViewSize (), where);
+		getDrawBackground ()->drawFrame (pContext, getViewSize (), where, heightOfOneImage);
 	}
 	setDirty (false);
 }
@@ -0,0 +1,413 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "cpixelspan.h"
+#include "ccolor.h"
+#include "vstguisimd.h"
+#include <algorithm>
+#include <cstring>
+
+namespace VSTGUI {
+namespace PixelSpan {
+
+/// @cond ignore
+namespace {
+
+//-----------------------------------------------------------------------------
+struct ChannelOrder
+{
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+	uint8_t alpha;
+};
+
+//-----------------------------------------------------------------------------
+const ChannelOrder kChannelOrders[] = {
+	{1, 2, 3, 0}, // kARGB
+	{0, 1, 2, 3}, // kRGBA
+	{3, 2, 1, 0}, // kABGR
+	{2, 1, 0, 3}  // kBGRA
+};
+
+//-----------------------------------------------------------------------------
+inline const ChannelOrder& getChannelOrder (Format format)
+{
+	return kChannelOrders[format];
+}
+
+//-----------------------------------------------------------------------------
+/** a * b / 255 rounded */
+inline uint32_t mulDiv255 (uint32_t a, uint32_t b)
+{
+	uint32_t t = a * b + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+//-----------------------------------------------------------------------------
+inline void premultiplyPixel (const uint8_t* s, uint8_t* d, uint32_t alphaIndex)
+{
+	uint32_t alpha = s[alphaIndex];
+	for (uint32_t i = 0; i < 4; ++i)
+		d[i] = static_cast<uint8_t> (i == alphaIndex ? alpha : mulDiv255 (s[i], alpha));
+}
+
+//-----------------------------------------------------------------------------
+inline void unpremultiplyPixel (const uint8_t* s, uint8_t* d, uint32_t alphaIndex)
+{
+	uint32_t alpha = s[alphaIndex];
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		if (i == alphaIndex || alpha == 0)
+			d[i] = s[i];
+		else
+			d[i] = static_cast<uint8_t> (std::min<uint32_t> (255, (s[i] * 255 + alpha / 2) / alpha));
+	}
+}
+
+//-----------------------------------------------------------------------------
+inline void blendPixel (const uint8_t* s, uint8_t* d, uint32_t alphaIndex, uint32_t alpha)
+{
+	uint8_t src[4];
+	for (uint32_t i = 0; i < 4; ++i)
+		src[i] = static_cast<uint8_t> (alpha == 255 ? s[i] : mulDiv255 (s[i], alpha));
+	uint32_t inverseAlpha = 255 - src[alphaIndex];
+	for (uint32_t i = 0; i < 4; ++i)
+		d[i] = static_cast<uint8_t> (std::min<uint32_t> (255, src[i] + mulDiv255 (d[i], inverseAlpha)));
+}
+
+#if VSTGUI_SIMD_SSE2
+//-----------------------------------------------------------------------------
+/** a * b / 255 rounded for 16 bit lanes */
+inline __m128i mulDiv255 (__m128i a, __m128i b)
+{
+	__m128i t = _mm_add_epi16 (_mm_mullo_epi16 (a, b), _mm_set1_epi16 (128));
+	return _mm_srli_epi16 (_mm_add_epi16 (t, _mm_srli_epi16 (t, 8)), 8);
+}
+
+//-----------------------------------------------------------------------------
+/** broadcast the alpha value of the two pixels in 16 bit lanes to all lanes of the pixel */
+template<int alphaIndex>
+inline __m128i broadcastAlpha (__m128i pixels)
+{
+	return _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (pixels, _MM_SHUFFLE (alphaIndex, alphaIndex, alphaIndex, alphaIndex)), _MM_SHUFFLE (alphaIndex, alphaIndex, alphaIndex, alphaIndex));
+}
+
+//-----------------------------------------------------------------------------
+template<int alphaIndex>
+uint32_t premultiplySSE2 (const uint32_t* src, uint32_t* dst, uint32_t count)
+{
+	const __m128i zero = _mm_setzero_si128 ();
+	const __m128i alphaMask = _mm_set1_epi32 (static_cast<int> (0xFFu << (alphaIndex * 8)));
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pixels = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		__m128i lo = _mm_unpacklo_epi8 (pixels, zero);
+		__m128i hi = _mm_unpackhi_epi8 (pixels, zero);
+		lo = mulDiv255 (lo, broadcastAlpha<alphaIndex> (lo));
+		hi = mulDiv255 (hi, broadcastAlpha<alphaIndex> (hi));
+		__m128i result = _mm_packus_epi16 (lo, hi);
+		result = _mm_or_si128 (_mm_and_si128 (pixels, alphaMask), _mm_andnot_si128 (alphaMask, result));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), result);
+	}
+	return x;
+}
+
+//-----------------------------------------------------------------------------
+template<int alphaIndex>
+inline __m128i unpremultiplyPixel (__m128i pixel)
+{
+	// the division is exact in float for all possible values, so the result matches unpremultiplyPixel
+	__m128i alpha = _mm_shuffle_epi32 (pixel, _MM_SHUFFLE (alphaIndex, alphaIndex, alphaIndex, alphaIndex));
+	__m128i n = _mm_add_epi32 (_mm_sub_epi32 (_mm_slli_epi32 (pixel, 8), pixel), _mm_srli_epi32 (alpha, 1));
+	__m128 divisor = _mm_max_ps (_mm_cvtepi32_ps (alpha), _mm_set1_ps (1.f));
+	return _mm_cvttps_epi32 (_mm_div_ps (_mm_cvtepi32_ps (n), divisor));
+}
+
+//-----------------------------------------------------------------------------
+template<int alphaIndex>
+uint32_t unpremultiplySSE2 (const uint32_t* src, uint32_t* dst, uint32_t count)
+{
+	const __m128i zero = _mm_setzero_si128 ();
+	const __m128i alphaMask = _mm_set1_epi32 (static_cast<int> (0xFFu << (alphaIndex * 8)));
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pixels = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		__m128i lo = _mm_unpacklo_epi8 (pixels, zero);
+		__m128i hi = _mm_unpackhi_epi8 (pixels, zero);
+		__m128i p0 = unpremultiplyPixel<alphaIndex> (_mm_unpacklo_epi16 (lo, zero));
+		__m128i p1 = unpremultiplyPixel<alphaIndex> (_mm_unpackhi_epi16 (lo, zero));
+		__m128i p2 = unpremultiplyPixel<alphaIndex> (_mm_unpacklo_epi16 (hi, zero));
+		__m128i p3 = unpremultiplyPixel<alphaIndex> (_mm_unpackhi_epi16 (hi, zero));
+		__m128i result = _mm_packus_epi16 (_mm_packs_epi32 (p0, p1), _mm_packs_epi32 (p2, p3));
+		// keep the alpha value and pixels with an alpha value of zero
+		__m128i keep = _mm_or_si128 (alphaMask, _mm_cmpeq_epi32 (_mm_and_si128 (pixels, alphaMask), zero));
+		result = _mm_or_si128 (_mm_and_si128 (pixels, keep), _mm_andnot_si128 (keep, result));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), result);
+	}
+	return x;
+}
+
+//-----------------------------------------------------------------------------
+template<int alphaIndex>
+uint32_t blendSSE2 (const uint32_t* src, uint32_t* dst, uint32_t count, uint8_t alpha)
+{
+	const __m128i zero = _mm_setzero_si128 ();
+	const __m128i globalAlpha = _mm_set1_epi16 (alpha);
+	const __m128i max = _mm_set1_epi16 (255);
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i s = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		__m128i d = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (dst + x));
+		__m128i slo = _mm_unpacklo_epi8 (s, zero);
+		__m128i shi = _mm_unpackhi_epi8 (s, zero);
+		if (alpha != 255)
+		{
+			slo = mulDiv255 (slo, globalAlpha);
+			shi = mulDiv255 (shi, globalAlpha);
+		}
+		__m128i dlo = mulDiv255 (_mm_unpacklo_epi8 (d, zero), _mm_sub_epi16 (max, broadcastAlpha<alphaIndex> (slo)));
+		__m128i dhi = mulDiv255 (_mm_unpackhi_epi8 (d, zero), _mm_sub_epi16 (max, broadcastAlpha<alphaIndex> (shi)));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), _mm_packus_epi16 (_mm_add_epi16 (slo, dlo), _mm_add_epi16 (shi, dhi)));
+	}
+	return x;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t convertSSE2 (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& srcOrder, const ChannelOrder& dstOrder)
+{
+	const uint8_t* srcIndex = &srcOrder.red;
+	const uint8_t* dstIndex = &dstOrder.red;
+	const __m128i byteMask = _mm_set1_epi32 (0xFF);
+	__m128i srcShift[4];
+	__m128i dstShift[4];
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		srcShift[i] = _mm_cvtsi32_si128 (srcIndex[i] * 8);
+		dstShift[i] = _mm_cvtsi32_si128 (dstIndex[i] * 8);
+	}
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pixels = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (src + x));
+		__m128i result = _mm_setzero_si128 ();
+		for (uint32_t i = 0; i < 4; ++i)
+			result = _mm_or_si128 (result, _mm_sll_epi32 (_mm_and_si128 (_mm_srl_epi32 (pixels, srcShift[i]), byteMask), dstShift[i]));
+		_mm_storeu_si128 (reinterpret_cast<__m128i*> (dst + x), result);
+	}
+	return x;
+}
+
+#elif VSTGUI_SIMD_NEON
+//-----------------------------------------------------------------------------
+/** a * b / 255 rounded */
+inline uint8x8_t mulDiv255 (uint8x8_t a, uint8x8_t b)
+{
+	uint16x8_t t = vmull_u8 (a, b);
+	return vraddhn_u16 (t, vrshrq_n_u16 (t, 8));
+}
+
+//-----------------------------------------------------------------------------
+uint32_t premultiplyNEON (const uint32_t* src, uint32_t* dst, uint32_t count, uint32_t alphaIndex)
+{
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		uint8x8x4_t pixels = vld4_u8 (reinterpret_cast<const uint8_t*> (src + x));
+		uint8x8_t alpha = pixels.val[alphaIndex];
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i != alphaIndex)
+				pixels.val[i] = mulDiv255 (pixels.val[i], alpha);
+		}
+		vst4_u8 (reinterpret_cast<uint8_t*> (dst + x), pixels);
+	}
+	return x;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t blendNEON (const uint32_t* src, uint32_t* dst, uint32_t count, uint32_t alphaIndex, uint8_t alpha)
+{
+	const uint8x8_t globalAlpha = vdup_n_u8 (alpha);
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		uint8x8x4_t s = vld4_u8 (reinterpret_cast<const uint8_t*> (src + x));
+		uint8x8x4_t d = vld4_u8 (reinterpret_cast<const uint8_t*> (dst + x));
+		if (alpha != 255)
+		{
+			for (uint32_t i = 0; i < 4; ++i)
+				s.val[i] = mulDiv255 (s.val[i], globalAlpha);
+		}
+		uint8x8_t inverseAlpha = vmvn_u8 (s.val[alphaIndex]);
+		for (uint32_t i = 0; i < 4; ++i)
+			d.val[i] = vqadd_u8 (s.val[i], mulDiv255 (d.val[i], inverseAlpha));
+		vst4_u8 (reinterpret_cast<uint8_t*> (dst + x), d);
+	}
+	return x;
+}
+
+//-----------------------------------------------------------------------------
+uint32_t convertNEON (const uint32_t* src, uint32_t* dst, uint32_t count, const ChannelOrder& srcOrder, const ChannelOrder& dstOrder)
+{
+	const uint8_t* srcIndex = &srcOrder.red;
+	const uint8_t* dstIndex = &dstOrder.red;
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		uint8x8x4_t pixels = vld4_u8 (reinterpret_cast<const uint8_t*> (src + x));
+		uint8x8x4_t result;
+		for (uint32_t i = 0; i < 4; ++i)
+			result.val[dstIndex[i]] = pixels.val[srcIndex[i]];
+		vst4_u8 (reinterpret_cast<uint8_t*> (dst + x), result);
+	}
+	return x;
+}
+#endif
+
+} // anonymous
+/// @endcond
+
+//-----------------------------------------------------------------------------
+uint32_t makePixel (const CColor& color, Format format)
+{
+	const ChannelOrder& order = getChannelOrder (format);
+	uint8_t bytes[4];
+	bytes[order.red] = color.red;
+	bytes[order.green] = color.green;
+	bytes[order.blue] = color.blue;
+	bytes[order.alpha] = color.alpha;
+	uint32_t pixel;
+	memcpy (&pixel, bytes, sizeof (pixel));
+	return pixel;
+}
+
+//-----------------------------------------------------------------------------
+CColor getColor (uint32_t pixel, Format format)
+{
+	const ChannelOrder& order = getChannelOrder (format);
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*> (&pixel);
+	return CColor (bytes[order.red], bytes[order.green], bytes[order.blue], bytes[order.alpha]);
+}
+
+//-----------------------------------------------------------------------------
+void fill (uint32_t* dst, uint32_t count, uint32_t pixel)
+{
+	std::fill (dst, dst + count, pixel);
+}
+
+//-----------------------------------------------------------------------------
+void copy (const uint32_t* src, uint32_t* dst, uint32_t count)
+{
+	if (src != dst)
+		memmove (dst, src, count * sizeof (uint32_t));
+}
+
+//-----------------------------------------------------------------------------
+void convert (const uint32_t* src, uint32_t* dst, uint32_t count, Format srcFormat, Format dstFormat)
+{
+	if (srcFormat == dstFormat)
+	{
+		copy (src, dst, count);
+		return;
+	}
+	const ChannelOrder& srcOrder = getChannelOrder (srcFormat);
+	const ChannelOrder& dstOrder = getChannelOrder (dstFormat);
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	x = convertSSE2 (src, dst, count, srcOrder, dstOrder);
+#elif VSTGUI_SIMD_NEON
+	x = convertNEON (src, dst, count, srcOrder, dstOrder);
+#endif
+	for (; x < count; ++x)
+	{
+		uint8_t s[4];
+		uint8_t d[4];
+		memcpy (s, src + x, 4);
+		d[dstOrder.red] = s[srcOrder.red];
+		d[dstOrder.green] = s[srcOrder.green];
+		d[dstOrder.blue] = s[srcOrder.blue];
+		d[dstOrder.alpha] = s[srcOrder.alpha];
+		memcpy (dst + x, d, 4);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void premultiply (const uint32_t* src, uint32_t* dst, uint32_t count, Format format)
+{
+	uint32_t alphaIndex = getChannelOrder (format).alpha;
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	x = alphaIndex == 0 ? premultiplySSE2<0> (src, dst, count) : premultiplySSE2<3> (src, dst, count);
+#elif VSTGUI_SIMD_NEON
+	x = premultiplyNEON (src, dst, count, alphaIndex);
+#endif
+	for (; x < count; ++x)
+		premultiplyPixel (reinterpret_cast<const uint8_t*> (src + x), reinterpret_cast<uint8_t*> (dst + x), alphaIndex);
+}
+
+//-----------------------------------------------------------------------------
+void unpremultiply (const uint32_t* src, uint32_t* dst, uint32_t count, Format format)
+{
+	uint32_t alphaIndex = getChannelOrder (format).alpha;
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	x = alphaIndex == 0 ? unpremultiplySSE2<0> (src, dst, count) : unpremultiplySSE2<3> (src, dst, count);
+#endif
+	for (; x < count; ++x)
+		unpremultiplyPixel (reinterpret_cast<const uint8_t*> (src + x), reinterpret_cast<uint8_t*> (dst + x), alphaIndex);
+}
+
+//-----------------------------------------------------------------------------
+void blend (const uint32_t* src, uint32_t* dst, uint32_t count, Format format, uint8_t alpha)
+{
+	if (alpha == 0)
+		return;
+	uint32_t alphaIndex = getChannelOrder (format).alpha;
+	uint32_t x = 0;
+#if VSTGUI_SIMD_SSE2
+	x = alphaIndex == 0 ? blendSSE2<0> (src, dst, count, alpha) : blendSSE2<3> (src, dst, count, alpha);
+#elif VSTGUI_SIMD_NEON
+	x = blendNEON (src, dst, count, alphaIndex, alpha);
+#endif
+	for (; x < count; ++x)
+		blendPixel (reinterpret_cast<const uint8_t*> (src + x), reinterpret_cast<uint8_t*> (dst + x), alphaIndex, alpha);
+}
+
+} // namespace PixelSpan
+} // namespace VSTGUI
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#ifndef __cpixelspan__
+#define __cpixelspan__
+
+#include "vstguifwd.h"
+
+namespace VSTGUI {
+
+//-----------------------------------------------------------------------------
+/** @brief Functions working on spans of 32 bit pixels
+	@ingroup new_in_4_3
+
+	A span is a row (or a part of a row) as returned by CBitmapPixelAccess::getRow. All functions process
+	count pixels and use SSE2 or NEON instructions where available. Source and destination may be the same
+	span, but must not overlap otherwise (except for copy).
+*/
+//-----------------------------------------------------------------------------
+namespace PixelSpan {
+
+/** byte order of the color components of a pixel in memory */
+enum Format {
+	kARGB,
+	kRGBA,
+	kABGR,
+	kBGRA
+};
+
+/** create a pixel value from a color */
+uint32_t makePixel (const CColor& color, Format format);
+/** get the color of a pixel value */
+CColor getColor (uint32_t pixel, Format format);
+
+/** set all pixels to the same value */
+void fill (uint32_t* dst, uint32_t count, uint32_t pixel);
+/** copy pixels, the spans may overlap */
+void copy (const uint32_t* src, uint32_t* dst, uint32_t count);
+/** convert pixels from one format to another */
+void convert (const uint32_t* src, uint32_t* dst, uint32_t count, Format srcFormat, Format dstFormat);
+
+/** multiply the color components with the alpha value (rounded) */
+void premultiply (const uint32_t* src, uint32_t* dst, uint32_t count, Format format);
+/** divide the color components by the alpha value (rounded), pixels with an alpha value of zero are copied unchanged */
+void unpremultiply (const uint32_t* src, uint32_t* dst, uint32_t count, Format format);
+
+/** draw the src pixels over the dst pixels (source over), both premultiplied. alpha is an additional global alpha value for src */
+void blend (const uint32_t* src, uint32_t* dst, uint32_t count, Format format, uint8_t alpha = 255);
+
+} // namespace PixelSpan
+
+} // namespace VSTGUI
+
+#endif // __cpixelspan__
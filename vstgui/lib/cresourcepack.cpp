@@ -0,0 +1,398 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "cresourcepack.h"
+#include "cbitmapcodec.h"
+#include "platform/iplatformbitmap.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if WINDOWS
+	#include "platform/win32/win32support.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace VSTGUI {
+
+/// @cond ignore
+namespace CResourcePackPrivate {
+
+enum {
+	kVersion = 1,
+	kHeaderSize = 16,
+	kRecordSize = 20,
+	kDataAlignment = 16
+};
+
+static const uint8_t kMagic[4] = {'V', 'G', 'R', 'P'};
+static const uint8_t kPNGSignature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+//-----------------------------------------------------------------------------
+inline uint32_t read32 (const uint8_t* p)
+{
+	return static_cast<uint32_t> (p[0]) | (static_cast<uint32_t> (p[1]) << 8) | (static_cast<uint32_t> (p[2]) << 16) | (static_cast<uint32_t> (p[3]) << 24);
+}
+
+//-----------------------------------------------------------------------------
+inline void write32 (std::vector<uint8_t>& output, uint32_t value)
+{
+	output.push_back (static_cast<uint8_t> (value));
+	output.push_back (static_cast<uint8_t> (value >> 8));
+	output.push_back (static_cast<uint8_t> (value >> 16));
+	output.push_back (static_cast<uint8_t> (value >> 24));
+}
+
+//-----------------------------------------------------------------------------
+inline uint32_t align (uint32_t value)
+{
+	return (value + kDataAlignment - 1) & ~static_cast<uint32_t> (kDataAlignment - 1);
+}
+
+//-----------------------------------------------------------------------------
+static double decodeScaleFactorFromName (const std::string& name)
+{
+	size_t start = name.find_last_of ('#');
+	if (start == std::string::npos)
+		return 1.;
+	size_t end = name.find ('x', start);
+	if (end == std::string::npos || end == start + 1)
+		return 1.;
+	double scaleFactor = std::strtod (name.substr (start + 1, end - start - 1).c_str (), 0);
+	return scaleFactor > 0. ? scaleFactor : 1.;
+}
+
+//-----------------------------------------------------------------------------
+static bool readFile (UTF8StringPtr path, std::vector<uint8_t>& data)
+{
+	FILE* file = fopen (path, "rb");
+	if (file == 0)
+		return false;
+	bool result = false;
+	if (fseek (file, 0, SEEK_END) == 0)
+	{
+		long size = ftell (file);
+		if (size >= 0 && fseek (file, 0, SEEK_SET) == 0)
+		{
+			data.resize (static_cast<size_t> (size));
+			result = size == 0 || fread (&data[0], 1, data.size (), file) == data.size ();
+		}
+	}
+	fclose (file);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+struct EntryNameLess
+{
+	bool operator() (const CResourcePack::Entry& entry, UTF8StringPtr name) const { return std::strcmp (entry.name, name) < 0; }
+};
+
+} // CResourcePackPrivate
+/// @endcond
+
+//-----------------------------------------------------------------------------
+CResourcePack::CResourcePack ()
+: mappedData (0)
+, mappedSize (0)
+#if WINDOWS
+, mappingHandle (0)
+#endif
+{
+}
+
+//-----------------------------------------------------------------------------
+CResourcePack::~CResourcePack ()
+{
+	unmap ();
+}
+
+//-----------------------------------------------------------------------------
+void CResourcePack::unmap ()
+{
+	if (mappedData == 0)
+		return;
+#if WINDOWS
+	UnmapViewOfFile (mappedData);
+	CloseHandle (mappingHandle);
+	mappingHandle = 0;
+#else
+	munmap (mappedData, mappedSize);
+#endif
+	mappedData = 0;
+	mappedSize = 0;
+}
+
+//-----------------------------------------------------------------------------
+CResourcePack* CResourcePack::open (UTF8StringPtr path)
+{
+	CResourcePack* pack = new CResourcePack ();
+#if WINDOWS
+	UTF8StringHelper widePath (path);
+	HANDLE file = CreateFileW (widePath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx (file, &fileSize) && fileSize.QuadPart > 0 && fileSize.QuadPart <= 0xFFFFFFFF)
+		{
+			HANDLE mapping = CreateFileMappingW (file, 0, PAGE_READONLY, 0, 0, 0);
+			if (mapping)
+			{
+				pack->mappedData = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+				if (pack->mappedData)
+				{
+					pack->mappingHandle = mapping;
+					pack->mappedSize = static_cast<uint32_t> (fileSize.QuadPart);
+				}
+				else
+					CloseHandle (mapping);
+			}
+		}
+		CloseHandle (file);
+	}
+#else
+	int file = ::open (path, O_RDONLY);
+	if (file >= 0)
+	{
+		struct stat fileStat;
+		if (fstat (file, &fileStat) == 0 && fileStat.st_size > 0 && static_cast<uint64_t> (fileStat.st_size) <= 0xFFFFFFFF)
+		{
+			void* data = mmap (0, static_cast<size_t> (fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if (data != MAP_FAILED)
+			{
+				pack->mappedData = data;
+				pack->mappedSize = static_cast<uint32_t> (fileStat.st_size);
+			}
+		}
+		close (file);
+	}
+#endif
+	if (pack->mappedData == 0 || !pack->setData (pack->mappedData, pack->mappedSize))
+	{
+		pack->forget ();
+		return 0;
+	}
+	return pack;
+}
+
+//-----------------------------------------------------------------------------
+CResourcePack* CResourcePack::openFromMemory (const void* data, uint32_t size)
+{
+	CResourcePack* pack = new CResourcePack ();
+	if (!pack->setData (data, size))
+	{
+		pack->forget ();
+		return 0;
+	}
+	return pack;
+}
+
+//-----------------------------------------------------------------------------
+bool CResourcePack::setData (const void* data, uint32_t size)
+{
+	using namespace CResourcePackPrivate;
+	const uint8_t* bytes = static_cast<const uint8_t*> (data);
+	if (data == 0 || size < kHeaderSize || std::memcmp (bytes, kMagic, 4) != 0 || read32 (bytes + 4) != kVersion)
+		return false;
+	uint32_t numEntries = read32 (bytes + 8);
+	uint32_t indexEnd = read32 (bytes + 12);
+	if (indexEnd > size || indexEnd < kHeaderSize || numEntries > (indexEnd - kHeaderSize) / kRecordSize)
+		return false;
+	entries.reserve (numEntries);
+	const uint8_t* record = bytes + kHeaderSize;
+	const uint8_t* recordsEnd = bytes + indexEnd;
+	for (uint32_t i = 0; i < numEntries; i++)
+	{
+		if (recordsEnd - record < kRecordSize)
+			return false;
+		uint32_t offset = read32 (record);
+		uint32_t entrySize = read32 (record + 4);
+		uint32_t codec = read32 (record + 8);
+		uint32_t scaleFactor = read32 (record + 12);
+		uint32_t nameLength = read32 (record + 16);
+		record += kRecordSize;
+		if (nameLength == 0 || nameLength > static_cast<uint32_t> (recordsEnd - record) || record[nameLength - 1] != 0)
+			return false;
+		if (offset < indexEnd || offset > size || entrySize > size - offset || codec > kCodecXML || scaleFactor == 0)
+			return false;
+		Entry entry;
+		entry.name = reinterpret_cast<UTF8StringPtr> (record);
+		entry.data = bytes + offset;
+		entry.size = entrySize;
+		entry.codec = static_cast<Codec> (codec);
+		entry.scaleFactor = scaleFactor / 1000.;
+		if (!entries.empty () && std::strcmp (entries.back ().name, entry.name) >= 0)
+			return false; // find needs the entries sorted and unique
+		entries.push_back (entry);
+		record += nameLength;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+const CResourcePack::Entry* CResourcePack::find (UTF8StringPtr name) const
+{
+	if (name == 0)
+		return 0;
+	std::vector<Entry>::const_iterator it = std::lower_bound (entries.begin (), entries.end (), name, CResourcePackPrivate::EntryNameLess ());
+	if (it != entries.end () && std::strcmp (it->name, name) == 0)
+		return &(*it);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+IPlatformBitmap* CResourcePack::createBitmap (UTF8StringPtr name) const
+{
+	const Entry* entry = find (name);
+	if (entry == 0 || entry->codec == kCodecXML)
+		return 0;
+	IPlatformBitmap* bitmap = BitmapCodec::createFromMemory (entry->data, entry->size);
+	if (bitmap && entry->scaleFactor != 1.)
+		bitmap->setScaleFactor (entry->scaleFactor);
+	return bitmap;
+}
+
+//-----------------------------------------------------------------------------
+CResourcePack::Codec CResourcePack::detectCodec (const void* data, uint32_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*> (data);
+	if (BitmapCodec::isQOI (data, size))
+		return kCodecQOI;
+	if (size >= 8 && std::memcmp (bytes, CResourcePackPrivate::kPNGSignature, 8) == 0)
+		return kCodecPNG;
+	if (size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+	{
+		bytes += 3;
+		size -= 3;
+	}
+	if (size >= 5 && std::memcmp (bytes, "<?xml", 5) == 0)
+		return kCodecXML;
+	return kCodecData;
+}
+
+//-----------------------------------------------------------------------------
+void CResourcePack::Writer::add (UTF8StringPtr name, const void* data, uint32_t size, Codec codec, double scaleFactor)
+{
+	WriterEntry entry;
+	entry.name = name;
+	if (size)
+		entry.data.assign (static_cast<const uint8_t*> (data), static_cast<const uint8_t*> (data) + size);
+	entry.codec = codec;
+	entry.scaleFactor = scaleFactor > 0. ? scaleFactor : CResourcePackPrivate::decodeScaleFactorFromName (entry.name);
+	entries.push_back (entry);
+}
+
+//-----------------------------------------------------------------------------
+void CResourcePack::Writer::add (UTF8StringPtr name, const void* data, uint32_t size)
+{
+	add (name, data, size, detectCodec (data, size));
+}
+
+//-----------------------------------------------------------------------------
+bool CResourcePack::Writer::addFile (UTF8StringPtr name, UTF8StringPtr path)
+{
+	std::vector<uint8_t> data;
+	if (!CResourcePackPrivate::readFile (path, data) || data.size () > 0xFFFFFFFF)
+		return false;
+	const uint8_t* ptr = data.empty () ? 0 : &data[0];
+	add (name, ptr, static_cast<uint32_t> (data.size ()));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool CResourcePack::Writer::write (std::vector<uint8_t>& output) const
+{
+	using namespace CResourcePackPrivate;
+	std::vector<WriterEntry> sorted (entries);
+	std::sort (sorted.begin (), sorted.end ());
+	uint64_t indexEnd = kHeaderSize;
+	for (size_t i = 0; i < sorted.size (); i++)
+	{
+		if (i > 0 && sorted[i].name == sorted[i - 1].name)
+			return false;
+		indexEnd += kRecordSize + sorted[i].name.size () + 1;
+	}
+	uint64_t dataEnd = indexEnd;
+	for (size_t i = 0; i < sorted.size (); i++)
+		dataEnd = ((dataEnd + kDataAlignment - 1) & ~static_cast<uint64_t> (kDataAlignment - 1)) + sorted[i].data.size ();
+	if (dataEnd > 0xFFFFFFFF)
+		return false;
+
+	output.clear ();
+	output.reserve (static_cast<size_t> (dataEnd));
+	output.insert (output.end (), kMagic, kMagic + 4);
+	write32 (output, kVersion);
+	write32 (output, static_cast<uint32_t> (sorted.size ()));
+	write32 (output, static_cast<uint32_t> (indexEnd));
+	uint32_t offset = static_cast<uint32_t> (indexEnd);
+	for (size_t i = 0; i < sorted.size (); i++)
+	{
+		const WriterEntry& entry = sorted[i];
+		offset = align (offset);
+		write32 (output, offset);
+		write32 (output, static_cast<uint32_t> (entry.data.size ()));
+		write32 (output, static_cast<uint32_t> (entry.codec));
+		write32 (output, std::max<uint32_t> (1, static_cast<uint32_t> (entry.scaleFactor * 1000. + 0.5)));
+		write32 (output, static_cast<uint32_t> (entry.name.size () + 1));
+		output.insert (output.end (), entry.name.begin (), entry.name.end ());
+		output.push_back (0);
+		offset += static_cast<uint32_t> (entry.data.size ());
+	}
+	for (size_t i = 0; i < sorted.size (); i++)
+	{
+		output.resize (align (static_cast<uint32_t> (output.size ())), 0);
+		output.insert (output.end (), sorted[i].data.begin (), sorted[i].data.end ());
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool CResourcePack::Writer::write (UTF8StringPtr path) const
+{
+	std::vector<uint8_t> output;
+	if (!write (output))
+		return false;
+	FILE* file = fopen (path, "wb");
+	if (file == 0)
+		return false;
+	bool result = fwrite (&output[0], 1, output.size (), file) == output.size ();
+	return fclose (file) == 0 && result;
+}
+
+} // namespace VSTGUI
@@ -0,0 +1,155 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#ifndef __cresourcepack__
+#define __cresourcepack__
+
+#include "vstguibase.h"
+#include <string>
+#include <vector>
+
+namespace VSTGUI {
+class IPlatformBitmap;
+
+//-----------------------------------------------------------------------------
+/** @brief A read-only pack of resources which is memory mapped
+	@ingroup new_in_4_3
+
+	A resource pack is a single file which contains the bitmaps and UIDescription files of a plug-in.
+	An index at the beginning of the file maps the resource names to the location of their data, so that opening a
+	pack needs only one file open and one memory mapping and no further file access. The data of the resources
+	is not copied, the entries point directly into the mapped file.
+
+	Packs are created with CResourcePack::Writer or the resourcepacker command line tool in the tools folder.
+
+	@code
+	SharedPointer<CResourcePack> pack = owned (CResourcePack::open ("/path/to/resources.vgrp"));
+	UIDescription* description = new UIDescription ("editor.uidesc");
+	description->setResourcePack (pack);
+	description->parse ();
+	@endcode
+
+	File format (all numbers little endian):
+	- header: "VGRP", uint32 version, uint32 number of entries, uint32 size of the index
+	- one index record per entry sorted by name: uint32 offset, uint32 size, uint32 codec, uint32 scale factor in
+	  thousandths, uint32 name length followed by the name including the terminating zero
+	- the data of the entries, each aligned to 16 bytes
+*/
+//-----------------------------------------------------------------------------
+class CResourcePack : public CBaseObject
+{
+public:
+	enum Codec {
+		kCodecData = 0,	///< any data
+		kCodecPNG,		///< PNG image, decoded by the platform
+		kCodecQOI,		///< QOI image, see BitmapCodec
+		kCodecXML		///< XML file, for example a UIDescription
+	};
+
+	struct Entry
+	{
+		UTF8StringPtr name;		///< zero terminated name inside the mapped data
+		const void* data;		///< data inside the mapped data
+		uint32_t size;
+		Codec codec;
+		double scaleFactor;
+	};
+
+	/** open and map a pack file, returns 0 if the file is no valid pack */
+	static CResourcePack* open (UTF8StringPtr path);
+	/** use a pack in memory, for example a resource linked into the binary. The memory must be valid as long as the pack is used */
+	static CResourcePack* openFromMemory (const void* data, uint32_t size);
+
+	uint32_t getNumEntries () const { return static_cast<uint32_t> (entries.size ()); }
+	const Entry& getEntry (uint32_t index) const { return entries[index]; }
+	/** find the entry with the name, returns 0 if the pack has none */
+	const Entry* find (UTF8StringPtr name) const;
+
+	/** create a platform bitmap from the entry with the name, the scale factor of the entry is set on the bitmap */
+	IPlatformBitmap* createBitmap (UTF8StringPtr name) const;
+
+	/** the codec of data, detected from its signature */
+	static Codec detectCodec (const void* data, uint32_t size);
+
+	//-----------------------------------------------------------------------------
+	/** @brief Creates resource packs */
+	//-----------------------------------------------------------------------------
+	class Writer
+	{
+	public:
+		/** add an entry with a copy of the data. The scale factor is decoded from a "#2x" suffix in the name if it's 0 */
+		void add (UTF8StringPtr name, const void* data, uint32_t size, Codec codec, double scaleFactor = 0.);
+		/** add an entry with the codec detected from the data */
+		void add (UTF8StringPtr name, const void* data, uint32_t size);
+		/** add an entry with the contents of a file */
+		bool addFile (UTF8StringPtr name, UTF8StringPtr path);
+
+		uint32_t getNumEntries () const { return static_cast<uint32_t> (entries.size ()); }
+
+		/** create the pack in memory, returns false if a name is used twice or the pack is larger than 4 GB */
+		bool write (std::vector<uint8_t>& output) const;
+		/** create the pack file */
+		bool write (UTF8StringPtr path) const;
+	protected:
+		struct WriterEntry
+		{
+			std::string name;
+			std::vector<uint8_t> data;
+			Codec codec;
+			double scaleFactor;
+
+			bool operator< (const WriterEntry& other) const { return name < other.name; }
+		};
+		std::vector<WriterEntry> entries;
+	};
+
+	~CResourcePack ();
+
+	CLASS_METHODS_NOCOPY(CResourcePack, CBaseObject)
+protected:
+	CResourcePack ();
+	bool setData (const void* data, uint32_t size);
+	void unmap ();
+
+	std::vector<Entry> entries;
+	void* mappedData;
+	uint32_t mappedSize;
+#if WINDOWS
+	void* mappingHandle;
+#endif
+};
+
+} // namespace VSTGUI
+
+#endif // __cresourcepack__
@@ -192,29 +192,20 @@ void CShadowViewContainer::drawRect (CDrawContext* pContext, const CRect& update
 			if (bitmap)
 			{
 				setBackground (bitmap);
-				SharedPointer<BitmapFilter::IFilter> setColorFilter = owned (BitmapFilter::Factory::getInstance ().createFilter (BitmapFilter::Standard::kSetColor));
+				BitmapFilter::Pipeline pipeline;
+				BitmapFilter::IFilter* setColorFilter = pipeline.addFilter (BitmapFilter::Standard::kSetColor);
 				if (setColorFilter)
 				{
-					setColorFilter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, bitmap);
 					setColorFilter->setProperty (BitmapFilter::Standard::Property::kInputColor, kBlackCColor);
 					setColorFilter->setProperty (BitmapFilter::Standard::Property::kIgnoreAlphaColorValue, (int32_t)1);
-					if (setColorFilter->run (true))
+					std::vector<int32_t> boxSizes = boxesForGauss (shadowBlurSize, 3);
+					for (std::vector<int32_t>::const_iterator it = boxSizes.begin (), end = boxSizes.end (); it != end; ++it)
 					{
-						SharedPointer<BitmapFilter::IFilter> boxBlurFilter = owned (BitmapFilter::Factory::getInstance ().createFilter (BitmapFilter::Standard::kBoxBlur));
+						BitmapFilter::IFilter* boxBlurFilter = pipeline.addFilter (BitmapFilter::Standard::kBoxBlur);
 						if (boxBlurFilter)
-						{
-							std::vector<int32_t> boxSizes = boxesForGauss (shadowBlurSize, 3);
-							boxBlurFilter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, bitmap);
-							boxBlurFilter->setProperty (BitmapFilter::Standard::Property::kRadius, boxSizes[0]);
-							if (boxBlurFilter->run (true))
-							{
-								boxBlurFilter->setProperty (BitmapFilter::Standard::Property::kRadius, boxSizes[1]);
-								boxBlurFilter->run (true);
-								boxBlurFilter->setProperty (BitmapFilter::Standard::Property::kRadius, boxSizes[2]);
-								boxBlurFilter->run (true);
-							}
-						}
+							boxBlurFilter->setProperty (BitmapFilter::Standard::Property::kRadius, *it);
 					}
+					pipeline.run (bitmap, true);
 				}
 
 				CViewContainer::drawRect (pContext, updateRect);
@@ -317,12 +317,16 @@ CView::CView (const CView& v)
 , pParentFrame (0)
 , pParentView (0)
 , pBackground (v.pBackground)
-, viewFlags (v.viewFlags)
+, viewFlags (v.viewFlags & ~(kIsAttached | kIsSubview))
 , autosizeFlags (v.autosizeFlags)
 , alphaValue (v.alphaValue)
 {
-	for (ViewAttributes::iterator it = attributes.begin (); it != attributes.end (); it++)
-		setAttribute (it->first, it->second->getSize (), it->second->getData ());
+	for (ViewAttributes::const_iterator it = v.attributes.begin (); it != v.attributes.end (); it++)
+	{
+		// the controller is owned by the original view
+		if (it->first != kCViewControllerAttribute)
+			setAttribute (it->first, it->second->getSize (), it->second->getData ());
+	}
 }
 
 //-----------------------------------------------------------------------------
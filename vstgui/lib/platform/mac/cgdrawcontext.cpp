@@ -594,7 +594,7 @@ void CGDrawContext::fillRectWithBitmap (CBitmap* bitmap, const CRect& srcRect, c
 	if (bitmap == 0 || alpha == 0.f || srcRect.isEmpty () || dstRect.isEmpty ())
 		return;
 
-	if (!(srcRect.left == 0 && srcRect.right == 0 && srcRect.right == bitmap->getWidth () && srcRect.bottom == bitmap->getHeight ()))
+	if (bitmap->getAtlas () || !(srcRect.left == 0 && srcRect.right == 0 && srcRect.right == bitmap->getWidth () && srcRect.bottom == bitmap->getHeight ()))
 	{
 		// CGContextDrawTiledImage does not work with parts of a bitmap
 		CDrawContext::fillRectWithBitmap(bitmap, srcRect, dstRect, alpha);
@@ -635,6 +635,8 @@ void CGDrawContext::drawBitmap (CBitmap* bitmap, const CRect& inRect, const CPoi
 {
 	if (bitmap == 0 || alpha == 0.f)
 		return;
+	if (drawBitmapFromAtlas (bitmap, inRect, inOffset, alpha))
+		return;
 	double transformedScaleFactor = scaleFactor;
 	CGraphicsTransform t = getCurrentTransform ();
 	if (t.m11 == t.m22 && t.m12 == 0 && t.m21 == 0)
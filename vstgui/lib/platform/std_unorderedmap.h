@@ -41,18 +41,18 @@
 		#include <unordered_map>
 	#else
 		#include <tr1/unordered_map>
-		namespace std { using tr1::unordered_map; }
+		namespace std { using tr1::unordered_map; using tr1::unordered_multimap; }
 	#endif
 #elif defined (__GNUC__)
 	#if __cplusplus >= 201103L
 		#include <unordered_map>
 	#else
 		#include <tr1/unordered_map>
-		namespace std { using tr1::unordered_map; }
+		namespace std { using tr1::unordered_map; using tr1::unordered_multimap; }
 	#endif
 #elif WINDOWS
 	#include <unordered_map>
 	#if _MSC_VER <	1600
-		namespace std { using tr1::unordered_map; }
+		namespace std { using tr1::unordered_map; using tr1::unordered_multimap; }
 	#endif
 #endif
@@ -37,6 +37,7 @@
 #if WINDOWS && VSTGUI_DIRECT2D_SUPPORT
 
 #include "../win32support.h"
+#include "../../../cpixelspan.h"
 #include <wincodec.h>
 #include <d2d1.h>
 #include <shlwapi.h>
@@ -350,18 +351,7 @@ void D2DBitmap::PixelAccess::premultiplyAlpha (BYTE* ptr, UINT bytesPerRow, cons
 	for (int32_t y = 0; y < (int32_t)size.y; y++, ptr += bytesPerRow)
 	{
 		uint32_t* pixelPtr = (uint32_t*)ptr;
-		for (int32_t x = 0; x < (int32_t)size.x; x++, pixelPtr++)
-		{
-			uint8_t* pixel = (uint8_t*)pixelPtr;
-			if (pixel[3] == 0)
-			{
-				*pixelPtr = 0;
-				continue;
-			}
-			pixel[0] = (uint32_t)((pixel[0] * pixel[3]) >> 8);
-			pixel[1] = (uint32_t)((pixel[1] * pixel[3]) >> 8);
-			pixel[2] = (uint32_t)((pixel[2] * pixel[3]) >> 8);
-		}
+		PixelSpan::premultiply (pixelPtr, pixelPtr, (uint32_t)size.x, PixelSpan::kBGRA);
 	}
 }
 
@@ -371,15 +361,7 @@ void D2DBitmap::PixelAccess::unpremultiplyAlpha (BYTE* ptr, UINT bytesPerRow, co
 	for (int32_t y = 0; y < (int32_t)size.y; y++, ptr += bytesPerRow)
 	{
 		uint32_t* pixelPtr = (uint32_t*)ptr;
-		for (int32_t x = 0; x < (int32_t)size.x; x++, pixelPtr++)
-		{
-			uint8_t* pixel = (uint8_t*)pixelPtr;
-			if (pixel[3] == 0)
-				continue;
-			pixel[0] = (uint32_t)(pixel[0] * 255) / pixel[3];
-			pixel[1] = (uint32_t)(pixel[1] * 255) / pixel[3];
-			pixel[2] = (uint32_t)(pixel[2] * 255) / pixel[3];
-		}
+		PixelSpan::unpremultiply (pixelPtr, pixelPtr, (uint32_t)size.x, PixelSpan::kBGRA);
 	}
 }
 
@@ -398,6 +398,8 @@ void D2DDrawContext::drawBitmap (CBitmap* bitmap, const CRect& dest, const CPoin
 {
 	if (renderTarget == 0)
 		return;
+	if (drawBitmapFromAtlas (bitmap, dest, offset, alpha))
+		return;
 	D2DApplyClip ac (this);
 	if (ac.isEmpty ())
 		return;
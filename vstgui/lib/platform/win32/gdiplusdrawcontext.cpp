@@ -407,6 +407,8 @@ void GdiplusDrawContext::drawPoint (const CPoint &point, const CColor& color)
 //-----------------------------------------------------------------------------
 void GdiplusDrawContext::drawBitmap (CBitmap* cbitmap, const CRect& dest, const CPoint& offset, float alpha)
 {
+	if (drawBitmapFromAtlas (cbitmap, dest, offset, alpha))
+		return;
 	alpha *= currentState.globalAlpha;
 	if (alpha == 0.f || pGraphics == 0)
 		return;
@@ -129,8 +129,12 @@ class IControlListener;
 
 // classes
 class CBitmap;
+class CBitmapAtlas;
 class CNinePartTiledBitmap;
+class CBitmapCache;
+class CFilmstripBitmap;
 class CResourceDescription;
+class CResourcePack;
 class CLineStyle;
 class CDrawContext;
 class COffscreenContext;
@@ -77,6 +77,8 @@ AEffGUIEditor::AEffGUIEditor (void* pEffect)
 //-----------------------------------------------------------------------------
 AEffGUIEditor::~AEffGUIEditor () 
 {
+	// the plug-in may be unloaded after the editor is gone
+	VSTGUI::BitmapFilter::Standard::stopWorkerThreads ();
 	#if WINDOWS
 	OleUninitialize ();
 	#endif
@@ -76,6 +76,8 @@ PluginGUIEditor::PluginGUIEditor (void *pEffect)
 //-----------------------------------------------------------------------------
 PluginGUIEditor::~PluginGUIEditor () 
 {
+	// the plug-in may be unloaded after the editor is gone
+	VSTGUI::BitmapFilter::Standard::stopWorkerThreads ();
 	#if WINDOWS
 	OleUninitialize ();
 	#endif
@@ -34,6 +34,7 @@
 
 #include "vst3editor.h"
 #include "../lib/vstkeycode.h"
+#include "../lib/cbitmapfilter.h"
 #include "../uidescription/editing/uieditcontroller.h"
 #include "../uidescription/editing/uieditmenucontroller.h"
 #include "../uidescription/uiviewfactory.h"
@@ -419,6 +420,8 @@ VST3Editor::VST3Editor (UIDescription* desc, Steinberg::Vst::EditController* con
 VST3Editor::~VST3Editor ()
 {
 	description->forget ();
+	// the plug-in may be unloaded after the editor is gone
+	BitmapFilter::Standard::stopWorkerThreads ();
 }
 
 //-----------------------------------------------------------------------------
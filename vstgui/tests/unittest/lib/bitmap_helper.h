@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#ifndef __bitmap_helper__
+#define __bitmap_helper__
+
+#include "../../../lib/cbitmap.h"
+#include "../../../lib/ccolor.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include <vector>
+
+namespace VSTGUI {
+namespace UnitTest {
+
+//------------------------------------------------------------------------
+/** create a bitmap with the color returned by colorAt (x, y) for each pixel */
+template <typename ColorAt>
+SharedPointer<CBitmap> createBitmap (uint32_t width, uint32_t height, ColorAt colorAt, double scaleFactor = 1., bool alphaPremultiplied = true)
+{
+	CPoint size (width, height);
+	auto platformBitmap = owned (IPlatformBitmap::create (&size));
+	platformBitmap->setScaleFactor (scaleFactor);
+	auto bitmap = owned (new CBitmap (platformBitmap));
+	auto accessor = owned (CBitmapPixelAccess::create (bitmap, alphaPremultiplied));
+	do
+	{
+		accessor->setColor (colorAt (accessor->getX (), accessor->getY ()));
+	} while (++(*accessor));
+	return bitmap;
+}
+
+//------------------------------------------------------------------------
+/** create a bitmap with pseudo random colors and some white pixels, the same seed creates the same pixels */
+inline SharedPointer<CBitmap> createTestBitmap (uint32_t width, uint32_t height, uint32_t seed, double scaleFactor = 1.)
+{
+	return createBitmap (width, height, [&seed] (uint32_t, uint32_t) {
+		seed = seed * 1664525 + 1013904223;
+		if ((seed & 0x7) == 0)
+			return kWhiteCColor;
+		return CColor (static_cast<uint8_t> (seed >> 16), static_cast<uint8_t> (seed >> 8), static_cast<uint8_t> (seed), static_cast<uint8_t> (seed >> 24));
+	}, scaleFactor);
+}
+
+//------------------------------------------------------------------------
+/** the pixel values of a bitmap row by row */
+inline std::vector<uint32_t> getPixels (CBitmap* bitmap, bool alphaPremultiplied = true)
+{
+	std::vector<uint32_t> result;
+	auto accessor = owned (CBitmapPixelAccess::create (bitmap, alphaPremultiplied));
+	uint32_t value;
+	do
+	{
+		accessor->getValue (value);
+		result.push_back (value);
+	} while (++(*accessor));
+	return result;
+}
+
+//------------------------------------------------------------------------
+inline std::vector<uint32_t> getPixels (IPlatformBitmap* platformBitmap, bool alphaPremultiplied = true)
+{
+	auto bitmap = owned (new CBitmap (platformBitmap));
+	return getPixels (bitmap, alphaPremultiplied);
+}
+
+//------------------------------------------------------------------------
+/** the pixel values of numRows rows starting with firstRow */
+inline std::vector<uint32_t> getPixelRows (IPlatformBitmap* platformBitmap, uint32_t firstRow, uint32_t numRows)
+{
+	auto pixels = getPixels (platformBitmap);
+	auto width = static_cast<uint32_t> (platformBitmap->getSize ().x);
+	return std::vector<uint32_t> (pixels.begin () + firstRow * width, pixels.begin () + (firstRow + numRows) * width);
+}
+
+} // UnitTest
+} // VSTGUI
+
+#endif // __bitmap_helper__
@@ -33,12 +33,53 @@
 //-----------------------------------------------------------------------------
 
 #include "../../../lib/cbitmap.h"
+#include "../../../lib/cbitmapfilter.h"
 #include "../../../lib/ccolor.h"
 #include "../../../lib/platform/iplatformbitmap.h"
 #include "../unittests.h"
+#include "bitmap_helper.h"
+#include <chrono>
+#include <thread>
+#include <vector>
 
 namespace VSTGUI {
 
+namespace {
+
+using UnitTest::getPixels;
+
+//------------------------------------------------------------------------
+SharedPointer<CBitmap> createFilmstrip (uint32_t width, uint32_t height, double scaleFactor)
+{
+	return UnitTest::createBitmap (width, height, [] (uint32_t x, uint32_t y) {
+		return CColor (static_cast<uint8_t> (x * 7), static_cast<uint8_t> (y * 3), 100, 255);
+	}, scaleFactor);
+}
+
+//------------------------------------------------------------------------
+std::vector<uint32_t> getAreaScaledPixels (CBitmap* bitmap, CCoord width, CCoord height)
+{
+	auto filter = owned (BitmapFilter::Factory::getInstance ().createFilter (BitmapFilter::Standard::kScaleArea));
+	filter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, bitmap);
+	filter->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, width, height));
+	filter->run ();
+	return getPixels (dynamic_cast<CBitmap*> (filter->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ()));
+}
+
+//------------------------------------------------------------------------
+CBitmap* waitForScaledFrames (CBitmap* bitmap, double scaleFactor, CCoord frameHeight)
+{
+	for (auto i = 0; i < 10000; ++i)
+	{
+		if (auto frames = bitmap->getScaledFrames (scaleFactor, frameHeight))
+			return frames;
+		std::this_thread::sleep_for (std::chrono::milliseconds (1));
+	}
+	return nullptr;
+}
+
+} // anonymous
+
 TESTCASE(CBitmapTest,
 
 	TEST(scaleFactor,
@@ -93,6 +134,75 @@ TESTCASE(CBitmapTest,
 			}
 		} while (++(*accessor));
 	);
+
+	TEST(scaledFrames,
+		auto bitmap = createFilmstrip (8, 32, 2.);
+		EXPECT (bitmap->getScaledFrames (1., 4.) == nullptr);
+		bitmap->setScaledFramesCacheEnabled (true);
+		EXPECT (bitmap->isScaledFramesCacheEnabled ());
+		auto frames = bitmap->getScaledFrames (1., 4.);
+		EXPECT (frames);
+		EXPECT (frames->getWidth () == 4.);
+		EXPECT (frames->getHeight () == 16.);
+		EXPECT (frames->getPlatformBitmap ()->getScaleFactor () == 1.);
+		EXPECT (frames->getPlatformBitmap ()->getSize () == CPoint (4, 16));
+		EXPECT (getPixels (frames) == getAreaScaledPixels (bitmap, 4, 16));
+		EXPECT (bitmap->getScaledFrames (1., 4.) == frames);
+
+		auto upscaled = bitmap->getScaledFrames (3., 4.);
+		EXPECT (upscaled);
+		EXPECT (upscaled->getPlatformBitmap ()->getSize () == CPoint (12, 48));
+		EXPECT (upscaled->getWidth () == 4.);
+
+		bitmap->setScaledFramesCacheEnabled (false);
+		EXPECT (bitmap->getScaledFrames (1., 4.) == nullptr);
+	);
+
+	TEST(scaledFramesNeedWholePixels,
+		auto bitmap = createFilmstrip (8, 32, 2.);
+		bitmap->setScaledFramesCacheEnabled (true);
+		EXPECT (bitmap->getScaledFrames (2., 4.) == nullptr);
+		EXPECT (bitmap->getScaledFrames (1.1, 4.) == nullptr);
+		EXPECT (bitmap->getScaledFrames (1.5, 3.) == nullptr);
+		EXPECT (bitmap->getScaledFrames (1., 0.) == nullptr);
+		EXPECT (bitmap->getScaledFrames (1.5, 4.));
+	);
+
+	TEST(scaledFramesAreClearedWhenThePlatformBitmapsChange,
+		auto bitmap = createFilmstrip (8, 32, 2.);
+		bitmap->setScaledFramesCacheEnabled (true);
+		SharedPointer<CBitmap> frames = bitmap->getScaledFrames (1., 4.);
+		EXPECT (frames);
+		auto other = createFilmstrip (8, 32, 2.);
+		bitmap->setPlatformBitmap (other->getPlatformBitmap ());
+		EXPECT (bitmap->getScaledFrames (1., 4.) != frames);
+		CPoint size (4, 16);
+		auto platformBitmap = owned (IPlatformBitmap::create (&size));
+		EXPECT (bitmap->addBitmap (platformBitmap));
+		EXPECT (bitmap->getScaledFrames (1., 4.) == nullptr);
+	);
+
+	TEST(largeScaledFramesAreResampledInTheBackground,
+		auto bitmap = createFilmstrip (1024, 1024, 2.);
+		bitmap->setScaledFramesCacheEnabled (true);
+		// resampling in the background is opt-in
+		auto frames = bitmap->getScaledFrames (1.5, 64.);
+		EXPECT (frames);
+		EXPECT (frames->getPlatformBitmap ()->getSize () == CPoint (768, 768));
+
+		bitmap->setScaledFramesCacheEnabled (true, true);
+		EXPECT (bitmap->getScaledFrames (1.5, 64.) == nullptr);
+		frames = waitForScaledFrames (bitmap, 1.5, 64.);
+		EXPECT (frames);
+		EXPECT (frames->getWidth () == 512.);
+		EXPECT (frames->getPlatformBitmap ()->getSize () == CPoint (768, 768));
+		EXPECT (getPixels (frames) == getAreaScaledPixels (bitmap, 768, 768));
+
+		// destroying the bitmap waits for the background thread
+		auto other = createFilmstrip (1024, 1024, 2.);
+		other->setScaledFramesCacheEnabled (true, true);
+		other->getScaledFrames (1.5, 64.);
+	);
 );
 
 } // VSTGUI
@@ -0,0 +1,254 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "../../../lib/cbitmapatlas.h"
+#include "../../../lib/cdrawcontext.h"
+#include "../../../lib/ccolor.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../unittests.h"
+#include "bitmap_helper.h"
+#include <vector>
+
+namespace VSTGUI {
+
+namespace {
+
+using UnitTest::createTestBitmap;
+using UnitTest::getPixels;
+
+//------------------------------------------------------------------------
+bool overlap (const CRect& r1, const CRect& r2)
+{
+	return r1.left < r2.right && r2.left < r1.right && r1.top < r2.bottom && r2.top < r1.bottom;
+}
+
+//------------------------------------------------------------------------
+class RecordingDrawContext : public CDrawContext
+{
+public:
+	struct Call
+	{
+		CBitmap* bitmap;
+		CRect dest;
+		CPoint offset;
+	};
+	std::vector<Call> calls;
+
+	RecordingDrawContext () : CDrawContext (CRect (0, 0, 1000, 1000)) { setClipRect (CRect (0, 0, 1000, 1000)); }
+
+	void drawBitmap (CBitmap* bitmap, const CRect& dest, const CPoint& offset, float alpha) override
+	{
+		if (drawBitmapFromAtlas (bitmap, dest, offset, alpha))
+			return;
+		Call call = {bitmap, dest, offset};
+		calls.push_back (call);
+	}
+	void drawLine (const LinePair& line) override {}
+	void drawLines (const LineList& lines) override {}
+	void drawPolygon (const PointList& polygonPointList, const CDrawStyle drawStyle) override {}
+	void drawRect (const CRect &rect, const CDrawStyle drawStyle) override {}
+	void drawArc (const CRect &rect, const float startAngle1, const float endAngle2, const CDrawStyle drawStyle) override {}
+	void drawEllipse (const CRect &rect, const CDrawStyle drawStyle) override {}
+	void drawPoint (const CPoint &point, const CColor& color) override {}
+	void clearRect (const CRect& rect) override {}
+	CGraphicsPath* createGraphicsPath () override { return nullptr; }
+	CGraphicsPath* createTextPath (const CFontRef font, UTF8StringPtr text) override { return nullptr; }
+	void drawGraphicsPath (CGraphicsPath* path, PathDrawMode mode, CGraphicsTransform* transformation) override {}
+	void fillLinearGradient (CGraphicsPath* path, const CGradient& gradient, const CPoint& startPoint, const CPoint& endPoint, bool evenOdd, CGraphicsTransform* transformation) override {}
+	void fillRadialGradient (CGraphicsPath* path, const CGradient& gradient, const CPoint& center, CCoord radius, const CPoint& originOffset, bool evenOdd, CGraphicsTransform* transformation) override {}
+};
+
+} // anonymous
+
+TESTCASE(CBitmapAtlasTest,
+
+	TEST(packIntoOnePage,
+		CBitmapAtlas atlas;
+		std::vector<SharedPointer<CBitmap>> bitmaps;
+		std::vector<std::vector<uint32_t>> pixels;
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			bitmaps.push_back (createTestBitmap (5 + i * 3, 30 - i, i));
+			pixels.push_back (getPixels (bitmaps.back ()));
+			EXPECT(atlas.add (bitmaps.back ()));
+		}
+		EXPECT(atlas.add (bitmaps.front ()) == false);
+		EXPECT(atlas.getNumBitmaps () == 20);
+		EXPECT(atlas.pack ());
+		EXPECT(atlas.getNumBitmaps () == 0);
+		EXPECT(atlas.getNumPages () == 1);
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			auto bitmap = bitmaps[i];
+			EXPECT(bitmap->getAtlas () == atlas.getPage (0));
+			EXPECT(bitmap->isLoaded ());
+			EXPECT(bitmap->getWidth () == 5 + i * 3);
+			EXPECT(bitmap->getHeight () == 30 - i);
+			for (uint32_t j = 0; j < i; j++)
+				EXPECT(overlap (bitmap->getAtlasRect (), bitmaps[j]->getAtlasRect ()) == false);
+		}
+		for (uint32_t i = 0; i < 20; i++)
+		{
+			// asking for the platform bitmap copies the part of the atlas
+			EXPECT(getPixels (bitmaps[i]) == pixels[i]);
+			EXPECT(bitmaps[i]->getAtlas () == nullptr);
+			EXPECT(bitmaps[i]->getWidth () == 5 + i * 3);
+		}
+	);
+
+	TEST(edgesAreRepeated,
+		CBitmapAtlas atlas;
+		auto bitmap = createTestBitmap (4, 3, 100);
+		auto pixels = getPixels (bitmap);
+		atlas.add (bitmap);
+		atlas.pack ();
+		auto rect = bitmap->getAtlasRect ();
+		auto accessor = owned (CBitmapPixelAccess::create (atlas.getPage (0)));
+		uint32_t value;
+		accessor->setPosition (static_cast<uint32_t> (rect.left - 1), static_cast<uint32_t> (rect.top - 1));
+		accessor->getValue (value);
+		EXPECT(value == pixels[0]);
+		accessor->setPosition (static_cast<uint32_t> (rect.right), static_cast<uint32_t> (rect.bottom - 1));
+		accessor->getValue (value);
+		EXPECT(value == pixels.back ());
+	);
+
+	TEST(multiplePages,
+		CBitmapAtlas atlas (64, 32);
+		std::vector<SharedPointer<CBitmap>> bitmaps;
+		for (uint32_t i = 0; i < 9; i++)
+		{
+			bitmaps.push_back (createTestBitmap (25, 25, i));
+			EXPECT(atlas.add (bitmaps.back ()));
+		}
+		EXPECT(atlas.add (createTestBitmap (33, 10, 0)) == false);
+		EXPECT(atlas.pack ());
+		EXPECT(atlas.getNumPages () == 3);
+		for (uint32_t i = 0; i < atlas.getNumPages (); i++)
+		{
+			auto size = atlas.getPage (i)->getPlatformBitmap ()->getSize ();
+			EXPECT(size.x <= 64 && size.y <= 64);
+		}
+		for (auto& bitmap : bitmaps)
+		{
+			auto rect = bitmap->getAtlasRect ();
+			EXPECT(bitmap->getAtlas ());
+			EXPECT(rect.right <= 64 && rect.bottom <= 64);
+		}
+	);
+
+	TEST(scaleFactorsUseSeparatePages,
+		CBitmapAtlas atlas;
+		auto bitmap1x = createTestBitmap (10, 10, 1);
+		auto bitmap2x = createTestBitmap (21, 20, 2, 2.);
+		auto pixels = getPixels (bitmap2x);
+		EXPECT(atlas.add (bitmap1x));
+		EXPECT(atlas.add (bitmap2x));
+		EXPECT(atlas.pack ());
+		EXPECT(atlas.getNumPages () == 2);
+		EXPECT(bitmap1x->getAtlas () != bitmap2x->getAtlas ());
+		EXPECT(bitmap2x->getAtlas ()->getPlatformBitmap ()->getScaleFactor () == 2.);
+		auto rect = bitmap2x->getAtlasRect ();
+		EXPECT(rect.left == static_cast<int32_t> (rect.left));
+		EXPECT(rect.top == static_cast<int32_t> (rect.top));
+		EXPECT(rect.getWidth () == 10.5);
+		EXPECT(bitmap2x->getHeight () == 10);
+		EXPECT(getPixels (bitmap2x) == pixels);
+		EXPECT(bitmap2x->getPlatformBitmap ()->getScaleFactor () == 2.);
+	);
+
+	TEST(unsuitableBitmaps,
+		CBitmapAtlas atlas;
+		EXPECT(atlas.add (nullptr) == false);
+		EXPECT(atlas.add (createTestBitmap (129, 10, 0)) == false);
+		auto variants = createTestBitmap (10, 10, 0);
+		CPoint size (20, 20);
+		auto platformBitmap2x = owned (IPlatformBitmap::create (&size));
+		platformBitmap2x->setScaleFactor (2.);
+		variants->addBitmap (platformBitmap2x);
+		EXPECT(atlas.add (variants) == false);
+		auto inAtlas = createTestBitmap (10, 10, 0);
+		EXPECT(inAtlas->setAtlas (variants, CRect (0, 0, 10, 10)));
+		EXPECT(atlas.add (inAtlas) == false);
+		EXPECT(inAtlas->getPlatformBitmap () != nullptr);
+		EXPECT(inAtlas->getAtlas () == nullptr);
+	);
+
+	TEST(mapToAtlas,
+		auto atlasBitmap = createTestBitmap (100, 100, 0);
+		auto bitmap = createTestBitmap (20, 20, 0);
+		EXPECT(bitmap->setAtlas (atlasBitmap, CRect (10, 20, 30, 40)));
+		CRect dest;
+		CPoint offset;
+		EXPECT(bitmap->mapToAtlas (CRect (50, 50, 60, 60), CPoint (0, 0), dest, offset));
+		EXPECT(dest == CRect (50, 50, 60, 60));
+		EXPECT(offset == CPoint (10, 20));
+		EXPECT(bitmap->mapToAtlas (CRect (0, 0, 100, 100), CPoint (5, 2), dest, offset));
+		EXPECT(dest == CRect (0, 0, 15, 18));
+		EXPECT(offset == CPoint (15, 22));
+		EXPECT(bitmap->mapToAtlas (CRect (0, 0, 10, 10), CPoint (20, 0), dest, offset) == false);
+		EXPECT(atlasBitmap->mapToAtlas (CRect (0, 0, 10, 10), CPoint (0, 0), dest, offset) == false);
+	);
+
+	TEST(drawFromAtlas,
+		CBitmapAtlas atlas;
+		auto bitmap = createTestBitmap (20, 10, 0);
+		auto ninePart = owned (new CNinePartTiledBitmap (createTestBitmap (12, 12, 1)->getPlatformBitmap (), CNinePartTiledDescription (4, 4, 4, 4)));
+		atlas.add (bitmap);
+		atlas.add (ninePart);
+		atlas.pack ();
+		auto page = atlas.getPage (0);
+		RecordingDrawContext context;
+		bitmap->draw (&context, CRect (100, 100, 200, 200), CPoint (5, 0));
+		EXPECT(context.calls.size () == 1);
+		EXPECT(context.calls[0].bitmap == page);
+		EXPECT(context.calls[0].dest == CRect (100, 100, 115, 110));
+		EXPECT(context.calls[0].offset == bitmap->getAtlasRect ().getTopLeft () + CPoint (5, 0));
+		context.calls.clear ();
+		ninePart->draw (&context, CRect (0, 0, 40, 40));
+		EXPECT(context.calls.size () >= 9);
+		CRect ninePartRect = ninePart->getAtlasRect ();
+		for (auto& call : context.calls)
+		{
+			EXPECT(call.bitmap == page);
+			CRect source (call.offset, call.dest.getSize ());
+			EXPECT(source.left >= ninePartRect.left && source.top >= ninePartRect.top);
+			EXPECT(source.right <= ninePartRect.right && source.bottom <= ninePartRect.bottom);
+		}
+	);
+
+);
+
+} // VSTGUI
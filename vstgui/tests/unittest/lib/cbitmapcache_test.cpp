@@ -0,0 +1,327 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "../../../lib/cbitmapcache.h"
+#include "../../../lib/cbitmap.h"
+#include "../../../lib/ccolor.h"
+#include "../../../lib/cframe.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../unittests.h"
+
+namespace VSTGUI {
+
+namespace {
+
+//-----------------------------------------------------------------------------
+SharedPointer<IPlatformBitmap> createPlatformBitmap (double scaleFactor)
+{
+	CPoint size (10. * scaleFactor, 10. * scaleFactor);
+	SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::create (&size));
+	platformBitmap->setScaleFactor (scaleFactor);
+	return platformBitmap;
+}
+
+//-----------------------------------------------------------------------------
+class TestLoader : public CBitmapCache::ILoader
+{
+public:
+	TestLoader () : numLoads (0) {}
+
+	IPlatformBitmap* loadPlatformBitmap (const CBitmapCache::Key& key) override
+	{
+		++numLoads;
+		SharedPointer<IPlatformBitmap> platformBitmap = createPlatformBitmap (key.scaleFactor);
+		platformBitmap->remember ();
+		return platformBitmap;
+	}
+
+	int32_t numLoads;
+};
+
+const uint8_t kData1[] = {1, 2, 3, 4};
+const uint8_t kData2[] = {1, 2, 3, 5};
+
+const uint64_t kOneXBytes = 10 * 10 * 4;
+const uint64_t kTwoXBytes = 20 * 20 * 4;
+
+//-----------------------------------------------------------------------------
+SharedPointer<CBitmap> createBitmapWithTwoVariants (CBitmapCache& cache, TestLoader* loader)
+{
+	SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+	cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap", 1.));
+	cache.add (bitmap, createPlatformBitmap (2.), CBitmapCache::Key ("bitmap", 2.), loader);
+	return bitmap;
+}
+
+} // anonymous
+
+TESTCASE(CBitmapCacheTest,
+
+	TEST(lookup,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap", 1., "filter")));
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap", 1., "filter")) == bitmap->getPlatformBitmap ());
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap", 1.)) == 0);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap", 2., "filter")) == 0);
+		EXPECT(cache.get (CBitmapCache::Key ("", 1., "filter")) == 0);
+		CBitmapCache::Statistics statistics = cache.getStatistics ();
+		EXPECT(statistics.hits == 1);
+		EXPECT(statistics.misses == 3);
+		EXPECT(statistics.numVariants == 1);
+		EXPECT(statistics.residentBytes == kOneXBytes);
+		cache.resetStatistics ();
+		statistics = cache.getStatistics ();
+		EXPECT(statistics.hits == 0);
+		EXPECT(statistics.misses == 0);
+		EXPECT(statistics.residentBytes == kOneXBytes);
+	);
+
+	TEST(keyIsUsedByOnePlatformBitmap,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap1 = owned (new CBitmap (createPlatformBitmap (1.)));
+		SharedPointer<CBitmap> bitmap2 = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap1, bitmap1->getPlatformBitmap (), CBitmapCache::Key ("bitmap")));
+		EXPECT(cache.add (bitmap2, bitmap2->getPlatformBitmap (), CBitmapCache::Key ("bitmap")) == false);
+		EXPECT(cache.add (bitmap2, bitmap2->getPlatformBitmap (), CBitmapCache::Key ()));
+	);
+
+	TEST(sharedPlatformBitmap,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap1 = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap1, bitmap1->getPlatformBitmap (), CBitmapCache::Key ("bitmap")));
+		IPlatformBitmap* platformBitmap = cache.get (CBitmapCache::Key ("bitmap"));
+		SharedPointer<CBitmap> bitmap2 = owned (new CBitmap (platformBitmap));
+		EXPECT(cache.add (bitmap2, platformBitmap, CBitmapCache::Key ("bitmap")));
+		EXPECT(cache.getStatistics ().numVariants == 1);
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes);
+		bitmap1 = 0;
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap")) == platformBitmap);
+		bitmap2 = 0;
+		EXPECT(cache.getStatistics ().numVariants == 0);
+		EXPECT(cache.getStatistics ().residentBytes == 0);
+	);
+
+	TEST(budgetKeepsUnusedVariants,
+		CBitmapCache cache;
+		cache.setBudget (kOneXBytes * 2);
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap1")));
+		bitmap = 0;
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap1")));
+		bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap2")));
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap1")));
+		bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap3")));
+		// the least recently used variant without bitmap was released
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap1")));
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap2")) == 0);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap3")));
+		EXPECT(cache.getStatistics ().evictions == 1);
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes * 2);
+		cache.setBudget (0);
+		EXPECT(cache.getStatistics ().numVariants == 1);
+	);
+
+	TEST(unusedScaleVariantIsReleasedAndReloaded,
+		CBitmapCache cache;
+		cache.setBudget (kTwoXBytes);
+		SharedPointer<TestLoader> loader = owned (new TestLoader);
+		SharedPointer<CBitmap> bitmap = createBitmapWithTwoVariants (cache, loader);
+		CBitmapCache::Statistics statistics = cache.getStatistics ();
+		EXPECT(statistics.evictions == 1);
+		EXPECT(statistics.numVariants == 2);
+		EXPECT(statistics.numResidentVariants == 1);
+		EXPECT(statistics.residentBytes == kOneXBytes);
+		EXPECT(bitmap->getWidth () == 10.);
+
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (1.)->getScaleFactor () == 1.);
+		EXPECT(loader->numLoads == 0);
+		IPlatformBitmap* platformBitmap = bitmap->getBestPlatformBitmapForScaleFactor (2.);
+		EXPECT(platformBitmap->getScaleFactor () == 2.);
+		EXPECT(loader->numLoads == 1);
+		EXPECT(cache.getStatistics ().reloads == 1);
+		// both variants are used now, so the budget is exceeded
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes + kTwoXBytes);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (2.) == platformBitmap);
+		EXPECT(loader->numLoads == 1);
+
+		cache.resetUsage ();
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes);
+		EXPECT(cache.getStatistics ().evictions == 2);
+	);
+
+	TEST(usageIsResetPerFrame,
+		CBitmapCache cache;
+		cache.setBudget (kTwoXBytes);
+		SharedPointer<TestLoader> loader = owned (new TestLoader);
+		SharedPointer<CBitmap> bitmap = createBitmapWithTwoVariants (cache, loader);
+		SharedPointer<CFrame> frame1 = owned (new CFrame (CRect (0, 0, 10, 10), 0));
+		SharedPointer<CFrame> frame2 = owned (new CFrame (CRect (0, 0, 10, 10), 0));
+		cache.setDrawingFrame (frame1);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (2.)->getScaleFactor () == 2.);
+		cache.setDrawingFrame (frame2);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (2.)->getScaleFactor () == 2.);
+		cache.setDrawingFrame (0);
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes + kTwoXBytes);
+
+		// the other frame still draws with the scale variant
+		cache.resetUsage (frame1);
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes + kTwoXBytes);
+		cache.resetUsage (frame2);
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes);
+		EXPECT(loader->numLoads == 1);
+	);
+
+	TEST(lastPlatformBitmapIsNeverReleased,
+		CBitmapCache cache;
+		cache.setBudget (1);
+		SharedPointer<TestLoader> loader = owned (new TestLoader);
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (2.)));
+		EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap", 2.), loader));
+		EXPECT(bitmap->getPlatformBitmap ());
+		EXPECT(cache.getStatistics ().evictions == 0);
+	);
+
+	TEST(unlimitedBudget,
+		CBitmapCache cache;
+		SharedPointer<TestLoader> loader = owned (new TestLoader);
+		SharedPointer<CBitmap> bitmap = createBitmapWithTwoVariants (cache, loader);
+		EXPECT(cache.getStatistics ().residentBytes == kOneXBytes + kTwoXBytes);
+		cache.resetUsage ();
+		EXPECT(cache.getStatistics ().evictions == 0);
+		bitmap = 0;
+		EXPECT(cache.getStatistics ().numVariants == 0);
+		EXPECT(cache.getStatistics ().residentBytes == 0);
+	);
+
+	TEST(detachLoadsReleasedVariants,
+		CBitmapCache cache;
+		cache.setBudget (kOneXBytes);
+		SharedPointer<TestLoader> loader = owned (new TestLoader);
+		SharedPointer<CBitmap> bitmap = createBitmapWithTwoVariants (cache, loader);
+		EXPECT(cache.getStatistics ().numResidentVariants == 1);
+		cache.detach (bitmap);
+		EXPECT(loader->numLoads == 1);
+		EXPECT(cache.getStatistics ().residentBytes <= kOneXBytes);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (2.)->getScaleFactor () == 2.);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (1.)->getScaleFactor () == 1.);
+	);
+
+	TEST(replacedPlatformBitmapIsRemoved,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap")));
+		bitmap->setPlatformBitmap (createPlatformBitmap (1.));
+		EXPECT(cache.getStatistics ().numVariants == 0);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap")) == 0);
+	);
+
+	TEST(cacheDestroyedBeforeBitmap,
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		{
+			CBitmapCache cache;
+			EXPECT(cache.add (bitmap, bitmap->getPlatformBitmap (), CBitmapCache::Key ("bitmap")));
+		}
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (1.) == bitmap->getPlatformBitmap ());
+	);
+
+	TEST(contentResource,
+		EXPECT(CBitmapCache::Key::makeContentResource (kData1, 4) == CBitmapCache::Key::makeContentResource (kData1, 4));
+		EXPECT(CBitmapCache::Key::makeContentResource (kData1, 4) != CBitmapCache::Key::makeContentResource (kData2, 4));
+		EXPECT(CBitmapCache::Key::makeContentResource (kData1, 4) != CBitmapCache::Key::makeContentResource (kData1, 3));
+	);
+
+	TEST(pixelAccessCopiesSharedPlatformBitmap,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap1 = owned (new CBitmap (createPlatformBitmap (1.)));
+		IPlatformBitmap* platformBitmap = bitmap1->getPlatformBitmap ();
+		EXPECT(cache.add (bitmap1, platformBitmap, CBitmapCache::Key ("bitmap")));
+		SharedPointer<CBitmap> bitmap2 = owned (new CBitmap (platformBitmap));
+		EXPECT(cache.add (bitmap2, platformBitmap, CBitmapCache::Key ("bitmap")));
+		SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap2));
+		EXPECT(accessor);
+		accessor->setColor (kRedCColor);
+		accessor = 0;
+		EXPECT(bitmap1->getPlatformBitmap () == platformBitmap);
+		EXPECT(bitmap2->getPlatformBitmap () != platformBitmap);
+		EXPECT(bitmap2->getWidth () == 10.);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap")) == platformBitmap);
+		accessor = owned (CBitmapPixelAccess::create (bitmap1, true, false));
+		CColor color;
+		accessor->getColor (color);
+		EXPECT(color != kRedCColor);
+	);
+
+	TEST(readOnlyPixelAccessKeepsSharedPlatformBitmap,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap1 = owned (new CBitmap (createPlatformBitmap (1.)));
+		IPlatformBitmap* platformBitmap = bitmap1->getPlatformBitmap ();
+		EXPECT(cache.add (bitmap1, platformBitmap, CBitmapCache::Key ("bitmap")));
+		SharedPointer<CBitmap> bitmap2 = owned (new CBitmap (platformBitmap));
+		EXPECT(cache.add (bitmap2, platformBitmap, CBitmapCache::Key ("bitmap")));
+		SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap2, true, false));
+		EXPECT(accessor);
+		accessor = 0;
+		EXPECT(bitmap2->getPlatformBitmap () == platformBitmap);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap")) == platformBitmap);
+		EXPECT(cache.getStatistics ().numVariants == 1);
+	);
+
+	TEST(pixelAccessOnSoleUserRemovesBitmapFromCache,
+		CBitmapCache cache;
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		IPlatformBitmap* platformBitmap = bitmap->getPlatformBitmap ();
+		EXPECT(cache.add (bitmap, platformBitmap, CBitmapCache::Key ("bitmap")));
+		SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap));
+		EXPECT(bitmap->getPlatformBitmap () == platformBitmap);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap")) == 0);
+		EXPECT(cache.getStatistics ().numVariants == 0);
+	);
+
+	TEST(pixelAccessKeepsCachedPlatformBitmapWithBudget,
+		CBitmapCache cache;
+		cache.setBudget (kOneXBytes * 4);
+		SharedPointer<CBitmap> bitmap = owned (new CBitmap (createPlatformBitmap (1.)));
+		IPlatformBitmap* platformBitmap = bitmap->getPlatformBitmap ();
+		EXPECT(cache.add (bitmap, platformBitmap, CBitmapCache::Key ("bitmap")));
+		SharedPointer<CBitmapPixelAccess> accessor = owned (CBitmapPixelAccess::create (bitmap));
+		EXPECT(bitmap->getPlatformBitmap () != platformBitmap);
+		EXPECT(cache.get (CBitmapCache::Key ("bitmap")) == platformBitmap);
+	);
+);
+
+} // VSTGUI
@@ -0,0 +1,180 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "../../../lib/cbitmapcodec.h"
+#include "../../../lib/cbitmap.h"
+#include "../../../lib/ccolor.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../unittests.h"
+#include "bitmap_helper.h"
+#include <cstdlib>
+#include <vector>
+
+namespace VSTGUI {
+
+namespace {
+
+//------------------------------------------------------------------------
+enum Content { kNoise, kGradient, kSolid, kPalette };
+
+//------------------------------------------------------------------------
+SharedPointer<IPlatformBitmap> createTestBitmap (uint32_t width, uint32_t height, Content content)
+{
+	uint32_t seed = 3;
+	auto bitmap = UnitTest::createBitmap (width, height, [&] (uint32_t x, uint32_t y) {
+		seed = seed * 1664525 + 1013904223;
+		switch (content)
+		{
+			case kNoise: return CColor (static_cast<uint8_t> (seed >> 16), static_cast<uint8_t> (seed >> 8), static_cast<uint8_t> (seed), static_cast<uint8_t> (seed >> 24));
+			case kGradient: return CColor (static_cast<uint8_t> (x * 2), static_cast<uint8_t> (y * 3), static_cast<uint8_t> (x + y + (seed >> 30)), 255);
+			case kSolid: return CColor (10, 20, 30, 128);
+			case kPalette: break;
+		}
+		return CColor (static_cast<uint8_t> ((seed >> 28) * 16), 0, static_cast<uint8_t> ((seed >> 24) & 0x30), (seed & 1) ? 255 : 64);
+	}, 1., false);
+	return bitmap->getPlatformBitmap ();
+}
+
+//------------------------------------------------------------------------
+std::vector<uint32_t> getPixels (IPlatformBitmap* platformBitmap)
+{
+	// QOI stores the color components not multiplied with alpha
+	return UnitTest::getPixels (platformBitmap, false);
+}
+
+//------------------------------------------------------------------------
+std::vector<uint8_t> encodeQOI (IPlatformBitmap* platformBitmap)
+{
+	void* data = nullptr;
+	uint32_t size = 0;
+	if (!BitmapCodec::createMemoryRepresentation (platformBitmap, BitmapCodec::kQOI, &data, size))
+		return {};
+	std::vector<uint8_t> result (static_cast<uint8_t*> (data), static_cast<uint8_t*> (data) + size);
+	std::free (data);
+	return result;
+}
+
+//------------------------------------------------------------------------
+bool roundTrip (Content content)
+{
+	auto original = createTestBitmap (67, 45, content);
+	auto data = encodeQOI (original);
+	if (!BitmapCodec::isQOI (data.data (), static_cast<uint32_t> (data.size ())))
+		return false;
+	auto decoded = owned (BitmapCodec::createFromMemory (data.data (), static_cast<uint32_t> (data.size ())));
+	return decoded && decoded->getSize () == original->getSize () && getPixels (decoded) == getPixels (original);
+}
+
+//------------------------------------------------------------------------
+bool decodeInPieces (uint32_t pieceSize)
+{
+	auto original = createTestBitmap (31, 29, kGradient);
+	auto data = encodeQOI (original);
+	BitmapCodec::QOIDecoder decoder;
+	for (size_t pos = 0; pos < data.size (); pos += pieceSize)
+	{
+		if (!decoder.write (data.data () + pos, static_cast<uint32_t> (std::min<size_t> (pieceSize, data.size () - pos))))
+			return false;
+	}
+	return decoder.isComplete () && getPixels (decoder.getPlatformBitmap ()) == getPixels (original);
+}
+
+//------------------------------------------------------------------------
+// 2 x 2 pixels: red, red, index of red, green with alpha 128
+const uint8_t kQOIData[] = {
+	'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 2, 4, 0,
+	0xFE, 255, 0, 0,
+	0xC0,
+	0x00 | ((255 * 3 + 255 * 11) % 64),
+	0xFF, 0, 255, 0, 128,
+	0, 0, 0, 0, 0, 0, 0, 1
+};
+
+} // anonymous
+
+TESTCASE(BitmapCodecTest,
+
+	TEST(roundTrip,
+		EXPECT (roundTrip (kNoise));
+		EXPECT (roundTrip (kGradient));
+		EXPECT (roundTrip (kSolid));
+		EXPECT (roundTrip (kPalette));
+	);
+
+	TEST(decodeInPieces,
+		EXPECT (decodeInPieces (1));
+		EXPECT (decodeInPieces (2));
+		EXPECT (decodeInPieces (7));
+		EXPECT (decodeInPieces (4096));
+	);
+
+	TEST(decodeReferenceData,
+		auto platformBitmap = owned (BitmapCodec::createFromMemory (kQOIData, sizeof (kQOIData)));
+		EXPECT (platformBitmap);
+		EXPECT (platformBitmap->getSize () == CPoint (2, 2));
+		auto bitmap = owned (new CBitmap (platformBitmap));
+		auto accessor = owned (CBitmapPixelAccess::create (bitmap, false));
+		CColor color;
+		accessor->getColor (color);
+		EXPECT (color == kRedCColor);
+		++(*accessor);
+		accessor->getColor (color);
+		EXPECT (color == kRedCColor);
+		++(*accessor);
+		accessor->getColor (color);
+		EXPECT (color == kRedCColor);
+		++(*accessor);
+		accessor->getColor (color);
+		EXPECT (color == CColor (0, 255, 0, 128));
+	);
+
+	TEST(invalidData,
+		EXPECT (BitmapCodec::isQOI (kQOIData, 10) == false);
+		EXPECT (BitmapCodec::createFromMemory (kQOIData, 20) == nullptr);
+		std::vector<uint8_t> data (kQOIData, kQOIData + sizeof (kQOIData));
+		data[7] = 0;
+		BitmapCodec::QOIDecoder decoder;
+		EXPECT (decoder.write (data.data (), static_cast<uint32_t> (data.size ())) == false);
+		EXPECT (decoder.getPlatformBitmap () == nullptr);
+	);
+
+	TEST(solidBitmapsAreSmall,
+		auto data = encodeQOI (createTestBitmap (100, 100, kSolid));
+		// header, one rgba op, runs of at most 62 pixels and the end marker
+		EXPECT (data.size () == 14 + 5 + (100 * 100 - 1 + 61) / 62 + 8);
+	);
+);
+
+} // VSTGUI
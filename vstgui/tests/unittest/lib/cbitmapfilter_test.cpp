@@ -0,0 +1,584 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "../../../lib/cbitmapfilter.h"
+#include "../../../lib/cbitmap.h"
+#include "../../../lib/ccolor.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../unittests.h"
+#include "bitmap_helper.h"
+#include <vector>
+
+namespace VSTGUI {
+
+namespace {
+
+using UnitTest::createTestBitmap;
+using UnitTest::getPixels;
+
+//------------------------------------------------------------------------
+SharedPointer<CBitmap> copyBitmap (CBitmap* bitmap)
+{
+	auto result = owned (new CBitmap (bitmap->getWidth (), bitmap->getHeight ()));
+	auto src = owned (CBitmapPixelAccess::create (bitmap));
+	auto dst = owned (CBitmapPixelAccess::create (result));
+	uint32_t value;
+	do
+	{
+		src->getValue (value);
+		dst->setValue (value);
+		++(*dst);
+	} while (++(*src));
+	return result;
+}
+
+//------------------------------------------------------------------------
+CBitmap* runFilter (IdStringPtr name, CBitmap* input, bool replace, std::function<void(BitmapFilter::IFilter*)> setup = nullptr)
+{
+	auto filter = owned (BitmapFilter::Factory::getInstance ().createFilter (name));
+	filter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, input);
+	if (setup)
+		setup (filter);
+	if (!filter->run (replace))
+		return nullptr;
+	auto result = dynamic_cast<CBitmap*> (filter->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ());
+	result->remember ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+// the box blur implementation of VSTGUI 4.3 working pixel by pixel
+void referenceBoxBlur (CBitmapPixelAccess& accessor, uint32_t radius)
+{
+	auto calculate = [] (uint32_t* colors, uint32_t numColors) {
+		uint32_t lastColor = numColors - 1;
+		uint32_t red = colors[lastColor] & 0xFF;
+		uint32_t green = (colors[lastColor] >> 8) & 0xFF;
+		uint32_t blue = (colors[lastColor] >> 16) & 0xFF;
+		uint32_t alpha = (colors[lastColor] >> 24) & 0xFF;
+		for (int64_t i = (int64_t)numColors - 2; i >= 0; i--)
+		{
+			red += colors[i] & 0xFF;
+			green += (colors[i] >> 8) & 0xFF;
+			blue += (colors[i] >> 16) & 0xFF;
+			alpha += (colors[i] >> 24) & 0xFF;
+			colors[i + 1] = colors[i];
+		}
+		colors[0] = (red / numColors) | ((green / numColors) << 8) | ((blue / numColors) << 16) | ((alpha / numColors) << 24);
+	};
+	const uint32_t halfRadius = radius / 2;
+	const uint32_t width = accessor.getBitmapWidth ();
+	const uint32_t height = accessor.getBitmapHeight ();
+	std::vector<uint32_t> nc (radius);
+	uint32_t x, y, x1, y1;
+	for (y = 0; y < height; y++)
+	{
+		std::fill (nc.begin (), nc.end (), 0);
+		for (x1 = 0; x1 < halfRadius; x1++)
+		{
+			accessor.setPosition (x1, y);
+			accessor.getValue (nc[0]);
+			calculate (nc.data (), radius);
+		}
+		for (x = 0; x < width - halfRadius; x++, x1++)
+		{
+			accessor.setPosition (x1, y);
+			accessor.getValue (nc[0]);
+			calculate (nc.data (), radius);
+			accessor.setPosition (x, y);
+			accessor.setValue (nc[0]);
+		}
+		for (; x < width; x++)
+		{
+			nc[0] = nc[1];
+			calculate (nc.data (), radius);
+			accessor.setPosition (x, y);
+			accessor.setValue (nc[0]);
+		}
+	}
+	for (x = 0; x < width; x++)
+	{
+		std::fill (nc.begin (), nc.end (), 0);
+		for (y1 = 0; y1 < halfRadius; y1++)
+		{
+			accessor.setPosition (x, y1);
+			accessor.getValue (nc[0]);
+			calculate (nc.data (), radius);
+		}
+		for (y = 0; y < height - halfRadius; y++, y1++)
+		{
+			accessor.setPosition (x, y1);
+			accessor.getValue (nc[0]);
+			calculate (nc.data (), radius);
+			accessor.setPosition (x, y);
+			accessor.setValue (nc[0]);
+		}
+		for (; y < height; y++)
+		{
+			nc[0] = nc[1];
+			calculate (nc.data (), radius);
+			accessor.setPosition (x, y);
+			accessor.setValue (nc[0]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+// the bilinear scale implementation of VSTGUI 4.3 working pixel by pixel
+void referenceScaleBilinear (CBitmapPixelAccess& originalBitmap, CBitmapPixelAccess& copyBitmap)
+{
+	uint32_t origWidth = originalBitmap.getBitmapWidth ();
+	uint32_t origHeight = originalBitmap.getBitmapHeight ();
+	uint32_t newWidth = copyBitmap.getBitmapWidth ();
+	uint32_t newHeight = copyBitmap.getBitmapHeight ();
+	float xRatio = ((float)(origWidth-1)) / (float)newWidth;
+	float yRatio = ((float)(origHeight-1)) / (float)newHeight;
+	CColor color[4];
+	for (uint32_t i = 0; i < newHeight; i++)
+	{
+		uint32_t y = static_cast<uint32_t> (yRatio * i);
+		float yDiff = (yRatio * i) - y;
+		for (uint32_t j = 0; j < newWidth; j++, ++copyBitmap)
+		{
+			uint32_t x = static_cast<uint32_t> (xRatio * j);
+			float xDiff = (xRatio * j) - x;
+			originalBitmap.setPosition (x, y);
+			originalBitmap.getColor (color[0]);
+			originalBitmap.setPosition (x+1, y);
+			originalBitmap.getColor (color[1]);
+			originalBitmap.setPosition (x, y+1);
+			originalBitmap.getColor (color[2]);
+			originalBitmap.setPosition (x+1, y+1);
+			originalBitmap.getColor (color[3]);
+			float r = color[0].red * (1.f - xDiff) * (1.f - yDiff) + color[1].red * xDiff * (1.f - yDiff)
+			+ color[2].red * yDiff * (1.f - xDiff) + color[3].red * xDiff * yDiff;
+			float g = color[0].green * (1.f - xDiff) * (1.f - yDiff) + color[1].green * xDiff * (1.f - yDiff)
+			+ color[2].green * yDiff * (1.f - xDiff) + color[3].green * xDiff * yDiff;
+			float b = color[0].blue * (1.f - xDiff) * (1.f - yDiff) + color[1].blue * xDiff * (1.f - yDiff)
+			+ color[2].blue * yDiff * (1.f - xDiff) + color[3].blue * xDiff * yDiff;
+			float a = color[0].alpha * (1.f - xDiff) * (1.f - yDiff) + color[1].alpha * xDiff * (1.f - yDiff)
+			+ color[2].alpha * yDiff * (1.f - xDiff) + color[3].alpha * xDiff * yDiff;
+			copyBitmap.setColor (CColor ((uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a));
+		}
+	}
+}
+
+//------------------------------------------------------------------------
+bool threadCountDoesNotChangeResult (IdStringPtr name, int32_t threadCount, bool replace, std::function<void(BitmapFilter::IFilter*)> setup = nullptr)
+{
+	auto singleThreaded = createTestBitmap (307, 211, 7);
+	auto multiThreaded = copyBitmap (singleThreaded);
+	auto result1 = owned (runFilter (name, singleThreaded, replace, [&] (BitmapFilter::IFilter* f) {
+		f->setProperty (BitmapFilter::Standard::Property::kThreadCount, (int32_t)1);
+		if (setup)
+			setup (f);
+	}));
+	auto result2 = owned (runFilter (name, multiThreaded, replace, [&] (BitmapFilter::IFilter* f) {
+		f->setProperty (BitmapFilter::Standard::Property::kThreadCount, threadCount);
+		if (setup)
+			setup (f);
+	}));
+	return result1 && result2 && getPixels (result1) == getPixels (result2);
+}
+
+//------------------------------------------------------------------------
+void setBoxBlurTestRadius (BitmapFilter::IFilter* f)
+{
+	f->setProperty (BitmapFilter::Standard::Property::kRadius, (int32_t)9);
+}
+
+//------------------------------------------------------------------------
+void setScaleTestSize (BitmapFilter::IFilter* f)
+{
+	f->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 517, 389));
+}
+
+//------------------------------------------------------------------------
+void setScaleDownTestSize (BitmapFilter::IFilter* f)
+{
+	f->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 131, 97));
+}
+
+//------------------------------------------------------------------------
+class InvertFilter : public BitmapFilter::FilterBase
+{
+public:
+	InvertFilter () : FilterBase ("Invert")
+	{
+		registerProperty (BitmapFilter::Standard::Property::kInputBitmap, BitmapFilter::Property (BitmapFilter::Property::kObject));
+	}
+
+	bool run (bool replace) override
+	{
+		if (replace)
+			return false;
+		auto output = copyBitmap (getInputBitmap ());
+		auto accessor = owned (CBitmapPixelAccess::create (output));
+		uint32_t value;
+		do
+		{
+			accessor->getValue (value);
+			accessor->setValue (~value);
+		} while (++(*accessor));
+		return registerProperty (BitmapFilter::Standard::Property::kOutputBitmap, BitmapFilter::Property (output));
+	}
+};
+
+//------------------------------------------------------------------------
+void addTestFilters (BitmapFilter::Pipeline& pipeline, bool withScale)
+{
+	auto setColor = pipeline.addFilter (BitmapFilter::Standard::kSetColor);
+	setColor->setProperty (BitmapFilter::Standard::Property::kInputColor, CColor (10, 200, 30, 255));
+	setColor->setProperty (BitmapFilter::Standard::Property::kIgnoreAlphaColorValue, (int32_t)1);
+	pipeline.addFilter (BitmapFilter::Standard::kGrayscale);
+	auto blur = pipeline.addFilter (BitmapFilter::Standard::kBoxBlur);
+	blur->setProperty (BitmapFilter::Standard::Property::kRadius, (int32_t)5);
+	pipeline.addFilter (owned (new InvertFilter));
+	auto replaceColor = pipeline.addFilter (BitmapFilter::Standard::kReplaceColor);
+	replaceColor->setProperty (BitmapFilter::Standard::Property::kInputColor, kBlackCColor);
+	if (withScale)
+	{
+		auto scale = pipeline.addFilter (BitmapFilter::Standard::kScaleBilinear);
+		scale->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 57, 33));
+	}
+	blur = pipeline.addFilter (BitmapFilter::Standard::kBoxBlur);
+	blur->setProperty (BitmapFilter::Standard::Property::kRadius, (int32_t)3);
+	pipeline.addFilter (BitmapFilter::Standard::kGrayscale);
+}
+
+//------------------------------------------------------------------------
+/** runs the filters of the pipeline one by one via IFilter::run */
+SharedPointer<CBitmap> runFiltersOneByOne (BitmapFilter::Pipeline& pipeline, CBitmap* input)
+{
+	SharedPointer<CBitmap> current = input;
+	for (uint32_t i = 0; i < pipeline.getNumFilters (); ++i)
+	{
+		auto filter = pipeline.getFilter (i);
+		filter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, BitmapFilter::Property (current));
+		if (!filter->run (false))
+			return nullptr;
+		current = dynamic_cast<CBitmap*> (filter->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ());
+	}
+	return current;
+}
+
+//------------------------------------------------------------------------
+bool pipelineMatchesFiltersOneByOne (bool withScale, bool replace)
+{
+	auto input = createTestBitmap (41, 29, 8);
+	auto original = getPixels (input);
+	BitmapFilter::Pipeline pipeline;
+	addTestFilters (pipeline, withScale);
+	auto reference = runFiltersOneByOne (pipeline, input);
+	if (reference == nullptr || getPixels (input) != original)
+		return false;
+	if (!pipeline.run (input, replace))
+		return false;
+	auto output = pipeline.getOutputBitmap ();
+	if (replace != (output == input))
+		return false;
+	if (!replace && getPixels (input) != original)
+		return false;
+	return output->getWidth () == reference->getWidth () && getPixels (output) == getPixels (reference);
+}
+
+//------------------------------------------------------------------------
+const uint32_t kBoxBlurTestSizes[][2] = {{37, 23}, {64, 64}, {5, 41}};
+const int32_t kBoxBlurTestRadii[] = {2, 3, 7, 12, 30};
+const CCoord kScaleTestSizes[][2] = {{11, 9}, {40, 31}, {23, 17}};
+
+} // anonymous
+
+TESTCASE(CBitmapFilterTest,
+
+	TEST(boxBlurMatchesPixelByPixelImplementation,
+		for (auto& size : kBoxBlurTestSizes)
+		{
+			for (auto radius : kBoxBlurTestRadii)
+			{
+				auto bitmap = createTestBitmap (size[0], size[1], static_cast<uint32_t> (radius));
+				auto reference = copyBitmap (bitmap);
+				{
+					auto accessor = owned (CBitmapPixelAccess::create (reference));
+					if (static_cast<uint32_t> (radius) / 2 < std::min (size[0], size[1]))
+						referenceBoxBlur (*accessor, static_cast<uint32_t> (radius));
+				}
+				if (static_cast<uint32_t> (radius) / 2 >= std::min (size[0], size[1]))
+					continue;
+				auto result = owned (runFilter (BitmapFilter::Standard::kBoxBlur, bitmap, true, [&] (BitmapFilter::IFilter* f) {
+					f->setProperty (BitmapFilter::Standard::Property::kRadius, radius);
+				}));
+				EXPECT (result == bitmap);
+				EXPECT (getPixels (result) == getPixels (reference));
+			}
+		}
+	);
+
+	TEST(boxBlurOutOfPlaceMatchesInPlace,
+		auto bitmap = createTestBitmap (31, 17, 1);
+		auto result = owned (runFilter (BitmapFilter::Standard::kBoxBlur, bitmap, false, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kRadius, (int32_t)5);
+		}));
+		EXPECT (result && result != bitmap);
+		auto original = getPixels (bitmap);
+		auto inPlace = owned (runFilter (BitmapFilter::Standard::kBoxBlur, bitmap, true, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kRadius, (int32_t)5);
+		}));
+		EXPECT (original != getPixels (bitmap));
+		EXPECT (getPixels (result) == getPixels (bitmap));
+	);
+
+	TEST(grayscale,
+		auto bitmap = createTestBitmap (19, 7, 2);
+		auto result = owned (runFilter (BitmapFilter::Standard::kGrayscale, bitmap, false));
+		auto src = owned (CBitmapPixelAccess::create (bitmap));
+		auto dst = owned (CBitmapPixelAccess::create (result));
+		CColor c1;
+		CColor c2;
+		do
+		{
+			src->getColor (c1);
+			dst->getColor (c2);
+			EXPECT (c2.red == c1.getLuma ());
+			EXPECT (c2.green == c1.getLuma ());
+			EXPECT (c2.blue == c1.getLuma ());
+			EXPECT (c2.alpha == c1.alpha);
+			++(*dst);
+		} while (++(*src));
+	);
+
+	TEST(setColor,
+		auto bitmap = createTestBitmap (13, 11, 3);
+		auto original = copyBitmap (bitmap);
+		auto result = owned (runFilter (BitmapFilter::Standard::kSetColor, bitmap, true, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kInputColor, CColor (10, 20, 30, 40));
+		}));
+		EXPECT (result == bitmap);
+		auto src = owned (CBitmapPixelAccess::create (original));
+		auto dst = owned (CBitmapPixelAccess::create (result));
+		CColor c1;
+		CColor c2;
+		do
+		{
+			src->getColor (c1);
+			dst->getColor (c2);
+			EXPECT (c2 == CColor (10, 20, 30, c1.alpha));
+			++(*dst);
+		} while (++(*src));
+
+		result = owned (runFilter (BitmapFilter::Standard::kSetColor, bitmap, false, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kInputColor, CColor (10, 20, 30, 40));
+			f->setProperty (BitmapFilter::Standard::Property::kIgnoreAlphaColorValue, (int32_t)0);
+		}));
+		dst = owned (CBitmapPixelAccess::create (result));
+		do
+		{
+			dst->getColor (c2);
+			EXPECT (c2 == CColor (10, 20, 30, 40));
+		} while (++(*dst));
+	);
+
+	TEST(replaceColor,
+		auto bitmap = createTestBitmap (21, 9, 4);
+		auto result = owned (runFilter (BitmapFilter::Standard::kReplaceColor, bitmap, false, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kInputColor, kWhiteCColor);
+			f->setProperty (BitmapFilter::Standard::Property::kOutputColor, kRedCColor);
+		}));
+		auto src = owned (CBitmapPixelAccess::create (bitmap));
+		auto dst = owned (CBitmapPixelAccess::create (result));
+		CColor c1;
+		CColor c2;
+		uint32_t numReplaced = 0;
+		do
+		{
+			src->getColor (c1);
+			dst->getColor (c2);
+			if (c1 == kWhiteCColor)
+			{
+				EXPECT (c2 == kRedCColor);
+				numReplaced++;
+			}
+			else
+				EXPECT (c2 == c1);
+			++(*dst);
+		} while (++(*src));
+		EXPECT (numReplaced > 0);
+	);
+
+	TEST(scaleLinear,
+		auto bitmap = createTestBitmap (16, 8, 5);
+		auto result = owned (runFilter (BitmapFilter::Standard::kScaleLinear, bitmap, false, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 32, 16));
+		}));
+		EXPECT (result->getWidth () == 32);
+		EXPECT (result->getHeight () == 16);
+		auto src = owned (CBitmapPixelAccess::create (bitmap));
+		auto dst = owned (CBitmapPixelAccess::create (result));
+		uint32_t v1;
+		uint32_t v2;
+		do
+		{
+			src->setPosition (dst->getX () / 2, dst->getY () / 2);
+			src->getValue (v1);
+			dst->getValue (v2);
+			EXPECT (v1 == v2);
+		} while (++(*dst));
+	);
+
+	TEST(scaleBilinearMatchesPixelByPixelImplementation,
+		auto bitmap = createTestBitmap (23, 17, 6);
+		for (auto& size : kScaleTestSizes)
+		{
+			auto result = owned (runFilter (BitmapFilter::Standard::kScaleBilinear, bitmap, false, [&] (BitmapFilter::IFilter* f) {
+				f->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, size[0], size[1]));
+			}));
+			auto reference = owned (new CBitmap (size[0], size[1]));
+			{
+				auto src = owned (CBitmapPixelAccess::create (bitmap));
+				auto dst = owned (CBitmapPixelAccess::create (reference));
+				referenceScaleBilinear (*src, *dst);
+			}
+			EXPECT (getPixels (result) == getPixels (reference));
+		}
+	);
+
+	TEST(scaleAreaAveragesCoveredPixels,
+		auto bitmap = createTestBitmap (16, 8, 9);
+		auto result = owned (runFilter (BitmapFilter::Standard::kScaleArea, bitmap, false, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 8, 4));
+		}));
+		EXPECT (result->getWidth () == 8);
+		EXPECT (result->getHeight () == 4);
+		auto src = owned (CBitmapPixelAccess::create (bitmap));
+		auto dst = owned (CBitmapPixelAccess::create (result));
+		do
+		{
+			uint32_t values[4];
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				src->setPosition (dst->getX () * 2 + (i & 1), dst->getY () * 2 + i / 2);
+				src->getValue (values[i]);
+			}
+			uint32_t expected = 0;
+			for (uint32_t shift = 0; shift < 32; shift += 8)
+			{
+				uint32_t sum = 0;
+				for (auto value : values)
+					sum += (value >> shift) & 0xFF;
+				expected |= ((sum + 2) / 4) << shift;
+			}
+			uint32_t value;
+			dst->getValue (value);
+			EXPECT (value == expected);
+		} while (++(*dst));
+	);
+
+	TEST(scaleAreaUpscalingRepeatsPixels,
+		auto bitmap = createTestBitmap (9, 7, 10);
+		auto result = owned (runFilter (BitmapFilter::Standard::kScaleArea, bitmap, false, [] (BitmapFilter::IFilter* f) {
+			f->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 27, 14));
+		}));
+		auto src = owned (CBitmapPixelAccess::create (bitmap));
+		auto dst = owned (CBitmapPixelAccess::create (result));
+		uint32_t v1;
+		uint32_t v2;
+		do
+		{
+			src->setPosition (dst->getX () / 3, dst->getY () / 2);
+			src->getValue (v1);
+			dst->getValue (v2);
+			EXPECT (v1 == v2);
+		} while (++(*dst));
+	);
+
+	TEST(multiThreadedMatchesSingleThreaded,
+		for (auto threadCount : {0, 2, 5})
+		{
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kBoxBlur, threadCount, true, setBoxBlurTestRadius));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kBoxBlur, threadCount, false, setBoxBlurTestRadius));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kGrayscale, threadCount, true));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kSetColor, threadCount, false));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kReplaceColor, threadCount, false));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kScaleLinear, threadCount, false, setScaleTestSize));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kScaleBilinear, threadCount, false, setScaleTestSize));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kScaleArea, threadCount, false, setScaleTestSize));
+			EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kScaleArea, threadCount, false, setScaleDownTestSize));
+		}
+	);
+
+	TEST(filtersRunAfterWorkerThreadsAreStopped,
+		BitmapFilter::Standard::stopWorkerThreads ();
+		EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kGrayscale, 4, true));
+		BitmapFilter::Standard::stopWorkerThreads ();
+		BitmapFilter::Standard::stopWorkerThreads ();
+		EXPECT (threadCountDoesNotChangeResult (BitmapFilter::Standard::kBoxBlur, 4, false, setBoxBlurTestRadius));
+	);
+
+	TEST(outputBitmapIsUpdatedOnEveryRun,
+		auto bitmap = createTestBitmap (5, 5, 11);
+		auto filter = owned (BitmapFilter::Factory::getInstance ().createFilter (BitmapFilter::Standard::kGrayscale));
+		filter->setProperty (BitmapFilter::Standard::Property::kInputBitmap, BitmapFilter::Property (bitmap));
+		EXPECT (filter->run ());
+		auto output1 = filter->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ();
+		EXPECT (filter->run ());
+		auto output2 = filter->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ();
+		EXPECT (output1 != output2);
+	);
+
+	TEST(pipelineMatchesFiltersOneByOne,
+		EXPECT (pipelineMatchesFiltersOneByOne (false, false));
+		EXPECT (pipelineMatchesFiltersOneByOne (false, true));
+		EXPECT (pipelineMatchesFiltersOneByOne (true, false));
+		EXPECT (pipelineMatchesFiltersOneByOne (true, true));
+	);
+
+	TEST(pipelineWithoutFilters,
+		auto input = createTestBitmap (3, 3, 9);
+		BitmapFilter::Pipeline pipeline;
+		EXPECT (pipeline.run (input));
+		EXPECT (pipeline.getOutputBitmap () == input);
+		EXPECT (pipeline.run (nullptr) == false);
+		EXPECT (pipeline.getOutputBitmap () == nullptr);
+	);
+
+	TEST(pipelineFailsOnInvalidFilterProperties,
+		auto input = createTestBitmap (3, 3, 10);
+		BitmapFilter::Pipeline pipeline;
+		pipeline.addFilter (BitmapFilter::Standard::kScaleLinear)->setProperty (BitmapFilter::Standard::Property::kOutputRect, CRect (0, 0, 0, 0));
+		EXPECT (pipeline.run (input) == false);
+		EXPECT (pipeline.getOutputBitmap () == nullptr);
+	);
+);
+
+} // VSTGUI
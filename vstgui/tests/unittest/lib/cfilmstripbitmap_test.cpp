@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "../../../lib/cfilmstripbitmap.h"
+#include "../../../lib/ccolor.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../unittests.h"
+#include "bitmap_helper.h"
+#include <vector>
+
+namespace VSTGUI {
+
+namespace {
+
+using UnitTest::getPixels;
+
+//------------------------------------------------------------------------
+// a knob like strip: a constant background with an indicator moving from frame to frame
+SharedPointer<IPlatformBitmap> createKnobStrip (uint32_t size, uint32_t numFrames, double scaleFactor)
+{
+	auto bitmap = UnitTest::createBitmap (size, size * numFrames, [size] (uint32_t x, uint32_t stripY) {
+		auto frame = stripY / size;
+		auto y = stripY % size;
+		if (x == (frame * 3) % size && y < size / 2)
+			return kWhiteCColor;
+		if (x > 2 && y > 2 && x < size - 2 && y < size - 2)
+			return CColor (50, 60, static_cast<uint8_t> (x + y), 255);
+		return CColor (0, 0, 0, 0);
+	}, scaleFactor);
+	return bitmap->getPlatformBitmap ();
+}
+
+//------------------------------------------------------------------------
+bool framesMatchStrip (CFilmstripBitmap& filmstrip, IPlatformBitmap* strip, const std::vector<uint32_t>& order)
+{
+	auto frameHeight = static_cast<uint32_t> (strip->getSize ().y) / filmstrip.getNumFrames ();
+	for (auto index : order)
+	{
+		auto frame = filmstrip.getFrame (index);
+		if (frame == nullptr || frame->getPlatformBitmap ()->getScaleFactor () != strip->getScaleFactor ())
+			return false;
+		if (getPixels (frame->getPlatformBitmap ()) != UnitTest::getPixelRows (strip, index * frameHeight, frameHeight))
+			return false;
+	}
+	return true;
+}
+
+} // anonymous
+
+TESTCASE(CFilmstripBitmapTest,
+
+	TEST(size,
+		auto strip = createKnobStrip (20, 12, 2.);
+		CFilmstripBitmap filmstrip (strip, 12);
+		EXPECT (filmstrip.getNumFrames () == 12);
+		EXPECT (filmstrip.getWidth () == 10.);
+		EXPECT (filmstrip.getHeight () == 120.);
+		EXPECT (filmstrip.getFrameHeight () == 10.);
+		EXPECT (filmstrip.getPlatformBitmap () == nullptr);
+		EXPECT (filmstrip.getFrame (12) == nullptr);
+		auto frame = filmstrip.getFrame (3);
+		EXPECT (frame->getWidth () == 10.);
+		EXPECT (frame->getHeight () == 10.);
+	);
+
+	TEST(framesMatchTheStrip,
+		auto strip = createKnobStrip (24, 20, 1.);
+		CFilmstripBitmap filmstrip (strip, 20);
+		EXPECT (framesMatchStrip (filmstrip, strip, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19}));
+		filmstrip.releaseDecodedFrames ();
+		EXPECT (framesMatchStrip (filmstrip, strip, {19, 3, 11, 9, 7, 8, 0, 15, 16, 14}));
+	);
+
+	TEST(incompressibleFramesMatchTheStrip,
+		SharedPointer<IPlatformBitmap> strip = UnitTest::createTestBitmap (13, 7 * 9, 1)->getPlatformBitmap ();
+		CFilmstripBitmap filmstrip (strip, 9);
+		EXPECT (framesMatchStrip (filmstrip, strip, {8, 0, 1, 4, 2, 7}));
+	);
+
+	TEST(compressedSize,
+		auto strip = createKnobStrip (64, 32, 1.);
+		CFilmstripBitmap filmstrip (strip, 32);
+		EXPECT (filmstrip.getCompressedSize () * 4 < 64 * 64 * 32 * 4);
+		EXPECT (filmstrip.getDecodedSize () == 0);
+	);
+
+	TEST(decodedFramesAreLimited,
+		auto strip = createKnobStrip (16, 10, 1.);
+		CFilmstripBitmap filmstrip (strip, 10);
+		filmstrip.setMaxDecodedFrames (2);
+		SharedPointer<CBitmap> first = filmstrip.getFrame (0);
+		EXPECT (filmstrip.getFrame (0) == first);
+		filmstrip.getFrame (1);
+		filmstrip.getFrame (2);
+		EXPECT (filmstrip.getDecodedSize () == 3 * 16 * 16 * 4);
+		EXPECT (filmstrip.getFrame (0) != first);
+		filmstrip.releaseDecodedFrames ();
+		EXPECT (filmstrip.getDecodedSize () == 0);
+	);
+
+	TEST(decodeAllFrames,
+		auto strip = createKnobStrip (16, 17, 1.);
+		CFilmstripBitmap filmstrip (strip, 17);
+		auto decoded = owned (filmstrip.decodeAllFrames ());
+		EXPECT (decoded->getSize () == strip->getSize ());
+		EXPECT (getPixels (decoded) == getPixels (strip));
+	);
+);
+
+} // VSTGUI
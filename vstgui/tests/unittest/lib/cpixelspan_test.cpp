@@ -0,0 +1,264 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "../unittests.h"
+#include "../../../lib/cpixelspan.h"
+#include "../../../lib/cbitmap.h"
+#include "../../../lib/ccolor.h"
+#include <vector>
+
+namespace VSTGUI {
+
+namespace {
+
+// not a multiple of the SIMD width, so that the scalar tail is tested, too
+const uint32_t kNumTestPixels = 71;
+const PixelSpan::Format kFormats[] = {PixelSpan::kARGB, PixelSpan::kRGBA, PixelSpan::kABGR, PixelSpan::kBGRA};
+
+//------------------------------------------------------------------------
+std::vector<CColor> createTestColors (uint32_t seed, bool premultiplied)
+{
+	std::vector<CColor> colors;
+	for (uint32_t i = 0; i < kNumTestPixels; ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		CColor c (static_cast<uint8_t> (seed >> 24), static_cast<uint8_t> (seed >> 16), static_cast<uint8_t> (seed >> 8), static_cast<uint8_t> (seed));
+		if (i % 9 == 0)
+			c.alpha = 0;
+		else if (i % 9 == 1)
+			c.alpha = 255;
+		if (premultiplied)
+		{
+			c.red = std::min (c.red, c.alpha);
+			c.green = std::min (c.green, c.alpha);
+			c.blue = std::min (c.blue, c.alpha);
+		}
+		colors.push_back (c);
+	}
+	return colors;
+}
+
+//------------------------------------------------------------------------
+std::vector<uint32_t> toPixels (const std::vector<CColor>& colors, PixelSpan::Format format)
+{
+	std::vector<uint32_t> pixels;
+	for (auto& c : colors)
+		pixels.push_back (PixelSpan::makePixel (c, format));
+	return pixels;
+}
+
+//------------------------------------------------------------------------
+uint8_t roundedMulDiv255 (uint32_t a, uint32_t b)
+{
+	return static_cast<uint8_t> ((a * b * 2 + 255) / 510);
+}
+
+//------------------------------------------------------------------------
+CColor referencePremultiply (CColor c)
+{
+	c.red = roundedMulDiv255 (c.red, c.alpha);
+	c.green = roundedMulDiv255 (c.green, c.alpha);
+	c.blue = roundedMulDiv255 (c.blue, c.alpha);
+	return c;
+}
+
+//------------------------------------------------------------------------
+uint8_t referenceUnpremultiply (uint32_t value, uint32_t alpha)
+{
+	return static_cast<uint8_t> (std::min<uint32_t> (255, (value * 255 + alpha / 2) / alpha));
+}
+
+//------------------------------------------------------------------------
+CColor referenceUnpremultiply (CColor c)
+{
+	if (c.alpha == 0)
+		return c;
+	c.red = referenceUnpremultiply (c.red, c.alpha);
+	c.green = referenceUnpremultiply (c.green, c.alpha);
+	c.blue = referenceUnpremultiply (c.blue, c.alpha);
+	return c;
+}
+
+//------------------------------------------------------------------------
+uint8_t referenceBlend (uint32_t src, uint32_t dst, uint32_t srcAlpha)
+{
+	return static_cast<uint8_t> (std::min<uint32_t> (255, src + roundedMulDiv255 (dst, 255 - srcAlpha)));
+}
+
+//------------------------------------------------------------------------
+CColor referenceBlend (CColor src, CColor dst, uint8_t alpha)
+{
+	src.red = roundedMulDiv255 (src.red, alpha);
+	src.green = roundedMulDiv255 (src.green, alpha);
+	src.blue = roundedMulDiv255 (src.blue, alpha);
+	src.alpha = roundedMulDiv255 (src.alpha, alpha);
+	dst.red = referenceBlend (src.red, dst.red, src.alpha);
+	dst.green = referenceBlend (src.green, dst.green, src.alpha);
+	dst.blue = referenceBlend (src.blue, dst.blue, src.alpha);
+	dst.alpha = referenceBlend (src.alpha, dst.alpha, src.alpha);
+	return dst;
+}
+
+//------------------------------------------------------------------------
+bool pixelsMatch (const std::vector<uint32_t>& pixels, const std::vector<CColor>& colors, PixelSpan::Format format)
+{
+	for (uint32_t i = 0; i < pixels.size (); ++i)
+	{
+		if (PixelSpan::getColor (pixels[i], format) != colors[i])
+			return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------
+bool testPremultiply (PixelSpan::Format format)
+{
+	auto colors = createTestColors (1, false);
+	auto pixels = toPixels (colors, format);
+	PixelSpan::premultiply (pixels.data (), pixels.data (), kNumTestPixels, format);
+	for (auto& c : colors)
+		c = referencePremultiply (c);
+	return pixelsMatch (pixels, colors, format);
+}
+
+//------------------------------------------------------------------------
+bool testUnpremultiply (PixelSpan::Format format)
+{
+	auto colors = createTestColors (2, true);
+	auto pixels = toPixels (colors, format);
+	std::vector<uint32_t> result (kNumTestPixels);
+	PixelSpan::unpremultiply (pixels.data (), result.data (), kNumTestPixels, format);
+	for (auto& c : colors)
+		c = referenceUnpremultiply (c);
+	return pixelsMatch (result, colors, format);
+}
+
+//------------------------------------------------------------------------
+bool testBlend (PixelSpan::Format format, uint8_t alpha)
+{
+	auto srcColors = createTestColors (3, true);
+	auto dstColors = createTestColors (4, true);
+	auto src = toPixels (srcColors, format);
+	auto dst = toPixels (dstColors, format);
+	PixelSpan::blend (src.data (), dst.data (), kNumTestPixels, format, alpha);
+	for (uint32_t i = 0; i < kNumTestPixels; ++i)
+		dstColors[i] = referenceBlend (srcColors[i], dstColors[i], alpha);
+	return pixelsMatch (dst, dstColors, format);
+}
+
+//------------------------------------------------------------------------
+bool testConvert (PixelSpan::Format srcFormat, PixelSpan::Format dstFormat)
+{
+	auto colors = createTestColors (5, false);
+	auto pixels = toPixels (colors, srcFormat);
+	PixelSpan::convert (pixels.data (), pixels.data (), kNumTestPixels, srcFormat, dstFormat);
+	return pixelsMatch (pixels, colors, dstFormat);
+}
+
+} // anonymous
+
+TESTCASE(PixelSpanTest,
+
+	TEST(makePixel,
+		EXPECT (PixelSpan::makePixel (CColor (1, 2, 3, 4), PixelSpan::kRGBA) == PixelSpan::makePixel (CColor (4, 3, 2, 1), PixelSpan::kABGR));
+		EXPECT (PixelSpan::makePixel (CColor (1, 2, 3, 4), PixelSpan::kARGB) == PixelSpan::makePixel (CColor (2, 1, 4, 3), PixelSpan::kBGRA));
+		for (auto format : kFormats)
+			EXPECT (PixelSpan::getColor (PixelSpan::makePixel (CColor (1, 2, 3, 4), format), format) == CColor (1, 2, 3, 4));
+	);
+
+	TEST(fillAndCopy,
+		std::vector<uint32_t> pixels (kNumTestPixels);
+		PixelSpan::fill (pixels.data (), kNumTestPixels, 0x12345678);
+		EXPECT (pixels == std::vector<uint32_t> (kNumTestPixels, 0x12345678));
+		std::vector<uint32_t> copy (kNumTestPixels);
+		PixelSpan::copy (pixels.data (), copy.data (), kNumTestPixels);
+		EXPECT (copy == pixels);
+	);
+
+	TEST(convert,
+		for (auto srcFormat : kFormats)
+		{
+			for (auto dstFormat : kFormats)
+				EXPECT (testConvert (srcFormat, dstFormat));
+		}
+	);
+
+	TEST(premultiply,
+		for (auto format : kFormats)
+			EXPECT (testPremultiply (format));
+	);
+
+	TEST(unpremultiply,
+		for (auto format : kFormats)
+			EXPECT (testUnpremultiply (format));
+	);
+
+	TEST(unpremultiplyRestoresOpaquePixels,
+		auto colors = createTestColors (6, false);
+		for (auto& c : colors)
+			c.alpha = 255;
+		auto pixels = toPixels (colors, PixelSpan::kBGRA);
+		auto original = pixels;
+		PixelSpan::premultiply (pixels.data (), pixels.data (), kNumTestPixels, PixelSpan::kBGRA);
+		PixelSpan::unpremultiply (pixels.data (), pixels.data (), kNumTestPixels, PixelSpan::kBGRA);
+		EXPECT (pixels == original);
+	);
+
+	TEST(blend,
+		for (auto format : kFormats)
+		{
+			EXPECT (testBlend (format, 255));
+			EXPECT (testBlend (format, 100));
+		}
+	);
+
+	TEST(bitmapRowAccess,
+		auto bitmap = owned (new CBitmap (13, 5));
+		auto accessor = owned (CBitmapPixelAccess::create (bitmap));
+		EXPECT (accessor->isAlphaPremultiplied ());
+		uint32_t pixel = PixelSpan::makePixel (CColor (10, 20, 30, 40), accessor->getPixelFormat ());
+		PixelSpan::fill (accessor->getRow (3), accessor->getBitmapWidth (), pixel);
+		accessor->setPosition (12, 3);
+		CColor color;
+		accessor->getColor (color);
+		EXPECT (color == CColor (10, 20, 30, 40));
+		accessor->setPosition (0, 4);
+		uint32_t value;
+		accessor->getValue (value);
+		EXPECT (value != pixel);
+	);
+);
+
+} // VSTGUI
@@ -0,0 +1,196 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+
+#include "../../../lib/cresourcepack.h"
+#include "../../../lib/cbitmap.h"
+#include "../../../lib/cbitmapcodec.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../unittests.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace VSTGUI {
+
+namespace {
+
+//------------------------------------------------------------------------
+std::vector<uint8_t> createPack (bool withDuplicate = false)
+{
+	static const uint8_t pngData[] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A, 1, 2, 3};
+	static const char xmlData[] = "<?xml version=\"1.0\"?><vstgui-ui-description/>";
+	static const char textData[] = "some data";
+	CResourcePack::Writer writer;
+	writer.add ("zebra.txt", textData, sizeof (textData) - 1);
+	writer.add ("knob#2x.png", pngData, sizeof (pngData));
+	writer.add ("editor.uidesc", xmlData, sizeof (xmlData) - 1);
+	writer.add ("background.png", pngData, sizeof (pngData), CResourcePack::kCodecData, 1.5);
+	if (withDuplicate)
+		writer.add ("editor.uidesc", xmlData, sizeof (xmlData) - 1);
+	std::vector<uint8_t> result;
+	if (!writer.write (result))
+		result.clear ();
+	return result;
+}
+
+//------------------------------------------------------------------------
+bool entryEquals (const CResourcePack::Entry* entry, const void* data, uint32_t size)
+{
+	return entry && entry->size == size && std::memcmp (entry->data, data, size) == 0;
+}
+
+//------------------------------------------------------------------------
+std::vector<uint8_t> createQOIData (uint32_t width, uint32_t height)
+{
+	CPoint size (width, height);
+	auto platformBitmap = owned (IPlatformBitmap::create (&size));
+	void* data = nullptr;
+	uint32_t dataSize = 0;
+	std::vector<uint8_t> result;
+	if (BitmapCodec::createMemoryRepresentation (platformBitmap, BitmapCodec::kQOI, &data, dataSize))
+	{
+		result.assign (static_cast<uint8_t*> (data), static_cast<uint8_t*> (data) + dataSize);
+		std::free (data);
+	}
+	return result;
+}
+
+} // anonymous
+
+TESTCASE(CResourcePackTest,
+
+	TEST(writeAndFind,
+		auto data = createPack ();
+		EXPECT(data.empty () == false);
+		auto pack = owned (CResourcePack::openFromMemory (data.data (), static_cast<uint32_t> (data.size ())));
+		EXPECT(pack);
+		EXPECT(pack->getNumEntries () == 4);
+		EXPECT(std::strcmp (pack->getEntry (0).name, "background.png") == 0);
+		EXPECT(std::strcmp (pack->getEntry (3).name, "zebra.txt") == 0);
+		EXPECT(entryEquals (pack->find ("zebra.txt"), "some data", 9));
+		EXPECT(pack->find ("zebra.txt")->codec == CResourcePack::kCodecData);
+		EXPECT(pack->find ("knob#2x.png")->codec == CResourcePack::kCodecPNG);
+		EXPECT(pack->find ("knob#2x.png")->scaleFactor == 2.);
+		EXPECT(pack->find ("editor.uidesc")->codec == CResourcePack::kCodecXML);
+		EXPECT(pack->find ("editor.uidesc")->scaleFactor == 1.);
+		EXPECT(pack->find ("background.png")->codec == CResourcePack::kCodecData);
+		EXPECT(pack->find ("background.png")->scaleFactor == 1.5);
+		EXPECT(pack->find ("knob.png") == nullptr);
+		EXPECT(pack->find ("") == nullptr);
+		EXPECT(pack->find (nullptr) == nullptr);
+	);
+
+	TEST(entriesPointIntoTheData,
+		auto data = createPack ();
+		auto pack = owned (CResourcePack::openFromMemory (data.data (), static_cast<uint32_t> (data.size ())));
+		for (uint32_t i = 0; i < pack->getNumEntries (); i++)
+		{
+			auto& entry = pack->getEntry (i);
+			auto offset = static_cast<const uint8_t*> (entry.data) - data.data ();
+			EXPECT(offset > 0);
+			EXPECT(offset % 16 == 0);
+			EXPECT(offset + entry.size <= data.size ());
+		}
+	);
+
+	TEST(duplicateNamesFail,
+		EXPECT(createPack (true).empty ());
+	);
+
+	TEST(invalidData,
+		auto data = createPack ();
+		EXPECT(CResourcePack::openFromMemory (data.data (), 15) == nullptr);
+		EXPECT(CResourcePack::openFromMemory (nullptr, 0) == nullptr);
+		auto truncated = owned (CResourcePack::openFromMemory (data.data (), static_cast<uint32_t> (data.size () - 1)));
+		EXPECT(truncated == nullptr);
+		auto corrupted = data;
+		corrupted[0] = 'X';
+		EXPECT(CResourcePack::openFromMemory (corrupted.data (), static_cast<uint32_t> (corrupted.size ())) == nullptr);
+		corrupted = data;
+		corrupted[16] = 0xFF; // offset of the first entry
+		corrupted[19] = 0xFF;
+		EXPECT(CResourcePack::openFromMemory (corrupted.data (), static_cast<uint32_t> (corrupted.size ())) == nullptr);
+	);
+
+	TEST(emptyPack,
+		CResourcePack::Writer writer;
+		std::vector<uint8_t> data;
+		EXPECT(writer.write (data));
+		auto pack = owned (CResourcePack::openFromMemory (data.data (), static_cast<uint32_t> (data.size ())));
+		EXPECT(pack);
+		EXPECT(pack->getNumEntries () == 0);
+		EXPECT(pack->find ("a") == nullptr);
+	);
+
+	TEST(mapFile,
+		const char* path = "cresourcepack_test.vgrp";
+		auto data = createPack ();
+		CResourcePack::Writer writer;
+		writer.add ("a", data.data (), static_cast<uint32_t> (data.size ()));
+		EXPECT(writer.write (path));
+		CResourcePack::Writer fileWriter;
+		EXPECT(fileWriter.addFile ("pack", path));
+		EXPECT(fileWriter.addFile ("missing", "cresourcepack_test_missing.vgrp") == false);
+		EXPECT(fileWriter.getNumEntries () == 1);
+		auto pack = owned (CResourcePack::open (path));
+		std::remove (path);
+		EXPECT(pack);
+		EXPECT(entryEquals (pack->find ("a"), data.data (), static_cast<uint32_t> (data.size ())));
+		EXPECT(CResourcePack::open ("cresourcepack_test_missing.vgrp") == nullptr);
+	);
+
+	TEST(createBitmap,
+		auto qoiData = createQOIData (8, 6);
+		EXPECT(qoiData.empty () == false);
+		CResourcePack::Writer writer;
+		writer.add ("knob#2x.qoi", qoiData.data (), static_cast<uint32_t> (qoiData.size ()));
+		writer.add ("editor.uidesc", "<?xml", 5);
+		std::vector<uint8_t> data;
+		EXPECT(writer.write (data));
+		auto pack = owned (CResourcePack::openFromMemory (data.data (), static_cast<uint32_t> (data.size ())));
+		EXPECT(pack->find ("knob#2x.qoi")->codec == CResourcePack::kCodecQOI);
+		auto platformBitmap = owned (pack->createBitmap ("knob#2x.qoi"));
+		EXPECT(platformBitmap);
+		EXPECT(platformBitmap->getSize () == CPoint (8, 6));
+		EXPECT(platformBitmap->getScaleFactor () == 2.);
+		EXPECT(pack->createBitmap ("editor.uidesc") == nullptr);
+		EXPECT(pack->createBitmap ("missing.qoi") == nullptr);
+	);
+
+);
+
+} // VSTGUI
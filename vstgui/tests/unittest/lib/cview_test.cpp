@@ -191,6 +191,17 @@ TESTCASE(CViewTest,
 		
 	);
 
+	TEST(copyAttributes,
+		auto v = owned (new CView (CRect (0, 0, 10, 10)));
+		uint64_t myAttr = 500;
+		EXPECT(v->setAttribute ('myAt', sizeof(myAttr), &myAttr));
+		auto copy = owned (static_cast<CView*> (v->newCopy ()));
+		uint32_t outSize;
+		myAttr = 0;
+		EXPECT(copy->getAttribute ('myAt', sizeof(myAttr), &myAttr, outSize));
+		EXPECT(myAttr == 500);
+	);
+
 	TEST(viewListener,
 		ViewListener listener;
 		{
@@ -35,6 +35,7 @@
 #include "../unittests.h"
 #include "../../../uidescription/base64codec.h"
 #include <string>
+#include <algorithm>
 
 namespace VSTGUI {
 
@@ -103,6 +104,29 @@ TESTCASE(Base64CodecTest,
 		 EXPECT (ptr[4] == 0x0D);
 		 EXPECT (ptr[5] == 0x0A);
 	);
+
+	TEST(decodeInPieces,
+		 std::string test ("iVBO\n\t Rw0KAAEC\r\nAwQF\nBgc=");
+		 uint8_t output[32];
+		 Base64Decoder decoder;
+		 uint32_t size = 0;
+		 for (size_t pos = 0; pos < test.size (); pos += 5)
+		 {
+			 uint32_t length = static_cast<uint32_t> (std::min<size_t> (5, test.size () - pos));
+			 EXPECT (size + Base64Decoder::getMaxDecodedSize (length) <= sizeof (output));
+			 size += decoder.decode (test.c_str () + pos, length, output + size);
+		 }
+		 EXPECT (size == 14);
+		 std::string expected ("\x89\x50\x4E\x47\x0D\x0A\x00\x01\x02\x03\x04\x05\x06\x07", 14);
+		 EXPECT (std::string (reinterpret_cast<const char*> (output), size) == expected);
+	);
+
+	TEST(decodeStopsAtPadding,
+		 std::string test ("QUJDRA==QUJD");
+		 Base64Codec bd;
+		 EXPECT (bd.init (test) == true)
+		 EXPECT (bd.getDataSize () == 4);
+	);
 );
 
 }
@@ -41,6 +41,7 @@
 namespace VSTGUI {
 
 static UTF8StringPtr attributes [] = {"K1", "V1", "K2", "V2", nullptr};
+static UTF8StringPtr duplicateAttributes [] = {"K2", "V2", "K1", "V1", "K2", "V3", nullptr};
 
 TESTCASE(UIAttributesTest,
 
@@ -135,6 +136,67 @@ TESTCASE(UIAttributesTest,
 		EXPECT(a.begin () == a.end ());
 	);
 	
+	TEST(sharedStorage,
+		UIAttributes a (attributes);
+		UIAttributes b (attributes);
+		EXPECT(a.size () == 2);
+		EXPECT(a.begin () == b.begin ());
+		EXPECT(a.getAttributeValue ("K1") == b.getAttributeValue ("K1"));
+		// the value is kept while attributes use it
+		UIAttributes saved (a);
+		auto value = a.getAttributeValue ("K2");
+		b.setAttribute ("K2", "V3");
+		EXPECT(a.begin () != b.begin ());
+		EXPECT(*a.getAttributeValue ("K2") == "V2");
+		EXPECT(*b.getAttributeValue ("K2") == "V3");
+		a.setAttribute ("K2", "V3");
+		EXPECT(a.begin () == b.begin ());
+		EXPECT(*value == "V2");
+		UIAttributes c (a);
+		EXPECT(c.begin () == a.begin ());
+		c.removeAttribute ("K1");
+		EXPECT(c.size () == 1);
+		EXPECT(a.size () == 2);
+	);
+
+	TEST(duplicateNames,
+		UIAttributes a (duplicateAttributes);
+		EXPECT(a.size () == 2);
+		EXPECT(*a.getAttributeValue ("K2") == "V2");
+		EXPECT(a.begin ()->first == "K1");
+	);
+
+	TEST(parsedValues,
+		UIAttributes a;
+		a.setRectAttribute ("rect", CRect (10, 20, 30, 40));
+		UIAttributes b (a);
+		CRect r;
+		CPoint p;
+		EXPECT(a.getRectAttribute ("rect", r));
+		EXPECT(r == CRect (10, 20, 30, 40));
+		EXPECT(a.getPointAttribute ("rect", p) == false);
+		EXPECT(b.getRectAttribute ("rect", r));
+		EXPECT(r == CRect (10, 20, 30, 40));
+		a.setRectAttribute ("rect", CRect (1, 2, 3, 4));
+		EXPECT(a.getRectAttribute ("rect", r));
+		EXPECT(r == CRect (1, 2, 3, 4));
+		EXPECT(b.getRectAttribute ("rect", r));
+		EXPECT(r == CRect (10, 20, 30, 40));
+		a.setAttribute ("rect", "5, 6");
+		EXPECT(a.getRectAttribute ("rect", r) == false);
+		EXPECT(a.getPointAttribute ("rect", p));
+		EXPECT(p == CPoint (5, 6));
+		double d;
+		int32_t i;
+		a.setAttribute ("number", "12.5");
+		EXPECT(a.getDoubleAttribute ("number", d));
+		EXPECT(d == 12.5);
+		EXPECT(a.getIntegerAttribute ("number", i));
+		EXPECT(i == 12);
+		EXPECT(a.getDoubleAttribute ("number", d));
+		EXPECT(d == 12.5);
+	);
+
 	TEST(storeRestore,
 		UIAttributes a;
 		CMemoryStream s2;
@@ -40,11 +40,21 @@
 #include "../../../lib/ccolor.h"
 #include "../../../lib/cgradient.h"
 #include "../../../lib/cviewcontainer.h"
+#include "../../../lib/controls/ccontrol.h"
+#include "../../../lib/cbitmapatlas.h"
+#include "../../../lib/cbitmapcache.h"
+#include "../../../lib/cbitmapcodec.h"
+#include "../../../lib/cresourcepack.h"
+#include "../../../uidescription/base64codec.h"
+#include "../../../lib/platform/iplatformbitmap.h"
+#include "../lib/bitmap_helper.h"
 
 namespace VSTGUI {
 
 namespace {
 
+using UnitTest::getPixels;
+
 constexpr auto emptyUIDesc = R"(
 <vstgui-ui-description version="1">
 </vstgui-ui-description>
@@ -84,6 +94,19 @@ constexpr auto bitmapNodesUIDesc = R"(
 </vstgui-ui-description>
 )";
 
+constexpr auto bitmapDataUIDesc = R"(
+<vstgui-ui-description version="1">
+	<bitmaps>
+		<bitmap name="b1" path="b1.png">
+			<data encoding="base64">
+				AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKiss
+				LS4vMDEyMzQ1Njc4OTo7PD0+P0BBQkNERUZHSElKS0xNTk9QUVJTVFVWV1hZ
+			</data>
+		</bitmap>
+	</bitmaps>
+</vstgui-ui-description>
+)";
+
 constexpr auto tagNodesUIDesc = R"(
 <vstgui-ui-description version="1">
 	<control-tags>
@@ -167,12 +190,70 @@ constexpr auto withAllNodesUIDesc = R"(<?xml version="1.0" encoding="UTF-8"?>
 </vstgui-ui-description>
 )";
 
+struct NotSeekableInputStream : public InputStream
+{
+	NotSeekableInputStream (const std::string& data) : data (data) {}
+
+	bool operator>> (std::string& string) override { return false; }
+	uint32_t readRaw (void* buffer, uint32_t size) override
+	{
+		size = std::min (size, static_cast<uint32_t> (data.size () - pos));
+		memcpy (buffer, data.data () + pos, size);
+		pos += size;
+		return size;
+	}
+
+	std::string data;
+	size_t pos {0};
+};
+
 struct SaveUIDescription : public UIDescription
 {
 	SaveUIDescription (Xml::IContentProvider* xmlContentProvider)
 	: UIDescription (xmlContentProvider) {}
 
 	using UIDescription::saveToStream;
+	using UIDescription::saveSections;
+};
+
+static std::string saveToString (SaveUIDescription& desc)
+{
+	CMemoryStream outputStream (1024, 1024, false);
+	EXPECT(desc.saveToStream (outputStream, SaveUIDescription::kWriteImagesIntoXMLFile));
+	outputStream.end ();
+	return std::string (reinterpret_cast<const char*> (outputStream.getBuffer ()));
+}
+
+struct SectionUIDescription : public SaveUIDescription
+{
+	SectionUIDescription () : SaveUIDescription (nullptr) {}
+
+	bool parse () override
+	{
+		createRootNode (rootAttributes);
+		for (uint32_t i = 0; i < sections.size (); ++i)
+		{
+			if (sections[i].templateAttributes)
+				addDeferredTemplate (*sections[i].templateAttributes, i);
+			else if (!parseSection (sections[i].xml))
+				return false;
+		}
+		completeParsing ();
+		return true;
+	}
+
+	bool readDeferredTemplate (uint32_t sectionIndex, std::string& xml) const override
+	{
+		numReadTemplates++;
+		xml = sections[sectionIndex].xml;
+		return true;
+	}
+
+	using UIDescription::SectionList;
+
+	UIAttributes rootAttributes;
+	SectionList sections;
+	mutable uint32_t numReadTemplates {0};
 };
 
 struct Controller : public IController
@@ -209,6 +290,74 @@ constexpr auto createViewUIDesc = R"(
 </vstgui-ui-description>
 )";
 
+constexpr auto templateReferenceUIDesc = R"(
+<vstgui-ui-description version="1">
+	<template class="CViewContainer" name="inner" origin="0, 0" size="20, 20">
+		<view class="CView" origin="0, 0" size="10, 10"/>
+	</template>
+	<template class="CViewContainer" name="outer" origin="0, 0" size="100, 100">
+		<view template="inner" origin="5, 5"/>
+		<attribute id="tatr" value="test"/>
+	</template>
+</vstgui-ui-description>
+)";
+
+struct PrototypeController : public Controller
+{
+	uint32_t numVerifiedViews {0};
+
+	CView* verifyView (CView* view, const UIAttributes& attributes, const IUIDescription* description) override
+	{
+		++numVerifiedViews;
+		return view;
+	}
+	IController* createSubController (UTF8StringPtr name, const IUIDescription* description) override
+	{
+		return new PrototypeController;
+	}
+};
+
+constexpr auto prototypeUIDesc = R"(
+<vstgui-ui-description version="1">
+	<control-tags>
+		<control-tag name="tag1" tag="42"/>
+	</control-tags>
+	<template class="CViewContainer" name="row" origin="0, 0" size="100, 20">
+		<view class="CTextButton" control-tag="tag1" origin="0, 0" size="20, 20"/>
+		<view class="CViewContainer" origin="20, 0" size="80, 20" sub-controller="sub">
+			<view class="CTextButton" control-tag="tag1" origin="0, 0" size="20, 20"/>
+		</view>
+	</template>
+</vstgui-ui-description>
+)";
+
+struct CustomViewController : public Controller
+{
+	uint32_t numCustomViews {0};
+
+	CView* createView (const UIAttributes& attributes, const IUIDescription* description) override
+	{
+		auto name = attributes.getAttributeValue (IUIDescription::kCustomViewName);
+		if (name == nullptr || *name != "custom")
+			return nullptr;
+		++numCustomViews;
+		auto view = new CView (CRect (0, 0, 10, 10));
+		view->setAttribute ('cust', sizeof (numCustomViews), &numCustomViews);
+		return view;
+	}
+};
+
+constexpr auto customViewUIDesc = R"(
+<vstgui-ui-description version="1">
+	<template class="CViewContainer" name="inner" origin="0, 0" size="100, 20">
+		<view class="CView" custom-view-name="custom" origin="0, 0" size="20, 20"/>
+	</template>
+	<template class="CViewContainer" name="outer" origin="0, 0" size="100, 20">
+		<view template="inner" origin="0, 0" size="100, 20"/>
+	</template>
+</vstgui-ui-description>
+)";
+
 constexpr auto restoreViewUIDesc = R"(
 <vstgui-ui-description version="1">
 	<template background-color="~ TransparentCColor" background-color-draw-style="filled and stroked" class="CViewContainer" mouse-enabled="true" name="view" opacity="1" origin="0, 0" size="400, 235" transparent="false">
@@ -302,6 +451,82 @@ constexpr auto completeExample = R"(
 </vstgui-ui-description>
 )";
 
+//-----------------------------------------------------------------------------
+class TestBitmapCreator : public IBitmapCreator
+{
+public:
+	IPlatformBitmap* createBitmap (const UIAttributes& attributes) override
+	{
+		double scaleFactor = 1.;
+		attributes.getDoubleAttribute ("scale-factor", scaleFactor);
+		CPoint size (10. * scaleFactor, 10. * scaleFactor);
+		IPlatformBitmap* platformBitmap = IPlatformBitmap::create (&size);
+		platformBitmap->setScaleFactor (scaleFactor);
+		++numCreated;
+		return platformBitmap;
+	}
+
+	int32_t numCreated {0};
+};
+
+//-----------------------------------------------------------------------------
+struct ScopedBitmapCacheBudget
+{
+	ScopedBitmapCacheBudget (uint64_t budget) : oldBudget (CBitmapCache::instance ().getBudget ())
+	{
+		CBitmapCache::instance ().setBudget (budget);
+	}
+	~ScopedBitmapCacheBudget () { CBitmapCache::instance ().setBudget (oldBudget); }
+
+	uint64_t oldBudget;
+};
+
+//-----------------------------------------------------------------------------
+std::vector<uint8_t> createQOIData (uint32_t width, uint32_t height)
+{
+	auto bitmap = UnitTest::createBitmap (width, height, [] (uint32_t x, uint32_t y) {
+		return CColor (static_cast<uint8_t> (x * 20), static_cast<uint8_t> (y * 40), 7, 255);
+	});
+	void* data;
+	uint32_t dataSize;
+	BitmapCodec::createMemoryRepresentation (bitmap->getPlatformBitmap (), BitmapCodec::kQOI, &data, dataSize);
+	std::vector<uint8_t> result (static_cast<uint8_t*> (data), static_cast<uint8_t*> (data) + dataSize);
+	std::free (data);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+std::string createQOIUIDesc (uint32_t width, uint32_t height)
+{
+	auto data = createQOIData (width, height);
+	Base64Codec codec;
+	codec.init (data.data (), static_cast<uint32_t> (data.size ()));
+	std::string result = "<vstgui-ui-description version=\"1\">\n\t<bitmaps>\n\t\t<bitmap name=\"b1\" path=\"b1.qoi\">\n\t\t\t<data encoding=\"base64\">";
+	result.append (reinterpret_cast<const char*> (codec.getData ()), codec.getDataSize ());
+	result += "</data>\n\t\t</bitmap>\n\t</bitmaps>\n</vstgui-ui-description>\n";
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+std::string createQOIBitmapNode (const std::string& name, uint32_t width, uint32_t height)
+{
+	auto data = createQOIData (width, height);
+	Base64Codec codec;
+	codec.init (data.data (), static_cast<uint32_t> (data.size ()));
+	std::string result = "\t\t<bitmap name=\"" + name + "\" path=\"" + name + ".qoi\">\n\t\t\t<data encoding=\"base64\">";
+	result.append (reinterpret_cast<const char*> (codec.getData ()), codec.getDataSize ());
+	result += "</data>\n\t\t</bitmap>\n";
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+void writeTextFile (const char* path, const char* text)
+{
+	FILE* file = fopen (path, "wb");
+	fwrite (text, 1, strlen (text), file);
+	fclose (file);
+}
+
 } // anonymous
 
 using StringPtrList = std::list<const std::string*>;
@@ -363,6 +588,23 @@ TESTCASE(UIDescriptionTests,
 		EXPECT(desc.getColor ("new color", c) == false);
 	);
 
+	TEST(lookupNamesAfterChanges,
+		Xml::MemoryContentProvider provider (colorNodesUIDesc, strlen(colorNodesUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		EXPECT(desc.lookupColorName (CColor (255, 0, 0, 100)) == std::string ("c3"));
+		EXPECT(desc.lookupColorName (CColor (1, 2, 3, 4)) == 0);
+		desc.changeColor ("c3", CColor (1, 2, 3, 4));
+		EXPECT(desc.lookupColorName (CColor (255, 0, 0, 100)) == 0);
+		EXPECT(desc.lookupColorName (CColor (1, 2, 3, 4)) == std::string ("c3"));
+		desc.changeColorName ("c3", "c0");
+		EXPECT(desc.lookupColorName (CColor (1, 2, 3, 4)) == std::string ("c0"));
+		desc.changeColor ("c6", CColor (1, 2, 3, 4));
+		EXPECT(desc.lookupColorName (CColor (1, 2, 3, 4)) == std::string ("c0"));
+		desc.removeColor ("c0");
+		EXPECT(desc.lookupColorName (CColor (1, 2, 3, 4)) == std::string ("c6"));
+	);
+
 	TEST(fonts,
 		Xml::MemoryContentProvider provider (fontNodesUIDesc, strlen(fontNodesUIDesc));
 		UIDescription desc (&provider);
@@ -447,7 +689,95 @@ TESTCASE(UIDescriptionTests,
 		bitmap = desc.getBitmap ("added bitmap node");
 		EXPECT(dynamic_cast<CNinePartTiledBitmap*>(bitmap) == nullptr);
 	);
-	
+
+	TEST(lookupBitmapNameAfterLoading,
+		Xml::MemoryContentProvider provider (bitmapNodesUIDesc, strlen(bitmapNodesUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		TestBitmapCreator creator;
+		desc.setBitmapCreator (&creator);
+		auto other = owned (new CBitmap (1, 1));
+		EXPECT(desc.lookupBitmapName (other) == 0);
+		auto bitmap = desc.getBitmap ("b1");
+		EXPECT(bitmap);
+		EXPECT(desc.lookupBitmapName (other) == 0);
+		EXPECT(desc.lookupBitmapName (bitmap) == std::string ("b1"));
+	);
+
+	TEST(bitmapScaleVariantIsReleasedWhenNotUsed,
+		ScopedBitmapCacheBudget budget (10 * 10 * 4);
+		Xml::MemoryContentProvider provider (bitmapNodesUIDesc, strlen(bitmapNodesUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		TestBitmapCreator creator;
+		desc.setBitmapCreator (&creator);
+		auto bitmap = desc.getBitmap ("b1");
+		EXPECT(bitmap);
+		EXPECT(creator.numCreated == 2);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (1.)->getScaleFactor () == 1.);
+		EXPECT(creator.numCreated == 2);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (2.)->getScaleFactor () == 2.);
+		EXPECT(creator.numCreated == 3);
+		EXPECT(desc.lookupBitmapName (bitmap) == std::string ("b1"));
+	);
+
+	TEST(bitmapsAreShared,
+		Xml::MemoryContentProvider provider1 (bitmapNodesUIDesc, strlen(bitmapNodesUIDesc));
+		UIDescription desc1 (&provider1);
+		EXPECT(desc1.parse () == true);
+		TestBitmapCreator creator;
+		desc1.setBitmapCreator (&creator);
+		Xml::MemoryContentProvider provider2 (bitmapNodesUIDesc, strlen(bitmapNodesUIDesc));
+		UIDescription desc2 (&provider2);
+		EXPECT(desc2.parse () == true);
+		desc2.setBitmapCreator (&creator);
+		auto bitmap1 = desc1.getBitmap ("b1");
+		auto bitmap2 = desc2.getBitmap ("b1");
+		EXPECT(creator.numCreated == 2);
+		EXPECT(bitmap1 != bitmap2);
+		EXPECT(bitmap1->getPlatformBitmap () == bitmap2->getPlatformBitmap ());
+		EXPECT(bitmap1->getBestPlatformBitmapForScaleFactor (2.) == bitmap2->getBestPlatformBitmapForScaleFactor (2.));
+	);
+
+	TEST(bitmapsAreDecodedInTheBackground,
+		Xml::MemoryContentProvider provider (bitmapNodesUIDesc, strlen(bitmapNodesUIDesc));
+		UIDescription desc (&provider);
+		TestBitmapCreator creator;
+		desc.setBitmapCreator (&creator);
+		desc.setAsyncBitmapDecoding (true);
+		EXPECT(desc.parse () == true);
+		auto bitmap = desc.getBitmap ("b1");
+		EXPECT(bitmap);
+		EXPECT(bitmap->isLoadDeferred ());
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (1.) == nullptr);
+		EXPECT(desc.lookupBitmapName (bitmap) == std::string ("b1"));
+		EXPECT(bitmap->getWidth () == 10.);
+		EXPECT(bitmap->isLoadDeferred () == false);
+		EXPECT(creator.numCreated == 1);
+		desc.finishBitmapDecoding ();
+		EXPECT(creator.numCreated == 2);
+		EXPECT(bitmap->getBestPlatformBitmapForScaleFactor (2.)->getScaleFactor () == 2.);
+		EXPECT(desc.getBitmap ("b1") == bitmap);
+	);
+
+	TEST(finishBitmapDecoding,
+		Xml::MemoryContentProvider provider (bitmapNodesUIDesc, strlen(bitmapNodesUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		TestBitmapCreator creator;
+		desc.setBitmapCreator (&creator);
+		desc.setAsyncBitmapDecoding (true);
+		EXPECT(desc.getAsyncBitmapDecoding ());
+		auto bitmap = desc.getBitmap ("b1#2.0x");
+		EXPECT(bitmap->isLoadDeferred ());
+		desc.finishBitmapDecoding ();
+		EXPECT(bitmap->isLoadDeferred () == false);
+		EXPECT(creator.numCreated == 2);
+		EXPECT(bitmap->getPlatformBitmap ()->getScaleFactor () == 2.);
+		desc.setAsyncBitmapDecoding (false);
+		EXPECT(desc.getAsyncBitmapDecoding () == false);
+	);
+
 	TEST(tags,
 		Xml::MemoryContentProvider provider (tagNodesUIDesc, strlen(tagNodesUIDesc));
 		UIDescription desc (&provider);
@@ -558,6 +888,26 @@ TESTCASE(UIDescriptionTests,
 		EXPECT(desc.calculateStringValue ("unknown", value) == false);
 	);
 
+	TEST(calculationsAfterTagChange,
+		Xml::MemoryContentProvider provider (tagNodesUIDesc, strlen(tagNodesUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		double value;
+		EXPECT(desc.calculateStringValue ("-(1+1)*2 + 5", value));
+		EXPECT(value == 1.);
+		EXPECT(desc.calculateStringValue ("tag.t1 - 4", value));
+		EXPECT(value == 1230.);
+		EXPECT(desc.calculateStringValue ("tag.t1 - 4", value));
+		EXPECT(value == 1230.);
+		EXPECT(desc.changeControlTagString ("t1", "100", false));
+		EXPECT(desc.calculateStringValue ("tag.t1 - 4", value));
+		EXPECT(value == 96.);
+		EXPECT(desc.calculateStringValue ("tag.t4 - 4", value) == false);
+		EXPECT(desc.changeControlTagString ("t4", "10", true));
+		EXPECT(desc.calculateStringValue ("tag.t4 - 4", value));
+		EXPECT(value == 6.);
+	);
+
 	TEST(writeToStream,
 		std::string str (withAllNodesUIDesc);
 		Xml::MemoryContentProvider provider (str.data (), static_cast<uint32_t> (str.size ()));
@@ -571,6 +921,307 @@ TESTCASE(UIDescriptionTests,
 		EXPECT(result == str);
 	);
 	
+	TEST(writeToStreamAfterChanges,
+		std::string str (withAllNodesUIDesc);
+		Xml::MemoryContentProvider provider (str.data (), static_cast<uint32_t> (str.size ()));
+		SaveUIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		EXPECT(saveToString (desc) == str);
+		desc.changeColor ("c2", kRedCColor);
+		desc.changeTagName ("t1", "<t&1>");
+		std::string result = saveToString (desc);
+		EXPECT(result != str);
+		EXPECT(result.find ("name=\"&lt;t&amp;1&gt;\"") != std::string::npos);
+		EXPECT(saveToString (desc) == result);
+
+		Xml::MemoryContentProvider provider2 (result.data (), static_cast<uint32_t> (result.size ()));
+		SaveUIDescription desc2 (&provider2);
+		EXPECT(desc2.parse () == true);
+		EXPECT(desc2.hasTagName ("<t&1>"));
+		EXPECT(saveToString (desc2) == result);
+		desc.removeColor ("c2");
+		desc2.removeColor ("c2");
+		EXPECT(saveToString (desc) == saveToString (desc2));
+	);
+
+	TEST(deferredTemplates,
+		std::string str (templateReferenceUIDesc);
+		str.insert (str.find ("<template"), "<colors>\n\t\t<color name=\"c1\" rgba=\"#000000ff\"/>\n\t</colors>\n\t<!-- a comment -->\n\t");
+		Xml::MemoryContentProvider provider (str.data (), static_cast<uint32_t> (str.size ()));
+		SaveUIDescription xmlDesc (&provider);
+		EXPECT(xmlDesc.parse () == true);
+		SectionUIDescription desc;
+		EXPECT(xmlDesc.saveSections (desc.rootAttributes, desc.sections, 0));
+		// the default nodes are resource sections, too
+		EXPECT(desc.sections.size () > 3);
+		EXPECT(desc.sections[0].templateAttributes == nullptr);
+		EXPECT(desc.sections[0].xml.find ("<!-- a comment -->") != std::string::npos);
+		EXPECT(*desc.sections[1].templateAttributes->getAttributeValue ("name") == "inner");
+		EXPECT(*desc.sections[2].templateAttributes->getAttributeValue ("name") == "outer");
+
+		EXPECT(desc.parse () == true);
+		EXPECT(desc.numReadTemplates == 0);
+		CColor color;
+		EXPECT(desc.getColor ("c1", color));
+		EXPECT(color == kBlackCColor);
+		std::list<const std::string*> templateNames;
+		desc.collectTemplateViewNames (templateNames);
+		EXPECT(templateNames.size () == 2);
+		EXPECT(desc.numReadTemplates == 0);
+
+		Controller controller;
+		auto view = owned (desc.createView ("inner", &controller));
+		EXPECT(view);
+		EXPECT(view.cast<CViewContainer> ()->getNbViews () == 1);
+		EXPECT(desc.numReadTemplates == 1);
+		view = owned (desc.createView ("inner", &controller));
+		EXPECT(desc.numReadTemplates == 1);
+		// creating a view adds the empty base nodes it looks up
+		view = owned (xmlDesc.createView ("inner", &controller));
+		EXPECT(saveToString (desc) == saveToString (xmlDesc));
+		EXPECT(desc.numReadTemplates == 2);
+	);
+
+	TEST(parseNotSeekableStream,
+		NotSeekableInputStream stream (withAllNodesUIDesc);
+		Xml::InputStreamContentProvider provider (stream);
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		CColor color;
+		EXPECT(desc.getColor ("c1", color));
+		EXPECT(desc.getTagForName ("t2") == 4321);
+	);
+
+	TEST(compiledFormat,
+		std::string str (withAllNodesUIDesc);
+		Xml::MemoryContentProvider provider (str.data (), static_cast<uint32_t> (str.size ()));
+		SaveUIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		CMemoryStream compiledStream (1024, 1024, false);
+		EXPECT(desc.saveToStream (compiledStream, SaveUIDescription::kWriteImagesIntoXMLFile | SaveUIDescription::kWriteCompiledFormat));
+		auto compiledData = reinterpret_cast<const char*> (compiledStream.getBuffer ());
+		auto compiledSize = static_cast<uint32_t> (compiledStream.tell ());
+		EXPECT(std::string (compiledData, 4) == "VGUC");
+
+		Xml::MemoryContentProvider compiledProvider (compiledData, compiledSize);
+		SaveUIDescription compiledDesc (&compiledProvider);
+		EXPECT(compiledDesc.parse () == true);
+		CMemoryStream outputStream (1024, 1024, false);
+		EXPECT(compiledDesc.saveToStream (outputStream, SaveUIDescription::kWriteImagesIntoXMLFile));
+		outputStream.end ();
+		std::string result (reinterpret_cast<const char*> (outputStream.getBuffer ()));
+		EXPECT(result == str);
+		CColor color;
+		EXPECT(compiledDesc.getColor ("c3", color));
+		EXPECT(color == CColor (255, 0, 0, 100));
+		EXPECT(compiledDesc.getTagForName ("t2") == 4321);
+		EXPECT(compiledDesc.getGradient ("g1"));
+
+		CMemoryStream compiledStream2 (1024, 1024, false);
+		EXPECT(compiledDesc.saveToStream (compiledStream2, SaveUIDescription::kWriteImagesIntoXMLFile | SaveUIDescription::kWriteCompiledFormat));
+		EXPECT(compiledStream2.tell () == compiledSize);
+		EXPECT(memcmp (compiledStream2.getBuffer (), compiledData, compiledSize) == 0);
+	);
+
+	TEST(compiledFormatFromResourcePack,
+		auto uidesc = createQOIUIDesc (5, 3);
+		Xml::MemoryContentProvider provider (uidesc.data (), static_cast<uint32_t> (uidesc.size ()));
+		SaveUIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		CMemoryStream compiledStream (1024, 1024, false);
+		EXPECT(desc.saveToStream (compiledStream, SaveUIDescription::kWriteImagesIntoXMLFile | SaveUIDescription::kWriteCompiledFormat));
+		CResourcePack::Writer writer;
+		writer.add ("editor.uidesc", compiledStream.getBuffer (), static_cast<uint32_t> (compiledStream.tell ()));
+		std::vector<uint8_t> packData;
+		EXPECT(writer.write (packData));
+		auto pack = owned (CResourcePack::openFromMemory (packData.data (), static_cast<uint32_t> (packData.size ())));
+		UIDescription compiledDesc ("editor.uidesc");
+		compiledDesc.setResourcePack (pack);
+		EXPECT(compiledDesc.parse () == true);
+		auto bitmap = compiledDesc.getBitmap ("b1");
+		EXPECT(bitmap);
+		EXPECT(bitmap->getWidth () == 5);
+		EXPECT(bitmap->getHeight () == 3);
+	);
+
+	TEST(truncatedCompiledFormat,
+		std::string str (withAllNodesUIDesc);
+		Xml::MemoryContentProvider provider (str.data (), static_cast<uint32_t> (str.size ()));
+		SaveUIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		CMemoryStream compiledStream (1024, 1024, false);
+		EXPECT(desc.saveToStream (compiledStream, SaveUIDescription::kWriteCompiledFormat));
+		Xml::MemoryContentProvider compiledProvider (compiledStream.getBuffer (), static_cast<uint32_t> (compiledStream.tell ()) - 1);
+		UIDescription compiledDesc (&compiledProvider);
+		EXPECT(compiledDesc.parse () == false);
+	);
+
+	TEST(writeBitmapData,
+		Xml::MemoryContentProvider provider (bitmapDataUIDesc, strlen(bitmapDataUIDesc));
+		SaveUIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		CMemoryStream outputStream (1024, 1024, false);
+		EXPECT(desc.saveToStream (outputStream, SaveUIDescription::kWriteImagesIntoXMLFile));
+		outputStream.end ();
+		std::string result (reinterpret_cast<const char*> (outputStream.getBuffer ()));
+		std::string expected ("\t\t\t<data encoding=\"base64\">\n"
+							  "\t\t\t\tAAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKissLS4vMDEyMzQ1Njc4OTo7PD\n"
+							  "\t\t\t\t0+P0BBQkNERUZHSElKS0xNTk9QUVJTVFVWV1hZ\n"
+							  "\t\t\t</data>\n");
+		EXPECT(result.find (expected) != std::string::npos);
+	);
+
+	TEST(qoiBitmapData,
+		auto uidesc = createQOIUIDesc (5, 3);
+		Xml::MemoryContentProvider provider (uidesc.data (), static_cast<uint32_t> (uidesc.size ()));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		auto bitmap = desc.getBitmap ("b1");
+		EXPECT(bitmap);
+		EXPECT(bitmap->getWidth () == 5);
+		EXPECT(bitmap->getHeight () == 3);
+		auto accessor = owned (CBitmapPixelAccess::create (bitmap));
+		accessor->setPosition (4, 2);
+		CColor color;
+		accessor->getColor (color);
+		EXPECT(color == CColor (80, 80, 7, 255));
+	);
+
+	TEST(embeddedBitmapsAreSharedByContent,
+		auto uidesc1 = createQOIUIDesc (5, 3);
+		auto uidesc2 = createQOIUIDesc (7, 2);
+		Xml::MemoryContentProvider provider1 (uidesc1.data (), static_cast<uint32_t> (uidesc1.size ()));
+		Xml::MemoryContentProvider provider2 (uidesc1.data (), static_cast<uint32_t> (uidesc1.size ()));
+		Xml::MemoryContentProvider provider3 (uidesc2.data (), static_cast<uint32_t> (uidesc2.size ()));
+		UIDescription desc1 (&provider1);
+		UIDescription desc2 (&provider2);
+		UIDescription desc3 (&provider3);
+		EXPECT(desc1.parse () && desc2.parse () && desc3.parse ());
+		auto bitmap1 = desc1.getBitmap ("b1");
+		auto bitmap2 = desc2.getBitmap ("b1");
+		auto bitmap3 = desc3.getBitmap ("b1");
+		EXPECT(bitmap1 && bitmap2 && bitmap3);
+		EXPECT(bitmap1 != bitmap2);
+		EXPECT(bitmap1->getPlatformBitmap () == bitmap2->getPlatformBitmap ());
+		EXPECT(bitmap3->getWidth () == 7);
+		EXPECT(bitmap3->getHeight () == 2);
+		auto accessor = owned (CBitmapPixelAccess::create (bitmap2));
+		accessor->setColor (kRedCColor);
+		accessor = nullptr;
+		EXPECT(bitmap1->getPlatformBitmap () != bitmap2->getPlatformBitmap ());
+		EXPECT(getPixels (bitmap1) != getPixels (bitmap2));
+	);
+
+	TEST(sharedParsing,
+		const char* path = "uidescription_sharedparsing_test.uidesc";
+		writeTextFile (path, colorNodesUIDesc);
+		UIDescription desc1 (path);
+		desc1.setSharedParsingEnabled (true);
+		EXPECT(desc1.parse ());
+		writeTextFile (path, emptyUIDesc);
+		UIDescription desc2 (path);
+		desc2.setSharedParsingEnabled (true);
+		EXPECT(desc2.parse ());
+		EXPECT(desc2.hasColorName ("c3"));
+		desc2.changeColor ("c1", kRedCColor);
+		CColor color;
+		EXPECT(desc1.getColor ("c1", color));
+		EXPECT(color == kBlackCColor);
+		UIDescription desc3 (path);
+		EXPECT(desc3.parse ());
+		EXPECT(desc3.hasColorName ("c3") == false);
+		UIDescription::releaseSharedParsedNodes ();
+		UIDescription desc4 (path);
+		desc4.setSharedParsingEnabled (true);
+		EXPECT(desc4.parse ());
+		EXPECT(desc4.hasColorName ("c3") == false);
+		EXPECT(desc2.save (path, 0));
+		UIDescription desc5 (path);
+		desc5.setSharedParsingEnabled (true);
+		EXPECT(desc5.parse ());
+		EXPECT(desc5.getColor ("c1", color));
+		EXPECT(color == kRedCColor);
+		UIDescription::releaseSharedParsedNodes ();
+		std::remove (path);
+	);
+
+	TEST(resourcePack,
+		std::string uidesc ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<vstgui-ui-description version=\"1\">\n\t<bitmaps>\n\t\t<bitmap name=\"knob\" path=\"images/knob#2x.png\"/>\n\t</bitmaps>\n</vstgui-ui-description>\n");
+		auto qoiData = createQOIData (6, 4);
+		CResourcePack::Writer writer;
+		writer.add ("knob#2x.png", qoiData.data (), static_cast<uint32_t> (qoiData.size ()));
+		writer.add ("editor.uidesc", uidesc.data (), static_cast<uint32_t> (uidesc.size ()));
+		std::vector<uint8_t> packData;
+		EXPECT(writer.write (packData));
+		auto pack = owned (CResourcePack::openFromMemory (packData.data (), static_cast<uint32_t> (packData.size ())));
+		EXPECT(pack);
+		UIDescription desc ("resourcepacktest/editor.uidesc");
+		desc.setResourcePack (pack);
+		EXPECT(desc.parse () == true);
+		auto bitmap = desc.getBitmap ("knob");
+		EXPECT(bitmap);
+		EXPECT(bitmap->getPlatformBitmap ());
+		EXPECT(bitmap->getPlatformBitmap ()->getScaleFactor () == 2.);
+		EXPECT(bitmap->getWidth () == 3);
+		EXPECT(bitmap->getHeight () == 2);
+	);
+
+	TEST(bitmapAtlas,
+		std::string uidesc ("<vstgui-ui-description version=\"1\">\n\t<bitmaps>\n");
+		uidesc += createQOIBitmapNode ("atlas1", 5, 3);
+		uidesc += createQOIBitmapNode ("atlas2", 8, 8);
+		uidesc += createQOIBitmapNode ("atlasLarge", 200, 2);
+		uidesc += createQOIBitmapNode ("atlasVariant", 4, 4);
+		uidesc += createQOIBitmapNode ("atlasVariant#2x", 8, 8);
+		uidesc += "\t</bitmaps>\n</vstgui-ui-description>\n";
+		Xml::MemoryContentProvider provider (uidesc.data (), static_cast<uint32_t> (uidesc.size ()));
+		UIDescription desc (&provider);
+		desc.setBitmapAtlasEnabled (true);
+		EXPECT(desc.parse () == true);
+		EXPECT(desc.getBitmapAtlas ());
+		EXPECT(desc.getBitmapAtlas ()->getNumPages () == 1);
+		auto page = desc.getBitmapAtlas ()->getPage (0);
+		auto bitmap1 = desc.getBitmap ("atlas1");
+		EXPECT(bitmap1->getAtlas () == page);
+		EXPECT(bitmap1->getWidth () == 5);
+		EXPECT(bitmap1->getHeight () == 3);
+		EXPECT(desc.getBitmap ("atlas2")->getAtlas () == page);
+		EXPECT(desc.getBitmap ("atlasLarge")->getAtlas () == nullptr);
+		EXPECT(desc.getBitmap ("atlasVariant")->getAtlas () == nullptr);
+		auto accessor = owned (CBitmapPixelAccess::create (bitmap1));
+		accessor->setPosition (4, 2);
+		CColor color;
+		accessor->getColor (color);
+		EXPECT(color == CColor (80, 80, 7, 255));
+	);
+
+	TEST(writeBitmapDataAsQOI,
+		auto uidesc = createQOIUIDesc (9, 4);
+		CMemoryStream outputStream (1024, 1024, false);
+		std::vector<uint32_t> pixels;
+		{
+			Xml::MemoryContentProvider provider (uidesc.data (), static_cast<uint32_t> (uidesc.size ()));
+			SaveUIDescription desc (&provider);
+			EXPECT(desc.parse () == true);
+			auto bitmap = desc.getBitmap ("b1");
+			{
+				auto accessor = owned (CBitmapPixelAccess::create (bitmap));
+				accessor->setColor (kBlueCColor);
+			}
+			pixels = getPixels (bitmap);
+			EXPECT(desc.saveToStream (outputStream, SaveUIDescription::kWriteImagesIntoXMLFile | SaveUIDescription::kWriteImagesAsQOI));
+			outputStream.end ();
+		}
+		std::string result (reinterpret_cast<const char*> (outputStream.getBuffer ()));
+		EXPECT(result.find ("<data encoding=\"base64\">") != std::string::npos);
+		Xml::MemoryContentProvider provider (result.data (), static_cast<uint32_t> (result.size ()));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		auto bitmap = desc.getBitmap ("b1");
+		EXPECT(bitmap);
+		EXPECT(getPixels (bitmap) == pixels);
+	);
+
 	TEST(templates,
 		Xml::MemoryContentProvider provider (createViewUIDesc, strlen(createViewUIDesc));
 		UIDescription desc (&provider);
@@ -618,6 +1269,204 @@ TESTCASE(UIDescriptionTests,
 		EXPECT(desc.getViewAttributes ("addNewTemplate"));
 	);
 
+	TEST(templateChangesAfterCreateView,
+		Xml::MemoryContentProvider provider (templateReferenceUIDesc, strlen(templateReferenceUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+
+		Controller controller;
+		for (auto i = 0; i < 2; ++i)
+		{
+			auto view = owned (desc.createView ("outer", &controller));
+			auto container = view.cast<CViewContainer> ();
+			EXPECT(container);
+			EXPECT(container->getNbViews () == 1);
+			auto inner = dynamic_cast<CViewContainer*> (container->getView (0));
+			EXPECT(inner);
+			EXPECT(inner->getNbViews () == 1);
+			EXPECT(inner->getViewSize ().getTopLeft () == CPoint (5, 5));
+			char value[5] = {};
+			uint32_t size;
+			EXPECT(view->getAttribute ('tatr', sizeof (value), value, size));
+			EXPECT(std::string (value) == "test");
+		}
+
+		EXPECT(desc.changeTemplateName ("inner", "renamed"));
+		EXPECT(desc.getViewAttributes ("inner") == nullptr);
+		EXPECT(desc.getViewAttributes ("renamed"));
+		auto view = owned (desc.createView ("outer", &controller));
+		EXPECT(view.cast<CViewContainer> ()->getNbViews () == 0);
+
+		view = owned (desc.createView ("renamed", &controller));
+		EXPECT(view.cast<CViewContainer> ()->getNbViews () == 1);
+		view.cast<CViewContainer> ()->removeAll ();
+		desc.updateViewDescription ("renamed", view);
+		view = owned (desc.createView ("renamed", &controller));
+		EXPECT(view.cast<CViewContainer> ()->getNbViews () == 0);
+	);
+
+	TEST(prototypeCloning,
+		Xml::MemoryContentProvider provider (prototypeUIDesc, strlen(prototypeUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		desc.setPrototypeCloningEnabled (true);
+
+		PrototypeController controller;
+		IController* subControllers[2] = {};
+		for (auto i = 0; i < 2; ++i)
+		{
+			auto view = owned (desc.createView ("row", &controller));
+			auto container = view.cast<CViewContainer> ();
+			EXPECT(container);
+			EXPECT(container->getNbViews () == 2);
+			std::string templateName;
+			EXPECT(desc.getTemplateNameFromView (view, templateName));
+			EXPECT(templateName == "row");
+			uint32_t size;
+			EXPECT(view->getAttributeSize ('uivp', size) == false);
+
+			auto control = dynamic_cast<CControl*> (container->getView (0));
+			EXPECT(control);
+			EXPECT(control->getTag () == 42);
+			EXPECT(control->getListener () == &controller);
+
+			auto subContainer = dynamic_cast<CViewContainer*> (container->getView (1));
+			EXPECT(subContainer);
+			EXPECT(subContainer->getAttribute (kCViewControllerAttribute, sizeof (IController*), &subControllers[i], size));
+			auto subControl = dynamic_cast<CControl*> (subContainer->getView (0));
+			EXPECT(subControl);
+			EXPECT(subControl->getTag () == 42);
+			EXPECT(subControl->getListener () == subControllers[i]);
+			EXPECT(static_cast<PrototypeController*> (subControllers[i])->numVerifiedViews == 2);
+		}
+		EXPECT(subControllers[0] != subControllers[1]);
+		EXPECT(controller.numVerifiedViews == 4);
+	);
+
+	TEST(prototypeCloningWithCustomViews,
+		Xml::MemoryContentProvider provider (customViewUIDesc, strlen(customViewUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		desc.setPrototypeCloningEnabled (true);
+
+		CustomViewController controller;
+		for (auto i = 0; i < 2; ++i)
+		{
+			auto view = owned (desc.createView ("outer", &controller));
+			auto container = view.cast<CViewContainer> ();
+			EXPECT(container);
+			EXPECT(container->getNbViews () == 1);
+			auto inner = dynamic_cast<CViewContainer*> (container->getView (0));
+			EXPECT(inner);
+			EXPECT(inner->getNbViews () == 1);
+			uint32_t customView = 0;
+			uint32_t size;
+			EXPECT(inner->getView (0)->getAttribute ('cust', sizeof (customView), &customView, size));
+			EXPECT(customView == static_cast<uint32_t> (i + 1));
+		}
+		EXPECT(controller.numCustomViews == 2);
+	);
+
+	TEST(parseAsync,
+		Xml::MemoryContentProvider provider (colorNodesUIDesc, strlen(colorNodesUIDesc));
+		UIDescription desc (&provider);
+		bool parsed = false;
+		EXPECT(desc.parseAsync ([&] (UIDescription* description, bool success) { parsed = success && description == &desc; }));
+		EXPECT(desc.parseAsync (nullptr) == false);
+		EXPECT(desc.isParsing ());
+		EXPECT(desc.parse () == false);
+		desc.finishParsing ();
+		EXPECT(desc.parse ());
+		EXPECT(parsed);
+		EXPECT(desc.isParsing () == false);
+		CColor color;
+		EXPECT(desc.getColor ("c1", color));
+	);
+
+	TEST(createViewIncrementally,
+		Xml::MemoryContentProvider provider (prototypeUIDesc, strlen(prototypeUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		PrototypeController controller;
+		auto parent = owned (new CViewContainer (CRect (0, 0, 200, 200)));
+		CView* createdView = nullptr;
+		auto placeholder = desc.createViewIncrementally ("row", &controller, 0, [&] (CView* view) { createdView = view; });
+		EXPECT(placeholder);
+		EXPECT(placeholder->getViewSize () == CRect (0, 0, 100, 20));
+		parent->addView (placeholder);
+		desc.finishViewCreation ();
+		EXPECT(createdView);
+		// the placeholder is only replaced when it is attached, otherwise the view is owned by the completion
+		EXPECT(parent->getView (0) == placeholder);
+		auto ownedView = owned (createdView);
+		std::string templateName;
+		EXPECT(desc.getTemplateNameFromView (createdView, templateName));
+		EXPECT(templateName == "row");
+		auto container = dynamic_cast<CViewContainer*> (createdView);
+		EXPECT(container);
+		EXPECT(container->getNbViews () == 2);
+		auto subContainer = dynamic_cast<CViewContainer*> (container->getView (1));
+		EXPECT(subContainer);
+		EXPECT(subContainer->getNbViews () == 1);
+		IController* subController = nullptr;
+		uint32_t size;
+		EXPECT(subContainer->getAttribute (kCViewControllerAttribute, sizeof (IController*), &subController, size));
+		EXPECT(static_cast<PrototypeController*> (subController)->numVerifiedViews == 2);
+		EXPECT(controller.numVerifiedViews == 2);
+
+		createdView = nullptr;
+		placeholder = desc.createViewIncrementally ("row", &controller, 0, [&] (CView* view) { createdView = view; });
+		placeholder->forget ();
+		desc.finishViewCreation ();
+		EXPECT(createdView == nullptr);
+	);
+
+	TEST(profiler,
+		Xml::MemoryContentProvider provider (prototypeUIDesc, strlen(prototypeUIDesc));
+		UIDescription desc (&provider);
+		auto profiler = owned (new UIDescriptionProfiler);
+		desc.setProfiler (profiler);
+		EXPECT(desc.parse () == true);
+		PrototypeController controller;
+		auto view = owned (desc.createView ("row", &controller));
+		EXPECT(view);
+		const auto& report = profiler->getReport ();
+		EXPECT(report.phases[UIDescriptionProfiler::kParse].count == 1);
+		EXPECT(report.templates.size () == 1);
+		EXPECT(report.templates.at ("row").count == 1);
+		EXPECT(report.getTotalTime () == report.phases[UIDescriptionProfiler::kParse].time + report.templates.at ("row").time);
+		EXPECT(report.phases[UIDescriptionProfiler::kViewCreatorCreate].count == 4);
+		const auto& createdViews = report.phaseEntries[UIDescriptionProfiler::kViewCreatorCreate];
+		EXPECT(createdViews.at ("CTextButton").count == 2);
+		EXPECT(createdViews.at ("CViewContainer").count == 2);
+		EXPECT(report.phases[UIDescriptionProfiler::kControllerCreateView].count == 4);
+		EXPECT(report.phases[UIDescriptionProfiler::kControllerVerifyView].count == 4);
+		EXPECT(report.phaseEntries[UIDescriptionProfiler::kControllerSubController].at ("sub").count == 1);
+
+		profiler->reset ();
+		EXPECT(report.getTotalTime () == 0);
+		desc.setProfiler (nullptr);
+		view = owned (desc.createView ("row", &controller));
+		EXPECT(report.phases[UIDescriptionProfiler::kViewCreatorCreate].count == 0);
+	);
+
+	TEST(profilerNestedTemplates,
+		Xml::MemoryContentProvider provider (templateReferenceUIDesc, strlen(templateReferenceUIDesc));
+		UIDescription desc (&provider);
+		EXPECT(desc.parse () == true);
+		auto profiler = owned (new UIDescriptionProfiler);
+		desc.setProfiler (profiler);
+		Controller controller;
+		auto view = owned (desc.createView ("outer", &controller));
+		EXPECT(view);
+		const auto& report = profiler->getReport ();
+		EXPECT(report.phases[UIDescriptionProfiler::kParse].count == 0);
+		EXPECT(report.templates.at ("outer").count == 1);
+		EXPECT(report.templates.at ("inner").count == 1);
+		EXPECT(report.templates.at ("outer").time >= report.templates.at ("inner").time);
+		EXPECT(report.getTotalTime () == report.templates.at ("outer").time);
+	);
+
 	TEST(storeRestoreViews,
 		Xml::MemoryContentProvider provider (createViewUIDesc, strlen(createViewUIDesc));
 		UIDescription desc (&provider);
@@ -0,0 +1,160 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+/*
+	resourcepacker - creates a VSTGUI::CResourcePack from files
+
+	usage: resourcepacker [-qoi] output-file [name=]file ...
+
+	Every file is added with its file name as entry name, or with the name before the '=' sign. Bitmaps are found by
+	the value of their path attribute, so the names need to match them. With -qoi PNG images are converted to QOI which
+	decodes faster. The scale factor of an entry is taken from a "#2x" suffix in its name.
+
+	Build it together with the platform file of the library (vstgui_mac.mm or vstgui_win32.cpp), for example:
+	c++ -I.. resourcepacker.cpp ../../vstgui_mac.mm -framework Cocoa -framework OpenGL -framework Accelerate
+		-framework QuartzCore -framework Carbon -o resourcepacker
+*/
+
+#include "../../lib/cresourcepack.h"
+#include "../../lib/cbitmapcodec.h"
+#include "../../lib/platform/iplatformbitmap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace VSTGUI;
+
+//-----------------------------------------------------------------------------
+static bool readFile (const char* path, std::vector<uint8_t>& data)
+{
+	FILE* file = fopen (path, "rb");
+	if (file == 0)
+		return false;
+	bool result = false;
+	if (fseek (file, 0, SEEK_END) == 0)
+	{
+		long size = ftell (file);
+		if (size > 0 && fseek (file, 0, SEEK_SET) == 0)
+		{
+			data.resize (static_cast<size_t> (size));
+			result = fread (&data[0], 1, data.size (), file) == data.size ();
+		}
+	}
+	fclose (file);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+static bool convertToQOI (std::vector<uint8_t>& data)
+{
+	SharedPointer<IPlatformBitmap> bitmap = owned (IPlatformBitmap::createFromMemory (&data[0], static_cast<uint32_t> (data.size ())));
+	void* qoiData = 0;
+	uint32_t qoiSize = 0;
+	if (bitmap == 0 || !BitmapCodec::createMemoryRepresentation (bitmap, BitmapCodec::kQOI, &qoiData, qoiSize))
+		return false;
+	data.assign (static_cast<uint8_t*> (qoiData), static_cast<uint8_t*> (qoiData) + qoiSize);
+	std::free (qoiData);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	bool qoi = false;
+	int arg = 1;
+	if (arg < argc && std::strcmp (argv[arg], "-qoi") == 0)
+	{
+		qoi = true;
+		arg++;
+	}
+	if (argc - arg < 2)
+	{
+		fprintf (stderr, "usage: %s [-qoi] output-file [name=]file ...\n", argv[0]);
+		return 1;
+	}
+	const char* outputPath = argv[arg++];
+
+	CResourcePack::Writer writer;
+	uint64_t inputSize = 0;
+	for (; arg < argc; arg++)
+	{
+		std::string name (argv[arg]);
+		std::string path (name);
+		size_t index = name.find ('=');
+		if (index != std::string::npos)
+		{
+			path = name.substr (index + 1);
+			name.erase (index);
+		}
+		else if ((index = name.find_last_of ("/\\")) != std::string::npos)
+			name.erase (0, index + 1);
+
+		std::vector<uint8_t> data;
+		if (!readFile (path.c_str (), data))
+		{
+			fprintf (stderr, "could not read %s\n", path.c_str ());
+			return 1;
+		}
+		inputSize += data.size ();
+		CResourcePack::Codec codec = CResourcePack::detectCodec (&data[0], static_cast<uint32_t> (data.size ()));
+		if (qoi && codec == CResourcePack::kCodecPNG)
+		{
+			if (convertToQOI (data))
+				codec = CResourcePack::kCodecQOI;
+			else
+				fprintf (stderr, "could not convert %s to QOI, it is stored as PNG\n", path.c_str ());
+		}
+		writer.add (name.c_str (), &data[0], static_cast<uint32_t> (data.size ()), codec);
+	}
+
+	std::vector<uint8_t> output;
+	if (!writer.write (output))
+	{
+		fprintf (stderr, "could not create the pack, the names must be unique and the pack smaller than 4 GB\n");
+		return 1;
+	}
+	FILE* file = fopen (outputPath, "wb");
+	if (file == 0 || fwrite (&output[0], 1, output.size (), file) != output.size ())
+	{
+		fprintf (stderr, "could not write %s\n", outputPath);
+		if (file)
+			fclose (file);
+		return 1;
+	}
+	fclose (file);
+	printf ("%u entries, %llu bytes packed into %u bytes\n", writer.getNumEntries (), static_cast<unsigned long long> (inputSize), static_cast<uint32_t> (output.size ()));
+	return 0;
+}
@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// VST Plug-Ins SDK
+// VSTGUI: Graphical User Interface Framework for VST plugins
+//
+// Version 4.3
+//
+//-----------------------------------------------------------------------------
+// VSTGUI LICENSE
+// (c) 2015, Steinberg Media Technologies, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+//   * Redistributions of source code must retain the above copyright notice, 
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation 
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this 
+//     software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+// INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+// OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE  OF THIS SOFTWARE, EVEN IF ADVISED
+// OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+/*
+	uidesccompiler - converts an UIDescription file into the compiled format
+
+	usage: uidesccompiler [-png|-qoi] input-file output-file
+
+	The compiled file is loaded by VSTGUI::UIDescription::parse without the XML parser, it can also be stored in a
+	VSTGUI::CResourcePack. With -png or -qoi the images are embedded into the compiled file in that format, otherwise
+	they are loaded with the path of the bitmaps. Images embedded in the input file are only kept with -png or -qoi.
+
+	Build it together with the platform file of the library (vstgui_mac.mm or vstgui_win32.cpp) and
+	vstgui_uidescription.cpp, for example:
+	c++ -I.. uidesccompiler.cpp ../../vstgui_mac.mm ../../vstgui_uidescription.cpp -framework Cocoa -framework OpenGL
+		-framework Accelerate -framework QuartzCore -framework Carbon -o uidesccompiler
+*/
+
+#include "../../uidescription/uidescription.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace VSTGUI;
+
+//-----------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+	int32_t flags = UIDescription::kWriteCompiledFormat;
+	int arg = 1;
+	if (arg < argc && std::strcmp (argv[arg], "-png") == 0)
+	{
+		flags |= UIDescription::kWriteImagesIntoXMLFile;
+		arg++;
+	}
+	else if (arg < argc && std::strcmp (argv[arg], "-qoi") == 0)
+	{
+		flags |= UIDescription::kWriteImagesIntoXMLFile | UIDescription::kWriteImagesAsQOI;
+		arg++;
+	}
+	if (argc - arg != 2)
+	{
+		fprintf (stderr, "usage: %s [-png|-qoi] input-file output-file\n", argv[0]);
+		return 1;
+	}
+	const char* inputPath = argv[arg];
+	const char* outputPath = argv[arg + 1];
+
+	SharedPointer<UIDescription> description = owned (new UIDescription (inputPath));
+	if (!description->parse ())
+	{
+		fprintf (stderr, "could not parse %s\n", inputPath);
+		return 1;
+	}
+	if (!description->save (outputPath, flags))
+	{
+		fprintf (stderr, "could not write %s\n", outputPath);
+		return 1;
+	}
+	return 0;
+}
@@ -41,6 +41,99 @@
 
 namespace VSTGUI {
 
+//-----------------------------------------------------------------------------
+/** Decodes base64 text which may arrive in pieces directly into a buffer of the caller.
+	Whitespace and other characters which are not part of the alphabet are skipped, decoding ends at the first '='. */
+//-----------------------------------------------------------------------------
+class Base64Decoder
+{
+public:
+	Base64Decoder () : bits (0), numBits (0), finished (false) {}
+
+	/** the number of bytes decode writes at most for length characters */
+	static uint32_t getMaxDecodedSize (uint32_t length) { return (length / 4) * 3 + 3; }
+
+	/** decodes the next piece of text into output, which must have room for getMaxDecodedSize (length) bytes, returns the number of bytes written */
+	uint32_t decode (const void* text, uint32_t length, void* output)
+	{
+		const uint8_t* table = getDecodeTable ();
+		const uint8_t* ptr = static_cast<const uint8_t*> (text);
+		const uint8_t* end = ptr + length;
+		uint8_t* out = static_cast<uint8_t*> (output);
+		while (ptr < end && !finished)
+		{
+			if (numBits == 0)
+			{
+				// four characters at a time as long as there is no whitespace or padding
+				while (end - ptr >= 4)
+				{
+					uint32_t c0 = table[ptr[0]];
+					uint32_t c1 = table[ptr[1]];
+					uint32_t c2 = table[ptr[2]];
+					uint32_t c3 = table[ptr[3]];
+					if ((c0 | c1 | c2 | c3) & 0xC0)
+						break;
+					uint32_t value = (c0 << 18) | (c1 << 12) | (c2 << 6) | c3;
+					out[0] = static_cast<uint8_t> (value >> 16);
+					out[1] = static_cast<uint8_t> (value >> 8);
+					out[2] = static_cast<uint8_t> (value);
+					out += 3;
+					ptr += 4;
+				}
+				if (ptr == end)
+					break;
+			}
+			uint8_t c = table[*ptr++];
+			if (c == kPadding)
+				finished = true;
+			else if (c != kInvalid)
+			{
+				bits = ((bits << 6) | c) & 0xFFFF;
+				numBits += 6;
+				if (numBits >= 8)
+				{
+					numBits -= 8;
+					*out++ = static_cast<uint8_t> (bits >> numBits);
+				}
+			}
+		}
+		return static_cast<uint32_t> (out - static_cast<uint8_t*> (output));
+	}
+
+protected:
+	enum {
+		kPadding = 0xFE,
+		kInvalid = 0xFF
+	};
+
+	static const uint8_t* getDecodeTable ()
+	{
+		static const uint8_t table[256] = {
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+			0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF,
+			0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+			0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+			0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		};
+		return table;
+	}
+
+	uint32_t bits;
+	uint32_t numBits;
+	bool finished;
+};
+
 //-----------------------------------------------------------------------------
 class Base64Codec
 {
@@ -58,28 +151,9 @@ public:
 		if (data)
 			return false;
 		uint32_t strLen = (uint32_t)base64String.length ();
-		uint8_t* strPtr = (uint8_t*)base64String.c_str ();
-		data = (int8_t*)std::malloc ((strLen * 3 / 4) + 3);
-		uint8_t input[4];
-		uint32_t i;
-		for (i = 0; i <= strLen - 4; i += 4)
-		{
-			input[0] = *strPtr++;
-			input[1] = *strPtr++;
-			input[2] = *strPtr++;
-			input[3] = *strPtr++;
-			dataSize += decodeblock (input, (uint8_t*)(data + dataSize));
-		}
-		if (i < strLen)
-		{
-			uint32_t j;
-			input[0] = input[1] = input[2] = input[3] = '=';
-			for (j = 0; i < strLen; i++, j++)
-			{
-				input[j] = *strPtr++;
-			}
-			dataSize += decodeblock (input, (uint8_t*)(data + dataSize));
-		}
+		data = (int8_t*)std::malloc (Base64Decoder::getMaxDecodedSize (strLen));
+		Base64Decoder decoder;
+		dataSize = decoder.decode (base64String.c_str (), strLen, data);
 		return true;
 	}
 
@@ -117,30 +191,6 @@ public:
 	uint32_t getDataSize () const { return dataSize; }
 
 protected:
-	inline uint32_t decodeblock (uint8_t input[4], uint8_t output[3])
-	{
-		static const uint8_t cd64[] = {
-			62,   0xFF, 0xFF, 0xFF, 63,   52,   53, 54, 55, 56, 57, 58, 59, 60, 61, 0xFF,
-			0xFF, 0xFF, 0,	0xFF, 0xFF, 0xFF, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,
-			10,   11,   12,   13,   14,   15,   16, 17, 18, 19, 20, 21, 22, 23, 24, 25,
-			0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
-			36,   37,   38,   39,   40,   41,   42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
-
-		uint32_t result = 3;
-		if (input[2] == '=')
-			result = 1;
-		else if (input[3] == '=')
-			result = 2;
-		input[0] = cd64[input[0] - 43];
-		input[1] = cd64[input[1] - 43];
-		input[2] = cd64[input[2] - 43];
-		input[3] = cd64[input[3] - 43];
-		output[0] = static_cast<uint8_t> ((input[0] << 2) | ((input[1] & 0x30) >> 4));
-		output[1] = static_cast<uint8_t> (((input[1] & 0xF) << 4) | ((input[2] & 0x3C) >> 2));
-		output[2] = static_cast<uint8_t> (((input[2] & 0x03) << 6) | input[3]);
-		return result;
-	}
-
 	inline void encodeblock (uint8_t input[3], uint8_t output[4], uint32_t len)
 	{
 		static const uint8_t cb64[] =
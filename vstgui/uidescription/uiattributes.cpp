@@ -37,30 +37,469 @@
 #include "../lib/cpoint.h"
 #include "../lib/crect.h"
 #include "../lib/cstring.h"
+#include "../lib/platform/std_unorderedmap.h"
 #include <sstream>
 #include <algorithm>
+#include <new>
+#if VSTGUI_HAS_FUNCTIONAL
+	#include <atomic>
+	#include <mutex>
+#endif
 
 namespace VSTGUI {
 
+/// @cond ignore
+namespace UIAttributesPrivate {
+
+//-----------------------------------------------------------------------------
+/** the typed values parsed from an attribute value string, never changed after they were parsed */
+struct ParsedValue
+{
+	double number;
+	int32_t integer;
+	CPoint point;
+	CRect rect;
+	bool pointValid;
+	bool rectValid;
+
+	ParsedValue (const std::string& str);
+};
+
+//-----------------------------------------------------------------------------
+/** an interned attribute name or value. It is kept while attribute storages use it, the typed values parsed from a
+	value are kept with it and are shared by all attributes with this value. */
+struct InternedString : public std::string
+{
+	size_t hash;
+	uint32_t refCount;
+
+	InternedString (const std::string& str, size_t hash) : std::string (str), hash (hash), refCount (0), parsedValue (0) {}
+	~InternedString ();
+
+	const ParsedValue& getParsedValue () const;
+
+private:
+	// set once, read without a lock
+#if VSTGUI_HAS_FUNCTIONAL
+	mutable std::atomic<const ParsedValue*> parsedValue;
+#else
+	mutable const ParsedValue* parsedValue;
+#endif
+};
+
+} // UIAttributesPrivate
+
+//-----------------------------------------------------------------------------
+/** shared storage of the attributes, the attributes are sorted by name and never changed. */
+struct UIAttributesData
+{
+	size_t hash;
+	uint32_t refCount;
+	uint32_t numAttributes;
+
+	UIAttributes::const_iterator begin () const { return reinterpret_cast<UIAttributes::const_iterator> (this + 1); }
+	UIAttributes::const_iterator end () const { return begin () + numAttributes; }
+};
+
+namespace UIAttributesPrivate {
+
+//-----------------------------------------------------------------------------
+/** an attribute while a storage is created, the strings are interned when the storage is acquired */
+struct Entry
+{
+	const std::string* name;
+	const std::string* value;
+	bool nameInterned;
+	bool valueInterned;
+
+	Entry (const std::string* name = 0, const std::string* value = 0, bool interned = false)
+	: name (name), value (value), nameInterned (interned), valueInterned (interned) {}
+	bool operator< (const Entry& e) const { return *name < *e.name; }
+};
+typedef std::vector<Entry> EntryVector;
+
+//-----------------------------------------------------------------------------
+struct EntryNameLess
+{
+	bool operator() (const Entry& e, const std::string& name) const { return *e.name < name; }
+};
+
+//-----------------------------------------------------------------------------
+/** the process wide table of the interned attribute strings and the shared attribute storages */
+class Table
+{
+public:
+	static Table& instance ()
+	{
+		// never deleted, as static objects may release their attributes after this table would be destroyed
+		static Table* gInstance = new Table;
+		return *gInstance;
+	}
+
+	const UIAttributesData* acquire (const EntryVector& entries)
+	{
+		if (entries.empty ())
+			return 0;
+		std::vector<InternedString*> strings (entries.size () * 2);
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		// an existing storage only uses interned strings, so it can't exist if a string is not interned yet
+		bool allInterned = true;
+		size_t hash = entries.size ();
+		for (size_t i = 0; i < entries.size (); i++)
+		{
+			strings[i * 2] = find (entries[i].name, entries[i].nameInterned);
+			strings[i * 2 + 1] = find (entries[i].value, entries[i].valueInterned);
+			if (strings[i * 2] == 0 || strings[i * 2 + 1] == 0)
+				allInterned = false;
+			hash = hash * 31 + reinterpret_cast<size_t> (strings[i * 2]);
+			hash = hash * 31 + reinterpret_cast<size_t> (strings[i * 2 + 1]);
+		}
+		if (allInterned)
+		{
+			std::pair<DataMap::iterator, DataMap::iterator> range = dataMap.equal_range (hash);
+			for (DataMap::iterator it = range.first; it != range.second; ++it)
+			{
+				if (isEqual (it->second, strings))
+				{
+					it->second->refCount++;
+					return it->second;
+				}
+			}
+		}
+		else
+		{
+			hash = entries.size ();
+			for (size_t i = 0; i < strings.size (); i++)
+			{
+				if (strings[i] == 0)
+					strings[i] = intern (i % 2 ? *entries[i / 2].value : *entries[i / 2].name);
+				hash = hash * 31 + reinterpret_cast<size_t> (strings[i]);
+			}
+		}
+		void* memory = ::operator new (sizeof (UIAttributesData) + entries.size () * sizeof (UIAttributes::Attribute));
+		UIAttributesData* data = static_cast<UIAttributesData*> (memory);
+		data->hash = hash;
+		data->refCount = 1;
+		data->numAttributes = static_cast<uint32_t> (entries.size ());
+		UIAttributes::Attribute* attributes = reinterpret_cast<UIAttributes::Attribute*> (data + 1);
+		for (size_t i = 0; i < entries.size (); i++)
+		{
+			strings[i * 2]->refCount++;
+			strings[i * 2 + 1]->refCount++;
+			new (attributes + i) UIAttributes::Attribute (*strings[i * 2], *strings[i * 2 + 1]);
+		}
+		dataMap.insert (std::make_pair (hash, data));
+		return data;
+	}
+
+	void retain (const UIAttributesData* data)
+	{
+		if (data == 0)
+			return;
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		const_cast<UIAttributesData*> (data)->refCount++;
+	}
+
+	void release (const UIAttributesData* data)
+	{
+		if (data == 0)
+			return;
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		if (--const_cast<UIAttributesData*> (data)->refCount > 0)
+			return;
+		std::pair<DataMap::iterator, DataMap::iterator> range = dataMap.equal_range (data->hash);
+		for (DataMap::iterator it = range.first; it != range.second; ++it)
+		{
+			if (it->second == data)
+			{
+				dataMap.erase (it);
+				break;
+			}
+		}
+		// the attributes only hold references, they don't need to be destroyed
+		for (UIAttributes::const_iterator it = data->begin (), end = data->end (); it != end; ++it)
+		{
+			release (static_cast<const InternedString*> (&it->first));
+			release (static_cast<const InternedString*> (&it->second));
+		}
+		::operator delete (const_cast<UIAttributesData*> (data));
+	}
+
+private:
+	static size_t hashString (const std::string& str)
+	{
+		// FNV-1a
+		size_t hash = 2166136261u;
+		for (std::string::const_iterator it = str.begin (), end = str.end (); it != end; ++it)
+			hash = (hash ^ static_cast<uint8_t> (*it)) * 16777619u;
+		return hash;
+	}
+
+	InternedString* find (const std::string* str, bool interned) const
+	{
+		if (interned)
+			return const_cast<InternedString*> (static_cast<const InternedString*> (str));
+		size_t hash = hashString (*str);
+		std::pair<StringMap::const_iterator, StringMap::const_iterator> range = strings.equal_range (hash);
+		for (StringMap::const_iterator it = range.first; it != range.second; ++it)
+		{
+			if (*it->second == *str)
+				return it->second;
+		}
+		return 0;
+	}
+
+	InternedString* intern (const std::string& str)
+	{
+		InternedString* interned = find (&str, false);
+		if (interned == 0)
+		{
+			interned = new InternedString (str, hashString (str));
+			strings.insert (std::make_pair (interned->hash, interned));
+		}
+		return interned;
+	}
+
+	void release (const InternedString* str)
+	{
+		InternedString* interned = const_cast<InternedString*> (str);
+		if (--interned->refCount > 0)
+			return;
+		std::pair<StringMap::iterator, StringMap::iterator> range = strings.equal_range (interned->hash);
+		for (StringMap::iterator it = range.first; it != range.second; ++it)
+		{
+			if (it->second == interned)
+			{
+				strings.erase (it);
+				break;
+			}
+		}
+		delete interned;
+	}
+
+	static bool isEqual (const UIAttributesData* data, const std::vector<InternedString*>& strings)
+	{
+		if (data->numAttributes * 2 != strings.size ())
+			return false;
+		UIAttributes::const_iterator attribute = data->begin ();
+		for (size_t i = 0; i < strings.size (); i += 2, ++attribute)
+		{
+			if (&attribute->first != strings[i] || &attribute->second != strings[i + 1])
+				return false;
+		}
+		return true;
+	}
+
+	typedef std::unordered_multimap<size_t, InternedString*> StringMap;
+	typedef std::unordered_multimap<size_t, UIAttributesData*> DataMap;
+
+	StringMap strings;
+	DataMap dataMap;
+#if VSTGUI_HAS_FUNCTIONAL
+	std::mutex mutex;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+static UIAttributes::const_iterator findAttribute (UIAttributes::const_iterator it, UIAttributes::const_iterator last, const std::string& name)
+{
+	// binary search, the attributes are sorted by name
+	size_t count = static_cast<size_t> (last - it);
+	while (count > 0)
+	{
+		size_t half = count / 2;
+		if (it[half].first < name)
+		{
+			it += half + 1;
+			count -= half + 1;
+		}
+		else
+			count = half;
+	}
+	if (it != last && it->first == name)
+		return it;
+	return last;
+}
+
+//-----------------------------------------------------------------------------
+static void splitValues (const std::string& str, UIAttributes::StringArray& subStrings)
+{
+	size_t start = 0;
+	size_t pos = str.find (",", start, 1);
+	if (pos == std::string::npos)
+		return;
+	while (pos != std::string::npos)
+	{
+		std::string name (str, start, pos - start);
+		subStrings.push_back (name);
+		start = pos+1;
+		pos = str.find (",", start, 1);
+	}
+	std::string name (str, start, std::string::npos);
+	subStrings.push_back (name);
+}
+
+//-----------------------------------------------------------------------------
+static void getEntries (const UIAttributes& attributes, EntryVector& entries)
+{
+	entries.reserve (attributes.size () + 1);
+	for (UIAttributes::const_iterator it = attributes.begin (), end = attributes.end (); it != end; ++it)
+		entries.push_back (Entry (&it->first, &it->second, true));
+}
+
+//-----------------------------------------------------------------------------
+ParsedValue::ParsedValue (const std::string& str)
+: number (0.)
+, integer (0)
+, pointValid (false)
+, rectValid (false)
+{
+	std::istringstream sstream (str);
+	sstream.imbue (std::locale::classic ());
+	sstream.precision (40);
+	sstream >> number;
+	integer = (int32_t)strtol (str.c_str (), 0, 10);
+	UIAttributes::StringArray subStrings;
+	splitValues (str, subStrings);
+	if (subStrings.size () == 2)
+	{
+		point.x = UTF8StringView (subStrings[0].c_str ()).toDouble ();
+		point.y = UTF8StringView (subStrings[1].c_str ()).toDouble ();
+		pointValid = true;
+	}
+	else if (subStrings.size () == 4)
+	{
+		rect.left = UTF8StringView (subStrings[0].c_str ()).toDouble ();
+		rect.top = UTF8StringView (subStrings[1].c_str ()).toDouble ();
+		rect.right = UTF8StringView (subStrings[2].c_str ()).toDouble ();
+		rect.bottom = UTF8StringView (subStrings[3].c_str ()).toDouble ();
+		rectValid = true;
+	}
+}
+
+//-----------------------------------------------------------------------------
+InternedString::~InternedString ()
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	delete parsedValue.load ();
+#else
+	delete parsedValue;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+const ParsedValue& InternedString::getParsedValue () const
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	const ParsedValue* value = parsedValue.load (std::memory_order_acquire);
+	if (value)
+		return *value;
+	// another thread may parse the value at the same time, the first one is kept
+	ParsedValue* newValue = new ParsedValue (*this);
+	if (parsedValue.compare_exchange_strong (value, newValue, std::memory_order_acq_rel))
+		return *newValue;
+	delete newValue;
+	return *value;
+#else
+	if (parsedValue == 0)
+		parsedValue = new ParsedValue (*this);
+	return *parsedValue;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+static const ParsedValue* getParsedValue (UIAttributes::const_iterator begin, UIAttributes::const_iterator end, const std::string& name)
+{
+	UIAttributes::const_iterator it = findAttribute (begin, end, name);
+	if (it == end)
+		return 0;
+	return &static_cast<const InternedString&> (it->second).getParsedValue ();
+}
+
+} // UIAttributesPrivate
+/// @endcond
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 UIAttributes::UIAttributes (UTF8StringPtr* attributes)
+: data (0)
 {
 	if (attributes)
 	{
-		int32_t i = 0;
-		while (attributes[i] != NULL && attributes[i+1] != NULL)
+		int32_t numAttributes = 0;
+		while (attributes[numAttributes * 2] != NULL && attributes[numAttributes * 2 + 1] != NULL)
+			numAttributes++;
+		std::vector<std::string> strings (attributes, attributes + numAttributes * 2);
+		UIAttributesPrivate::EntryVector entries;
+		for (int32_t i = 0; i < numAttributes; i++)
+			entries.push_back (UIAttributesPrivate::Entry (&strings[i * 2], &strings[i * 2 + 1]));
+		// the first attribute with a name wins, like it did when this was a map
+		std::stable_sort (entries.begin (), entries.end ());
+		UIAttributesPrivate::EntryVector::iterator last = entries.end ();
+		for (UIAttributesPrivate::EntryVector::iterator it = entries.begin (); it != last && it + 1 != last;)
 		{
-			insert (std::make_pair (attributes[i], attributes[i+1]));
-			i += 2;
+			if (*(it + 1)->name == *it->name)
+				last = std::copy (it + 2, last, it + 1);
+			else
+				++it;
 		}
+		entries.erase (last, entries.end ());
+		data = UIAttributesPrivate::Table::instance ().acquire (entries);
 	}
 }
 
+//-----------------------------------------------------------------------------
+UIAttributes::UIAttributes (const UIAttributes& attributes)
+: CBaseObject ()
+, data (attributes.data)
+{
+	UIAttributesPrivate::Table::instance ().retain (data);
+}
+
 //-----------------------------------------------------------------------------
 UIAttributes::~UIAttributes ()
 {
+	UIAttributesPrivate::Table::instance ().release (data);
+}
+
+//-----------------------------------------------------------------------------
+UIAttributes& UIAttributes::operator= (const UIAttributes& attributes)
+{
+	UIAttributesPrivate::Table::instance ().retain (attributes.data);
+	setData (attributes.data);
+	return *this;
+}
+
+//-----------------------------------------------------------------------------
+void UIAttributes::setData (const UIAttributesData* newData)
+{
+	UIAttributesPrivate::Table::instance ().release (data);
+	data = newData;
+}
+
+//-----------------------------------------------------------------------------
+UIAttributes::const_iterator UIAttributes::begin () const
+{
+	return data ? data->begin () : 0;
+}
+
+//-----------------------------------------------------------------------------
+UIAttributes::const_iterator UIAttributes::end () const
+{
+	return data ? data->end () : 0;
+}
+
+//-----------------------------------------------------------------------------
+size_t UIAttributes::size () const
+{
+	return data ? data->numAttributes : 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -74,47 +513,58 @@ bool UIAttributes::hasAttribute (const std::string& name) const
 //-----------------------------------------------------------------------------
 const std::string* UIAttributes::getAttributeValue (const std::string& name) const
 {
-	const_iterator iter = find (name);
-	if (iter != end ())
-		return &iter->second;
+	const_iterator it = UIAttributesPrivate::findAttribute (begin (), end (), name);
+	if (it != end ())
+		return &it->second;
 	return 0;
 }
 
 //-----------------------------------------------------------------------------
 void UIAttributes::setAttribute (const std::string& name, const std::string& value)
 {
-	iterator iter = find (name);
-	if (iter != end ())
-		erase (iter);
-	insert (std::make_pair (name, value));
+	UIAttributesPrivate::EntryVector entries;
+	UIAttributesPrivate::getEntries (*this, entries);
+	UIAttributesPrivate::EntryVector::iterator it = std::lower_bound (entries.begin (), entries.end (), name, UIAttributesPrivate::EntryNameLess ());
+	if (it != entries.end () && *it->name == name)
+	{
+		it->value = &value;
+		it->valueInterned = false;
+	}
+	else
+		entries.insert (it, UIAttributesPrivate::Entry (&name, &value));
+	setData (UIAttributesPrivate::Table::instance ().acquire (entries));
 }
 
 #if VSTGUI_RVALUE_REF_SUPPORT
 //-----------------------------------------------------------------------------
 void UIAttributes::setAttribute (const std::string& name, std::string&& value)
 {
-	iterator iter = find (name);
-	if (iter != end ())
-		erase (iter);
-	insert (std::make_pair (name, std::move (value)));
+	setAttribute (name, static_cast<const std::string&> (value));
 }
 
 //-----------------------------------------------------------------------------
 void UIAttributes::setAttribute (std::string&& name, std::string&& value)
 {
-	iterator iter = find (name);
-	if (iter != end ())
-		erase (iter);
-	insert (std::make_pair (std::move (name), std::move (value)));
+	setAttribute (static_cast<const std::string&> (name), static_cast<const std::string&> (value));
 }
 #endif
 
 //-----------------------------------------------------------------------------
 void UIAttributes::removeAttribute (const std::string& name)
 {
-	iterator iter = find (name);
-	if (iter != end ())
-		erase (iter);
+	UIAttributesPrivate::EntryVector entries;
+	UIAttributesPrivate::getEntries (*this, entries);
+	UIAttributesPrivate::EntryVector::iterator it = std::lower_bound (entries.begin (), entries.end (), name, UIAttributesPrivate::EntryNameLess ());
+	if (it == entries.end () || *it->name != name)
+		return;
+	entries.erase (it);
+	setData (UIAttributesPrivate::Table::instance ().acquire (entries));
+}
+
+//-----------------------------------------------------------------------------
+void UIAttributes::removeAll ()
+{
+	setData (0);
 }
 
 //-----------------------------------------------------------------------------
@@ -130,16 +580,11 @@ void UIAttributes::setDoubleAttribute (const std::string& name, double value)
 //-----------------------------------------------------------------------------
 bool UIAttributes::getDoubleAttribute (const std::string& name, double& value) const
 {
-	const std::string* str = getAttributeValue (name);
-	if (str)
-	{
-		std::istringstream sstream (*str);
-		sstream.imbue (std::locale::classic ());
-		sstream.precision (40);
-		sstream >> value;
-		return true;
-	}
-	return false;
+	const UIAttributesPrivate::ParsedValue* parsed = UIAttributesPrivate::getParsedValue (begin (), end (), name);
+	if (parsed == 0)
+		return false;
+	value = parsed->number;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -179,13 +624,11 @@ void UIAttributes::setIntegerAttribute (const std::string& name, int32_t value)
 //-----------------------------------------------------------------------------
 bool UIAttributes::getIntegerAttribute (const std::string& name, int32_t& value) const
 {
-	const std::string* str = getAttributeValue (name);
-	if (str)
-	{
-		value = (int32_t)strtol (str->c_str (), 0, 10);
-		return true;
-	}
-	return false;
+	const UIAttributesPrivate::ParsedValue* parsed = UIAttributesPrivate::getParsedValue (begin (), end (), name);
+	if (parsed == 0)
+		return false;
+	value = parsed->integer;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -201,32 +644,11 @@ void UIAttributes::setPointAttribute (const std::string& name, const CPoint& p)
 //-----------------------------------------------------------------------------
 bool UIAttributes::getPointAttribute (const std::string& name, CPoint& p) const
 {
-	const std::string* str = getAttributeValue (name);
-	if (str)
-	{
-		size_t start = 0;
-		size_t pos = str->find (",", start, 1);
-		if (pos != std::string::npos)
-		{
-			StringArray subStrings;
-			while (pos != std::string::npos)
-			{
-				std::string name (*str, start, pos - start);
-				subStrings.push_back (name);
-				start = pos+1;
-				pos = str->find (",", start, 1);
-			}
-			std::string name (*str, start, std::string::npos);
-			subStrings.push_back (name);
-			if (subStrings.size () == 2)
-			{
-				p.x = UTF8StringView (subStrings[0].c_str ()).toDouble ();
-				p.y = UTF8StringView (subStrings[1].c_str ()).toDouble ();
-				return true;
-			}
-		}
-	}
-	return false;
+	const UIAttributesPrivate::ParsedValue* parsed = UIAttributesPrivate::getParsedValue (begin (), end (), name);
+	if (parsed == 0 || !parsed->pointValid)
+		return false;
+	p = parsed->point;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -246,34 +668,11 @@ void UIAttributes::setRectAttribute (const std::string& name, const CRect& r)
 //-----------------------------------------------------------------------------
 bool UIAttributes::getRectAttribute (const std::string& name, CRect& r) const
 {
-	const std::string* str = getAttributeValue (name);
-	if (str)
-	{
-		size_t start = 0;
-		size_t pos = str->find (",", start, 1);
-		if (pos != std::string::npos)
-		{
-			StringArray subStrings;
-			while (pos != std::string::npos)
-			{
-				std::string name (*str, start, pos - start);
-				subStrings.push_back (name);
-				start = pos+1;
-				pos = str->find (",", start, 1);
-			}
-			std::string name (*str, start, std::string::npos);
-			subStrings.push_back (name);
-			if (subStrings.size () == 4)
-			{
-				r.left = UTF8StringView (subStrings[0].c_str ()).toDouble ();
-				r.top = UTF8StringView (subStrings[1].c_str ()).toDouble ();
-				r.right = UTF8StringView (subStrings[2].c_str ()).toDouble ();
-				r.bottom = UTF8StringView (subStrings[3].c_str ()).toDouble ();
-				return true;
-			}
-		}
-	}
-	return false;
+	const UIAttributesPrivate::ParsedValue* parsed = UIAttributesPrivate::getParsedValue (begin (), end (), name);
+	if (parsed == 0 || !parsed->rectValid)
+		return false;
+	r = parsed->rect;
+	return true;
 }
 
 //-----------------------------------------------------------------------------
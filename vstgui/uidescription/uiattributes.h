@@ -38,28 +38,44 @@
 #include "../lib/vstguifwd.h"
 
 #include <string>
+#include <utility>
 #include <vector>
-#include "../lib/platform/std_unorderedmap.h"
 
 namespace VSTGUI {
 class OutputStream;
 class InputStream;
 
-typedef std::unordered_map<std::string,std::string> UIAttributesMap;
+struct UIAttributesData;
 
 //-----------------------------------------------------------------------------
-class UIAttributes : public CBaseObject, private UIAttributesMap
+/** The names and values of the attributes are kept in a process wide table of strings as long as attributes use them,
+	the typed values parsed from a value are kept with its string. Instances with the same attributes share their
+	storage, which is copied when one of them is changed. */
+//-----------------------------------------------------------------------------
+class UIAttributes : public CBaseObject
 {
 public:
 	typedef std::vector<std::string> StringArray;
-	
+	struct Attribute
+	{
+		const std::string& first;
+		const std::string& second;
+
+		Attribute (const std::string& name, const std::string& value) : first (name), second (value) {}
+		template<typename T1, typename T2> operator std::pair<T1, T2> () const { return std::pair<T1, T2> (first, second); }
+	};
+	typedef const Attribute* const_iterator;
+	typedef const_iterator iterator;
+
 	UIAttributes (UTF8StringPtr* attributes = 0);
+	UIAttributes (const UIAttributes& attributes);
 	~UIAttributes ();
 
-	using UIAttributesMap::begin;
-	using UIAttributesMap::end;
-	using UIAttributesMap::iterator;
-	using UIAttributesMap::const_iterator;
+	UIAttributes& operator= (const UIAttributes& attributes);
+
+	const_iterator begin () const;
+	const_iterator end () const;
+	size_t size () const;
 
 	bool hasAttribute (const std::string& name) const;
 	const std::string* getAttributeValue (const std::string& name) const;
@@ -90,10 +106,15 @@ public:
 	
 	static std::string createStringArrayValue (const StringArray& values);
 	
-	void removeAll () { clear (); }
+	void removeAll ();
 
 	bool store (OutputStream& stream) const;
 	bool restore (InputStream& stream);
+
+private:
+	void setData (const UIAttributesData* newData);
+
+	const UIAttributesData* data;
 };
 
 }
@@ -36,15 +36,23 @@
 #include "uiattributes.h"
 #include "uiviewfactory.h"
 #include "uiviewcreator.h"
+#include "uiviewswitchcontainer.h"
 #include "cstream.h"
 #include "base64codec.h"
 #include "../lib/cfont.h"
 #include "../lib/cstring.h"
 #include "../lib/cframe.h"
+#include "../lib/controls/ccontrol.h"
 #include "../lib/cdrawcontext.h"
 #include "../lib/cgradient.h"
 #include "../lib/cgraphicspath.h"
+#include "../lib/cbitmapatlas.h"
+#include "../lib/cbitmapcache.h"
+#include "../lib/cbitmapcodec.h"
 #include "../lib/cbitmapfilter.h"
+#include "../lib/cresourcepack.h"
+#include "../lib/cvstguitimer.h"
+#include "../lib/iviewlistener.h"
 #include "../lib/platform/std_unorderedmap.h"
 #include "../lib/platform/iplatformbitmap.h"
 #include "../lib/platform/iplatformfont.h"
@@ -53,6 +61,18 @@
 #include <fstream>
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <set>
+#include <typeinfo>
+
+#if VSTGUI_HAS_FUNCTIONAL
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+	#include <chrono>
+#endif
 
 namespace VSTGUI {
 
@@ -137,8 +157,8 @@ public:
 	~UINode ();
 
 	const std::string& getName () const { return name; }
-	std::stringstream& getData () { return data; }
-	const std::stringstream& getData () const { return data; }
+	std::string& getData () { return data; }
+	const std::string& getData () const { return data; }
 
 	UIAttributes* getAttributes () const { return attributes; }
 	UIDescList& getChildren () const { return *children; }
@@ -159,7 +179,7 @@ public:
 	CLASS_METHODS(UINode, CBaseObject)
 protected:
 	std::string name;
-	std::stringstream data;
+	std::string data;
 	UIAttributes* attributes;
 	UIDescList* children;
 	int32_t flags;
@@ -170,7 +190,52 @@ class UICommentNode : public UINode
 {
 public:
 	UICommentNode (const std::string& comment);
-	CLASS_METHODS_NOCOPY(UICommentNode, UINode)
+	CLASS_METHODS(UICommentNode, UINode)
+};
+
+//-----------------------------------------------------------------------------
+/** A template whose child nodes are parsed the first time the template is needed, see
+	UIDescription::addDeferredTemplate. */
+//-----------------------------------------------------------------------------
+class UIDeferredTemplateNode : public UINode
+{
+public:
+	UIDeferredTemplateNode (const UIAttributes& attributes, uint32_t sectionIndex);
+
+	uint32_t getSectionIndex () const { return sectionIndex; }
+	bool isLoaded () const { return loaded; }
+	void setLoaded () { loaded = true; }
+
+	CLASS_METHODS(UIDeferredTemplateNode, UINode)
+protected:
+	uint32_t sectionIndex;
+	bool loaded;
+};
+
+//-----------------------------------------------------------------------------
+/** The data child of a bitmap node. Base64 text is decoded while it is parsed, only the decoded bytes are kept and they
+	are encoded again when the node is written. The decoded bytes don't change, so they can be read on other threads. */
+//-----------------------------------------------------------------------------
+class UIBitmapDataNode : public UINode
+{
+public:
+	UIBitmapDataNode (const std::string& name, UIAttributes* attributes);
+	UIBitmapDataNode (const void* data, uint32_t dataSize);
+	UIBitmapDataNode (const UIBitmapDataNode& n);
+
+	bool isBase64 () const { return base64; }
+	void appendBase64Text (const int8_t* text, int32_t length);
+	void endBase64Text ();
+	void setDecodedData (const void* data, uint32_t dataSize);
+
+	const uint8_t* getDecodedData () const { return decodedData.empty () ? 0 : &decodedData[0]; }
+	uint32_t getDecodedDataSize () const { return static_cast<uint32_t> (decodedData.size ()); }
+
+	CLASS_METHODS(UIBitmapDataNode, UINode)
+protected:
+	std::vector<uint8_t> decodedData;
+	Base64Decoder decoder;
+	bool base64;
 };
 
 //-----------------------------------------------------------------------------
@@ -189,7 +254,7 @@ public:
 	double getNumber () const;
 	const std::string& getString () const;
 
-	CLASS_METHODS_NOCOPY(UIVariableNode, UINode)
+	CLASS_METHODS(UIVariableNode, UINode)
 protected:
 	Type type;
 	double number;
@@ -206,7 +271,7 @@ public:
 	const std::string* getTagString () const;
 	void setTagString (const std::string& str);
 	
-	CLASS_METHODS_NOCOPY(UIControlTagNode, UINode)
+	CLASS_METHODS(UIControlTagNode, UINode)
 protected:
 	int32_t tag;
 };
@@ -216,7 +281,10 @@ class UIBitmapNode : public UINode
 {
 public:
 	UIBitmapNode (const std::string& name, UIAttributes* attributes);
+	UIBitmapNode (const UIBitmapNode& n);
 	CBitmap* getBitmap (const std::string& pathHint);
+	CBitmap* getBitmap (IPlatformBitmap* platformBitmap);
+	CBitmap* getLoadedBitmap () const { return bitmap; }
 	void setBitmap (UTF8StringPtr bitmapName);
 	void setNinePartTiledOffset (const CRect* offsets);
 	void invalidBitmap ();
@@ -224,14 +292,25 @@ public:
 	void setFilterProcessed () { filterProcessed = true; }
 	bool getScaledBitmapsAdded () const { return scaledBitmapsAdded; }
 	void setScaledBitmapsAdded () { scaledBitmapsAdded = true; }
+	const CBitmapCache::Key& getCacheKey () const { return cacheKey; }
+	void setCacheKey (const CBitmapCache::Key& key) { cacheKey = key; }
+	/** the bitmap index of resourceIndex is dropped when the bitmap is loaded or released */
+	void setResourceIndex (UIResourceIndex* index) { resourceIndex = index; }
 	
-	void createXMLData (const std::string& pathHint);
+	void createXMLData (const std::string& pathHint, BitmapCodec::Format format = BitmapCodec::kPNG);
 	void removeXMLData ();
-	CLASS_METHODS_NOCOPY(UIBitmapNode, UINode)
+	CLASS_METHODS(UIBitmapNode, UINode)
 protected:
 	~UIBitmapNode ();
-	CBitmap* createBitmap (const std::string& str, CNinePartTiledDescription* partDesc) const;
+	CBitmap* createBitmap (IPlatformBitmap* platformBitmap) const;
+	bool getNinePartTiledDescription (CNinePartTiledDescription& partDesc) const;
+	void releaseBitmap ();
+	void bitmapChanged ();
 	CBitmap* bitmap;
+	CBitmapCache::Key cacheKey;
+	SharedPointer<UIResourceIndex> resourceIndex;
+	const IPlatformBitmap* xmlDataSource; // the platform bitmap the data child was created from, 0 if it was not created
+	BitmapCodec::Format xmlDataFormat;
 	bool filterProcessed;
 	bool scaledBitmapsAdded;
 };
@@ -241,11 +320,12 @@ class UIFontNode : public UINode
 {
 public:
 	UIFontNode (const std::string& name, UIAttributes* attributes);
+	UIFontNode (const UIFontNode& n);
 	CFontRef getFont ();
 	void setFont (CFontRef newFont);
 	void setAlternativeFontNames (UTF8StringPtr fontNames);
 	bool getAlternativeFontNames (std::string& fontNames);
-	CLASS_METHODS_NOCOPY(UIFontNode, UINode)
+	CLASS_METHODS(UIFontNode, UINode)
 protected:
 	~UIFontNode ();
 	CFontRef font;
@@ -258,7 +338,7 @@ public:
 	UIColorNode (const std::string& name, UIAttributes* attributes);
 	const CColor& getColor () const { return color; }
 	void setColor (const CColor& newColor);
-	CLASS_METHODS_NOCOPY(UIColorNode, UINode)
+	CLASS_METHODS(UIColorNode, UINode)
 protected:
 	CColor color;
 };
@@ -268,9 +348,10 @@ class UIGradientNode : public UINode
 {
 public:
 	UIGradientNode (const std::string& name, UIAttributes* attributes);
+	UIGradientNode (const UIGradientNode& n);
 	CGradient* getGradient ();
 	void setGradient (CGradient* g);
-	CLASS_METHODS_NOCOPY(UIGradientNode, UINode)
+	CLASS_METHODS(UIGradientNode, UINode)
 protected:
 	SharedPointer<CGradient> gradient;
 	
@@ -283,6 +364,17 @@ private:
 	typedef std::unordered_map<std::string, UINode*> ChildMap;
 public:
 	UIDescListWithFastFindAttributeNameChild () {}
+	UIDescListWithFastFindAttributeNameChild (const UIDescListWithFastFindAttributeNameChild& descList)
+	: UIDescList (descList)
+	{
+		// the base class constructor can't call our add method
+		for (const_iterator it = begin (); it != end (); ++it)
+		{
+			const std::string* nameAttributeValue = (*it)->getAttributes ()->getAttributeValue ("name");
+			if (nameAttributeValue)
+				childMap.insert (std::make_pair (*nameAttributeValue, *it));
+		}
+	}
 	
 	void add (UINode* obj) VSTGUI_OVERRIDE_VMETHOD
 	{
@@ -331,6 +423,8 @@ public:
 		if (nameAttributeValue)
 			childMap.insert (std::make_pair (*nameAttributeValue, node));
 	}
+
+	CLASS_METHODS(UIDescListWithFastFindAttributeNameChild, UIDescList)
 private:
 	ChildMap childMap;
 };
@@ -344,6 +438,7 @@ UIDescList::UIDescList (bool ownsObjects)
 
 //-----------------------------------------------------------------------------
 UIDescList::UIDescList (const UIDescList& descList)
+: ownsObjects (true)
 {
 	for (const_iterator it = descList.begin (); it != descList.end (); it++)
 	{
@@ -425,18 +520,140 @@ void UIDescList::sort ()
 	std::sort (begin (), end (), Compare ());
 }
 
+//-----------------------------------------------------------------------------
+/** Returns the bytes read to detect the format of the content before the rest of the content, so that content which
+	can't be rewound, like a stream which is not seekable, is parsed completely. It can't be rewound itself. */
+//-----------------------------------------------------------------------------
+class UIPrefixContentProvider : public Xml::IContentProvider
+{
+public:
+	UIPrefixContentProvider (Xml::IContentProvider* provider, const int8_t* prefix, uint32_t prefixSize)
+	: provider (provider), prefix (prefix), prefixSize (prefixSize), prefixPos (0) {}
+
+	uint32_t readRawXmlData (int8_t* buffer, uint32_t size) VSTGUI_OVERRIDE_VMETHOD
+	{
+		if (prefixPos < prefixSize)
+		{
+			uint32_t numBytes = std::min (size, prefixSize - prefixPos);
+			memcpy (buffer, prefix + prefixPos, numBytes);
+			prefixPos += numBytes;
+			return numBytes;
+		}
+		return provider->readRawXmlData (buffer, size);
+	}
+	void rewind () VSTGUI_OVERRIDE_VMETHOD {}
+protected:
+	Xml::IContentProvider* provider;
+	const int8_t* prefix;
+	uint32_t prefixSize;
+	uint32_t prefixPos;
+};
+
+//-----------------------------------------------------------------------------
+/** Keeps the text UIDescWriter created for the nodes, so that the next write only creates it again for the nodes
+	which were changed. A node is unchanged if its attribute storage, its data and its indentation are the same, the
+	attribute storage is never changed but replaced (see UIAttributes). The decoded data of a bitmap data node doesn't
+	change, so its encoded text is kept as long as the node exists. The entries of the nodes not written by the last
+	write are removed, which releases the removed nodes. */
+//-----------------------------------------------------------------------------
+class UIDescWriterCache : public CBaseObject
+{
+public:
+	struct Entry
+	{
+		SharedPointer<UINode> node;
+		UIAttributes attributes;
+		std::string data;
+		int32_t intendLevel;
+		bool hasChildren;
+		uint32_t generation;
+		std::string startText;	// the indented start tag with the data of the node, or the whole node without children
+		std::string endText;	// the indented end tag, empty without children
+
+		Entry () : intendLevel (0), hasChildren (false), generation (0) {}
+	};
+
+	UIDescWriterCache () : generation (0) {}
+
+	void beginWrite () { generation++; }
+	void endWrite ()
+	{
+		for (EntryMap::iterator it = entries.begin (); it != entries.end ();)
+		{
+			if (it->second.generation != generation)
+				entries.erase (it++);
+			else
+				++it;
+		}
+	}
+
+	/** returns the entry of the node if the node was not changed since it was written, otherwise 0 */
+	const Entry* find (UINode* node, int32_t intendLevel)
+	{
+		EntryMap::iterator it = entries.find (node);
+		if (it == entries.end ())
+			return 0;
+		Entry& entry = it->second;
+		if (entry.intendLevel != intendLevel || entry.hasChildren != !node->getChildren ().empty ())
+			return 0;
+		if (dynamic_cast<UIBitmapDataNode*> (node) == 0)
+		{
+			if (entry.attributes.begin () != node->getAttributes ()->begin () || entry.data != node->getData ())
+				return 0;
+		}
+		entry.generation = generation;
+		return &entry;
+	}
+
+	/** takes the text, the strings are empty afterwards */
+	void add (UINode* node, int32_t intendLevel, std::string& startText, std::string& endText)
+	{
+		Entry& entry = entries[node];
+		entry.node = node;
+		entry.attributes = *node->getAttributes ();
+		entry.data = node->getData ();
+		entry.intendLevel = intendLevel;
+		entry.hasChildren = !node->getChildren ().empty ();
+		entry.generation = generation;
+		entry.startText.swap (startText);
+		entry.endText.swap (endText);
+	}
+
+	CLASS_METHODS_NOCOPY (UIDescWriterCache, CBaseObject)
+protected:
+	typedef std::unordered_map<const UINode*, Entry> EntryMap;
+	EntryMap entries;
+	uint32_t generation;
+};
+
+//-----------------------------------------------------------------------------
+/** Writes the nodes as XML. The text of every node is created in one buffer, the attribute values are escaped while
+	they are appended, and written to the stream in one piece. With a cache the text of unchanged nodes is not created
+	again. */
 //-----------------------------------------------------------------------------
 class UIDescWriter
 {
 public:
+	UIDescWriter (UIDescWriterCache* cache = 0) : cache (cache), intendLevel (0) {}
+
 	bool write (OutputStream& stream, UINode* rootNode);
+	/** writes the node without the XML declaration and the cache */
+	bool writeElement (OutputStream& stream, UINode* node);
 protected:
-	static void encodeAttributeString (std::string& str);
+	static void appendEncodedAttributeString (const std::string& str, std::string& text);
 
 	bool writeNode (UINode* node, OutputStream& stream);
-	bool writeComment (UICommentNode* node, OutputStream& stream);
-	bool writeNodeData (std::stringstream& str, OutputStream& stream);
-	bool writeAttributes (UIAttributes* attr, OutputStream& stream);
+	bool writeText (const std::string& text, OutputStream& stream);
+	bool createText (UINode* node, std::string& startText, std::string& endText);
+	void appendStartText (UINode* node, std::string& text);
+	void appendEndText (UINode* node, std::string& text);
+	void appendComment (UICommentNode* node, std::string& text);
+	bool appendBitmapData (UIBitmapDataNode* node, std::string& text);
+	void appendNodeData (const char* data, size_t dataSize, std::string& text);
+	void appendAttributes (UIAttributes* attr, std::string& text);
+	void appendIndentation (std::string& text) { text.append (static_cast<size_t> (intendLevel), '\t'); }
+
+	UIDescWriterCache* cache;
 	int32_t intendLevel;
 };
 
@@ -444,284 +661,1703 @@ protected:
 bool UIDescWriter::write (OutputStream& stream, UINode* rootNode)
 {
 	intendLevel = 0;
-	stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-	return writeNode (rootNode, stream);
+	if (!writeText ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", stream))
+		return false;
+	if (cache)
+		cache->beginWrite ();
+	bool result = writeNode (rootNode, stream);
+	if (result && cache)
+		cache->endWrite ();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescWriter::writeElement (OutputStream& stream, UINode* node)
+{
+	intendLevel = 0;
+	UIDescWriterCache* savedCache = cache;
+	cache = 0;
+	bool result = writeNode (node, stream);
+	cache = savedCache;
+	return result;
 }
 
 //-----------------------------------------------------------------------------
-void UIDescWriter::encodeAttributeString (std::string& str)
+bool UIDescWriter::writeText (const std::string& text, OutputStream& stream)
 {
-	const int8_t entities[] = {'&', '<','>', '\'', '\"', 0};
-	const char* replacements[] = {"&amp;", "&lt;", "&gt;", "&apos;", "&quot;"};
-	int32_t i = 0;
-	while (entities[i] != 0)
+	return stream.writeRaw (text.data (), static_cast<uint32_t> (text.size ())) == text.size ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescWriter::appendEncodedAttributeString (const std::string& str, std::string& text)
+{
+	const char* start = str.data ();
+	const char* end = start + str.size ();
+	for (const char* pos = start; pos != end; ++pos)
 	{
-		size_t pos = 0;
-		while ((pos = str.find (entities[i], pos)) != std::string::npos)
+		const char* replacement;
+		switch (*pos)
 		{
-			str.replace (pos, 1, replacements[i]);
-			pos++;
+			case '&': replacement = "&amp;"; break;
+			case '<': replacement = "&lt;"; break;
+			case '>': replacement = "&gt;"; break;
+			case '\'': replacement = "&apos;"; break;
+			case '\"': replacement = "&quot;"; break;
+			default: continue;
 		}
-		i++;
+		text.append (start, pos);
+		text.append (replacement);
+		start = pos + 1;
+	}
+	text.append (start, end);
+}
+
+//-----------------------------------------------------------------------------
+void UIDescWriter::appendAttributes (UIAttributes* attr, std::string& text)
+{
+	// the attributes are sorted by name
+	for (UIAttributes::const_iterator it = attr->begin (), end = attr->end (); it != end; ++it)
+	{
+		if (it->second.empty ())
+			continue;
+		text += ' ';
+		text += it->first;
+		text += "=\"";
+		appendEncodedAttributeString (it->second, text);
+		text += '\"';
+	}
+}
+
+//-----------------------------------------------------------------------------
+void UIDescWriter::appendNodeData (const char* data, size_t dataSize, std::string& text)
+{
+	const size_t kLineLength = 82;
+	text.reserve (text.size () + dataSize + (dataSize / kLineLength + 1) * (static_cast<size_t> (intendLevel) + 1));
+	for (size_t pos = 0; pos < dataSize; pos += kLineLength)
+	{
+		appendIndentation (text);
+		text.append (data + pos, std::min (kLineLength, dataSize - pos));
+		text += '\n';
 	}
 }
 
 //-----------------------------------------------------------------------------
-bool UIDescWriter::writeAttributes (UIAttributes* attr, OutputStream& stream)
+bool UIDescWriter::appendBitmapData (UIBitmapDataNode* node, std::string& text)
 {
+	text += '<';
+	text += node->getName ();
+	appendAttributes (node->getAttributes (), text);
+	text += ">\n";
+	intendLevel++;
 	bool result = true;
-	typedef std::map<std::string,std::string> SortedAttributes;
-	SortedAttributes sortedAttributes (attr->begin (), attr->end ());
-	for (SortedAttributes::const_iterator it = sortedAttributes.begin (), end = sortedAttributes.end (); it != end; ++it)
+	if (node->getDecodedDataSize () > 0)
 	{
-		if ((*it).second.length () > 0)
-		{
-			stream << " ";
-			stream << (*it).first;
-			stream << "=\"";
-			std::string value ((*it).second);
-			encodeAttributeString (value);
-			stream << value;
-			stream << "\"";
-		}
+		Base64Codec bd;
+		result = bd.init (node->getDecodedData (), node->getDecodedDataSize ());
+		if (result)
+			appendNodeData (reinterpret_cast<const char*> (bd.getData ()), bd.getDataSize (), text);
 	}
+	intendLevel--;
+	appendIndentation (text);
+	text += "</";
+	text += node->getName ();
+	text += ">\n";
 	return result;
 }
 
 //-----------------------------------------------------------------------------
-bool UIDescWriter::writeNodeData (std::stringstream& str, OutputStream& stream)
+void UIDescWriter::appendComment (UICommentNode* node, std::string& text)
+{
+	text += "<!--";
+	text += node->getData ();
+	text += "-->\n";
+}
+
+//-----------------------------------------------------------------------------
+void UIDescWriter::appendStartText (UINode* node, std::string& text)
 {
-	for (int32_t i = 0; i < intendLevel; i++) stream << "\t";
-	str.seekg (0);
-	uint32_t i = 0;
-	while (str.tellg () < str.tellp ())
+	text += '<';
+	text += node->getName ();
+	appendAttributes (node->getAttributes (), text);
+	if (node->getChildren ().empty () && node->getData ().empty ())
 	{
-		int8_t byte;
-		str >> byte;
-		stream << byte;
-		if (i++ > 80)
-		{
-			stream << "\n";
-			i = 0;
-			for (int32_t i = 0; i < intendLevel; i++) stream << "\t";
-		}
+		text += "/>\n";
+		return;
 	}
-	stream << "\n";
-	return true;
+	text += ">\n";
+	intendLevel++;
+	appendNodeData (node->getData ().data (), node->getData ().size (), text);
+	intendLevel--;
 }
 
 //-----------------------------------------------------------------------------
-bool UIDescWriter::writeComment (UICommentNode* node, OutputStream& stream)
+void UIDescWriter::appendEndText (UINode* node, std::string& text)
 {
-	stream << "<!--";
-	stream << node->getData ().str ();
-	stream << "-->\n";
-	return true;
+	if (node->getChildren ().empty () && node->getData ().empty ())
+		return;
+	appendIndentation (text);
+	text += "</";
+	text += node->getName ();
+	text += ">\n";
 }
 
 //-----------------------------------------------------------------------------
-bool UIDescWriter::writeNode (UINode* node, OutputStream& stream)
+bool UIDescWriter::createText (UINode* node, std::string& startText, std::string& endText)
 {
-	bool result = true;
-	if (node->noExport ())
-		return result;
-	for (int32_t i = 0; i < intendLevel; i++) stream << "\t";
+	appendIndentation (startText);
 	if (UICommentNode* commentNode = dynamic_cast<UICommentNode*> (node))
 	{
-		return writeComment (commentNode, stream);
+		appendComment (commentNode, startText);
+		return true;
 	}
-	stream << "<";
-	stream << node->getName ();
-	result = writeAttributes (node->getAttributes (), stream);
-	if (result)
+	UIBitmapDataNode* bitmapDataNode = dynamic_cast<UIBitmapDataNode*> (node);
+	if (bitmapDataNode && bitmapDataNode->isBase64 ())
+		return appendBitmapData (bitmapDataNode, startText);
+	appendStartText (node, startText);
+	appendEndText (node, endText);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescWriter::writeNode (UINode* node, OutputStream& stream)
+{
+	if (node->noExport ())
+		return true;
+	std::string startText;
+	std::string endText;
+	const UIDescWriterCache::Entry* entry = cache ? cache->find (node, intendLevel) : 0;
+	if (entry == 0 && !createText (node, startText, endText))
+		return false;
+	if (!writeText (entry ? entry->startText : startText, stream))
+		return false;
+	UIDescList& children = node->getChildren ();
+	if (!children.empty ())
 	{
-		UIDescList& children = node->getChildren ();
-		if (!children.empty ())
+		intendLevel++;
+		for (UIDescList::iterator it = children.begin (), end = children.end (); it != end; ++it)
 		{
-			stream << ">\n";
-			intendLevel++;
-			if (node->getData ().str ().length () > 0)
-				result = writeNodeData (node->getData (), stream);
-			for (UIDescList::iterator it = children.begin (), end = children.end (); it != end; ++it)
-			{
-				if (!writeNode (*it, stream))
-					return false;
-			}
-			intendLevel--;
-			for (int32_t i = 0; i < intendLevel; i++) stream << "\t";
-			stream << "</";
-			stream << node->getName ();
-			stream << ">\n";
-		}
-		else if (node->getData ().str ().length () > 0)
-		{
-			stream << ">\n";
-			intendLevel++;
-			result = writeNodeData (node->getData (), stream);
-			intendLevel--;
-			for (int32_t i = 0; i < intendLevel; i++) stream << "\t";
-			stream << "</";
-			stream << node->getName ();
-			stream << ">\n";
+			if (!writeNode (*it, stream))
+				return false;
 		}
-		else
-			stream << "/>\n";
+		intendLevel--;
 	}
-	return result;
+	if (!writeText (entry ? entry->endText : endText, stream))
+		return false;
+	if (entry == 0 && cache)
+		cache->add (node, intendLevel, startText, endText);
+	return true;
 }
-/// @endcond
 
 //-----------------------------------------------------------------------------
+/** The compiled format written with UIDescription::kWriteCompiledFormat.
+
+	All numbers are 32 bit little endian values. The header is followed by the offsets of the strings, the node
+	records, the attribute records, the strings and the bitmap data:
+	- header: 'VGUC', version, number of strings, size of the strings, number of nodes, number of attributes, size of the data
+	- node: kind, name, text, parent, first attribute, number of attributes, data offset, data size.
+	  The nodes are stored depth first, a parent is always stored before its children, the root node has no parent.
+	- attribute: name, value
+	- strings: all zero terminated, stored once and referenced by their index. They can be used directly from the data.
+	- data: the decoded bitmap data of the bitmap data nodes
+*/
 //-----------------------------------------------------------------------------
+namespace UICompiledFormat {
+
+static const uint32_t kVersion = 1;
+static const uint32_t kHeaderSize = 7 * 4;
+static const uint32_t kNodeSize = 8 * 4;
+static const uint32_t kAttributeSize = 2 * 4;
+static const uint32_t kNoIndex = 0xFFFFFFFF;
+
+enum NodeKind {
+	kElement,
+	kComment,
+	kBitmapData
+};
+
+struct Node
+{
+	uint32_t kind;
+	uint32_t name;
+	uint32_t text;
+	uint32_t parent;
+	uint32_t firstAttribute;
+	uint32_t numAttributes;
+	uint32_t dataOffset;
+	uint32_t dataSize;
+};
+
 //-----------------------------------------------------------------------------
-bool UIDescription::parseColor (const std::string& colorString, CColor& color)
+static bool isCompiled (const void* data, uint32_t size)
 {
-	if (colorString.length () == 7)
-	{
-		if (colorString[0] == '#')
-		{
-			std::string rv (colorString.substr (1, 2));
-			std::string gv (colorString.substr (3, 2));
-			std::string bv (colorString.substr (5, 2));
-			color.red = (uint8_t)strtol (rv.c_str (), 0, 16);
-			color.green = (uint8_t)strtol (gv.c_str (), 0, 16);
-			color.blue = (uint8_t)strtol (bv.c_str (), 0, 16);
-			color.alpha = 255;
-			return true;
-		}
-	}
-	if (colorString.length () == 9)
-	{
-		if (colorString[0] == '#')
-		{
-			std::string rv (colorString.substr (1, 2));
-			std::string gv (colorString.substr (3, 2));
-			std::string bv (colorString.substr (5, 2));
-			std::string av (colorString.substr (7, 2));
-			color.red = (uint8_t)strtol (rv.c_str (), 0, 16);
-			color.green = (uint8_t)strtol (gv.c_str (), 0, 16);
-			color.blue = (uint8_t)strtol (bv.c_str (), 0, 16);
-			color.alpha = (uint8_t)strtol (av.c_str (), 0, 16);
-			return true;
-		}
-	}
-	return false;
+	return size >= 4 && memcmp (data, "VGUC", 4) == 0;
 }
 
 //-----------------------------------------------------------------------------
-static UIViewFactory* getGenericViewFactory ()
+static uint32_t readUInt32 (const uint8_t* ptr)
 {
-	static UIViewFactory genericViewFactory;
-	return &genericViewFactory;
+	return static_cast<uint32_t> (ptr[0]) | (static_cast<uint32_t> (ptr[1]) << 8) | (static_cast<uint32_t> (ptr[2]) << 16) | (static_cast<uint32_t> (ptr[3]) << 24);
 }
 
-namespace UIDescriptionPrivate {
 //-----------------------------------------------------------------------------
-static bool decodeScaleFactorFromName (std::string name, double& scaleFactor)
+class Reader
 {
-	size_t index = name.find_last_of ("#");
-	if (index == std::string::npos)
+public:
+	Reader () : data (0), numStrings (0), numNodes (0), numAttributes (0) {}
+
+	bool init (const uint8_t* data, uint32_t size);
+
+	uint32_t getNumNodes () const { return numNodes; }
+	Node getNode (uint32_t index) const;
+	bool getAttribute (uint32_t index, UTF8StringPtr& name, UTF8StringPtr& value) const;
+	UTF8StringPtr getString (uint32_t index) const;
+	const uint8_t* getData (const Node& node) const { return bitmapData + node.dataOffset; }
+protected:
+	const uint8_t* data;
+	const uint8_t* nodeRecords;
+	const uint8_t* attributeRecords;
+	const uint8_t* strings;
+	const uint8_t* bitmapData;
+	uint32_t numStrings;
+	uint32_t stringsSize;
+	uint32_t numNodes;
+	uint32_t numAttributes;
+	uint32_t dataSize;
+};
+
+//-----------------------------------------------------------------------------
+bool Reader::init (const uint8_t* _data, uint32_t size)
+{
+	if (size < kHeaderSize || !isCompiled (_data, size) || readUInt32 (_data + 4) != kVersion)
 		return false;
-	name.erase (0, index+1);
-	index = name.find_last_of ("x");
-	if (index == std::string::npos)
+	numStrings = readUInt32 (_data + 8);
+	stringsSize = readUInt32 (_data + 12);
+	numNodes = readUInt32 (_data + 16);
+	numAttributes = readUInt32 (_data + 20);
+	dataSize = readUInt32 (_data + 24);
+	uint64_t requiredSize = kHeaderSize + static_cast<uint64_t> (numStrings) * 4 + static_cast<uint64_t> (numNodes) * kNodeSize
+						  + static_cast<uint64_t> (numAttributes) * kAttributeSize + stringsSize + dataSize;
+	if (requiredSize > size || (stringsSize > 0 && _data[requiredSize - dataSize - 1] != 0))
 		return false;
-	name.erase (index);
-	scaleFactor = UTF8StringView (name.c_str ()).toDouble ();
+	data = _data;
+	nodeRecords = data + kHeaderSize + numStrings * 4;
+	attributeRecords = nodeRecords + numNodes * kNodeSize;
+	strings = attributeRecords + numAttributes * kAttributeSize;
+	bitmapData = strings + stringsSize;
 	return true;
 }
 
 //-----------------------------------------------------------------------------
-static std::string removeScaleFactorFromName (std::string name)
+Node Reader::getNode (uint32_t index) const
 {
-	size_t index = name.find_last_of ("#");
-	if (index == std::string::npos)
-		return "";
-	name.erase (index);
-	return name;
+	const uint8_t* record = nodeRecords + index * kNodeSize;
+	Node node;
+	node.kind = readUInt32 (record);
+	node.name = readUInt32 (record + 4);
+	node.text = readUInt32 (record + 8);
+	node.parent = readUInt32 (record + 12);
+	node.firstAttribute = readUInt32 (record + 16);
+	node.numAttributes = readUInt32 (record + 20);
+	node.dataOffset = readUInt32 (record + 24);
+	node.dataSize = readUInt32 (record + 28);
+	if (node.dataOffset > dataSize || node.dataSize > dataSize - node.dataOffset)
+		node.dataSize = node.dataOffset = 0;
+	if (node.firstAttribute > numAttributes || node.numAttributes > numAttributes - node.firstAttribute)
+		node.numAttributes = node.firstAttribute = 0;
+	return node;
 }
-} // UIDescriptionPrivate
-
-IdStringPtr IUIDescription::kCustomViewName = "custom-view-name";
 
 //-----------------------------------------------------------------------------
-IdStringPtr UIDescription::kMessageTagChanged = "kMessageTagChanged";
-IdStringPtr UIDescription::kMessageColorChanged = "kMessageColorChanged";
-IdStringPtr UIDescription::kMessageFontChanged = "kMessageFontChanged";
-IdStringPtr UIDescription::kMessageBitmapChanged = "kMessageBitmapChanged";
-IdStringPtr UIDescription::kMessageTemplateChanged = "kMessageTemplateChanged";
-IdStringPtr UIDescription::kMessageGradientChanged = "kMessageGradientChanged";
-IdStringPtr UIDescription::kMessageBeforeSave = "kMessageBeforeSave";
+bool Reader::getAttribute (uint32_t index, UTF8StringPtr& name, UTF8StringPtr& value) const
+{
+	const uint8_t* record = attributeRecords + index * kAttributeSize;
+	name = getString (readUInt32 (record));
+	value = getString (readUInt32 (record + 4));
+	return name && value;
+}
 
 //-----------------------------------------------------------------------------
-UIDescription::UIDescription (const CResourceDescription& xmlFile, IViewFactory* _viewFactory)
-: xmlFile (xmlFile)
-, nodes (0)
-, controller (0)
-, viewFactory (_viewFactory)
-, xmlContentProvider (0)
-, bitmapCreator (0)
-, restoreViewsMode (false)
+UTF8StringPtr Reader::getString (uint32_t index) const
 {
-	if (xmlFile.type == CResourceDescription::kStringType && xmlFile.u.name != 0)
-		setFilePath (xmlFile.u.name);
-	if (viewFactory == 0)
-		viewFactory = getGenericViewFactory ();
+	if (index >= numStrings)
+		return 0;
+	uint32_t offset = readUInt32 (data + kHeaderSize + index * 4);
+	if (offset >= stringsSize)
+		return 0;
+	return reinterpret_cast<UTF8StringPtr> (strings + offset);
 }
 
 //-----------------------------------------------------------------------------
-UIDescription::UIDescription (Xml::IContentProvider* xmlContentProvider, IViewFactory* _viewFactory)
-: nodes (0)
-, controller (0)
-, viewFactory (_viewFactory)
-, xmlContentProvider (xmlContentProvider)
-, bitmapCreator (0)
-, restoreViewsMode (false)
+class Writer
 {
-	memset (&xmlFile, 0, sizeof (CResourceDescription));
-	if (viewFactory == 0)
-		viewFactory = getGenericViewFactory ();
+public:
+	bool write (OutputStream& stream, UINode* rootNode);
+protected:
+	uint32_t addString (const std::string& str);
+	void addNode (UINode* node, uint32_t parent);
+	static bool writeUInt32s (OutputStream& stream, const std::vector<uint32_t>& values);
+
+	typedef std::map<std::string, uint32_t> StringMap;
+	StringMap stringMap;
+	std::string strings;
+	std::vector<uint32_t> stringOffsets;
+	std::vector<uint32_t> nodeRecords;
+	std::vector<uint32_t> attributeRecords;
+	std::vector<uint8_t> bitmapData;
+};
+
+//-----------------------------------------------------------------------------
+bool Writer::write (OutputStream& stream, UINode* rootNode)
+{
+	addNode (rootNode, kNoIndex);
+	if (strings.size () + bitmapData.size () > 0x7FFFFFFF)
+		return false;
+	std::vector<uint32_t> header;
+	header.push_back (kVersion);
+	header.push_back (static_cast<uint32_t> (stringOffsets.size ()));
+	header.push_back (static_cast<uint32_t> (strings.size ()));
+	header.push_back (static_cast<uint32_t> (nodeRecords.size () * 4 / kNodeSize));
+	header.push_back (static_cast<uint32_t> (attributeRecords.size () * 4 / kAttributeSize));
+	header.push_back (static_cast<uint32_t> (bitmapData.size ()));
+	ByteOrder byteOrder = stream.getByteOrder ();
+	stream.setByteOrder (kLittleEndianByteOrder);
+	bool result = stream.writeRaw ("VGUC", 4) == 4
+			   && writeUInt32s (stream, header)
+			   && writeUInt32s (stream, stringOffsets)
+			   && writeUInt32s (stream, nodeRecords)
+			   && writeUInt32s (stream, attributeRecords)
+			   && stream.writeRaw (strings.data (), static_cast<uint32_t> (strings.size ())) == strings.size ()
+			   && (bitmapData.empty () || stream.writeRaw (&bitmapData[0], static_cast<uint32_t> (bitmapData.size ())) == bitmapData.size ());
+	stream.setByteOrder (byteOrder);
+	return result;
 }
 
 //-----------------------------------------------------------------------------
-UIDescription::~UIDescription ()
+bool Writer::writeUInt32s (OutputStream& stream, const std::vector<uint32_t>& values)
 {
-	if (nodes)
-		nodes->forget ();
+	for (std::vector<uint32_t>::const_iterator it = values.begin (), end = values.end (); it != end; ++it)
+	{
+		if (!(stream << *it))
+			return false;
+	}
+	return true;
 }
 
-//------------------------------------------------------------------------
-void UIDescription::setFilePath (UTF8StringPtr path)
+//-----------------------------------------------------------------------------
+uint32_t Writer::addString (const std::string& str)
 {
-	filePath = path;
-	xmlFile.u.name = filePath.c_str (); // make sure that xmlFile.u.name points to valid memory
+	StringMap::const_iterator it = stringMap.find (str);
+	if (it != stringMap.end ())
+		return it->second;
+	uint32_t index = static_cast<uint32_t> (stringOffsets.size ());
+	stringOffsets.push_back (static_cast<uint32_t> (strings.size ()));
+	strings.append (str.c_str (), str.size () + 1);
+	stringMap.insert (std::make_pair (str, index));
+	return index;
 }
 
 //-----------------------------------------------------------------------------
-void UIDescription::addDefaultNodes ()
+void Writer::addNode (UINode* node, uint32_t parent)
 {
-	UINode* fontsNode = getBaseNode (MainNodeNames::kFont);
-	if (fontsNode)
+	if (node->noExport ())
+		return;
+	uint32_t index = static_cast<uint32_t> (nodeRecords.size () * 4 / kNodeSize);
+	uint32_t kind = kElement;
+	uint32_t text = kNoIndex;
+	uint32_t dataOffset = 0;
+	uint32_t dataSize = 0;
+	if (dynamic_cast<UICommentNode*> (node))
+		kind = kComment;
+	UIBitmapDataNode* bitmapDataNode = dynamic_cast<UIBitmapDataNode*> (node);
+	if (bitmapDataNode && bitmapDataNode->isBase64 ())
 	{
-		struct DefaultFont {
-			UTF8StringPtr name;
-			CFontRef font;
-		};
+		kind = kBitmapData;
+		dataOffset = static_cast<uint32_t> (bitmapData.size ());
+		dataSize = bitmapDataNode->getDecodedDataSize ();
+		if (dataSize > 0)
+			bitmapData.insert (bitmapData.end (), bitmapDataNode->getDecodedData (), bitmapDataNode->getDecodedData () + dataSize);
+	}
+	else if (!node->getData ().empty ())
+		text = addString (node->getData ());
 
-		const DefaultFont defaultFonts [] = {
-			{ "~ SystemFont", kSystemFont },
-			{ "~ NormalFontVeryBig", kNormalFontVeryBig },
-			{ "~ NormalFontBig", kNormalFontBig },
-			{ "~ NormalFont", kNormalFont },
-			{ "~ NormalFontSmall", kNormalFontSmall },
-			{ "~ NormalFontSmaller", kNormalFontSmaller },
-			{ "~ NormalFontVerySmall", kNormalFontVerySmall },
-			{ "~ SymbolFont", kSymbolFont },
-			{ 0, 0 },
-		};
-		int32_t i = 0;
-		while (defaultFonts[i].name != 0)
-		{
+	// sorted like in the XML format, so that the same nodes always create the same data
+	typedef std::map<std::string,std::string> SortedAttributes;
+	SortedAttributes sortedAttributes (node->getAttributes ()->begin (), node->getAttributes ()->end ());
+	uint32_t firstAttribute = static_cast<uint32_t> (attributeRecords.size () * 4 / kAttributeSize);
+	uint32_t numAttributes = 0;
+	for (SortedAttributes::const_iterator it = sortedAttributes.begin (), end = sortedAttributes.end (); it != end; ++it)
+	{
+		if ((*it).second.length () == 0)
+			continue;
+		attributeRecords.push_back (addString ((*it).first));
+		attributeRecords.push_back (addString ((*it).second));
+		++numAttributes;
+	}
+
+	nodeRecords.push_back (kind);
+	nodeRecords.push_back (addString (node->getName ()));
+	nodeRecords.push_back (text);
+	nodeRecords.push_back (parent);
+	nodeRecords.push_back (firstAttribute);
+	nodeRecords.push_back (numAttributes);
+	nodeRecords.push_back (dataOffset);
+	nodeRecords.push_back (dataSize);
+	if (kind == kElement)
+	{
+		for (UIDescList::iterator it = node->getChildren ().begin (), end = node->getChildren ().end (); it != end; ++it)
+			addNode (*it, index);
+	}
+}
+
+} // namespace UICompiledFormat
+
+//-----------------------------------------------------------------------------
+/** the structure of a view node prepared for instantiation.
+	The node attributes are still read from the node, as the editor may change them in place.
+*/
+class UIViewPlan : public CBaseObject
+{
+public:
+	UIViewPlan (UINode* node);
+
+	struct Child
+	{
+		SharedPointer<UIViewPlan> view;
+		CViewAttributeID attributeID;
+		std::string attributeValue;
+	};
+	typedef std::vector<Child> ChildList;
+
+	UINode* getNode () const { return node; }
+	const UIAttributes& getAttributes () const { return *node->getAttributes (); }
+	const std::string* getTemplateName () const { return hasTemplateName ? &templateName : 0; }
+	const std::string* getSubControllerName () const { return hasSubControllerName ? &subControllerName : 0; }
+	const std::string* getViewClass () const { return hasViewClass ? &viewClass : 0; }
+	const ChildList& getChildren () const { return children; }
+	bool hasChildViews () const { return numChildViews > 0; }
+	/** the view is created by the controller from its custom-view-name */
+	bool hasCustomViewName () const { return customViewName; }
+
+	CView* getPrototype () const { return prototype; }
+	bool hasPrototypeFailed () const { return prototypeFailed; }
+	void setPrototype (CView* view) { prototype = view; prototypeFailed = view == 0; }
+
+protected:
+	SharedPointer<UINode> node;
+	std::string templateName;
+	std::string subControllerName;
+	std::string viewClass;
+	ChildList children;
+	SharedPointer<CView> prototype;
+	uint32_t numChildViews;
+	bool prototypeFailed;
+	bool hasTemplateName;
+	bool hasSubControllerName;
+	bool hasViewClass;
+	bool customViewName;
+};
+
+//-----------------------------------------------------------------------------
+UIViewPlan::UIViewPlan (UINode* node)
+: node (node)
+, numChildViews (0)
+, prototypeFailed (false)
+, hasTemplateName (false)
+, hasSubControllerName (false)
+, hasViewClass (false)
+, customViewName (false)
+{
+	const UIAttributes* attributes = node->getAttributes ();
+	customViewName = attributes->hasAttribute (IUIDescription::kCustomViewName);
+	const std::string* value = attributes->getAttributeValue (MainNodeNames::kTemplate);
+	if (value)
+	{
+		// a template reference ignores the child nodes
+		templateName = *value;
+		hasTemplateName = true;
+		return;
+	}
+	if ((value = attributes->getAttributeValue ("sub-controller")))
+	{
+		subControllerName = *value;
+		hasSubControllerName = true;
+	}
+	if ((value = attributes->getAttributeValue (UIViewCreator::kAttrClass)))
+	{
+		viewClass = *value;
+		hasViewClass = true;
+	}
+	VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, node->getChildren (), UINode*, itNode)
+		if (itNode->getName () == "view")
+		{
+			Child child;
+			child.view = owned (new UIViewPlan (itNode));
+			child.attributeID = 0;
+			children.push_back (child);
+			++numChildViews;
+		}
+		else if (itNode->getName () == "attribute")
+		{
+			const std::string* attrName = itNode->getAttributes ()->getAttributeValue ("id");
+			const std::string* attrValue = itNode->getAttributes ()->getAttributeValue ("value");
+			if (attrName && attrValue)
+			{
+				CViewAttributeID attrId = 0;
+				if (attrName->size () == 4)
+				{
+					char c1 = (*attrName)[0];
+					char c2 = (*attrName)[1];
+					char c3 = (*attrName)[2];
+					char c4 = (*attrName)[3];
+					attrId = ((((size_t)c1) << 24) | (((size_t)c2) << 16) | (((size_t)c3) << 8) | (((size_t)c4) << 0));
+				}
+				else
+					attrId = (CViewAttributeID)strtol (attrName->c_str (), 0, 10);
+				if (attrId)
+				{
+					Child child;
+					child.attributeID = attrId;
+					child.attributeValue = *attrValue;
+					children.push_back (child);
+				}
+			}
+		}
+	VSTGUI_RANGE_BASED_FOR_LOOP_END
+}
+
+namespace UIDescriptionPrivate {
+class StringToken;
+typedef std::vector<StringToken> StringTokenVector;
+} // UIDescriptionPrivate
+
+//-----------------------------------------------------------------------------
+/** an expression of calculateStringValue compiled to a postfix program.
+	The last result is kept until one of the tags or variables it depends on changes.
+*/
+class UIExpression : public CBaseObject
+{
+public:
+	static UIExpression* compile (UTF8StringPtr str);
+
+	void evaluate (const UIDescription* description);
+
+	bool hasResult () const { return resultState != kNoResult; }
+	bool getResult (double& value) const { value = result; return resultState == kValidResult; }
+	void setResult (double value, bool valid) { result = value; resultState = valid ? kValidResult : kInvalidResult; }
+	void resetResult () { resultState = kNoResult; }
+
+	bool dependsOn (const std::string& name) const { return dependencies.find (name) != dependencies.end (); }
+	bool dependsOnTags () const { return usesTags; }
+	void addDependencies (const UIExpression* expression);
+
+protected:
+	UIExpression ();
+
+	enum OpCode {
+		kPushNumber,
+		kPushTag,
+		kPushVariable,
+		kAdd,
+		kSubtract,
+		kMultiply,
+		kDivide,
+		kNegate
+	};
+
+	struct Op
+	{
+		OpCode code;
+		double value;
+		std::string name;
+
+		Op (OpCode code, double value = 0.) : code (code), value (value) {}
+		Op (OpCode code, const std::string& name) : code (code), value (0.), name (name) {}
+	};
+	typedef std::vector<Op> OpList;
+
+	enum ResultState {
+		kNoResult,
+		kValidResult,
+		kInvalidResult
+	};
+
+	bool compileSum (const UIDescriptionPrivate::StringTokenVector& tokens, size_t& pos);
+	bool compileProduct (const UIDescriptionPrivate::StringTokenVector& tokens, size_t& pos);
+	bool compileFactor (const UIDescriptionPrivate::StringTokenVector& tokens, size_t& pos);
+	void addDependency (const std::string& name);
+
+	OpList ops;
+	std::set<std::string> dependencies;
+	double result;
+	ResultState resultState;
+	bool compiled;
+	bool usesTags;
+};
+
+//-----------------------------------------------------------------------------
+/** a hashed index from a resource value to the first node with this value */
+template<typename KeyType>
+class UIResourceValueIndex
+{
+public:
+	UIResourceValueIndex () : valid (false) {}
+
+	bool isValid () const { return valid; }
+	void setValid () { valid = true; }
+	void clear () { map.clear (); valid = false; }
+
+	void add (const KeyType& key, UINode* node) { map.insert (std::make_pair (key, node)); }
+	UINode* find (const KeyType& key) const
+	{
+		typename Map::const_iterator it = map.find (key);
+		return it != map.end () ? it->second : 0;
+	}
+
+private:
+	typedef std::unordered_map<KeyType, UINode*> Map;
+	Map map;
+	bool valid;
+};
+
+//-----------------------------------------------------------------------------
+/** the reverse lookup indexes of the resources, dropped when a resource changes */
+class UIResourceIndex : public CBaseObject
+{
+public:
+	UIResourceValueIndex<uint32_t> colors;
+	UIResourceValueIndex<int32_t> tags;
+	UIResourceValueIndex<const CFontDesc*> fonts;
+	UIResourceValueIndex<const CBitmap*> bitmaps;
+	UIResourceValueIndex<std::string> gradients;
+};
+
+/// @endcond
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool UIDescription::parseColor (const std::string& colorString, CColor& color)
+{
+	if ((colorString.length () == 7 || colorString.length () == 9) && colorString[0] == '#')
+	{
+		uint8_t channels[4] = {0, 0, 0, 255};
+		for (size_t i = 0, numChannels = (colorString.length () - 1) / 2; i < numChannels; i++)
+		{
+			char hex[3] = {colorString[1 + i * 2], colorString[2 + i * 2], 0};
+			channels[i] = (uint8_t)strtol (hex, 0, 16);
+		}
+		color.red = channels[0];
+		color.green = channels[1];
+		color.blue = channels[2];
+		color.alpha = channels[3];
+		return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+static UIViewFactory* getGenericViewFactory ()
+{
+	static UIViewFactory genericViewFactory;
+	return &genericViewFactory;
+}
+
+namespace UIDescriptionPrivate {
+static const uint32_t kBitmapAtlasPageSize = 1024;
+
+//-----------------------------------------------------------------------------
+static bool decodeScaleFactorFromName (std::string name, double& scaleFactor)
+{
+	size_t index = name.find_last_of ("#");
+	if (index == std::string::npos)
+		return false;
+	name.erase (0, index+1);
+	index = name.find_last_of ("x");
+	if (index == std::string::npos)
+		return false;
+	name.erase (index);
+	scaleFactor = UTF8StringView (name.c_str ()).toDouble ();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+static std::string removeScaleFactorFromName (std::string name)
+{
+	size_t index = name.find_last_of ("#");
+	if (index == std::string::npos)
+		return "";
+	name.erase (index);
+	return name;
+}
+
+//-----------------------------------------------------------------------------
+static const CResourcePack::Entry* findResourcePackEntry (const CResourcePack* pack, const std::string& path)
+{
+	if (pack == 0 || path.empty ())
+		return 0;
+	const CResourcePack::Entry* entry = pack->find (path.c_str ());
+	size_t index = path.find_last_of ("/\\");
+	if (entry == 0 && index != std::string::npos)
+		entry = pack->find (path.c_str () + index + 1);
+	return entry;
+}
+
+//-----------------------------------------------------------------------------
+/** The parsed nodes shared by UIDescription instances, see UIDescription::setSharedParsingEnabled. The kept nodes are
+	never changed and never handed out, the instances get copies of them. */
+//-----------------------------------------------------------------------------
+class SharedParsedNodes
+{
+public:
+	static SharedParsedNodes& instance ()
+	{
+		static SharedParsedNodes gInstance;
+		return gInstance;
+	}
+
+	static std::string makeFileKey (UTF8StringPtr path) { return std::string ("file:") + path; }
+
+	UINode* copy (const std::string& key) const
+	{
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		NodeMap::const_iterator it = nodeMap.find (key);
+		if (it == nodeMap.end ())
+			return 0;
+		return static_cast<UINode*> (it->second->newCopy ());
+	}
+
+	void add (const std::string& key, const UINode* nodes)
+	{
+		SharedPointer<UINode> nodesCopy = owned (static_cast<UINode*> (nodes->newCopy ()));
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		nodeMap[key] = nodesCopy;
+	}
+
+	void remove (const std::string& key)
+	{
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		nodeMap.erase (key);
+	}
+
+	void removeAll ()
+	{
+	#if VSTGUI_HAS_FUNCTIONAL
+		std::lock_guard<std::mutex> guard (mutex);
+	#endif
+		nodeMap.clear ();
+	}
+private:
+	typedef std::map<std::string, SharedPointer<UINode> > NodeMap;
+	NodeMap nodeMap;
+#if VSTGUI_HAS_FUNCTIONAL
+	mutable std::mutex mutex;
+#endif
+};
+
+//-----------------------------------------------------------------------------
+class ScaledBitmapLoader : public CBitmapCache::ILoader
+{
+public:
+	ScaledBitmapLoader (const UIDescription* description, UIBitmapNode* node, const std::string& name)
+	: description (description), node (node), name (name) {}
+
+	IPlatformBitmap* loadPlatformBitmap (const CBitmapCache::Key& key) VSTGUI_OVERRIDE_VMETHOD
+	{
+		IPlatformBitmap* platformBitmap = 0;
+		CBitmap* bitmap = description->getBitmap (name.c_str ());
+		if (bitmap && (platformBitmap = bitmap->getPlatformBitmap ()))
+			platformBitmap->remember ();
+		node->invalidBitmap ();
+		return platformBitmap;
+	}
+private:
+	const UIDescription* description;
+	SharedPointer<UIBitmapNode> node;
+	std::string name;
+};
+
+//-----------------------------------------------------------------------------
+/** the plan of a prototype view, copied with the prototype */
+static const CViewAttributeID kViewPlanAttribute = 'uivp';
+
+//-----------------------------------------------------------------------------
+static bool isPrototypeCopy (CView* prototype, CView* copy)
+{
+	// views which don't implement a copy constructor are copied as their base class
+	if (copy == 0 || typeid (*prototype) != typeid (*copy))
+		return false;
+	// the view switch controller is owned by the container
+	if (dynamic_cast<UIViewSwitchContainer*> (prototype))
+		return false;
+	CViewContainer* prototypeContainer = dynamic_cast<CViewContainer*> (prototype);
+	CViewContainer* copyContainer = dynamic_cast<CViewContainer*> (copy);
+	if (prototypeContainer == 0)
+		return true;
+	if (prototypeContainer->getNbViews () != copyContainer->getNbViews ())
+		return false;
+	ViewIterator prototypeIt (prototypeContainer);
+	ViewIterator copyIt (copyContainer);
+	while (*prototypeIt)
+	{
+		if (!isPrototypeCopy (*prototypeIt, *copyIt))
+			return false;
+		++prototypeIt;
+		++copyIt;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+/** same as the control-tag attribute of the CControl view creator, for the copies of a prototype */
+static void bindControlTag (CControl* control, const std::string& tagName, const IUIDescription* description)
+{
+	if (tagName.length () == 0)
+	{
+		control->setTag (-1);
+		control->setListener (0);
+		return;
+	}
+	int32_t tag = description->getTagForName (tagName.c_str ());
+	if (tag == -1)
+	{
+		char* endPtr = 0;
+		tag = (int32_t)strtol (tagName.c_str (), &endPtr, 10);
+		if (endPtr == tagName.c_str ())
+			return;
+	}
+	control->setListener (description->getControlListener (tagName.c_str ()));
+	control->setTag (tag);
+}
+
+//-----------------------------------------------------------------------------
+/** the name the controller calls of a view are recorded with, 0 without a profiler */
+static UTF8StringPtr getProfilerViewName (const UIDescriptionProfiler* profiler, const UIAttributes& attributes)
+{
+	if (profiler == 0)
+		return 0;
+	const std::string* name = attributes.getAttributeValue (IUIDescription::kCustomViewName);
+	if (name == 0)
+		name = attributes.getAttributeValue (UIViewCreator::kAttrClass);
+	return name ? name->c_str () : "CViewContainer";
+}
+
+} // UIDescriptionPrivate
+
+/// @cond ignore
+//-----------------------------------------------------------------------------
+/** Loads the platform bitmap of a bitmap node. The constructor copies everything decode and runFilters need from the
+	node, so that they can run on another thread, the rest is done by UIDescription::completeBitmapLoad on the UI thread. */
+//-----------------------------------------------------------------------------
+class UIBitmapLoadJob : public CBaseObject
+{
+public:
+	enum State {
+		kQueued,
+		kDecoding,
+		kDecoded,
+		kCompleted
+	};
+
+	UIBitmapLoadJob (UIBitmapNode* node, const std::string& name, const std::string& pathHint, CResourcePack* resourcePack = 0);
+
+	void decode ();
+	void runFilters ();
+
+	bool hasPath () const { return hasPathAttribute; }
+	std::string getCacheResource (const std::string& filePath) const;
+
+	SharedPointer<UIBitmapNode> node;
+	std::string name;
+	CBitmapCache::Key cacheKey;
+	BitmapFilter::Pipeline filters;
+	SharedPointer<IPlatformBitmap> platformBitmap;
+	double pathScaleFactor; // scale factor decoded from the path, 0 if the path has none
+
+	SharedPointer<CBitmap> bitmap; // the bitmap the platform bitmap is set on, or 0 if it's created on completion
+
+	// only used when decoding on background threads
+	State state;
+	std::list<CView*> views;
+	SharedPointer<CBitmap> scaleVariantOf;
+	SharedPointer<CBitmapCache::ILoader> scaleVariantLoader;
+protected:
+	std::string path;
+	std::string absolutePath;
+	SharedPointer<UIBitmapDataNode> dataNode;
+	SharedPointer<CResourcePack> resourcePack;
+	double dataScaleFactor;
+	bool hasPathAttribute;
+	bool hasDataScaleFactor;
+};
+
+//-----------------------------------------------------------------------------
+UIBitmapLoadJob::UIBitmapLoadJob (UIBitmapNode* node, const std::string& name, const std::string& pathHint, CResourcePack* resourcePack)
+: node (node)
+, name (name)
+, pathScaleFactor (0.)
+, state (kQueued)
+, resourcePack (resourcePack)
+, dataScaleFactor (1.)
+, hasPathAttribute (false)
+, hasDataScaleFactor (false)
+{
+	const std::string* pathAttr = node->getAttributes ()->getAttributeValue ("path");
+	if (pathAttr == 0)
+		return;
+	hasPathAttribute = true;
+	path = *pathAttr;
+	if (pathIsAbsolute (pathHint))
+	{
+		absolutePath = pathHint;
+		if (removeLastPathComponent (absolutePath))
+			absolutePath += "/" + path;
+		else
+			absolutePath.clear ();
+	}
+	dataNode = dynamic_cast<UIBitmapDataNode*> (node->getChildren ().findChildNode ("data"));
+	if (dataNode && dataNode->isBase64 () && dataNode->getDecodedDataSize () > 0)
+		hasDataScaleFactor = node->getAttributes ()->getDoubleAttribute ("scale-factor", dataScaleFactor);
+	else
+		dataNode = 0;
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapLoadJob::decode ()
+{
+	if (!hasPathAttribute)
+		return;
+	const CResourcePack::Entry* packEntry = UIDescriptionPrivate::findResourcePackEntry (resourcePack, path);
+	if (packEntry)
+		platformBitmap = owned (resourcePack->createBitmap (packEntry->name));
+	else
+	{
+		platformBitmap = owned (IPlatformBitmap::create ());
+		if (platformBitmap && !platformBitmap->load (CResourceDescription (path.c_str ())))
+			platformBitmap = 0;
+	}
+	if (platformBitmap == 0 && !absolutePath.empty ())
+		platformBitmap = owned (BitmapCodec::createFromPath (absolutePath.c_str ()));
+	if (platformBitmap == 0 && dataNode)
+	{
+		platformBitmap = owned (BitmapCodec::createFromMemory (dataNode->getDecodedData (), dataNode->getDecodedDataSize ()));
+		if (platformBitmap && hasDataScaleFactor)
+			platformBitmap->setScaleFactor (dataScaleFactor);
+	}
+	if (platformBitmap && platformBitmap->getScaleFactor () == 1.)
+	{
+		double scaleFactor = 1.;
+		if (UIDescriptionPrivate::decodeScaleFactorFromName (path, scaleFactor))
+		{
+			platformBitmap->setScaleFactor (scaleFactor);
+			pathScaleFactor = scaleFactor;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+std::string UIBitmapLoadJob::getCacheResource (const std::string& filePath) const
+{
+	// bitmaps with the same content share one platform bitmap, even if they come from different descriptions
+	if (const CResourcePack::Entry* packEntry = UIDescriptionPrivate::findResourcePackEntry (resourcePack, path))
+		return CBitmapCache::Key::makeContentResource (packEntry->data, packEntry->size);
+	std::string resource = filePath + ":" + path;
+	if (dataNode)
+		resource += ":" + CBitmapCache::Key::makeContentResource (dataNode->getDecodedData (), dataNode->getDecodedDataSize ());
+	return resource;
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapLoadJob::runFilters ()
+{
+	if (platformBitmap == 0 || filters.getNumFilters () == 0)
+		return;
+	SharedPointer<CBitmap> input = owned (new CBitmap (platformBitmap));
+	if (filters.run (input))
+		platformBitmap = filters.getOutputBitmap ()->getPlatformBitmap ();
+}
+
+#if VSTGUI_HAS_FUNCTIONAL
+//-----------------------------------------------------------------------------
+/** Decodes the bitmaps of an UIDescription on background threads.
+	Jobs are completed on the UI thread by a timer, or immediately when their bitmap is needed. The views which
+	requested a bitmap while they were created get invalidated when the bitmap is completed. */
+//-----------------------------------------------------------------------------
+class UIBitmapDecoder : public IViewListenerAdapter
+{
+public:
+	typedef std::function<void (UIBitmapLoadJob*)> CompletionFunc;
+
+	UIBitmapDecoder (const CompletionFunc& completion);
+	~UIBitmapDecoder ();
+
+	CBitmap* add (UIBitmapLoadJob* job, CBitmap* placeholder);
+	UIBitmapLoadJob* findJob (CBitmap* placeholder) const;
+	void finish (UIBitmapLoadJob* job);
+	void finishAll ();
+
+	void beginViewCreation ();
+	void endViewCreation (CView* view);
+	void bitmapRequested (CBitmap* bitmap);
+
+	typedef std::vector<std::vector<SharedPointer<UIBitmapLoadJob> > > ViewCreationStack;
+	void suspendViewCreation (size_t depth, ViewCreationStack& suspended);
+	void resumeViewCreation (ViewCreationStack& suspended);
+
+	void viewWillDelete (CView* view) VSTGUI_OVERRIDE_VMETHOD;
+protected:
+	class DeferredLoader;
+
+	struct Worker
+	{
+		std::thread thread;
+		bool done;
+
+		Worker () : done (false) {}
+	};
+
+	void startWorkers ();
+	void work (Worker& worker);
+	void complete (UIBitmapLoadJob* job);
+	void completeDecodedJobs ();
+
+	typedef std::list<SharedPointer<UIBitmapLoadJob> > JobList;
+	typedef std::vector<SharedPointer<UIBitmapLoadJob> > JobVector;
+	typedef std::map<CView*, uint32_t> ViewMap;
+
+	CompletionFunc completion;
+	JobList jobs;
+	std::vector<JobVector> viewCreationStack;
+	ViewMap views;
+	SharedPointer<CVSTGUITimer> timer;
+
+	// guarded by mutex
+	std::deque<UIBitmapLoadJob*> queue;
+	std::list<Worker> workers;
+	std::mutex mutex;
+	std::condition_variable jobDecoded;
+};
+
+//-----------------------------------------------------------------------------
+class UIBitmapDecoder::DeferredLoader : public CBitmap::IDeferredLoader
+{
+public:
+	DeferredLoader (UIBitmapDecoder* decoder, UIBitmapLoadJob* job) : decoder (decoder), job (job) {}
+
+	void loadNow (CBitmap* bitmap) VSTGUI_OVERRIDE_VMETHOD { decoder->finish (job); }
+protected:
+	UIBitmapDecoder* decoder;
+	UIBitmapLoadJob* job;
+};
+
+//-----------------------------------------------------------------------------
+UIBitmapDecoder::UIBitmapDecoder (const CompletionFunc& completion)
+: completion (completion)
+{
+}
+
+//-----------------------------------------------------------------------------
+UIBitmapDecoder::~UIBitmapDecoder ()
+{
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		queue.clear ();
+	}
+	for (std::list<Worker>::iterator it = workers.begin (), end = workers.end (); it != end; ++it)
+		it->thread.join ();
+	if (timer)
+		timer->stop ();
+	for (JobList::const_iterator it = jobs.begin (), end = jobs.end (); it != end; ++it)
+		(*it)->bitmap->setDeferredLoader (0);
+	for (ViewMap::const_iterator it = views.begin (), end = views.end (); it != end; ++it)
+		it->first->unregisterViewListener (this);
+}
+
+//-----------------------------------------------------------------------------
+CBitmap* UIBitmapDecoder::add (UIBitmapLoadJob* job, CBitmap* placeholder)
+{
+	job->bitmap = placeholder;
+	placeholder->setDeferredLoader (owned (new DeferredLoader (this, job)));
+	jobs.push_back (job);
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		job->state = UIBitmapLoadJob::kQueued;
+		queue.push_back (job);
+		startWorkers ();
+	}
+	if (timer == 0)
+		timer = owned (new CVSTGUITimer ([this] (CVSTGUITimer*) { completeDecodedJobs (); }, 16, false));
+	timer->start ();
+	return placeholder;
+}
+
+//-----------------------------------------------------------------------------
+UIBitmapLoadJob* UIBitmapDecoder::findJob (CBitmap* placeholder) const
+{
+	for (JobList::const_iterator it = jobs.begin (), end = jobs.end (); it != end; ++it)
+	{
+		if ((*it)->bitmap == placeholder)
+			return *it;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::startWorkers ()
+{
+	// called with the mutex locked
+	for (std::list<Worker>::iterator it = workers.begin (); it != workers.end ();)
+	{
+		if (it->done)
+		{
+			it->thread.join ();
+			it = workers.erase (it);
+		}
+		else
+			++it;
+	}
+	size_t maxWorkers = std::min<size_t> (std::max<size_t> (std::thread::hardware_concurrency (), 1), 4);
+	while (workers.size () < maxWorkers && workers.size () < queue.size ())
+	{
+		workers.push_back (Worker ());
+		Worker& worker = workers.back ();
+		worker.thread = std::thread ([this, &worker] () { work (worker); });
+	}
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::work (Worker& worker)
+{
+	std::unique_lock<std::mutex> lock (mutex);
+	while (!queue.empty ())
+	{
+		UIBitmapLoadJob* job = queue.front ();
+		queue.pop_front ();
+		job->state = UIBitmapLoadJob::kDecoding;
+		lock.unlock ();
+		job->decode ();
+		job->runFilters ();
+		lock.lock ();
+		job->state = UIBitmapLoadJob::kDecoded;
+		jobDecoded.notify_all ();
+	}
+	worker.done = true;
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::finish (UIBitmapLoadJob* job)
+{
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		if (job->state == UIBitmapLoadJob::kQueued)
+		{
+			// not started yet, so it's faster to decode it here than to wait for a worker
+			queue.erase (std::find (queue.begin (), queue.end (), job));
+			job->state = UIBitmapLoadJob::kDecoding;
+			lock.unlock ();
+			job->decode ();
+			job->runFilters ();
+			lock.lock ();
+			job->state = UIBitmapLoadJob::kDecoded;
+		}
+		else
+		{
+			while (job->state == UIBitmapLoadJob::kDecoding)
+				jobDecoded.wait (lock);
+		}
+	}
+	complete (job);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::finishAll ()
+{
+	while (!jobs.empty ())
+		finish (jobs.front ());
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::complete (UIBitmapLoadJob* inJob)
+{
+	SharedPointer<UIBitmapLoadJob> job (inJob);
+	JobList::iterator it = std::find (jobs.begin (), jobs.end (), job);
+	if (it == jobs.end ())
+		return;
+	jobs.erase (it);
+	job->state = UIBitmapLoadJob::kCompleted;
+	completion (job);
+	for (std::list<CView*>::const_iterator viewIt = job->views.begin (), end = job->views.end (); viewIt != end; ++viewIt)
+	{
+		CView* view = *viewIt;
+		view->invalid ();
+		ViewMap::iterator mapIt = views.find (view);
+		if (mapIt != views.end () && --mapIt->second == 0)
+		{
+			views.erase (mapIt);
+			view->unregisterViewListener (this);
+		}
+	}
+	job->views.clear ();
+	if (jobs.empty () && timer)
+		timer->stop ();
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::completeDecodedJobs ()
+{
+	JobVector decodedJobs;
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		for (JobList::const_iterator it = jobs.begin (), end = jobs.end (); it != end; ++it)
+		{
+			if ((*it)->state == UIBitmapLoadJob::kDecoded)
+				decodedJobs.push_back (*it);
+		}
+	}
+	for (JobVector::const_iterator it = decodedJobs.begin (), end = decodedJobs.end (); it != end; ++it)
+		complete (*it);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::beginViewCreation ()
+{
+	viewCreationStack.push_back (JobVector ());
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::endViewCreation (CView* view)
+{
+	if (viewCreationStack.empty ())
+		return;
+	JobVector requestedJobs;
+	requestedJobs.swap (viewCreationStack.back ());
+	viewCreationStack.pop_back ();
+	if (view == 0)
+		return;
+	for (JobVector::const_iterator it = requestedJobs.begin (), end = requestedJobs.end (); it != end; ++it)
+	{
+		if ((*it)->state == UIBitmapLoadJob::kCompleted)
+			continue;
+		(*it)->views.push_back (view);
+		if (views[view]++ == 0)
+			view->registerViewListener (this);
+	}
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::bitmapRequested (CBitmap* bitmap)
+{
+	if (viewCreationStack.empty () || !bitmap->isLoadDeferred ())
+		return;
+	if (UIBitmapLoadJob* job = findJob (bitmap))
+		viewCreationStack.back ().push_back (job);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::viewWillDelete (CView* view)
+{
+	for (JobList::const_iterator it = jobs.begin (), end = jobs.end (); it != end; ++it)
+		(*it)->views.remove (view);
+	views.erase (view);
+	view->unregisterViewListener (this);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::suspendViewCreation (size_t depth, ViewCreationStack& suspended)
+{
+	// moves the innermost view creations out, to continue them later
+	depth = std::min (depth, viewCreationStack.size ());
+	suspended.clear ();
+	for (std::vector<JobVector>::iterator it = viewCreationStack.end () - static_cast<std::ptrdiff_t> (depth), end = viewCreationStack.end (); it != end; ++it)
+	{
+		suspended.push_back (JobVector ());
+		suspended.back ().swap (*it);
+	}
+	viewCreationStack.resize (viewCreationStack.size () - depth);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDecoder::resumeViewCreation (ViewCreationStack& suspended)
+{
+	for (ViewCreationStack::iterator it = suspended.begin (), end = suspended.end (); it != end; ++it)
+	{
+		viewCreationStack.push_back (JobVector ());
+		viewCreationStack.back ().swap (*it);
+	}
+	suspended.clear ();
+}
+
+//-----------------------------------------------------------------------------
+/** runs the parsing of a description on a thread and reports the result on the UI thread */
+class UIAsyncParser
+{
+public:
+	typedef std::function<bool ()> ParseFunc;
+	typedef std::function<void (bool success)> CompletionFunc;
+
+	UIAsyncParser (const ParseFunc& parse, const CompletionFunc& completion);
+	~UIAsyncParser ();
+
+	bool isFinished () const { return finished; }
+	void finish () { checkDone (true); }
+	/** the time the parse function took in microseconds, valid when finished */
+	uint64_t getParseTime () const { return parseTime; }
+protected:
+	void checkDone (bool wait);
+
+	CompletionFunc completion;
+	SharedPointer<CVSTGUITimer> timer;
+	std::thread thread;
+	uint64_t parseTime;
+	bool finished;
+
+	// guarded by mutex
+	std::mutex mutex;
+	bool done;
+	bool success;
+};
+
+//-----------------------------------------------------------------------------
+UIAsyncParser::UIAsyncParser (const ParseFunc& parse, const CompletionFunc& completion)
+: completion (completion)
+, parseTime (0)
+, finished (false)
+, done (false)
+, success (false)
+{
+	timer = owned (new CVSTGUITimer ([this] (CVSTGUITimer*) { checkDone (false); }, 16, true));
+	thread = std::thread ([this, parse] () {
+		uint64_t startTime = UIDescriptionProfiler::getMicroseconds ();
+		bool result = parse ();
+		// read after the thread is joined
+		parseTime = UIDescriptionProfiler::getMicroseconds () - startTime;
+		std::unique_lock<std::mutex> lock (mutex);
+		success = result;
+		done = true;
+	});
+}
+
+//-----------------------------------------------------------------------------
+UIAsyncParser::~UIAsyncParser ()
+{
+	if (thread.joinable ())
+		thread.join ();
+	timer->stop ();
+}
+
+//-----------------------------------------------------------------------------
+void UIAsyncParser::checkDone (bool wait)
+{
+	if (finished)
+		return;
+	if (!wait)
+	{
+		std::unique_lock<std::mutex> lock (mutex);
+		if (!done)
+			return;
+	}
+	thread.join ();
+	timer->stop ();
+	finished = true;
+	// the completion may delete the description and this parser
+	CompletionFunc func (completion);
+	func (success);
+}
+
+//-----------------------------------------------------------------------------
+/** the state of a view created in time slices by UIDescription::createViewIncrementally */
+class UIViewBuilder : public CBaseObject, public IViewListenerAdapter
+{
+public:
+	struct Frame
+	{
+		const UIViewPlan* plan;
+		CView* view;
+		CViewContainer* container;
+		IController* subController;
+		size_t nextChild;
+
+		Frame (const UIViewPlan* plan, CView* view, IController* subController)
+		: plan (plan)
+		, view (view)
+		, container (view && plan->hasChildViews () ? dynamic_cast<CViewContainer*> (view) : 0)
+		, subController (subController)
+		, nextChild (0)
+		{}
+	};
+	typedef std::vector<Frame> FrameStack;
+
+	UIViewBuilder (UIViewPlan* plan, UTF8StringPtr templateName, IController* controller, CView* placeholder, uint32_t timeBudget, const UIDescription::ViewCompletionFunc& completion);
+	~UIViewBuilder ();
+
+	void viewWillDelete (CView* view) VSTGUI_OVERRIDE_VMETHOD;
+
+	SharedPointer<UIViewPlan> plan;
+	std::string templateName;
+	CView* placeholder;
+	uint32_t timeBudget;
+	UIDescription::ViewCompletionFunc completion;
+	SharedPointer<CVSTGUITimer> timer;
+
+	// the view creation context between the time slices
+	IController* controller;
+	std::deque<IController*> subControllerStack;
+	UIBitmapDecoder::ViewCreationStack bitmapRequests;
+	FrameStack frames;
+	CView* result;
+	bool started;
+};
+
+//-----------------------------------------------------------------------------
+UIViewBuilder::UIViewBuilder (UIViewPlan* plan, UTF8StringPtr templateName, IController* controller, CView* placeholder, uint32_t timeBudget, const UIDescription::ViewCompletionFunc& completion)
+: plan (plan)
+, templateName (templateName)
+, placeholder (placeholder)
+, timeBudget (timeBudget)
+, completion (completion)
+, controller (controller)
+, result (0)
+, started (false)
+{
+	placeholder->registerViewListener (this);
+}
+
+//-----------------------------------------------------------------------------
+UIViewBuilder::~UIViewBuilder ()
+{
+	if (placeholder)
+		placeholder->unregisterViewListener (this);
+}
+
+//-----------------------------------------------------------------------------
+void UIViewBuilder::viewWillDelete (CView* view)
+{
+	// the building is canceled with the next time slice
+	placeholder->unregisterViewListener (this);
+	placeholder = 0;
+}
+
+#endif // VSTGUI_HAS_FUNCTIONAL
+/// @endcond
+
+//-----------------------------------------------------------------------------
+UIDescriptionProfiler::UIDescriptionProfiler ()
+: currentScope (0)
+{
+}
+
+//-----------------------------------------------------------------------------
+void UIDescriptionProfiler::reset ()
+{
+	report = Report ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescriptionProfiler::addTime (Phase phase, uint64_t time, UTF8StringPtr name)
+{
+	report.phases[phase].time += time;
+	report.phases[phase].count++;
+	if (name)
+	{
+		Entry& entry = report.phaseEntries[phase][name];
+		entry.time += time;
+		entry.count++;
+	}
+}
+
+//-----------------------------------------------------------------------------
+IdStringPtr UIDescriptionProfiler::getPhaseName (Phase phase)
+{
+	switch (phase)
+	{
+		case kParse: return "parse";
+		case kViewTree: return "view tree";
+		case kExpressions: return "expressions";
+		case kBitmaps: return "bitmaps";
+		case kFonts: return "fonts";
+		case kControllerCreateView: return "IController::createView";
+		case kControllerVerifyView: return "IController::verifyView";
+		case kControllerSubController: return "IController::createSubController";
+		case kViewCreatorCreate: return "IViewCreator::create";
+		case kViewCreatorApply: return "IViewCreator::apply";
+		case kNumPhases: break;
+	}
+	return "";
+}
+
+//-----------------------------------------------------------------------------
+uint64_t UIDescriptionProfiler::getMicroseconds ()
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	return static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::microseconds> (std::chrono::steady_clock::now ().time_since_epoch ()).count ());
+#else
+	return static_cast<uint64_t> (IPlatformFrame::getTicks ()) * 1000;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+uint64_t UIDescriptionProfiler::Report::getTotalTime () const
+{
+	uint64_t time = 0;
+	for (int32_t i = 0; i < kNumPhases; i++)
+		time += phases[i].time;
+	return time;
+}
+
+//-----------------------------------------------------------------------------
+UIDescriptionProfiler::Scope::Scope (UIDescriptionProfiler* profiler, Phase phase, UTF8StringPtr name)
+: profiler (profiler)
+, parent (0)
+, name (name)
+, phase (phase)
+, startTime (0)
+, nestedTime (0)
+{
+	if (profiler)
+	{
+		parent = profiler->currentScope;
+		profiler->currentScope = this;
+		startTime = getMicroseconds ();
+	}
+}
+
+//-----------------------------------------------------------------------------
+UIDescriptionProfiler::Scope::~Scope ()
+{
+	if (profiler == 0)
+		return;
+	uint64_t time = getMicroseconds () - startTime;
+	profiler->addTime (phase, time > nestedTime ? time - nestedTime : 0, name);
+	if (phase == kViewTree && name)
+	{
+		Entry& entry = profiler->report.templates[name];
+		entry.time += time;
+		entry.count++;
+	}
+	if (parent)
+		parent->nestedTime += time;
+	profiler->currentScope = parent;
+}
+
+IdStringPtr IUIDescription::kCustomViewName = "custom-view-name";
+
+//-----------------------------------------------------------------------------
+IdStringPtr UIDescription::kMessageTagChanged = "kMessageTagChanged";
+IdStringPtr UIDescription::kMessageColorChanged = "kMessageColorChanged";
+IdStringPtr UIDescription::kMessageFontChanged = "kMessageFontChanged";
+IdStringPtr UIDescription::kMessageBitmapChanged = "kMessageBitmapChanged";
+IdStringPtr UIDescription::kMessageTemplateChanged = "kMessageTemplateChanged";
+IdStringPtr UIDescription::kMessageGradientChanged = "kMessageGradientChanged";
+IdStringPtr UIDescription::kMessageBeforeSave = "kMessageBeforeSave";
+
+//-----------------------------------------------------------------------------
+UIDescription::UIDescription (const CResourceDescription& xmlFile, IViewFactory* _viewFactory)
+: xmlFile (xmlFile)
+, nodes (0)
+, controller (0)
+, viewFactory (_viewFactory)
+, xmlContentProvider (0)
+, bitmapCreator (0)
+, bitmapDecoder (0)
+, asyncParser (0)
+, atlasMaxBitmapSize (0)
+, sharedParsing (false)
+, prototypeCloning (false)
+, buildingPrototype (false)
+, evaluatingExpression (0)
+, restoreViewsMode (false)
+{
+	if (xmlFile.type == CResourceDescription::kStringType && xmlFile.u.name != 0)
+		setFilePath (xmlFile.u.name);
+	if (viewFactory == 0)
+		viewFactory = getGenericViewFactory ();
+}
+
+//-----------------------------------------------------------------------------
+UIDescription::UIDescription (Xml::IContentProvider* xmlContentProvider, IViewFactory* _viewFactory)
+: nodes (0)
+, controller (0)
+, viewFactory (_viewFactory)
+, xmlContentProvider (xmlContentProvider)
+, bitmapCreator (0)
+, bitmapDecoder (0)
+, asyncParser (0)
+, atlasMaxBitmapSize (0)
+, sharedParsing (false)
+, prototypeCloning (false)
+, buildingPrototype (false)
+, evaluatingExpression (0)
+, restoreViewsMode (false)
+{
+	memset (&xmlFile, 0, sizeof (CResourceDescription));
+	if (viewFactory == 0)
+		viewFactory = getGenericViewFactory ();
+}
+
+//-----------------------------------------------------------------------------
+UIDescription::~UIDescription ()
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	// waits for the parsing thread
+	delete asyncParser;
+	while (!viewBuilders.empty ())
+		cancelViewBuilding (viewBuilders.front ());
+	delete bitmapDecoder;
+#endif
+	if (nodes)
+	{
+		// release the bitmaps while the nodes are intact, views still using them may need to load their scale variants
+		UINode* bitmapsNode = nodes->getChildren ().findChildNode (MainNodeNames::kBitmap);
+		if (bitmapsNode)
+		{
+			for (UIDescList::const_iterator it = bitmapsNode->getChildren ().begin (), end = bitmapsNode->getChildren ().end (); it != end; ++it)
+			{
+				UIBitmapNode* bitmapNode = dynamic_cast<UIBitmapNode*> (*it);
+				if (bitmapNode)
+					bitmapNode->invalidBitmap ();
+			}
+		}
+		nodes->forget ();
+	}
+}
+
+//------------------------------------------------------------------------
+void UIDescription::setFilePath (UTF8StringPtr path)
+{
+	filePath = path;
+	xmlFile.u.name = filePath.c_str (); // make sure that xmlFile.u.name points to valid memory
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::addDefaultNodes ()
+{
+	UINode* fontsNode = getBaseNode (MainNodeNames::kFont);
+	if (fontsNode)
+	{
+		struct DefaultFont {
+			UTF8StringPtr name;
+			CFontRef font;
+		};
+
+		const DefaultFont defaultFonts [] = {
+			{ "~ SystemFont", kSystemFont },
+			{ "~ NormalFontVeryBig", kNormalFontVeryBig },
+			{ "~ NormalFontBig", kNormalFontBig },
+			{ "~ NormalFont", kNormalFont },
+			{ "~ NormalFontSmall", kNormalFontSmall },
+			{ "~ NormalFontSmaller", kNormalFontSmaller },
+			{ "~ NormalFontVerySmall", kNormalFontVerySmall },
+			{ "~ SymbolFont", kSymbolFont },
+			{ 0, 0 },
+		};
+		int32_t i = 0;
+		while (defaultFonts[i].name != 0)
+		{
 			UIAttributes* attr = new UIAttributes;
 			attr->setAttribute ("name", defaultFonts[i].name);
 			UIFontNode* node = new UIFontNode ("font", attr);
@@ -772,56 +2408,403 @@ void UIDescription::addDefaultNodes ()
 //-----------------------------------------------------------------------------
 bool UIDescription::parse ()
 {
+#if VSTGUI_HAS_FUNCTIONAL
+	// the nodes are still built on the thread of parseAsync
+	if (isParsing ())
+		return false;
+#endif
 	if (nodes)
 		return true;
+	{
+		UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kParse);
+		if (!parseNodes ())
+			return false;
+	}
+	completeParsing ();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::parseNodes ()
+{
+	// only builds the nodes, this may run on the thread of parseAsync
+	std::string sharedKey = getSharedParsingKey ();
+	if (!sharedKey.empty ())
+		nodes = UIDescriptionPrivate::SharedParsedNodes::instance ().copy (sharedKey);
+	if (nodes == 0)
+	{
+		if (!parseXml ())
+			return false;
+		if (!sharedKey.empty ())
+			UIDescriptionPrivate::SharedParsedNodes::instance ().add (sharedKey, nodes);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::completeParsing ()
+{
+	addDefaultNodes ();
+	buildBitmapAtlas ();
+	startBitmapDecoding ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::createRootNode (const UIAttributes& attributes)
+{
+	vstgui_assert (nodes == 0);
+	// the templates are looked up by name
+	nodes = new UINode ("vstgui-ui-description", new UIAttributes (attributes), true);
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::parseSection (const std::string& xml)
+{
+	if (nodes == 0 || xml.empty ())
+		return false;
+	Xml::MemoryContentProvider provider (xml.data (), static_cast<uint32_t> (xml.size ()));
 	Xml::Parser parser;
+	nodeStack.push_back (nodes);
+	bool result = parser.parse (&provider, this);
+	nodeStack.clear ();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::addDeferredTemplate (const UIAttributes& attributes, uint32_t sectionIndex)
+{
+	vstgui_assert (nodes != 0);
+	nodes->getChildren ().add (new UIDeferredTemplateNode (attributes, sectionIndex));
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::loadDeferredTemplate (UINode* node) const
+{
+	UIDeferredTemplateNode* deferredNode = dynamic_cast<UIDeferredTemplateNode*> (node);
+	if (deferredNode == 0 || deferredNode->isLoaded ())
+		return;
+	// a template which can't be read stays empty, it is not read again
+	deferredNode->setLoaded ();
+	std::string xml;
+	if (!readDeferredTemplate (deferredNode->getSectionIndex (), xml))
+		return;
+	UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kParse);
+	// the section is parsed into a root node of its own and the children of its template are moved to the node
+	UIDescription* self = const_cast<UIDescription*> (this);
+	UINode* sectionRoot = new UINode ("vstgui-ui-description");
+	bool result;
+	{
+		ScopePointer<UINode> sp (&self->nodes, sectionRoot);
+		result = self->parseSection (xml);
+	}
+	UIDescList& sectionNodes = sectionRoot->getChildren ();
+	if (result && sectionNodes.size () == 1 && (*sectionNodes.begin ())->getName () == MainNodeNames::kTemplate)
+	{
+		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, (*sectionNodes.begin ())->getChildren (), UINode*, child)
+			child->remember ();
+			deferredNode->getChildren ().add (child);
+		VSTGUI_RANGE_BASED_FOR_LOOP_END
+	}
+#if DEBUG
+	else
+		DebugPrint ("*** Could not parse the deferred template %d\n", deferredNode->getSectionIndex ());
+#endif
+	sectionRoot->forget ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::loadDeferredTemplates () const
+{
+	if (nodes == 0)
+		return;
+	VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, nodes->getChildren (), UINode*, itNode)
+		loadDeferredTemplate (itNode);
+	VSTGUI_RANGE_BASED_FOR_LOOP_END
+}
+
+#if VSTGUI_HAS_FUNCTIONAL
+//-----------------------------------------------------------------------------
+bool UIDescription::parseAsync (const ParseCompletionFunc& completion)
+{
+	if (nodes || asyncParser)
+		return false;
+	asyncParser = new UIAsyncParser ([this] () { return parseNodes (); }, [this, completion] (bool success) {
+		// the time was measured on the thread
+		if (profiler)
+			profiler->addTime (UIDescriptionProfiler::kParse, asyncParser->getParseTime ());
+		if (success)
+			completeParsing ();
+		if (completion)
+			completion (this, success);
+	});
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::isParsing () const
+{
+	return asyncParser && !asyncParser->isFinished ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::finishParsing ()
+{
+	if (asyncParser)
+		asyncParser->finish ();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+bool UIDescription::parseXml ()
+{
 	if (xmlContentProvider)
+		return parseContent (xmlContentProvider);
+	if (const CResourcePack::Entry* packEntry = (xmlFile.type == CResourceDescription::kStringType && xmlFile.u.name) ? UIDescriptionPrivate::findResourcePackEntry (resourcePack, xmlFile.u.name) : 0)
+	{
+		// the compiled format is used directly from the mapped pack
+		if (UICompiledFormat::isCompiled (packEntry->data, packEntry->size))
+			return parseCompiled (static_cast<const uint8_t*> (packEntry->data), packEntry->size);
+		Xml::MemoryContentProvider contentProvider (packEntry->data, packEntry->size);
+		Xml::Parser parser;
+		return parser.parse (&contentProvider, this);
+	}
+	CResourceInputStream resInputStream;
+	if (resInputStream.open (xmlFile))
+	{
+		Xml::InputStreamContentProvider contentProvider (resInputStream);
+		return parseContent (&contentProvider);
+	}
+	if (xmlFile.type == CResourceDescription::kStringType)
 	{
-		if (parser.parse (xmlContentProvider, this))
+		CFileStream fileStream;
+		if (fileStream.open (xmlFile.u.name, CFileStream::kReadMode|CFileStream::kBinaryMode))
 		{
-			addDefaultNodes ();
-			return true;
+			Xml::InputStreamContentProvider contentProvider (fileStream);
+			return parseContent (&contentProvider);
 		}
 	}
-	else
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::parseContent (Xml::IContentProvider* provider)
+{
+	int8_t buffer[0x8000];
+	provider->rewind ();
+	uint32_t prefixSize = provider->readRawXmlData (buffer, 4);
+	if (prefixSize == kStreamIOError)
+		prefixSize = 0;
+	if (prefixSize == 4 && UICompiledFormat::isCompiled (buffer, 4))
+	{
+		std::vector<uint8_t> data (buffer, buffer + 4);
+		uint32_t bytesRead;
+		while ((bytesRead = provider->readRawXmlData (buffer, sizeof (buffer))) > 0 && bytesRead != kStreamIOError)
+			data.insert (data.end (), buffer, buffer + bytesRead);
+		return parseCompiled (&data[0], static_cast<uint32_t> (data.size ()));
+	}
+	// not every provider can be rewound, the parser gets the bytes already read first
+	UIPrefixContentProvider prefixProvider (provider, buffer, prefixSize);
+	Xml::Parser parser;
+	return parser.parse (&prefixProvider, this);
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::parseCompiled (const uint8_t* data, uint32_t dataSize)
+{
+	UICompiledFormat::Reader reader;
+	if (!reader.init (data, dataSize) || reader.getNumNodes () == 0)
+		return false;
+	std::vector<UINode*> nodeList (reader.getNumNodes (), static_cast<UINode*> (0));
+	std::vector<UTF8StringPtr> attributes;
+	for (uint32_t i = 0; i < reader.getNumNodes (); i++)
 	{
-		CResourceInputStream resInputStream;
-		if (resInputStream.open (xmlFile))
+		UICompiledFormat::Node record = reader.getNode (i);
+		UTF8StringPtr name = reader.getString (record.name);
+		if (name == 0)
+			return false;
+		attributes.clear ();
+		for (uint32_t a = 0; a < record.numAttributes; a++)
 		{
-			Xml::InputStreamContentProvider contentProvider (resInputStream);
-			if (parser.parse (&contentProvider, this))
-			{
-				addDefaultNodes ();
-				return true;
-			}
+			UTF8StringPtr attributeName;
+			UTF8StringPtr attributeValue;
+			if (!reader.getAttribute (record.firstAttribute + a, attributeName, attributeValue))
+				return false;
+			attributes.push_back (attributeName);
+			attributes.push_back (attributeValue);
+		}
+		attributes.push_back (0);
+		attributes.push_back (0);
+
+		UINode* node = 0;
+		if (i == 0)
+		{
+			if (record.kind != UICompiledFormat::kElement || std::strcmp (name, "vstgui-ui-description") != 0)
+				return false;
+			node = nodes = new UINode (name, new UIAttributes (&attributes[0]), true);
 		}
-		else if (xmlFile.type == CResourceDescription::kStringType)
+		else
 		{
-			CFileStream fileStream;
-			if (fileStream.open (xmlFile.u.name, CFileStream::kReadMode))
+			UINode* parent = record.parent < i ? nodeList[record.parent] : 0;
+			if (parent == 0)
+				return false;
+			if (record.kind == UICompiledFormat::kComment)
 			{
-				Xml::InputStreamContentProvider contentProvider (fileStream);
-				if (parser.parse (&contentProvider, this))
-				{
-					addDefaultNodes ();
-					return true;
-				}
+			#if VSTGUI_LIVE_EDITING
+				if (UTF8StringPtr comment = reader.getString (record.text))
+					parent->getChildren ().add (new UICommentNode (comment));
+			#endif
+				continue;
 			}
+			if ((node = createNode (parent, name, &attributes[0])) == 0)
+				return false;
+			parent->getChildren ().add (node);
 		}
+		if (record.kind == UICompiledFormat::kBitmapData)
+		{
+			if (UIBitmapDataNode* dataNode = dynamic_cast<UIBitmapDataNode*> (node))
+				dataNode->setDecodedData (reader.getData (record), record.dataSize);
+		}
+		else if (UTF8StringPtr text = reader.getString (record.text))
+			node->getData () += text;
+		nodeList[i] = node;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+std::string UIDescription::getSharedParsingKey () const
+{
+	if (!sharedParsing || xmlContentProvider)
+		return "";
+	if (xmlFile.type == CResourceDescription::kIntegerType)
+	{
+		std::stringstream key;
+		key << "id:" << xmlFile.u.id;
+		return key.str ();
+	}
+	if (xmlFile.u.name == 0)
+		return "";
+	// the same pack entry can be used by different packs, or different entries by the same pack
+	if (const CResourcePack::Entry* packEntry = UIDescriptionPrivate::findResourcePackEntry (resourcePack, xmlFile.u.name))
+		return CBitmapCache::Key::makeContentResource (packEntry->data, packEntry->size);
+	return UIDescriptionPrivate::SharedParsedNodes::makeFileKey (xmlFile.u.name);
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::setSharedParsingEnabled (bool state)
+{
+	sharedParsing = state;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::releaseSharedParsedNodes ()
+{
+	UIDescriptionPrivate::SharedParsedNodes::instance ().removeAll ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::setController (IController* inController) const
+{
+	controller = inController;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::setResourcePack (CResourcePack* pack)
+{
+	resourcePack = pack;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::setBitmapCreator (IBitmapCreator* creator)
+{
+	bitmapCreator = creator;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::setAsyncBitmapDecoding (bool state)
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	if (state == getAsyncBitmapDecoding ())
+		return;
+	if (state)
+	{
+		bitmapDecoder = new UIBitmapDecoder ([this] (UIBitmapLoadJob* job) { completeBitmapLoad (job); });
+		startBitmapDecoding ();
+	}
+	else
+	{
+		bitmapDecoder->finishAll ();
+		delete bitmapDecoder;
+		bitmapDecoder = 0;
+	}
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::finishBitmapDecoding () const
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	if (bitmapDecoder)
+		bitmapDecoder->finishAll ();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::startBitmapDecoding () const
+{
+	if (bitmapDecoder == 0 || nodes == 0)
+		return;
+	UINode* bitmapsNode = getBaseNode (MainNodeNames::kBitmap);
+	if (bitmapsNode == 0)
+		return;
+	for (UIDescList::const_iterator it = bitmapsNode->getChildren ().begin (), end = bitmapsNode->getChildren ().end (); it != end; ++it)
+	{
+		UIBitmapNode* bitmapNode = dynamic_cast<UIBitmapNode*> (*it);
+		const std::string* name = bitmapNode ? bitmapNode->getAttributes ()->getAttributeValue ("name") : 0;
+		if (name && !bitmapNode->getFilterProcessed ())
+			loadBitmap (bitmapNode, name->c_str ());
 	}
-	return false;
 }
 
 //-----------------------------------------------------------------------------
-void UIDescription::setController (IController* inController) const
+void UIDescription::setBitmapAtlasEnabled (bool state, uint32_t maxBitmapSize)
 {
-	controller = inController;
+	atlasMaxBitmapSize = state ? maxBitmapSize : 0;
 }
 
 //-----------------------------------------------------------------------------
-void UIDescription::setBitmapCreator (IBitmapCreator* creator)
+void UIDescription::buildBitmapAtlas ()
 {
-	bitmapCreator = creator;
+	if (atlasMaxBitmapSize == 0 || nodes == 0)
+		return;
+	UINode* bitmapsNode = getBaseNode (MainNodeNames::kBitmap);
+	if (bitmapsNode == 0)
+		return;
+	// bitmaps with scale variants have more than one platform bitmap, they can't be a part of an atlas
+	std::set<std::string> namesWithVariants;
+	for (UIDescList::const_iterator it = bitmapsNode->getChildren ().begin (), end = bitmapsNode->getChildren ().end (); it != end; ++it)
+	{
+		const std::string* name = (*it)->getAttributes ()->getAttributeValue ("name");
+		if (name && name->find ('#') != std::string::npos)
+			namesWithVariants.insert (UIDescriptionPrivate::removeScaleFactorFromName (*name));
+	}
+	SharedPointer<CBitmapAtlas> atlas = owned (new CBitmapAtlas (UIDescriptionPrivate::kBitmapAtlasPageSize, atlasMaxBitmapSize));
+	for (UIDescList::const_iterator it = bitmapsNode->getChildren ().begin (), end = bitmapsNode->getChildren ().end (); it != end; ++it)
+	{
+		UIBitmapNode* bitmapNode = dynamic_cast<UIBitmapNode*> (*it);
+		const std::string* name = bitmapNode ? bitmapNode->getAttributes ()->getAttributeValue ("name") : 0;
+		if (name == 0 || bitmapNode->getFilterProcessed () || name->find ('#') != std::string::npos || namesWithVariants.find (*name) != namesWithVariants.end ())
+			continue;
+		CBitmap* bitmap = loadBitmap (bitmapNode, name->c_str (), false);
+		IPlatformBitmap* platformBitmap = bitmap ? bitmap->getPlatformBitmap () : 0;
+		if (platformBitmap == 0 || platformBitmap->getSize ().x > atlasMaxBitmapSize || platformBitmap->getSize ().y > atlasMaxBitmapSize)
+			continue;
+		// the atlas replaces the platform bitmap, so it's not shared via the cache
+		CBitmapCache::instance ().detach (bitmap);
+		atlas->add (bitmap);
+	}
+	atlas->pack ();
+	bitmapAtlas = atlas;
 }
 
 //-----------------------------------------------------------------------------
@@ -876,7 +2859,10 @@ bool UIDescription::save (UTF8StringPtr filename, int32_t flags)
 	std::string oldName = moveOldFile (filename);
 	bool result = false;
 	CFileStream stream;
-	if (stream.open (filename, CFileStream::kWriteMode|CFileStream::kTruncateMode))
+	int32_t mode = CFileStream::kWriteMode|CFileStream::kTruncateMode;
+	if (flags & kWriteCompiledFormat)
+		mode |= CFileStream::kBinaryMode;
+	if (stream.open (filename, mode))
 	{
 		result = saveToStream (stream, flags);
 	}
@@ -893,12 +2879,29 @@ bool UIDescription::save (UTF8StringPtr filename, int32_t flags)
 	}
 	if (result && oldName.empty () == false)
 		std::remove (oldName.c_str ());
+	if (result)
+		UIDescriptionPrivate::SharedParsedNodes::instance ().remove (UIDescriptionPrivate::SharedParsedNodes::makeFileKey (filename));
 
 	return result;
 }
 
 //-----------------------------------------------------------------------------
 bool UIDescription::saveToStream (OutputStream& stream, int32_t flags)
+{
+	prepareSaving (flags);
+	if (flags & kWriteCompiledFormat)
+	{
+		UICompiledFormat::Writer writer;
+		return writer.write (stream, nodes);
+	}
+	if (writerCache == 0)
+		writerCache = owned (new UIDescWriterCache);
+	UIDescWriter writer (writerCache);
+	return writer.write (stream, nodes);
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::prepareSaving (int32_t flags)
 {
 	changed (kMessageBeforeSave);
 	UINode* bitmapNodes = getBaseNode (MainNodeNames::kBitmap);
@@ -910,16 +2913,58 @@ bool UIDescription::saveToStream (OutputStream& stream, int32_t flags)
 			if (bitmapNode)
 			{
 				if (flags & kWriteImagesIntoXMLFile)
-					bitmapNode->createXMLData (filePath);
+					bitmapNode->createXMLData (filePath, (flags & kWriteImagesAsQOI) ? BitmapCodec::kQOI : BitmapCodec::kPNG);
 				else
 					bitmapNode->removeXMLData ();
 				
 			}
 		}
 	}
+	loadDeferredTemplates ();
 	nodes->getAttributes ()->setAttribute ("version", "1");
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::saveSections (UIAttributes& rootAttributes, SectionList& sections, int32_t flags)
+{
+	if (nodes == 0)
+		return false;
+	prepareSaving (flags);
+	rootAttributes = *nodes->getAttributes ();
+	sections.clear ();
+	// a comment of the root node can't be a section of its own and is kept with a resource section, as only those are
+	// parsed into the root node
+	std::string comments;
+	size_t lastResourceSection = std::string::npos;
 	UIDescWriter writer;
-	return writer.write (stream, nodes);
+	VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, nodes->getChildren (), UINode*, itNode)
+		CMemoryStream stream (1024, 1024, false);
+		if (!writer.writeElement (stream, itNode))
+			return false;
+		std::string xml (reinterpret_cast<const char*> (stream.getBuffer ()), static_cast<size_t> (stream.tell ()));
+		if (xml.empty ())
+			continue;
+		if (dynamic_cast<UICommentNode*> (itNode))
+		{
+			if (lastResourceSection != std::string::npos)
+				sections[lastResourceSection].xml += xml;
+			else
+				comments += xml;
+			continue;
+		}
+		sections.push_back (Section ());
+		Section& section = sections.back ();
+		if (itNode->getName () == MainNodeNames::kTemplate)
+		{
+			section.templateAttributes = owned (new UIAttributes (*itNode->getAttributes ()));
+			section.xml.swap (xml);
+			continue;
+		}
+		section.xml = comments + xml;
+		comments.clear ();
+		lastResourceSection = sections.size () - 1;
+	VSTGUI_RANGE_BASED_FOR_LOOP_END
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -931,18 +2976,7 @@ UINode* UIDescription::findNodeForView (CView* view) const
 		parentView = parentView->getParentView ();
 	if (parentView)
 	{
-		UINode* node = 0;
-		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, nodes->getChildren (), UINode*, itNode)
-			if (itNode->getName () == MainNodeNames::kTemplate)
-			{
-				const std::string* nodeName = itNode->getAttributes ()->getAttributeValue ("name");
-				if (nodeName && *nodeName == templateName)
-				{
-					node = itNode;
-					break;
-				}
-			}
-		VSTGUI_RANGE_BASED_FOR_LOOP_END
+		UINode* node = findTemplateNode (templateName.c_str ());
 		if (node)
 		{
 			while (view != parentView)
@@ -1076,87 +3110,451 @@ bool UIDescription::restoreViews (InputStream& stream, std::list<SharedPointer<C
 //-----------------------------------------------------------------------------
 CView* UIDescription::createViewFromNode (UINode* node) const
 {
-	const std::string* templateName = node->getAttributes ()->getAttributeValue (MainNodeNames::kTemplate);
-	if (templateName)
+	SharedPointer<UIViewPlan> plan = owned (new UIViewPlan (node));
+	return createViewFromPlan (plan);
+}
+
+//-----------------------------------------------------------------------------
+CView* UIDescription::createViewFromPlan (const UIViewPlan* plan) const
+{
+	if (plan->getTemplateName ())
+		return createTemplateReferenceView (plan);
+
+	IController* subController = 0;
+	CView* result = beginViewFromPlan (plan, subController);
+	if (result && !plan->getChildren ().empty ())
 	{
-		CView* view = createView (templateName->c_str (), controller);
-		if (view)
-			viewFactory->applyAttributeValues (view, *node->getAttributes (), this);
-		return view;
+		CViewContainer* viewContainer = plan->hasChildViews () ? dynamic_cast<CViewContainer*> (result) : 0;
+		VSTGUI_RANGE_BASED_FOR_LOOP (UIViewPlan::ChildList, plan->getChildren (), const UIViewPlan::Child&, child)
+			if (child.view)
+			{
+				if (viewContainer)
+				{
+					CView* childView = createViewFromPlan (child.view);
+					if (childView)
+					{
+						if (!viewContainer->addView (childView))
+							childView->forget ();
+					}
+				}
+			}
+			else
+				result->setAttribute (child.attributeID, static_cast<uint32_t> (child.attributeValue.size () + 1), child.attributeValue.c_str ());
+		VSTGUI_RANGE_BASED_FOR_LOOP_END
 	}
+	return endViewFromPlan (plan, result, subController);
+}
 
-	IController* subController = 0;
+//-----------------------------------------------------------------------------
+CView* UIDescription::createTemplateReferenceView (const UIViewPlan* plan) const
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	// collect the bitmaps which are still decoded, to invalidate the view when they are loaded
+	if (bitmapDecoder)
+		bitmapDecoder->beginViewCreation ();
+#endif
+	CView* view = createView (plan->getTemplateName ()->c_str (), controller);
+	if (view)
+		viewFactory->applyAttributeValues (view, plan->getAttributes (), this);
+#if VSTGUI_HAS_FUNCTIONAL
+	if (bitmapDecoder)
+		bitmapDecoder->endViewCreation (view);
+#endif
+	return view;
+}
+
+//-----------------------------------------------------------------------------
+CView* UIDescription::beginViewFromPlan (const UIViewPlan* plan, IController*& subController) const
+{
+#if VSTGUI_HAS_FUNCTIONAL
+	if (bitmapDecoder)
+		bitmapDecoder->beginViewCreation ();
+#endif
+	const UIAttributes& attributes = plan->getAttributes ();
+	subController = 0;
 	CView* result = 0;
 	if (controller)
 	{
-		const std::string* subControllerName = node->getAttributes ()->getAttributeValue ("sub-controller");
+		const std::string* subControllerName = plan->getSubControllerName ();
 		if (subControllerName)
 		{
-			subController = controller->createSubController (subControllerName->c_str (), this);
+			{
+				UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kControllerSubController, subControllerName->c_str ());
+				subController = controller->createSubController (subControllerName->c_str (), this);
+			}
 			if (subController)
 			{
 				subControllerStack.push_back (controller);
 				setController (subController);
 			}
 		}
-		result = controller->createView (*node->getAttributes (), this);
+		{
+			UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kControllerCreateView, UIDescriptionPrivate::getProfilerViewName (profiler, attributes));
+			result = controller->createView (attributes, this);
+		}
 		if (result && viewFactory)
 		{
-			const std::string* viewClass = node->getAttributes ()->getAttributeValue (UIViewCreator::kAttrClass);
+			const std::string* viewClass = plan->getViewClass ();
 			if (viewClass)
-				viewFactory->applyCustomViewAttributeValues (result, viewClass->c_str (), *node->getAttributes (), this);
+				viewFactory->applyCustomViewAttributeValues (result, viewClass->c_str (), attributes, this);
 		}
 	}
 	if (result == 0 && viewFactory)
 	{
-		result = viewFactory->createView (*node->getAttributes (), this);
+		result = viewFactory->createView (attributes, this);
 		if (result == 0)
 		{
 			result = new CViewContainer (CRect (0, 0, 0, 0));
-			viewFactory->applyCustomViewAttributeValues (result, "CViewContainer", *node->getAttributes (), this);
+			viewFactory->applyCustomViewAttributeValues (result, "CViewContainer", attributes, this);
+		}
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+CView* UIDescription::endViewFromPlan (const UIViewPlan* plan, CView* result, IController* subController) const
+{
+	if (result && controller)
+	{
+		UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kControllerVerifyView, UIDescriptionPrivate::getProfilerViewName (profiler, plan->getAttributes ()));
+		result = controller->verifyView (result, plan->getAttributes (), this);
+	}
+	if (result && buildingPrototype)
+		result->setAttribute (UIDescriptionPrivate::kViewPlanAttribute, sizeof (plan), &plan);
+	if (subController)
+	{
+		if (result)
+			result->setAttribute (kCViewControllerAttribute, sizeof (IController*), &subController);
+		setController (subControllerStack.back ());
+		subControllerStack.pop_back ();
+		if (result == 0)
+		{
+			CBaseObject* obj = dynamic_cast<CBaseObject*> (subController);
+			if (obj)
+				obj->forget ();
+			else
+				delete subController;
 		}
 	}
-	if (result && node->hasChildren ())
+#if VSTGUI_HAS_FUNCTIONAL
+	if (bitmapDecoder)
+		bitmapDecoder->endViewCreation (result);
+#endif
+	return result;
+}
+
+#if VSTGUI_HAS_FUNCTIONAL
+//-----------------------------------------------------------------------------
+CView* UIDescription::createViewIncrementally (UTF8StringPtr name, IController* _controller, uint32_t timeBudget, const ViewCompletionFunc& completion) const
+{
+	UINode* templateNode = findTemplateNode (name);
+	if (templateNode == 0)
+		return 0;
+	CRect size;
+	CPoint p;
+	if (templateNode->getAttributes ()->getPointAttribute (UIViewCreator::kAttrOrigin, p))
+		size.setTopLeft (p);
+	if (templateNode->getAttributes ()->getPointAttribute (UIViewCreator::kAttrSize, p))
+		size.setSize (p);
+	CViewContainer* placeholder = new CViewContainer (size);
+	placeholder->setTransparency (true);
+	SharedPointer<UIViewBuilder> builder = owned (new UIViewBuilder (getViewPlan (templateNode), name, _controller, placeholder, timeBudget, completion));
+	UIViewBuilder* builderPtr = builder;
+	builder->timer = owned (new CVSTGUITimer ([this, builderPtr] (CVSTGUITimer*) {
+		if (continueViewBuilding (builderPtr))
+			finishViewBuilding (builderPtr);
+	}, 16, true));
+	viewBuilders.push_back (builder);
+	return placeholder;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::finishViewCreation () const
+{
+	while (!viewBuilders.empty ())
+	{
+		UIViewBuilder* builder = viewBuilders.front ();
+		builder->timeBudget = std::numeric_limits<uint32_t>::max ();
+		if (continueViewBuilding (builder))
+			finishViewBuilding (builder);
+	}
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::continueViewBuilding (UIViewBuilder* builder) const
+{
+	if (builder->placeholder == 0)
+	{
+		cancelViewBuilding (builder);
+		return false;
+	}
+	// the slices are not recorded per template, the template would be counted once per slice
+	UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kViewTree);
+	// switch to the view creation context of the builder
+	ScopePointer<IController> sp (&controller, builder->controller);
+	std::deque<IController*> savedSubControllerStack;
+	savedSubControllerStack.swap (subControllerStack);
+	subControllerStack.swap (builder->subControllerStack);
+	if (bitmapDecoder)
+		bitmapDecoder->resumeViewCreation (builder->bitmapRequests);
+
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (builder->timeBudget);
+	if (!builder->started)
+	{
+		IController* subController = 0;
+		CView* view = beginViewFromPlan (builder->plan, subController);
+		builder->frames.push_back (UIViewBuilder::Frame (builder->plan, view, subController));
+		builder->started = true;
+	}
+	while (!builder->frames.empty ())
 	{
-		CViewContainer* viewContainer = dynamic_cast<CViewContainer*> (result);
-		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, node->getChildren (), UINode*, itNode)
-			if (viewContainer)
+		UIViewBuilder::Frame& frame = builder->frames.back ();
+		const UIViewPlan::ChildList& children = frame.plan->getChildren ();
+		if (frame.view && frame.nextChild < children.size ())
+		{
+			const UIViewPlan::Child& child = children[frame.nextChild++];
+			if (child.view == 0)
+				frame.view->setAttribute (child.attributeID, static_cast<uint32_t> (child.attributeValue.size () + 1), child.attributeValue.c_str ());
+			else if (frame.container)
 			{
-				if (itNode->getName () == "view")
+				if (child.view->getTemplateName ())
 				{
-					CView* childView = createViewFromNode (itNode);
-					if (childView)
-					{
-						if (!viewContainer->addView (childView))
-							childView->forget ();
-					}
+					CView* childView = createTemplateReferenceView (child.view);
+					if (childView && !frame.container->addView (childView))
+						childView->forget ();
+				}
+				else
+				{
+					IController* subController = 0;
+					CView* childView = beginViewFromPlan (child.view, subController);
+					builder->frames.push_back (UIViewBuilder::Frame (child.view, childView, subController));
 				}
 			}
-			if (itNode->getName () == "attribute")
+		}
+		else
+		{
+			CView* view = endViewFromPlan (frame.plan, frame.view, frame.subController);
+			builder->frames.pop_back ();
+			if (builder->frames.empty ())
+				builder->result = view;
+			else if (view)
+			{
+				CViewContainer* container = builder->frames.back ().container;
+				if (!container->addView (view))
+					view->forget ();
+			}
+		}
+		if (std::chrono::steady_clock::now () >= deadline)
+			break;
+	}
+
+	// and back to the context of the description
+	if (bitmapDecoder)
+		bitmapDecoder->suspendViewCreation (builder->frames.size (), builder->bitmapRequests);
+	builder->controller = controller;
+	builder->subControllerStack.swap (subControllerStack);
+	subControllerStack.swap (savedSubControllerStack);
+	return builder->frames.empty ();
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::finishViewBuilding (UIViewBuilder* builder) const
+{
+	CView* view = builder->result;
+	builder->timer->stop ();
+	CView* placeholder = builder->placeholder;
+	if (view)
+	{
+		view->setAttribute (kTemplateNameAttributeID, static_cast<uint32_t> (builder->templateName.size () + 1), builder->templateName.c_str ());
+		CViewContainer* parent = placeholder ? dynamic_cast<CViewContainer*> (placeholder->getParentView ()) : 0;
+		if (parent)
+		{
+			parent->addView (view, placeholder);
+			parent->removeView (placeholder, true);
+		}
+	}
+	// the completion may delete the description
+	SharedPointer<UIViewBuilder> guard (builder);
+	viewBuilders.remove (guard);
+	if (builder->completion)
+		builder->completion (view);
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::cancelViewBuilding (UIViewBuilder* builder) const
+{
+	// the views of the frames are not added to their parents yet
+	while (!builder->frames.empty ())
+	{
+		UIViewBuilder::Frame& frame = builder->frames.back ();
+		if (frame.subController)
+		{
+			if (frame.view)
+				frame.view->setAttribute (kCViewControllerAttribute, sizeof (IController*), &frame.subController);
+			else if (CBaseObject* obj = dynamic_cast<CBaseObject*> (frame.subController))
+				obj->forget ();
+			else
+				delete frame.subController;
+		}
+		if (frame.view)
+			frame.view->forget ();
+		builder->frames.pop_back ();
+	}
+	builder->timer->stop ();
+	viewBuilders.remove (SharedPointer<UIViewBuilder> (builder));
+}
+#endif
+
+//-----------------------------------------------------------------------------
+UIViewPlan* UIDescription::getViewPlan (UINode* templateNode) const
+{
+	ViewPlanMap::const_iterator it = viewPlans.find (templateNode);
+	if (it != viewPlans.end ())
+		return it->second;
+	SharedPointer<UIViewPlan> plan = owned (new UIViewPlan (templateNode));
+	viewPlans.insert (std::make_pair (templateNode, plan));
+	return plan;
+}
+
+//-----------------------------------------------------------------------------
+UINode* UIDescription::findTemplateNode (UTF8StringPtr name) const
+{
+	if (nodes == 0 || name == 0)
+		return 0;
+	// the template nodes are indexed by name, other top level nodes may share the name of a template
+	UINode* node = nodes->getChildren ().findChildNodeWithAttributeValue ("name", name);
+	if (node == 0 || node->getName () != MainNodeNames::kTemplate)
+	{
+		node = 0;
+		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, nodes->getChildren (), UINode*, itNode)
+			if (itNode->getName () == MainNodeNames::kTemplate)
 			{
-				const std::string* attrName = itNode->getAttributes ()->getAttributeValue ("id");
-				const std::string* attrValue = itNode->getAttributes ()->getAttributeValue ("value");
-				if (attrName && attrValue)
+				const std::string* nodeName = itNode->getAttributes ()->getAttributeValue ("name");
+				if (nodeName && *nodeName == name)
 				{
-					CViewAttributeID attrId = 0;
-					if (attrName->size () == 4)
-					{
-						char c1 = (*attrName)[0];
-						char c2 = (*attrName)[1];
-						char c3 = (*attrName)[2];
-						char c4 = (*attrName)[3];
-						attrId = ((((size_t)c1) << 24) | (((size_t)c2) << 16) | (((size_t)c3) << 8) | (((size_t)c4) << 0));
-					}
-					else
-						attrId = (CViewAttributeID)strtol (attrName->c_str (), 0, 10);
-					if (attrId)
-						result->setAttribute (attrId, static_cast<uint32_t> (attrValue->size () + 1), attrValue->c_str ());
+					node = itNode;
+					break;
 				}
 			}
 		VSTGUI_RANGE_BASED_FOR_LOOP_END
 	}
-	if (result && controller)
-		result = controller->verifyView (result, *node->getAttributes (), this);
+	if (node)
+		loadDeferredTemplate (node);
+	return node;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::canCloneViews (const UIViewPlan* plan, uint32_t depth) const
+{
+	// the prototype is built without the controller, the views it would create from their custom-view-name are missing
+	if (plan->hasCustomViewName () || depth > 64)
+		return false;
+	if (const std::string* templateName = plan->getTemplateName ())
+	{
+		UINode* templateNode = findTemplateNode (templateName->c_str ());
+		return templateNode == 0 || canCloneViews (getViewPlan (templateNode), depth + 1);
+	}
+	const UIViewPlan::ChildList& children = plan->getChildren ();
+	for (UIViewPlan::ChildList::const_iterator it = children.begin (); it != children.end (); ++it)
+	{
+		if (it->view && !canCloneViews (it->view, depth + 1))
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool UIDescription::createViewFromPrototype (UIViewPlan* plan, CView*& view) const
+{
+	if (plan->getPrototype () == 0 && !plan->hasPrototypeFailed ())
+	{
+		if (!canCloneViews (plan))
+		{
+			plan->setPrototype (0);
+			return false;
+		}
+		// the prototype must not use the placeholders of bitmaps which are still decoded
+		finishBitmapDecoding ();
+		SharedPointer<CView> prototype;
+		{
+			ScopePointer<IController> sp (&controller, 0);
+			buildingPrototype = true;
+			prototype = owned (createViewFromPlan (plan));
+			buildingPrototype = false;
+		}
+		if (prototype)
+		{
+			SharedPointer<CView> copy = owned (static_cast<CView*> (prototype->newCopy ()));
+			if (!UIDescriptionPrivate::isPrototypeCopy (prototype, copy))
+				prototype = 0;
+		}
+		plan->setPrototype (prototype);
+	}
+	if (plan->getPrototype () == 0)
+		return false;
+	view = bindPrototypeCopy (static_cast<CView*> (plan->getPrototype ()->newCopy ()));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+CView* UIDescription::bindPrototypeCopy (CView* view) const
+{
+	const UIViewPlan* plan = 0;
+	uint32_t size;
+	if (view->getAttribute (UIDescriptionPrivate::kViewPlanAttribute, sizeof (plan), &plan, size))
+		view->removeAttribute (UIDescriptionPrivate::kViewPlanAttribute);
+	IController* subController = 0;
+	if (plan && controller)
+	{
+		const std::string* subControllerName = plan->getSubControllerName ();
+		if (subControllerName)
+		{
+			{
+				UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kControllerSubController, subControllerName->c_str ());
+				subController = controller->createSubController (subControllerName->c_str (), this);
+			}
+			if (subController)
+			{
+				subControllerStack.push_back (controller);
+				setController (subController);
+			}
+		}
+	}
+	if (plan)
+	{
+		CControl* control = dynamic_cast<CControl*> (view);
+		const std::string* controlTagName = control ? plan->getAttributes ().getAttributeValue (UIViewCreator::kAttrControlTag) : 0;
+		if (controlTagName)
+			UIDescriptionPrivate::bindControlTag (control, *controlTagName, this);
+	}
+	CViewContainer* container = dynamic_cast<CViewContainer*> (view);
+	if (container)
+	{
+		std::vector<CView*> children;
+		ViewIterator it (container);
+		while (*it)
+		{
+			children.push_back (*it);
+			++it;
+		}
+		for (std::vector<CView*>::const_iterator childIt = children.begin (), end = children.end (); childIt != end; ++childIt)
+		{
+			CView* child = bindPrototypeCopy (*childIt);
+			if (child != *childIt)
+			{
+				// the controller replaced the view in verifyView and took over the original one
+				if (child)
+					container->addView (child, *childIt);
+				container->removeView (*childIt, false);
+			}
+		}
+	}
+	CView* result = view;
+	if (plan && controller)
+	{
+		UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kControllerVerifyView, UIDescriptionPrivate::getProfilerViewName (profiler, plan->getAttributes ()));
+		result = controller->verifyView (view, plan->getAttributes (), this);
+	}
 	if (subController)
 	{
 		if (result)
@@ -1175,6 +3573,27 @@ CView* UIDescription::createViewFromNode (UINode* node) const
 	return result;
 }
 
+//-----------------------------------------------------------------------------
+void UIDescription::setPrototypeCloningEnabled (bool state)
+{
+	prototypeCloning = state;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::setProfiler (UIDescriptionProfiler* _profiler)
+{
+	profiler = _profiler;
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::changed (IdStringPtr message)
+{
+	// the plans and their prototypes may use the changed resources
+	viewPlans.clear ();
+	resourceIndex = 0;
+	IDependency::changed (message);
+}
+
 //-----------------------------------------------------------------------------
 CViewAttributeID UIDescription::kTemplateNameAttributeID = 'uitl';
 
@@ -1182,21 +3601,18 @@ CViewAttributeID UIDescription::kTemplateNameAttributeID = 'uitl';
 CView* UIDescription::createView (UTF8StringPtr name, IController* _controller) const
 {
 	ScopePointer<IController> sp (&controller, _controller);
-	if (nodes)
+	UINode* templateNode = findTemplateNode (name);
+	if (templateNode)
 	{
-		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, nodes->getChildren (), UINode*, itNode)
-			if (itNode->getName () == MainNodeNames::kTemplate)
-			{
-				const std::string* nodeName = itNode->getAttributes ()->getAttributeValue ("name");
-				if (nodeName && *nodeName == name)
-				{
-					CView* view = createViewFromNode (itNode);
-					if (view)
-						view->setAttribute (kTemplateNameAttributeID, static_cast<uint32_t> (strlen (name) + 1), name);
-					return view;
-				}
-			}
-		VSTGUI_RANGE_BASED_FOR_LOOP_END
+		UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kViewTree, name);
+		// keep the plan alive, the controller may edit the templates while the view is created
+		SharedPointer<UIViewPlan> plan (getViewPlan (templateNode));
+		CView* view = 0;
+		if (!prototypeCloning || buildingPrototype || !createViewFromPrototype (plan, view))
+			view = createViewFromPlan (plan);
+		if (view)
+			view->setAttribute (kTemplateNameAttributeID, static_cast<uint32_t> (strlen (name) + 1), name);
+		return view;
 	}
 	return 0;
 }
@@ -1222,18 +3638,8 @@ bool UIDescription::getTemplateNameFromView (CView* view, std::string& templateN
 //-----------------------------------------------------------------------------
 const UIAttributes* UIDescription::getViewAttributes (UTF8StringPtr name) const
 {
-	if (nodes)
-	{
-		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, nodes->getChildren (), UINode*, itNode)
-			if (itNode->getName () == MainNodeNames::kTemplate)
-			{
-				const std::string* nodeName = itNode->getAttributes ()->getAttributeValue ("name");
-				if (nodeName && *nodeName == name)
-					return itNode->getAttributes ();
-			}
-		VSTGUI_RANGE_BASED_FOR_LOOP_END
-	}
-	return 0;
+	UINode* templateNode = findTemplateNode (name);
+	return templateNode ? templateNode->getAttributes () : 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -1245,7 +3651,7 @@ UINode* UIDescription::getBaseNode (UTF8StringPtr name) const
 		if (node)
 			return node;
 
-		node = new UINode (name);
+		node = new UINode (name, 0, true);
 		nodes->getChildren ().add (node);
 		return node;
 	}
@@ -1333,110 +3739,12 @@ IControlListener* UIDescription::getControlListener (UTF8StringPtr name) const
 //-----------------------------------------------------------------------------
 CBitmap* UIDescription::getBitmap (UTF8StringPtr name) const
 {
+	UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kBitmaps, name);
 	UIBitmapNode* bitmapNode = dynamic_cast<UIBitmapNode*> (findChildNodeByNameAttribute (getBaseNode (MainNodeNames::kBitmap), name));
 	if (bitmapNode)
 	{
-		CBitmap* bitmap = bitmapNode->getBitmap (filePath);
-		if (bitmapCreator && bitmap && bitmap->getPlatformBitmap () == 0)
-		{
-			IPlatformBitmap* platformBitmap = bitmapCreator->createBitmap (*bitmapNode->getAttributes ());
-			if (platformBitmap)
-			{
-				double scaleFactor;
-				if (UIDescriptionPrivate::decodeScaleFactorFromName (name, scaleFactor))
-					platformBitmap->setScaleFactor (scaleFactor);
-				bitmap->setPlatformBitmap (platformBitmap);
-				platformBitmap->forget ();
-			}
-		}
-		if (bitmap && bitmapNode->getFilterProcessed () == false)
-		{
-			std::list<OwningPointer<BitmapFilter::IFilter> > filters;
-			for (UIDescList::iterator it = bitmapNode->getChildren ().begin (); it != bitmapNode->getChildren ().end (); it++)
-			{
-				const std::string* filterName = 0;
-				if ((*it)->getName () == "filter" && (filterName = (*it)->getAttributes ()->getAttributeValue ("name")))
-				{
-					BitmapFilter::IFilter* filter = BitmapFilter::Factory::getInstance().createFilter (filterName->c_str ());
-					if (filter == 0)
-						continue;
-					filters.push_back (filter);
-					for (UIDescList::iterator it2 = (*it)->getChildren ().begin (); it2 != (*it)->getChildren ().end (); it2++)
-					{
-						if ((*it2)->getName () != "property")
-							continue;
-						const std::string* name = (*it2)->getAttributes ()->getAttributeValue ("name");
-						if (name == 0)
-							continue;
-						switch (filter->getProperty (name->c_str ()).getType ())
-						{
-							case BitmapFilter::Property::kInteger:
-							{
-								int32_t intValue;
-								if ((*it2)->getAttributes ()->getIntegerAttribute ("value", intValue))
-									filter->setProperty (name->c_str (), intValue);
-								break;
-							}
-							case BitmapFilter::Property::kFloat:
-							{
-								double floatValue;
-								if ((*it2)->getAttributes ()->getDoubleAttribute ("value", floatValue))
-									filter->setProperty (name->c_str (), floatValue);
-								break;
-							}
-							case BitmapFilter::Property::kPoint:
-							{
-								CPoint pointValue;
-								if ((*it2)->getAttributes ()->getPointAttribute ("value", pointValue))
-									filter->setProperty (name->c_str (), pointValue);
-								break;
-							}
-							case BitmapFilter::Property::kRect:
-							{
-								CRect rectValue;
-								if ((*it2)->getAttributes ()->getRectAttribute ("value", rectValue))
-									filter->setProperty (name->c_str (), rectValue);
-								break;
-							}
-							case BitmapFilter::Property::kColor:
-							{
-								const std::string* colorString = (*it2)->getAttributes()->getAttributeValue ("value");
-								if (colorString)
-								{
-									CColor color;
-									if (getColor (colorString->c_str (), color))
-										filter->setProperty(name->c_str (), color);
-								}
-								break;
-							}
-							case BitmapFilter::Property::kTransformMatrix:
-							{
-								// TODO
-								break;
-							}
-							case BitmapFilter::Property::kObject: // objects can not be stored/restored
-							case BitmapFilter::Property::kUnknown:
-								break;
-						}
-					}
-				}
-			}
-			for (std::list<OwningPointer<BitmapFilter::IFilter> >::const_iterator it = filters.begin (); it != filters.end (); it++)
-			{
-				(*it)->setProperty (BitmapFilter::Standard::Property::kInputBitmap, bitmap);
-				if ((*it)->run ())
-				{
-					CBaseObject* obj = (*it)->getProperty (BitmapFilter::Standard::Property::kOutputBitmap).getObject ();
-					CBitmap* outputBitmap = dynamic_cast<CBitmap*>(obj);
-					if (outputBitmap)
-					{
-						bitmap->setPlatformBitmap (outputBitmap->getPlatformBitmap ());
-					}
-				}
-			}
-			bitmapNode->setFilterProcessed ();
-		}
-		if (bitmapNode->getScaledBitmapsAdded () == false)
+		CBitmap* bitmap = bitmapNode->getFilterProcessed () ? bitmapNode->getBitmap (filePath) : loadBitmap (bitmapNode, name);
+		if (bitmap && bitmapNode->getScaledBitmapsAdded () == false)
 		{
 			double scaleFactor;
 			if (!UIDescriptionPrivate::decodeScaleFactorFromName (name, scaleFactor))
@@ -1456,21 +3764,197 @@ CBitmap* UIDescription::getBitmap (UTF8StringPtr name) const
 					{
 						childNode->setScaledBitmapsAdded ();
 						CBitmap* childBitmap = getBitmap (childNodeBitmapName->c_str ());
-						if (childBitmap && childBitmap->getPlatformBitmap ())
-							bitmap->addBitmap (childBitmap->getPlatformBitmap ());
+						if (childBitmap == 0)
+							continue;
+						// the cache owns the scale variant from now on and may release it while it is not used
+						OwningPointer<CBitmapCache::ILoader> loader = new UIDescriptionPrivate::ScaledBitmapLoader (this, childNode, *childNodeBitmapName);
+					#if VSTGUI_HAS_FUNCTIONAL
+						UIBitmapLoadJob* job = bitmapDecoder && childBitmap->isLoadDeferred () ? bitmapDecoder->findJob (childBitmap) : 0;
+						if (job)
+						{
+							// added when it is decoded, so that the bitmap can be returned without waiting for it
+							job->scaleVariantOf = bitmap;
+							job->scaleVariantLoader = loader;
+							continue;
+						}
+					#endif
+						if (childBitmap->getPlatformBitmap () && CBitmapCache::instance ().add (bitmap, childBitmap->getPlatformBitmap (), childNode->getCacheKey (), loader))
+							childNode->invalidBitmap ();
 					}
 				}
 			}
 			bitmapNode->setScaledBitmapsAdded ();
 		}
+	#if VSTGUI_HAS_FUNCTIONAL
+		if (bitmapDecoder && bitmap)
+			bitmapDecoder->bitmapRequested (bitmap);
+	#endif
 		return bitmap;
 	}
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+CBitmap* UIDescription::loadBitmap (UIBitmapNode* bitmapNode, UTF8StringPtr name, bool decodeAsync) const
+{
+	OwningPointer<UIBitmapLoadJob> job = new UIBitmapLoadJob (bitmapNode, name, filePath, resourcePack);
+	CBitmapCache::Key& cacheKey = job->cacheKey;
+	if (job->hasPath ())
+		cacheKey.resource = job->getCacheResource (filePath);
+	if (!bitmapNode->getAttributes ()->getDoubleAttribute ("scale-factor", cacheKey.scaleFactor))
+		UIDescriptionPrivate::decodeScaleFactorFromName (name, cacheKey.scaleFactor);
+
+	BitmapFilter::Pipeline& filters = job->filters;
+	for (UIDescList::iterator it = bitmapNode->getChildren ().begin (); it != bitmapNode->getChildren ().end (); it++)
+	{
+		const std::string* filterName = 0;
+		if ((*it)->getName () == "filter" && (filterName = (*it)->getAttributes ()->getAttributeValue ("name")))
+		{
+			BitmapFilter::IFilter* filter = filters.addFilter (filterName->c_str ());
+			if (filter == 0)
+				continue;
+			cacheKey.filters += *filterName + ";";
+			for (UIDescList::iterator it2 = (*it)->getChildren ().begin (); it2 != (*it)->getChildren ().end (); it2++)
+			{
+				if ((*it2)->getName () != "property")
+					continue;
+				const std::string* name = (*it2)->getAttributes ()->getAttributeValue ("name");
+				const std::string* value = (*it2)->getAttributes ()->getAttributeValue ("value");
+				if (name == 0)
+					continue;
+				switch (filter->getProperty (name->c_str ()).getType ())
+				{
+					case BitmapFilter::Property::kInteger:
+					{
+						int32_t intValue;
+						if ((*it2)->getAttributes ()->getIntegerAttribute ("value", intValue))
+							filter->setProperty (name->c_str (), intValue);
+						break;
+					}
+					case BitmapFilter::Property::kFloat:
+					{
+						double floatValue;
+						if ((*it2)->getAttributes ()->getDoubleAttribute ("value", floatValue))
+							filter->setProperty (name->c_str (), floatValue);
+						break;
+					}
+					case BitmapFilter::Property::kPoint:
+					{
+						CPoint pointValue;
+						if ((*it2)->getAttributes ()->getPointAttribute ("value", pointValue))
+							filter->setProperty (name->c_str (), pointValue);
+						break;
+					}
+					case BitmapFilter::Property::kRect:
+					{
+						CRect rectValue;
+						if ((*it2)->getAttributes ()->getRectAttribute ("value", rectValue))
+							filter->setProperty (name->c_str (), rectValue);
+						break;
+					}
+					case BitmapFilter::Property::kColor:
+					{
+						if (value)
+						{
+							CColor color;
+							if (getColor (value->c_str (), color))
+							{
+								filter->setProperty(name->c_str (), color);
+								// named colors can change, so the key needs the color value
+								std::string colorString;
+								UIViewCreator::colorToString (color, colorString, 0);
+								cacheKey.filters += *name + "=" + colorString + ";";
+								value = 0;
+							}
+						}
+						break;
+					}
+					case BitmapFilter::Property::kTransformMatrix:
+					{
+						// TODO
+						break;
+					}
+					case BitmapFilter::Property::kObject: // objects can not be stored/restored
+					case BitmapFilter::Property::kUnknown:
+						break;
+				}
+				if (value)
+					cacheKey.filters += *name + "=" + *value + ";";
+			}
+		}
+	}
+
+	CBitmap* bitmap = 0;
+	if (IPlatformBitmap* cachedBitmap = CBitmapCache::instance ().get (cacheKey))
+	{
+		bitmap = bitmapNode->getBitmap (cachedBitmap);
+		CBitmapCache::instance ().add (bitmap, cachedBitmap, cacheKey);
+	}
+	else if (CBitmap* loadedBitmap = bitmapNode->getLoadedBitmap ())
+	{
+		// loaded without the filters, only the filters need to be applied
+		job->bitmap = loadedBitmap;
+		job->platformBitmap = loadedBitmap->getPlatformBitmap ();
+		job->runFilters ();
+		bitmap = completeBitmapLoad (job);
+	}
+#if VSTGUI_HAS_FUNCTIONAL
+	else if (bitmapDecoder && decodeAsync && job->hasPath ())
+	{
+		bitmap = bitmapDecoder->add (job, bitmapNode->getBitmap (static_cast<IPlatformBitmap*> (0)));
+	}
+#endif
+	else
+	{
+		job->decode ();
+		job->runFilters ();
+		bitmap = completeBitmapLoad (job);
+	}
+	bitmapNode->setCacheKey (cacheKey);
+	bitmapNode->setFilterProcessed ();
+	return bitmap;
+}
+
+//-----------------------------------------------------------------------------
+CBitmap* UIDescription::completeBitmapLoad (UIBitmapLoadJob* job) const
+{
+	UIBitmapNode* bitmapNode = job->node;
+	if (job->platformBitmap == 0 && job->hasPath () && bitmapCreator)
+	{
+		job->platformBitmap = owned (bitmapCreator->createBitmap (*bitmapNode->getAttributes ()));
+		double scaleFactor;
+		if (job->platformBitmap && UIDescriptionPrivate::decodeScaleFactorFromName (job->name, scaleFactor))
+			job->platformBitmap->setScaleFactor (scaleFactor);
+		job->runFilters ();
+	}
+	if (job->pathScaleFactor != 0.)
+		bitmapNode->getAttributes ()->setDoubleAttribute ("scale-factor", job->pathScaleFactor);
+
+	CBitmap* bitmap = job->bitmap;
+	if (bitmap)
+	{
+		bitmap->setDeferredLoader (0);
+		if (job->platformBitmap)
+			bitmap->setPlatformBitmap (job->platformBitmap);
+		// the node may have released the bitmap while it was decoded
+		if (bitmapNode->getLoadedBitmap () != bitmap)
+			return bitmap;
+	}
+	else if (job->hasPath ())
+		bitmap = bitmapNode->getBitmap (job->platformBitmap);
+	if (bitmap && job->platformBitmap)
+	{
+		CBitmapCache::instance ().add (bitmap, job->platformBitmap, job->cacheKey);
+		if (job->scaleVariantOf && CBitmapCache::instance ().add (job->scaleVariantOf, job->platformBitmap, job->cacheKey, job->scaleVariantLoader))
+			bitmapNode->invalidBitmap ();
+	}
+	return bitmap;
+}
+
 //-----------------------------------------------------------------------------
 CFontRef UIDescription::getFont (UTF8StringPtr name) const
 {
+	UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kFonts, name);
 	UIFontNode* fontNode = dynamic_cast<UIFontNode*> (findChildNodeByNameAttribute (getBaseNode (MainNodeNames::kFont), name));
 	if (fontNode)
 		return fontNode->getFont ();
@@ -1501,85 +3985,151 @@ CGradient* UIDescription::getGradient (UTF8StringPtr name) const
 	return 0;
 }
 
+namespace UIDescriptionPrivate {
+
 //-----------------------------------------------------------------------------
-template<typename NodeType, typename ObjType, typename CompareFunction> UTF8StringPtr UIDescription::lookupName (const ObjType& obj, IdStringPtr mainNodeName, CompareFunction compare) const
+template<typename NodeType, typename KeyType, typename KeyFunction>
+static void buildResourceIndex (const UIDescription* desc, UINode* baseNode, UIResourceValueIndex<KeyType>& index, KeyFunction getKey)
 {
-	UINode* baseNode = getBaseNode (mainNodeName);
+	index.clear ();
 	if (baseNode)
 	{
 		UIDescList& children = baseNode->getChildren ();
 		VSTGUI_RANGE_BASED_FOR_LOOP (UIDescList, children, UINode*, itNode)
 			NodeType* node = dynamic_cast<NodeType*>(itNode);
-			if (node && compare (this, node, obj))
-			{
-				const std::string* name = node->getAttributes ()->getAttributeValue ("name");
-				return name ? name->c_str () : 0;
-			}
+			KeyType key;
+			if (node && getKey (desc, node, key))
+				index.add (key, node);
 		VSTGUI_RANGE_BASED_FOR_LOOP_END
 	}
+	index.setValid ();
+}
+
+//-----------------------------------------------------------------------------
+static uint32_t colorKey (const CColor& color)
+{
+	return (static_cast<uint32_t> (color.red) << 24) | (static_cast<uint32_t> (color.green) << 16) | (static_cast<uint32_t> (color.blue) << 8) | color.alpha;
+}
+
+//-----------------------------------------------------------------------------
+static std::string gradientKey (const CGradient::ColorStopMap& colorStops)
+{
+	std::string key;
+	key.reserve (colorStops.size () * (sizeof (double) + sizeof (uint32_t)));
+	for (CGradient::ColorStopMap::const_iterator it = colorStops.begin (), end = colorStops.end (); it != end; ++it)
+	{
+		uint32_t color = colorKey (it->second);
+		key.append (reinterpret_cast<const char*> (&it->first), sizeof (double));
+		key.append (reinterpret_cast<const char*> (&color), sizeof (uint32_t));
+	}
+	return key;
+}
+
+} // UIDescriptionPrivate
+
+//-----------------------------------------------------------------------------
+UIResourceIndex* UIDescription::getResourceIndex () const
+{
+	if (resourceIndex == 0)
+		resourceIndex = owned (new UIResourceIndex);
+	return resourceIndex;
+}
+
+//-----------------------------------------------------------------------------
+template<typename NodeType, typename KeyType, typename KeyFunction> UTF8StringPtr UIDescription::lookupName (const KeyType& key, IdStringPtr mainNodeName, UIResourceValueIndex<KeyType>& index, KeyFunction getKey) const
+{
+	bool rebuilt = false;
+	if (!index.isValid ())
+	{
+		UIDescriptionPrivate::buildResourceIndex<NodeType> (this, getBaseNode (mainNodeName), index, getKey);
+		rebuilt = true;
+	}
+	NodeType* node = static_cast<NodeType*> (index.find (key));
+	KeyType nodeKey;
+	if (node && !rebuilt && !(getKey (this, node, nodeKey) && nodeKey == key))
+	{
+		// the value of the node was changed without a change message
+		UIDescriptionPrivate::buildResourceIndex<NodeType> (this, getBaseNode (mainNodeName), index, getKey);
+		node = static_cast<NodeType*> (index.find (key));
+	}
+	if (node)
+	{
+		const std::string* name = node->getAttributes ()->getAttributeValue ("name");
+		return name ? name->c_str () : 0;
+	}
 	return 0;
 }
 
 //-----------------------------------------------------------------------------
 UTF8StringPtr UIDescription::lookupColorName (const CColor& color) const
 {
-	struct Compare {
-		bool operator () (const UIDescription* desc, UIColorNode* node, const CColor& color) const {
-			return node->getColor() == color;
+	struct Key {
+		bool operator () (const UIDescription* desc, UIColorNode* node, uint32_t& key) const {
+			key = UIDescriptionPrivate::colorKey (node->getColor ());
+			return true;
 		}
 	};
-	return lookupName<UIColorNode> (color, MainNodeNames::kColor, Compare ());
+	return lookupName<UIColorNode> (UIDescriptionPrivate::colorKey (color), MainNodeNames::kColor, getResourceIndex ()->colors, Key ());
 }
 
 //-----------------------------------------------------------------------------
 UTF8StringPtr UIDescription::lookupFontName (const CFontRef font) const
 {
-	struct Compare {
-		bool operator () (const UIDescription* desc, UIFontNode* node, const CFontRef& font) const {
-			return node->getFont () && node->getFont () == font;
+	struct Key {
+		bool operator () (const UIDescription* desc, UIFontNode* node, const CFontDesc*& key) const {
+			key = node->getFont ();
+			return key != 0;
 		}
 	};
-	return font ? lookupName<UIFontNode> (font, MainNodeNames::kFont, Compare ()) : 0;
+	return font ? lookupName<UIFontNode> (static_cast<const CFontDesc*> (font), MainNodeNames::kFont, getResourceIndex ()->fonts, Key ()) : 0;
 }
 
 //-----------------------------------------------------------------------------
 UTF8StringPtr UIDescription::lookupBitmapName (const CBitmap* bitmap) const
 {
-	struct Compare {
-		bool operator () (const UIDescription* desc, UIBitmapNode* node, const CBitmap* bitmap) const {
-			return node->getBitmap (desc->filePath) == bitmap;
+	struct Key {
+		bool operator () (const UIDescription* desc, UIBitmapNode* node, const CBitmap*& key) const {
+			// bitmaps are loaded and released lazily, the node drops the index when this happens
+			node->setResourceIndex (desc->getResourceIndex ());
+			key = node->getLoadedBitmap ();
+			return key != 0;
 		}
 	};
-	return bitmap ? lookupName<UIBitmapNode> (bitmap, MainNodeNames::kBitmap, Compare ()) : 0;
+	return bitmap ? lookupName<UIBitmapNode> (bitmap, MainNodeNames::kBitmap, getResourceIndex ()->bitmaps, Key ()) : 0;
 }
 
 //-----------------------------------------------------------------------------
 UTF8StringPtr UIDescription::lookupGradientName (const CGradient* gradient) const
 {
-	struct Compare {
-		bool operator () (const UIDescription* desc, UIGradientNode* node, const CGradient* gradient) const {
-			return node->getGradient() == gradient || (node->getGradient () && gradient->getColorStops () == node->getGradient ()->getColorStops ());
+	struct Key {
+		bool operator () (const UIDescription* desc, UIGradientNode* node, std::string& key) const {
+			// gradients with the same color stops are equal
+			CGradient* gradient = node->getGradient ();
+			if (gradient == 0)
+				return false;
+			key = UIDescriptionPrivate::gradientKey (gradient->getColorStops ());
+			return true;
 		}
 	};
-	return gradient ? lookupName<UIGradientNode> (gradient, MainNodeNames::kGradient, Compare ()) : 0;
+	return gradient ? lookupName<UIGradientNode> (UIDescriptionPrivate::gradientKey (gradient->getColorStops ()), MainNodeNames::kGradient, getResourceIndex ()->gradients, Key ()) : 0;
 }
 	
 //-----------------------------------------------------------------------------
 UTF8StringPtr UIDescription::lookupControlTagName (const int32_t tag) const
 {
-	struct Compare {
-		bool operator () (const UIDescription* desc, UIControlTagNode* node, const int32_t tag) const {
-			int32_t nodeTag = node->getTag ();
-			if (nodeTag == -1 && node->getTagString ())
+	struct Key {
+		bool operator () (const UIDescription* desc, UIControlTagNode* node, int32_t& key) const {
+			key = node->getTag ();
+			if (key == -1 && node->getTagString ())
 			{
 				double v;
 				if (desc->calculateStringValue (node->getTagString ()->c_str (), v))
-					nodeTag = (int32_t)v;
+					key = (int32_t)v;
 			}
-			return nodeTag == tag;
+			return true;
 		}
 	};
-	return lookupName<UIControlTagNode> (tag, MainNodeNames::kControlTag, Compare ());
+	return lookupName<UIControlTagNode> (tag, MainNodeNames::kControlTag, getResourceIndex ()->tags, Key ());
 }
 
 //-----------------------------------------------------------------------------
@@ -1605,6 +4155,8 @@ void UIDescription::changeColorName (UTF8StringPtr oldName, UTF8StringPtr newNam
 //-----------------------------------------------------------------------------
 void UIDescription::changeTagName (UTF8StringPtr oldName, UTF8StringPtr newName)
 {
+	invalidateExpressions (std::string ("tag.") + oldName);
+	invalidateExpressions (std::string ("tag.") + newName);
 	changeNodeName<UIControlTagNode> (oldName, newName, MainNodeNames::kControlTag, kMessageTagChanged);
 }
 
@@ -1842,6 +4394,7 @@ void UIDescription::removeColor (UTF8StringPtr name)
 //-----------------------------------------------------------------------------
 void UIDescription::removeTag (UTF8StringPtr name)
 {
+	invalidateExpressions (std::string ("tag.") + name);
 	removeNode (name, MainNodeNames::kControlTag, kMessageTagChanged);
 }
 
@@ -2027,24 +4580,14 @@ void UIDescription::updateViewDescription (UTF8StringPtr name, CView* view)
 	UIViewFactory* factory = dynamic_cast<UIViewFactory*> (viewFactory);
 	if (factory && nodes)
 	{
-		UINode* node = 0;
-		for (UIDescList::iterator it = nodes->getChildren ().begin (), end = nodes->getChildren ().end (); it != end && node == 0; ++it)
-		{
-			if ((*it)->getName () == MainNodeNames::kTemplate)
-			{
-				const std::string* nodeName = (*it)->getAttributes ()->getAttributeValue ("name");
-				if (*nodeName == name)
-				{
-					node = (*it);
-				}
-			}
-		}
+		UINode* node = findTemplateNode (name);
 		if (node == 0)
 		{
 			node = new UINode (MainNodeNames::kTemplate);
 		}
 		node->getChildren ().removeAll ();
 		updateAttributesForView (node, view);
+		viewPlans.clear ();
 	}
 #endif
 }
@@ -2055,15 +4598,16 @@ bool UIDescription::addNewTemplate (UTF8StringPtr name, UIAttributes* attr)
 #if VSTGUI_LIVE_EDITING
 	if (!nodes)
 	{
-		nodes = new UINode ("vstgui-ui-description");
+		nodes = new UINode ("vstgui-ui-description", new UIAttributes, true);
 		addDefaultNodes ();
 	}
-	UINode* templateNode = findChildNodeByNameAttribute (nodes, name);
+	UINode* templateNode = findTemplateNode (name);
 	if (templateNode == 0)
 	{
 		UINode* newNode = new UINode (MainNodeNames::kTemplate, attr);
 		attr->setAttribute ("name", name);
 		nodes->getChildren ().add (newNode);
+		viewPlans.clear ();
 		changed (kMessageTemplateChanged);
 		return true;
 	}
@@ -2075,10 +4619,11 @@ bool UIDescription::addNewTemplate (UTF8StringPtr name, UIAttributes* attr)
 bool UIDescription::removeTemplate (UTF8StringPtr name)
 {
 #if VSTGUI_LIVE_EDITING
-	UINode* templateNode = findChildNodeByNameAttribute (nodes, name);
+	UINode* templateNode = findTemplateNode (name);
 	if (templateNode)
 	{
 		nodes->getChildren ().remove (templateNode);
+		viewPlans.clear ();
 		changed (kMessageTemplateChanged);
 		return true;
 	}
@@ -2090,10 +4635,12 @@ bool UIDescription::removeTemplate (UTF8StringPtr name)
 bool UIDescription::changeTemplateName (UTF8StringPtr name, UTF8StringPtr newName)
 {
 #if VSTGUI_LIVE_EDITING
-	UINode* templateNode = findChildNodeByNameAttribute (nodes, name);
+	UINode* templateNode = findTemplateNode (name);
 	if (templateNode)
 	{
 		templateNode->getAttributes()->setAttribute ("name", newName);
+		nodes->childAttributeChanged (templateNode, "name", name);
+		viewPlans.clear ();
 		changed (kMessageTemplateChanged);
 		return true;
 	}
@@ -2105,7 +4652,7 @@ bool UIDescription::changeTemplateName (UTF8StringPtr name, UTF8StringPtr newNam
 bool UIDescription::duplicateTemplate (UTF8StringPtr name, UTF8StringPtr duplicateName)
 {
 #if VSTGUI_LIVE_EDITING
-	UINode* templateNode = findChildNodeByNameAttribute (nodes, name);
+	UINode* templateNode = findTemplateNode (name);
 	if (templateNode)
 	{
 		UINode* duplicate = static_cast<UINode*> (templateNode->newCopy ());
@@ -2169,6 +4716,7 @@ bool UIDescription::getControlTagString (UTF8StringPtr tagName, std::string& tag
 //-----------------------------------------------------------------------------
 bool UIDescription::changeControlTagString  (UTF8StringPtr tagName, const std::string& newTagString, bool create)
 {
+	invalidateExpressions (std::string ("tag.") + tagName);
 	UINode* tagsNode = getBaseNode (MainNodeNames::kControlTag);
 	UIControlTagNode* controlTagNode = dynamic_cast<UIControlTagNode*> (findChildNodeByNameAttribute (tagsNode, tagName));
 	if (controlTagNode)
@@ -2262,16 +4810,14 @@ public:
 		kMulitply,
 		kDivide,
 		kOpenParenthesis,
-		kCloseParenthesis,
-		kResult
+		kCloseParenthesis
 	};
 	
-	StringToken (const std::string& str) : std::string (str), type (kString), result (0) {}
-	StringToken (const StringToken& token) : std::string (token), type (token.type), result (token.result) {}
-	StringToken (Type type, double value = 0) : type (type), result (value) {}
+	StringToken (const std::string& str) : std::string (str), type (kString) {}
+	StringToken (const StringToken& token) : std::string (token), type (token.type) {}
+	StringToken (Type type) : type (type) {}
 	
 	Type type;
-	double result;
 };
 
 typedef std::list<StringToken> StringTokenList;
@@ -2370,215 +4916,272 @@ static bool tokenizeString (std::string& str, StringTokenList& tokens)
 	} while (iterator.next () != iterator.back ());
 	if (tokenStart != iterator)
 	{
-		std::string token ((const char*)tokenStart, static_cast<size_t> (iterator - tokenStart));
-		tokens.push_back (token);
+		std::string token ((const char*)tokenStart, static_cast<size_t> (iterator - tokenStart));
+		tokens.push_back (token);
+	}
+	return true;	
+}
+
+} // namespace UIDescriptionPrivate
+
+//-----------------------------------------------------------------------------
+UIExpression::UIExpression ()
+: result (0.)
+, resultState (kNoResult)
+, compiled (false)
+, usesTags (false)
+{
+}
+
+//-----------------------------------------------------------------------------
+UIExpression* UIExpression::compile (UTF8StringPtr str)
+{
+	UIExpression* expression = new UIExpression;
+	UIDescriptionPrivate::Locale localeResetter;
+
+	char* endPtr = 0;
+	double value = strtod (str, &endPtr);
+	if (endPtr == str + strlen (str))
+	{
+		expression->ops.push_back (Op (kPushNumber, value));
+		expression->compiled = true;
+		return expression;
+	}
+	std::string string (str);
+	UIDescriptionPrivate::StringTokenList tokenList;
+	if (!UIDescriptionPrivate::tokenizeString (string, tokenList))
+	{
+	#if DEBUG
+		DebugPrint("TokenizeString failed :%s\n", str);
+	#endif
+		return expression;
+	}
+	UIDescriptionPrivate::StringTokenVector tokens (tokenList.begin (), tokenList.end ());
+	size_t pos = 0;
+	expression->compiled = expression->compileSum (tokens, pos) && pos == tokens.size ();
+	if (!expression->compiled)
+	{
+		expression->ops.clear ();
+	#if DEBUG
+		DebugPrint ("Wrong Expression: %s\n", str);
+	#endif
+	}
+	return expression;
+}
+
+//-----------------------------------------------------------------------------
+bool UIExpression::compileSum (const UIDescriptionPrivate::StringTokenVector& tokens, size_t& pos)
+{
+	// a leading sign applies to the whole sum
+	bool negate = false;
+	if (pos < tokens.size () && (tokens[pos].type == UIDescriptionPrivate::StringToken::kAdd || tokens[pos].type == UIDescriptionPrivate::StringToken::kSubtract))
+	{
+		negate = tokens[pos].type == UIDescriptionPrivate::StringToken::kSubtract;
+		++pos;
+	}
+	if (!compileProduct (tokens, pos))
+		return false;
+	if (negate)
+		ops.push_back (Op (kNegate));
+	while (pos < tokens.size () && (tokens[pos].type == UIDescriptionPrivate::StringToken::kAdd || tokens[pos].type == UIDescriptionPrivate::StringToken::kSubtract))
+	{
+		OpCode code = tokens[pos].type == UIDescriptionPrivate::StringToken::kAdd ? kAdd : kSubtract;
+		++pos;
+		if (!compileProduct (tokens, pos))
+			return false;
+		ops.push_back (Op (code));
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool UIExpression::compileProduct (const UIDescriptionPrivate::StringTokenVector& tokens, size_t& pos)
+{
+	if (!compileFactor (tokens, pos))
+		return false;
+	while (pos < tokens.size () && (tokens[pos].type == UIDescriptionPrivate::StringToken::kMulitply || tokens[pos].type == UIDescriptionPrivate::StringToken::kDivide))
+	{
+		OpCode code = tokens[pos].type == UIDescriptionPrivate::StringToken::kMulitply ? kMultiply : kDivide;
+		++pos;
+		if (!compileFactor (tokens, pos))
+			return false;
+		ops.push_back (Op (code));
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+bool UIExpression::compileFactor (const UIDescriptionPrivate::StringTokenVector& tokens, size_t& pos)
+{
+	if (pos >= tokens.size ())
+		return false;
+	const UIDescriptionPrivate::StringToken& token = tokens[pos++];
+	if (token.type == UIDescriptionPrivate::StringToken::kOpenParenthesis)
+	{
+		if (!compileSum (tokens, pos))
+			return false;
+		if (pos >= tokens.size () || tokens[pos].type != UIDescriptionPrivate::StringToken::kCloseParenthesis)
+			return false;
+		++pos;
+		return true;
+	}
+	if (token.type != UIDescriptionPrivate::StringToken::kString)
+		return false;
+	char* endPtr = 0;
+	double value = strtod (token.c_str (), &endPtr);
+	if (endPtr == token.c_str () + token.length ())
+	{
+		ops.push_back (Op (kPushNumber, value));
+		return true;
+	}
+	// if it is not pure numeric it is a reference to a control tag or variable
+	if (token.compare (0, 4, "tag.") == 0)
+	{
+		ops.push_back (Op (kPushTag, token.substr (4)));
+		addDependency (token);
+		return true;
+	}
+	if (token.compare (0, 4, "var.") == 0)
+	{
+		ops.push_back (Op (kPushVariable, token.substr (4)));
+		addDependency (token);
+		return true;
 	}
-	return true;	
+#if DEBUG
+	DebugPrint("Substitution failed :%s\n", token.c_str ());
+#endif
+	return false;
 }
 
 //-----------------------------------------------------------------------------
-static bool computeTokens (StringTokenList& tokens, double& result)
+void UIExpression::addDependency (const std::string& name)
 {
-	int32_t openCount = 0;
-	StringTokenList::iterator openPosition = tokens.end ();
-	// first check parentheses
-	for (StringTokenList::iterator it = tokens.begin (); it != tokens.end (); it++)
-	{
-		if ((*it).type == StringToken::kOpenParenthesis)
-		{
-			openCount++;
-			if (openCount == 1)
-				openPosition = it;
-		}
-		else if ((*it).type == StringToken::kCloseParenthesis)
-		{
-			openCount--;
-			if (openCount == 0)
-			{
-				StringTokenList tmp (++openPosition, it);
-				double value = 0;
-				if (computeTokens (tmp, value))
-				{
-					openPosition--;
-					it++;
-					tokens.erase (openPosition, it);
-					tokens.insert (it, StringToken (StringToken::kResult, value));
-					if (it == tokens.end ())
-					{
-						break;
-					}
+	dependencies.insert (name);
+	if (name.compare (0, 4, "tag.") == 0)
+		usesTags = true;
+}
 
-				}
-				else
-					return false;
-			}
-		}
+//-----------------------------------------------------------------------------
+void UIExpression::addDependencies (const UIExpression* expression)
+{
+	dependencies.insert (expression->dependencies.begin (), expression->dependencies.end ());
+	if (expression->usesTags)
+		usesTags = true;
+}
+
+//-----------------------------------------------------------------------------
+void UIExpression::evaluate (const UIDescription* description)
+{
+	if (!compiled)
+	{
+		setResult (0., false);
+		return;
 	}
-	// now multiply and divide
-	StringTokenList::iterator prevToken = tokens.begin ();
-	for (StringTokenList::iterator it = tokens.begin (); it != tokens.end (); it++)
+	std::vector<double> stack;
+	stack.reserve (ops.size ());
+	for (OpList::const_iterator it = ops.begin (), end = ops.end (); it != end; ++it)
 	{
-		if (prevToken != it)
+		switch (it->code)
 		{
-			if ((*it).type == StringToken::kMulitply)
+			case kPushNumber:
 			{
-				if ((*prevToken).type == StringToken::kResult)
-				{
-					it++;
-					if ((*it).type == StringToken::kResult)
-					{
-						double value = (*prevToken).result * (*it).result;
-						it++;
-						tokens.erase (prevToken, it);
-						tokens.insert (it, StringToken (StringToken::kResult, value));
-						it--;
-						prevToken = it;
-					}
-					else
-					{
-						return false;
-					}
-				}
-				else
-				{
-					return false;
-				}
+				stack.push_back (it->value);
+				break;
 			}
-			else if ((*it).type == StringToken::kDivide)
+			case kPushTag:
 			{
-				if ((*prevToken).type == StringToken::kResult)
+				int32_t tag = description->getTagForName (it->name.c_str ());
+				if (tag == -1)
 				{
-					it++;
-					if ((*it).type == StringToken::kResult)
-					{
-						double value = (*prevToken).result / (*it).result;
-						it++;
-						tokens.erase (prevToken, it);
-						tokens.insert (it, StringToken (StringToken::kResult, value));
-						it--;
-						prevToken = it;
-					}
-					else
-					{
-						return false;
-					}
+				#if DEBUG
+					DebugPrint("Tag not found :tag.%s\n", it->name.c_str ());
+				#endif
+					setResult (0., false);
+					return;
 				}
-				else
+				stack.push_back (tag);
+				break;
+			}
+			case kPushVariable:
+			{
+				double value;
+				if (!description->getVariable (it->name.c_str (), value))
 				{
-					return false;
+				#if DEBUG
+					DebugPrint("Variable not found :var.%s\n", it->name.c_str ());
+				#endif
+					setResult (0., false);
+					return;
 				}
+				stack.push_back (value);
+				break;
 			}
-			else
+			case kNegate:
 			{
-				prevToken = it;
+				stack.back () = -stack.back ();
+				break;
 			}
-		}
-	}
-	// now add and subtract
-	int32_t lastType = -1;
-	for (StringTokenList::const_iterator it = tokens.begin (); it != tokens.end (); it++)
-	{
-		if ((*it).type == UIDescriptionPrivate::StringToken::kResult)
-		{
-			double value = (*it).result;
-			if (lastType == -1)
-				result = value;
-			else if (lastType == StringToken::kAdd)
-				result += value;
-			else if (lastType == StringToken::kSubtract)
-				result -= value;
-			else
+			default:
 			{
-			#if DEBUG
-				DebugPrint ("Wrong Expression: %d\n", (*it).type);
-			#endif
-				return false;
+				double rhs = stack.back ();
+				stack.pop_back ();
+				double& lhs = stack.back ();
+				if (it->code == kAdd)
+					lhs += rhs;
+				else if (it->code == kSubtract)
+					lhs -= rhs;
+				else if (it->code == kMultiply)
+					lhs *= rhs;
+				else
+					lhs /= rhs;
+				break;
 			}
 		}
-		else if (!(lastType == -1 || lastType == UIDescriptionPrivate::StringToken::kResult))
-		{
-		#if DEBUG
-			DebugPrint ("Wrong Expression: %d\n", (*it).type);
-		#endif
-			return false;
-		}
-		lastType = (*it).type;
-		
-	}	
-	return true;	
+	}
+	setResult (stack.back (), true);
 }
 
-} // namespace UIDescriptionPrivate
-
 //-----------------------------------------------------------------------------
-bool UIDescription::calculateStringValue (UTF8StringPtr _str, double& result) const
+bool UIDescription::calculateStringValue (UTF8StringPtr str, double& result) const
 {
-	UIDescriptionPrivate::Locale localeResetter;
-
-	char* endPtr = 0;
-	result = strtod (_str, &endPtr);
-	if (endPtr == _str + strlen (_str))
-		return true;
-	std::string str (_str);
-	UIDescriptionPrivate::StringTokenList tokens;
-	if (!UIDescriptionPrivate::tokenizeString (str, tokens))
+	UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kExpressions, str);
+	SharedPointer<UIExpression> expression;
+	ExpressionMap::const_iterator it = expressions.find (str);
+	if (it != expressions.end ())
+		expression = it->second;
+	else
 	{
-	#if DEBUG
-		DebugPrint("TokenizeString failed :%s\n", _str);
-	#endif
-		return false;
+		expression = owned (UIExpression::compile (str));
+		expressions.insert (std::make_pair (std::string (str), expression));
 	}
-	// first make substituation
-	for (UIDescriptionPrivate::StringTokenList::iterator it = tokens.begin (); it != tokens.end (); it++)
+	if (!expression->hasResult ())
 	{
-		if ((*it).type == UIDescriptionPrivate::StringToken::kString)
-		{
-			const char* tokenStr = (*it).c_str ();
-			double value = strtod (tokenStr, &endPtr);
-			if (endPtr != tokenStr + (*it).length ())
-			{
-				// if it is not pure numeric try to substitute the string with a control tag or variable
-				size_t pos;
-				if ((pos = (*it).find ("tag.")) == 0)
-				{
-					value = getTagForName ((*it).c_str () + 4);
-					if (value == -1)
-					{
-					#if DEBUG
-						DebugPrint("Tag not found :%s\n", tokenStr);
-					#endif
-						return false;
-					}
-				}
-				else if ((pos = (*it).find ("var.")) == 0)
-				{
-					double v;
-					if (getVariable ((*it).c_str () + 4, v))
-					{
-						value = v;
-					}
-					else
-					{
-					#if DEBUG
-						DebugPrint("Variable not found :%s\n", tokenStr);
-					#endif
-						return false;
-					}
-				}
-				else
-				{
-				#if DEBUG
-					DebugPrint("Substitution failed :%s\n", tokenStr);
-				#endif
-					return false;
-				}
-			}
-			(*it).result = value;
-			(*it).type = UIDescriptionPrivate::StringToken::kResult;
-		}
+		// variables may be expressions themselves, their dependencies are collected here
+		UIExpression* parentExpression = evaluatingExpression;
+		evaluatingExpression = expression;
+		expression->evaluate (this);
+		evaluatingExpression = parentExpression;
+		bool valid = expression->getResult (result);
+		// the controller may remap tags, so such a result is not kept
+		if (controller && expression->dependsOnTags ())
+			expression->resetResult ();
+		if (evaluatingExpression)
+			evaluatingExpression->addDependencies (expression);
+		return valid;
+	}
+	if (evaluatingExpression)
+		evaluatingExpression->addDependencies (expression);
+	return expression->getResult (result);
+}
+
+//-----------------------------------------------------------------------------
+void UIDescription::invalidateExpressions (const std::string& dependency)
+{
+	for (ExpressionMap::const_iterator it = expressions.begin (), end = expressions.end (); it != end; ++it)
+	{
+		if (it->second->dependsOn (dependency))
+			it->second->resetResult ();
 	}
-	result = 0;
-	return UIDescriptionPrivate::computeTokens (tokens, result);
 }
 
 //-----------------------------------------------------------------------------
@@ -2597,65 +5200,8 @@ void UIDescription::startXmlElement (Xml::Parser* parser, IdStringPtr elementNam
 			}
 			newNode = new UINode (name, new UIAttributes (elementAttributes));
 		}
-		else
-		{
-			if (parent == nodes)
-			{
-				// only allowed second level elements
-				if (name == MainNodeNames::kControlTag || name == MainNodeNames::kColor || name == MainNodeNames::kBitmap)
-					newNode = new UINode (name, new UIAttributes (elementAttributes), true);
-				else if (name == MainNodeNames::kFont || name == MainNodeNames::kTemplate
-					  || name == MainNodeNames::kControlTag || name == MainNodeNames::kCustom
-					  || name == MainNodeNames::kVariable || name == MainNodeNames::kGradient)
-					newNode = new UINode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else if (parent->getName () == MainNodeNames::kBitmap)
-			{
-				if (name == "bitmap")
-					newNode = new UIBitmapNode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else if (parent->getName () == MainNodeNames::kFont)
-			{
-				if (name == "font")
-					newNode = new UIFontNode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else if (parent->getName () == MainNodeNames::kColor)
-			{
-				if (name == "color")
-					newNode = new UIColorNode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else if (parent->getName () == MainNodeNames::kControlTag)
-			{
-				if (name == "control-tag")
-					newNode = new UIControlTagNode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else if (parent->getName () == MainNodeNames::kVariable)
-			{
-				if (name == "var")
-					newNode = new UIVariableNode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else if (parent->getName () == MainNodeNames::kGradient)
-			{
-				if (name == "gradient")
-					newNode = new UIGradientNode (name, new UIAttributes (elementAttributes));
-				else
-					parser->stop ();
-			}
-			else
-				newNode = new UINode (name, new UIAttributes (elementAttributes));
-		}
+		else if ((newNode = createNode (parent, name, elementAttributes)) == 0)
+			parser->stop ();
 		if (newNode)
 		{
 			parent->getChildren ().add (newNode);
@@ -2664,7 +5210,8 @@ void UIDescription::startXmlElement (Xml::Parser* parser, IdStringPtr elementNam
 	}
 	else if (name == "vstgui-ui-description")
 	{
-		nodes = new UINode (name, new UIAttributes (elementAttributes));
+		// the templates are looked up by name
+		nodes = new UINode (name, new UIAttributes (elementAttributes), true);
 		nodeStack.push_back (nodes);
 	}
 	else if (name == "vstgui-ui-description-view-list")
@@ -2676,9 +5223,42 @@ void UIDescription::startXmlElement (Xml::Parser* parser, IdStringPtr elementNam
 	}
 }
 
+//-----------------------------------------------------------------------------
+UINode* UIDescription::createNode (UINode* parent, const std::string& name, UTF8StringPtr* elementAttributes) const
+{
+	if (parent == nodes)
+	{
+		// only allowed second level elements
+		if (name == MainNodeNames::kControlTag || name == MainNodeNames::kColor || name == MainNodeNames::kBitmap
+		 || name == MainNodeNames::kFont || name == MainNodeNames::kCustom || name == MainNodeNames::kVariable || name == MainNodeNames::kGradient)
+			return new UINode (name, new UIAttributes (elementAttributes), true);
+		if (name == MainNodeNames::kTemplate)
+			return new UINode (name, new UIAttributes (elementAttributes));
+		return 0;
+	}
+	if (parent->getName () == MainNodeNames::kBitmap)
+		return name == "bitmap" ? new UIBitmapNode (name, new UIAttributes (elementAttributes)) : 0;
+	if (parent->getName () == MainNodeNames::kFont)
+		return name == "font" ? new UIFontNode (name, new UIAttributes (elementAttributes)) : 0;
+	if (parent->getName () == MainNodeNames::kColor)
+		return name == "color" ? new UIColorNode (name, new UIAttributes (elementAttributes)) : 0;
+	if (parent->getName () == MainNodeNames::kControlTag)
+		return name == "control-tag" ? new UIControlTagNode (name, new UIAttributes (elementAttributes)) : 0;
+	if (parent->getName () == MainNodeNames::kVariable)
+		return name == "var" ? new UIVariableNode (name, new UIAttributes (elementAttributes)) : 0;
+	if (parent->getName () == MainNodeNames::kGradient)
+		return name == "gradient" ? new UIGradientNode (name, new UIAttributes (elementAttributes)) : 0;
+	if (name == "data" && dynamic_cast<UIBitmapNode*> (parent))
+		return new UIBitmapDataNode (name, new UIAttributes (elementAttributes));
+	return new UINode (name, new UIAttributes (elementAttributes));
+}
+
 //-----------------------------------------------------------------------------
 void UIDescription::endXmlElement (Xml::Parser* parser, IdStringPtr name)
 {
+	UIBitmapDataNode* dataNode = dynamic_cast<UIBitmapDataNode*> (nodeStack.back ());
+	if (dataNode && dataNode->isBase64 ())
+		dataNode->endBase64Text ();
 	if (nodeStack.back () == nodes)
 		restoreViewsMode = false;
 	nodeStack.pop_back ();
@@ -2689,12 +5269,18 @@ void UIDescription::xmlCharData (Xml::Parser* parser, const int8_t* data, int32_
 {
 	if (nodeStack.size () == 0)
 		return;
-	std::stringstream& sstream = nodeStack.back ()->getData ();
+	UIBitmapDataNode* dataNode = dynamic_cast<UIBitmapDataNode*> (nodeStack.back ());
+	if (dataNode && dataNode->isBase64 ())
+	{
+		dataNode->appendBase64Text (data, length);
+		return;
+	}
+	std::string& text = nodeStack.back ()->getData ();
 	for (int32_t i = 0; i < length; i++)
 	{
 		if (data[i] == '\t' || data[i] == '\n' || data[i] == '\r' || data[i] == 0x20)
 			continue;
-		sstream << (char)data[i];
+		text += static_cast<char> (data[i]);
 	}
 }
 
@@ -2731,7 +5317,6 @@ UINode::UINode (const std::string& _name, UIAttributes* _attributes, bool needsF
 , children (needsFastChildNameAttributeLookup ? new UIDescListWithFastFindAttributeNameChild: new UIDescList)
 , flags (0)
 {
-	data.clear ();
 	if (attributes == 0)
 		attributes = new UIAttributes ();
 }
@@ -2744,7 +5329,6 @@ UINode::UINode (const std::string& _name, UIDescList* _children, UIAttributes* _
 , flags (0)
 {
 	vstgui_assert (children != 0);
-	data.clear ();
 	children->remember ();
 	if (attributes == 0)
 		attributes = new UIAttributes ();
@@ -2755,10 +5339,9 @@ UINode::UINode (const UINode& n)
 : name (n.name)
 , flags (n.flags)
 , attributes (new UIAttributes (*n.attributes))
-, children (new UIDescList (*n.children))
+, children (static_cast<UIDescList*> (n.children->newCopy ()))
 {
-	data.clear ();
-	data << n.getData ().str ();
+	data = n.getData ();
 }
 
 //-----------------------------------------------------------------------------
@@ -2793,7 +5376,65 @@ void UINode::sortChildren ()
 UICommentNode::UICommentNode (const std::string& comment)
 : UINode ("comment")
 {
-	data << comment;
+	data = comment;
+}
+
+//-----------------------------------------------------------------------------
+UIDeferredTemplateNode::UIDeferredTemplateNode (const UIAttributes& attributes, uint32_t sectionIndex)
+: UINode (MainNodeNames::kTemplate, new UIAttributes (attributes))
+, sectionIndex (sectionIndex)
+, loaded (false)
+{
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+UIBitmapDataNode::UIBitmapDataNode (const std::string& name, UIAttributes* attributes)
+: UINode (name, attributes)
+, base64 (false)
+{
+	const std::string* encoding = getAttributes ()->getAttributeValue ("encoding");
+	base64 = encoding && *encoding == "base64";
+}
+
+//-----------------------------------------------------------------------------
+UIBitmapDataNode::UIBitmapDataNode (const void* data, uint32_t dataSize)
+: UINode ("data")
+, decodedData (static_cast<const uint8_t*> (data), static_cast<const uint8_t*> (data) + dataSize)
+, base64 (true)
+{
+	getAttributes ()->setAttribute ("encoding", "base64");
+}
+
+//-----------------------------------------------------------------------------
+UIBitmapDataNode::UIBitmapDataNode (const UIBitmapDataNode& n)
+: UINode (n)
+, decodedData (n.decodedData)
+, base64 (n.base64)
+{
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDataNode::appendBase64Text (const int8_t* text, int32_t length)
+{
+	size_t size = decodedData.size ();
+	decodedData.resize (size + Base64Decoder::getMaxDecodedSize (static_cast<uint32_t> (length)));
+	size += decoder.decode (text, static_cast<uint32_t> (length), &decodedData[size]);
+	decodedData.resize (size);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDataNode::setDecodedData (const void* data, uint32_t dataSize)
+{
+	decodedData.assign (static_cast<const uint8_t*> (data), static_cast<const uint8_t*> (data) + dataSize);
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapDataNode::endBase64Text ()
+{
+	// release the memory the vector reserved while growing
+	std::vector<uint8_t> (decodedData).swap (decodedData);
 }
 
 //-----------------------------------------------------------------------------
@@ -2921,6 +5562,19 @@ void UIControlTagNode::setTagString (const std::string& str)
 UIBitmapNode::UIBitmapNode (const std::string& name, UIAttributes* attributes)
 : UINode (name, attributes)
 , bitmap (0)
+, xmlDataSource (0)
+, xmlDataFormat (BitmapCodec::kPNG)
+, filterProcessed (false)
+, scaledBitmapsAdded (false)
+{
+}
+
+//-----------------------------------------------------------------------------
+UIBitmapNode::UIBitmapNode (const UIBitmapNode& n)
+: UINode (n)
+, bitmap (0)
+, xmlDataSource (0)
+, xmlDataFormat (BitmapCodec::kPNG)
 , filterProcessed (false)
 , scaledBitmapsAdded (false)
 {
@@ -2929,35 +5583,31 @@ UIBitmapNode::UIBitmapNode (const std::string& name, UIAttributes* attributes)
 //-----------------------------------------------------------------------------
 UIBitmapNode::~UIBitmapNode ()
 {
-	if (bitmap)
-		bitmap->forget ();
+	releaseBitmap ();
 }
 
 //-----------------------------------------------------------------------------
-void UIBitmapNode::createXMLData (const std::string& pathHint)
+void UIBitmapNode::createXMLData (const std::string& pathHint, BitmapCodec::Format format)
 {
 	CBitmap* bitmap = getBitmap (pathHint);
 	if (bitmap)
 	{
 		IPlatformBitmap* platformBitmap = bitmap->getPlatformBitmap ();
-		if (platformBitmap)
+		// the data of the last save is still valid while the bitmap was not changed
+		if (platformBitmap && (platformBitmap != xmlDataSource || format != xmlDataFormat || getChildren ().findChildNode ("data") == 0))
 		{
 			void* data;
 			uint32_t dataSize;
-			if (IPlatformBitmap::createMemoryPNGRepresentation (platformBitmap, &data, dataSize))
+			if (BitmapCodec::createMemoryRepresentation (platformBitmap, format, &data, dataSize))
 			{
-				Base64Codec bd;
-				if (bd.init (data, dataSize))
-				{
-					UINode* node = getChildren ().findChildNode ("data");
-					if (node)
-						getChildren ().remove (node);
-					UINode* dataNode = new UINode ("data");
-					dataNode->getAttributes ()->setAttribute ("encoding", "base64");
-					dataNode->getData ().write ((const char*)bd.getData (), static_cast<std::streamsize> (bd.getDataSize ()));
-					getChildren ().add (dataNode);
-				}
+				// encoded when it's written
+				UINode* node = getChildren ().findChildNode ("data");
+				if (node)
+					getChildren ().remove (node);
+				getChildren ().add (new UIBitmapDataNode (data, dataSize));
 				std::free (data);
+				xmlDataSource = platformBitmap;
+				xmlDataFormat = format;
 			}
 		}
 	}
@@ -2969,89 +5619,92 @@ void UIBitmapNode::removeXMLData ()
 	UINode* node = getChildren ().findChildNode ("data");
 	if (node)
 		getChildren ().remove (node);
+	xmlDataSource = 0;
 }
 
 //-----------------------------------------------------------------------------
-CBitmap* UIBitmapNode::createBitmap (const std::string& str, CNinePartTiledDescription* partDesc) const
+CBitmap* UIBitmapNode::createBitmap (IPlatformBitmap* platformBitmap) const
 {
-	if (partDesc)
-		return new CNinePartTiledBitmap (CResourceDescription (str.c_str()), *partDesc);
-	return new CBitmap (CResourceDescription (str.c_str()));
+	// the resource description points to the attribute value, it's only valid until the path changes and the bitmap is released
+	const std::string* path = attributes->getAttributeValue ("path");
+	CResourceDescription desc;
+	if (path)
+		desc = CResourceDescription (path->c_str ());
+	CNinePartTiledDescription partDesc;
+	if (getNinePartTiledDescription (partDesc))
+		return new CNinePartTiledBitmap (desc, platformBitmap, partDesc);
+	return new CBitmap (desc, platformBitmap);
 }
 
 //-----------------------------------------------------------------------------
 CBitmap* UIBitmapNode::getBitmap (const std::string& pathHint)
 {
-	if (bitmap == 0)
+	if (bitmap == 0 && attributes->getAttributeValue ("path"))
 	{
-		const std::string* path = attributes->getAttributeValue ("path");
-		if (path)
-		{
-			CNinePartTiledDescription partDesc;
-			CNinePartTiledDescription* partDescPtr = 0;
-			CRect offsets;
-			if (attributes->getRectAttribute ("nineparttiled-offsets", offsets))
-			{
-				partDesc = CNinePartTiledDescription (offsets.left, offsets.top, offsets.right, offsets.bottom);
-				partDescPtr = &partDesc;
-			}
-			bitmap = createBitmap (*path, partDescPtr);
-			if (bitmap->getPlatformBitmap () == 0 && pathIsAbsolute (pathHint))
-			{
-				std::string absPath = pathHint;
-				if (removeLastPathComponent (absPath))
-				{
-					absPath += "/" + *path;
-					SharedPointer<IPlatformBitmap> platformBitmap = owned (IPlatformBitmap::createFromPath (absPath.c_str ()));
-					if (platformBitmap)
-						bitmap->setPlatformBitmap (platformBitmap);
-				}
-			}
-		}
-		if (bitmap && bitmap->getPlatformBitmap () == 0)
-		{
-			UINode* node = getChildren ().findChildNode ("data");
-			if (node && node->getData ().str ().length () > 0)
-			{
-				const std::string* codec = node->getAttributes ()->getAttributeValue ("encoding");
-				if (codec && *codec == "base64")
-				{
-					Base64Codec bd;
-					if (bd.init (node->getData ().str ()))
-					{
-						OwningPointer<IPlatformBitmap> platformBitmap = IPlatformBitmap::createFromMemory (bd.getData (), bd.getDataSize ());
-						if (platformBitmap)
-						{
-							double scaleFactor = 1.;
-							if (attributes->getDoubleAttribute ("scale-factor", scaleFactor))
-								platformBitmap->setScaleFactor (scaleFactor);
-							bitmap->setPlatformBitmap (platformBitmap);
-						}
-					}
-				}
-			}
-		}
-		if (bitmap && path && bitmap->getPlatformBitmap () && bitmap->getPlatformBitmap ()->getScaleFactor () == 1.)
-		{
-			double scaleFactor = 1.;
-			if (UIDescriptionPrivate::decodeScaleFactorFromName (*path, scaleFactor))
-			{
-				bitmap->getPlatformBitmap ()->setScaleFactor (scaleFactor);
-				attributes->setDoubleAttribute ("scale-factor", scaleFactor);
-			}
-		}
+		OwningPointer<UIBitmapLoadJob> job = new UIBitmapLoadJob (this, "", pathHint);
+		job->decode ();
+		if (job->pathScaleFactor != 0.)
+			attributes->setDoubleAttribute ("scale-factor", job->pathScaleFactor);
+		bitmap = createBitmap (job->platformBitmap);
+		bitmapChanged ();
+	}
+	return bitmap;
+}
+
+//-----------------------------------------------------------------------------
+CBitmap* UIBitmapNode::getBitmap (IPlatformBitmap* platformBitmap)
+{
+	if (bitmap)
+		bitmap->setPlatformBitmap (platformBitmap);
+	else
+	{
+		bitmap = createBitmap (platformBitmap);
+		bitmapChanged ();
 	}
 	return bitmap;
 }
 
+//-----------------------------------------------------------------------------
+bool UIBitmapNode::getNinePartTiledDescription (CNinePartTiledDescription& partDesc) const
+{
+	CRect offsets;
+	if (attributes->getRectAttribute ("nineparttiled-offsets", offsets))
+	{
+		partDesc = CNinePartTiledDescription (offsets.left, offsets.top, offsets.right, offsets.bottom);
+		return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapNode::releaseBitmap ()
+{
+	if (bitmap)
+	{
+		// views still using the bitmap need all of its scale variants
+		if (bitmap->getNbReference () > 1)
+			CBitmapCache::instance ().detach (bitmap);
+		bitmap->forget ();
+		bitmap = 0;
+		bitmapChanged ();
+	}
+	xmlDataSource = 0;
+	filterProcessed = false;
+}
+
+//-----------------------------------------------------------------------------
+void UIBitmapNode::bitmapChanged ()
+{
+	if (resourceIndex)
+		resourceIndex->bitmaps.clear ();
+}
+
 //-----------------------------------------------------------------------------
 void UIBitmapNode::setBitmap (UTF8StringPtr bitmapName)
 {
 	std::string attrValue (bitmapName);
 	attributes->setAttribute ("path", attrValue);
-	if (bitmap)
-		bitmap->forget ();
-	bitmap = 0;
+	releaseBitmap ();
 	double scaleFactor = 1.;
 	if (UIDescriptionPrivate::decodeScaleFactorFromName (bitmapName, scaleFactor))
 		attributes->setDoubleAttribute ("scale-factor", scaleFactor);
@@ -3068,10 +5721,7 @@ void UIBitmapNode::setNinePartTiledOffset (const CRect* offsets)
 			tiledBitmap->setPartOffsets (CNinePartTiledDescription (offsets->left, offsets->top, offsets->right, offsets->bottom));
 		}
 		else
-		{
-			bitmap->forget ();
-			bitmap = 0;
-		}
+			releaseBitmap ();
 	}
 	if (offsets)
 		attributes->setRectAttribute ("nineparttiled-offsets", *offsets);
@@ -3082,10 +5732,7 @@ void UIBitmapNode::setNinePartTiledOffset (const CRect* offsets)
 //-----------------------------------------------------------------------------
 void UIBitmapNode::invalidBitmap ()
 {
-	if (bitmap)
-		bitmap->forget ();
-	bitmap = 0;
-	filterProcessed = false;
+	releaseBitmap ();
 }
 
 //-----------------------------------------------------------------------------
@@ -3097,6 +5744,15 @@ UIFontNode::UIFontNode (const std::string& name, UIAttributes* attributes)
 {
 }
 
+//-----------------------------------------------------------------------------
+UIFontNode::UIFontNode (const UIFontNode& n)
+: UINode (n)
+, font (n.font)
+{
+	if (font)
+		font->remember ();
+}
+
 //-----------------------------------------------------------------------------
 UIFontNode::~UIFontNode ()
 {
@@ -3255,6 +5911,13 @@ UIGradientNode::UIGradientNode (const std::string& name, UIAttributes* attribute
 {
 }
 
+//-----------------------------------------------------------------------------
+UIGradientNode::UIGradientNode (const UIGradientNode& n)
+: UINode (n)
+{
+	// created again from the color stop nodes when needed
+}
+
 //-----------------------------------------------------------------------------
 CGradient* UIGradientNode::getGradient ()
 {
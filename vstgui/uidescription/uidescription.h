@@ -42,11 +42,26 @@
 #include "xmlparser.h"
 #include <deque>
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
+#if VSTGUI_HAS_FUNCTIONAL
+#include <functional>
+#endif
 
 namespace VSTGUI {
 
 class UINode;
+class UIBitmapNode;
+class UIBitmapLoadJob;
+class UIBitmapDecoder;
+class UIViewPlan;
+class UIViewBuilder;
+class UIAsyncParser;
+class UIExpression;
+class UIResourceIndex;
+class UIDescWriterCache;
+template<typename KeyType> class UIResourceValueIndex;
 class UIAttributes;
 class IViewFactory;
 class IUIDescription;
@@ -54,6 +69,80 @@ class IBitmapCreator;
 class InputStream;
 class OutputStream;
 
+//-----------------------------------------------------------------------------
+/// @brief records the time spent in the phases of parsing an UIDescription and creating its views
+/// @details Set it with UIDescription::setProfiler before parse to include the parse time. Every phase records the time
+/// spent in it without the time of the phases nested in it, so that the phase times add up to the measured time. The
+/// templates record the whole time their views took to create, including nested templates. The time is only measured
+/// with millisecond precision without c++11. The profiler must only be used on the UI thread.
+/// @ingroup new_in_4_3
+//-----------------------------------------------------------------------------
+class UIDescriptionProfiler : public CBaseObject
+{
+public:
+	enum Phase {
+		kParse,						///< parsing the file, the names are not recorded
+		kViewTree,					///< building the view tree of a template, by template name
+		kExpressions,				///< evaluating expressions, by expression
+		kBitmaps,					///< getting and decoding bitmaps on the UI thread, by bitmap name
+		kFonts,						///< getting and creating fonts, by font name
+		kControllerCreateView,		///< IController::createView, by view class or custom view name
+		kControllerVerifyView,		///< IController::verifyView, by view class or custom view name
+		kControllerSubController,	///< IController::createSubController, by sub-controller name
+		kViewCreatorCreate,			///< IViewCreator::create, by view class
+		kViewCreatorApply,			///< IViewCreator::apply, by view class
+		kNumPhases
+	};
+
+	struct Entry
+	{
+		uint64_t time;		///< in microseconds
+		uint32_t count;
+
+		Entry () : time (0), count (0) {}
+	};
+	typedef std::map<std::string, Entry> EntryMap;
+
+	struct Report
+	{
+		Entry phases[kNumPhases];
+		EntryMap phaseEntries[kNumPhases];
+		EntryMap templates;
+
+		uint64_t getTotalTime () const;
+	};
+
+	/** measures the time until it is destroyed, does nothing without a profiler */
+	class Scope
+	{
+	public:
+		Scope (UIDescriptionProfiler* profiler, Phase phase, UTF8StringPtr name = 0);
+		~Scope ();
+	private:
+		UIDescriptionProfiler* profiler;
+		Scope* parent;
+		UTF8StringPtr name;
+		Phase phase;
+		uint64_t startTime;
+		uint64_t nestedTime;
+	};
+
+	UIDescriptionProfiler ();
+
+	const Report& getReport () const { return report; }
+	void reset ();
+
+	void addTime (Phase phase, uint64_t time, UTF8StringPtr name = 0);
+
+	static IdStringPtr getPhaseName (Phase phase);
+	static uint64_t getMicroseconds ();
+protected:
+	Report report;
+	Scope* currentScope;
+
+	friend class Scope;
+};
+
 //-----------------------------------------------------------------------------
 /// @brief XML description parser and view creator
 /// @ingroup new_in_4_0
@@ -65,11 +154,14 @@ public:
 	UIDescription (Xml::IContentProvider* xmlContentProvider, IViewFactory* viewFactory = 0);
 	~UIDescription ();
 
+	/** parse the description, returns false while parseAsync is parsing it */
 	virtual bool parse ();
 
 	enum SaveFlags {
 		kWriteWindowsResourceFile	= 1 << 0,
-		kWriteImagesIntoXMLFile		= 1 << 1
+		kWriteImagesIntoXMLFile		= 1 << 1,
+		kWriteImagesAsQOI			= 1 << 2,	///< together with kWriteImagesIntoXMLFile the images are stored in the QOI format instead of PNG, see BitmapCodec
+		kWriteCompiledFormat		= 1 << 3	///< write a compiled binary file instead of XML. parse loads it without the XML parser, embedded images are stored decoded from base64
 	};
 
 	virtual bool save (UTF8StringPtr filename, int32_t flags = kWriteWindowsResourceFile);
@@ -156,6 +248,72 @@ public:
 	bool calculateStringValue (UTF8StringPtr str, double& result) const;
 	
 	void setBitmapCreator (IBitmapCreator* bitmapCreator);
+
+	/** load the UIDescription file and the bitmaps from the resource pack when it contains them.
+		The UIDescription file is looked up with the name it was created with, the bitmaps with their path.
+		If the pack has no entry for the full name, the last path component is used. Set it before parse. */
+	void setResourcePack (CResourcePack* pack);
+	CResourcePack* getResourcePack () const { return resourcePack; }
+
+	/** pack the small bitmaps into a few large atlas bitmaps while parsing, see CBitmapAtlas. Bitmaps without scale variants
+		of at most maxBitmapSize pixels in both dimensions are loaded while parsing for it, also with async bitmap decoding.
+		Set it before parse. */
+	void setBitmapAtlasEnabled (bool state, uint32_t maxBitmapSize = 128);
+	bool getBitmapAtlasEnabled () const { return atlasMaxBitmapSize != 0; }
+	/** the atlas the bitmaps were packed into, 0 if the atlas is not enabled */
+	CBitmapAtlas* getBitmapAtlas () const { return bitmapAtlas; }
+
+	/** share the parsed nodes with the other UIDescription instances created with the same xml file or resource pack entry.
+		The first instance parses the file and keeps a copy of the nodes for the process, the others copy these nodes instead
+		of parsing the file again. Changes made to an instance are not seen by the others, saving the file lets the next
+		instance parse it again. Not available for instances created with a content provider. Set it before parse. */
+	void setSharedParsingEnabled (bool state);
+	bool getSharedParsingEnabled () const { return sharedParsing; }
+	/** release the nodes kept for shared parsing, the next instance parses the file again */
+	static void releaseSharedParsedNodes ();
+
+	/** create the views of a template by copying a prototype of the template views, which is built once per template.
+		IController::createView is not called for the views of such a template, the sub-controllers, the control tags
+		and IController::verifyView are handled per copy like for views created from the nodes. Templates with views
+		which can not be copied or which have a custom-view-name are created from the nodes. The prototypes are dropped when the description changes. */
+	void setPrototypeCloningEnabled (bool state);
+	bool getPrototypeCloningEnabled () const { return prototypeCloning; }
+
+	/** record the time spent in parsing and creating views, see UIDescriptionProfiler */
+	void setProfiler (UIDescriptionProfiler* profiler);
+	UIDescriptionProfiler* getProfiler () const { return profiler; }
+
+	// IDependency
+	void changed (IdStringPtr message) VSTGUI_OVERRIDE_VMETHOD;
+
+	/** decode the bitmaps on background threads after parsing, getBitmap returns bitmaps which draw nothing until they are decoded.
+		The views using them are invalidated when the bitmap is decoded. Asking the bitmap for its platform bitmap or size waits for it.
+		The platform bitmap implementation must support loading bitmaps on other threads. Not available without c++11. */
+	void setAsyncBitmapDecoding (bool state);
+	bool getAsyncBitmapDecoding () const { return bitmapDecoder != 0; }
+	/** wait until all bitmaps decoded on background threads are loaded */
+	void finishBitmapDecoding () const;
+
+#if VSTGUI_HAS_FUNCTIONAL
+	typedef std::function<void (UIDescription* description, bool success)> ParseCompletionFunc;
+	typedef std::function<void (CView* view)> ViewCompletionFunc;
+
+	/** parse the description on a background thread, the completion is called on the UI thread when it is done.
+		The description must not be used until then, parse returns false in this time. Returns false if the description
+		is already parsed or parsing. */
+	bool parseAsync (const ParseCompletionFunc& completion);
+	bool isParsing () const;
+	/** wait until the parsing thread is done and call the completion now */
+	void finishParsing ();
+
+	/** create the views of a template in time slices of at most timeBudget milliseconds, one slice per timer tick.
+		Returns a placeholder view with the size of the template, which is replaced by the template view when all
+		its views are created. The completion is called with the template view afterwards, if the placeholder was not
+		attached to a frame the completion owns the view. Deleting the placeholder cancels the creation. */
+	CView* createViewIncrementally (UTF8StringPtr name, IController* controller, uint32_t timeBudget, const ViewCompletionFunc& completion) const;
+	/** create the remaining views of all incremental view creations now */
+	void finishViewCreation () const;
+#endif
 	
 	static bool parseColor (const std::string& colorString, CColor& color);
 	static CViewAttributeID kTemplateNameAttributeID;
@@ -169,18 +327,69 @@ public:
 	static IdStringPtr kMessageBeforeSave;
 protected:
 	CView* createViewFromNode (UINode* node) const;
+	CView* createViewFromPlan (const UIViewPlan* plan) const;
+	CView* createTemplateReferenceView (const UIViewPlan* plan) const;
+	CView* beginViewFromPlan (const UIViewPlan* plan, IController*& subController) const;
+	CView* endViewFromPlan (const UIViewPlan* plan, CView* view, IController* subController) const;
+#if VSTGUI_HAS_FUNCTIONAL
+	bool continueViewBuilding (UIViewBuilder* builder) const;
+	void finishViewBuilding (UIViewBuilder* builder) const;
+	void cancelViewBuilding (UIViewBuilder* builder) const;
+#endif
+	UIViewPlan* getViewPlan (UINode* templateNode) const;
+	UINode* findTemplateNode (UTF8StringPtr name) const;
+	bool canCloneViews (const UIViewPlan* plan, uint32_t depth = 0) const;
+	bool createViewFromPrototype (UIViewPlan* plan, CView*& view) const;
+	CView* bindPrototypeCopy (CView* view) const;
 	UINode* getBaseNode (UTF8StringPtr name) const;
 	UINode* findChildNodeByNameAttribute (UINode* node, UTF8StringPtr nameAttribute) const;
 	UINode* findNodeForView (CView* view) const;
 	bool updateAttributesForView (UINode* node, CView* view, bool deep = true);
 	void removeNode (UTF8StringPtr name, IdStringPtr mainNodeName, IdStringPtr changeMsg);
-	template<typename NodeType, typename ObjType, typename CompareFunction> UTF8StringPtr lookupName (const ObjType& obj, IdStringPtr mainNodeName, CompareFunction compare) const;
+	template<typename NodeType, typename KeyType, typename KeyFunction> UTF8StringPtr lookupName (const KeyType& key, IdStringPtr mainNodeName, UIResourceValueIndex<KeyType>& index, KeyFunction getKey) const;
+	UIResourceIndex* getResourceIndex () const;
 	template<typename NodeType> void changeNodeName (UTF8StringPtr oldName, UTF8StringPtr newName, IdStringPtr mainNodeName, IdStringPtr changeMsg);
 	template<typename NodeType> void collectNamesFromNode (IdStringPtr mainNodeName, std::list<const std::string*>& names) const;
+	CBitmap* loadBitmap (UIBitmapNode* bitmapNode, UTF8StringPtr name, bool decodeAsync = true) const;
+	CBitmap* completeBitmapLoad (UIBitmapLoadJob* job) const;
+	void startBitmapDecoding () const;
+	void buildBitmapAtlas ();
 
+	bool parseNodes ();
+	void completeParsing ();
+	bool parseXml ();
+	bool parseContent (Xml::IContentProvider* provider);
+	bool parseCompiled (const uint8_t* data, uint32_t dataSize);
+	UINode* createNode (UINode* parent, const std::string& name, UTF8StringPtr* elementAttributes) const;
+	std::string getSharedParsingKey () const;
 	void addDefaultNodes ();
+	void invalidateExpressions (const std::string& dependency);
 
 	bool saveToStream (OutputStream& stream, int32_t flags);
+	void prepareSaving (int32_t flags);
+
+	/** @name Container formats
+		A subclass which keeps the top level elements of the description separately, like CompressedUIDescription in
+		contrib, creates the nodes with createRootNode, parseSection and addDeferredTemplate instead of parse and calls
+		completeParsing afterwards. The views of a deferred template are parsed from the XML returned by
+		readDeferredTemplate the first time the template is needed.
+	*/
+	///@{
+	struct Section
+	{
+		std::string xml;								///< one top level element, resource sections also hold the comments of the root node
+		SharedPointer<UIAttributes> templateAttributes;	///< the attributes of a template section, 0 for resource sections
+	};
+	typedef std::vector<Section> SectionList;
+
+	void createRootNode (const UIAttributes& attributes);
+	bool parseSection (const std::string& xml);
+	void addDeferredTemplate (const UIAttributes& attributes, uint32_t sectionIndex);
+	virtual bool readDeferredTemplate (uint32_t sectionIndex, std::string& xml) const { return false; }
+	bool saveSections (UIAttributes& rootAttributes, SectionList& sections, int32_t flags);
+	///@}
+	void loadDeferredTemplate (UINode* node) const;
+	void loadDeferredTemplates () const;
 
 	// Xml::IHandler
 	void startXmlElement (Xml::Parser* parser, IdStringPtr elementName, UTF8StringPtr* elementAttributes) VSTGUI_OVERRIDE_VMETHOD;
@@ -196,9 +405,33 @@ protected:
 	IViewFactory* viewFactory;
 	Xml::IContentProvider* xmlContentProvider;
 	IBitmapCreator* bitmapCreator;
+	UIBitmapDecoder* bitmapDecoder;
+	UIAsyncParser* asyncParser;
+	SharedPointer<CResourcePack> resourcePack;
+	SharedPointer<CBitmapAtlas> bitmapAtlas;
+	uint32_t atlasMaxBitmapSize;
+	bool sharedParsing;
+	bool prototypeCloning;
+	mutable bool buildingPrototype;
+
+	typedef std::map<const UINode*, SharedPointer<UIViewPlan> > ViewPlanMap;
+	mutable ViewPlanMap viewPlans;
+
+	typedef std::map<std::string, SharedPointer<UIExpression> > ExpressionMap;
+	mutable ExpressionMap expressions;
+	mutable UIExpression* evaluatingExpression;
+
+	mutable SharedPointer<UIResourceIndex> resourceIndex;
+	SharedPointer<UIDescriptionProfiler> profiler;
+	SharedPointer<UIDescWriterCache> writerCache;
 
 	mutable std::deque<IController*> subControllerStack;
 
+#if VSTGUI_HAS_FUNCTIONAL
+	typedef std::list<SharedPointer<UIViewBuilder> > ViewBuilderList;
+	mutable ViewBuilderList viewBuilders;
+#endif
+
 	std::deque<UINode*> nodeStack;
 	
 	bool restoreViewsMode;
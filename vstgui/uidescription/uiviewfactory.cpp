@@ -34,10 +34,13 @@
 
 #include "uiviewfactory.h"
 #include "uiattributes.h"
+#include "uidescription.h"
 #include "../lib/cview.h"
 #include "../lib/cstring.h"
 #include "detail/uiviewcreatorattributes.h"
 #include "../lib/platform/std_unorderedmap.h"
+#include <vector>
+#include <algorithm>
 
 namespace VSTGUI {
 
@@ -118,6 +121,7 @@ namespace VSTGUI {
 */
 
 typedef std::unordered_map<std::string, const IViewCreator*> ViewCreatorRegistryMap;
+typedef std::vector<const IViewCreator*> ViewCreatorChain;
 
 //-----------------------------------------------------------------------------
 class ViewCreatorRegistry : private ViewCreatorRegistryMap
@@ -144,7 +148,7 @@ public:
 		}
 #endif
 		insert (std::make_pair (viewCreator->getViewName (), viewCreator));
-		
+		chains.clear ();
 	}
 
 	void remove (const IViewCreator* viewCreator)
@@ -153,9 +157,53 @@ public:
 		if (it == end ())
 			return;
 		erase (it);
+		chains.clear ();
 	}
+
+	/** returns the creator of the view class followed by the creators of all its base classes or 0 if the view class is unknown */
+	const ViewCreatorChain* findChain (IdStringPtr name)
+	{
+		if (name == 0)
+			return 0;
+		ChainMap::const_iterator it = chains.find (name);
+		if (it == chains.end ())
+		{
+			ViewCreatorChain chain;
+			const_iterator iter = find (name);
+			while (iter != end () && std::find (chain.begin (), chain.end (), (*iter).second) == chain.end ())
+			{
+				chain.push_back ((*iter).second);
+				iter = find ((*iter).second->getBaseViewName ());
+			}
+			it = chains.insert (std::make_pair (std::string (name), chain)).first;
+		}
+		return it->second.empty () ? 0 : &it->second;
+	}
+
+private:
+	typedef std::unordered_map<std::string, ViewCreatorChain> ChainMap;
+	ChainMap chains;
 };
 
+//-----------------------------------------------------------------------------
+static bool applyViewCreatorChain (const ViewCreatorChain& chain, CView* view, const UIAttributes& attributes, const IUIDescription* description)
+{
+	bool result = false;
+	for (ViewCreatorChain::const_iterator it = chain.begin (), end = chain.end (); it != end; ++it)
+	{
+		if (!(result = (*it)->apply (view, attributes, description)))
+			break;
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+static UIDescriptionProfiler* getProfiler (const IUIDescription* description)
+{
+	const UIDescription* uiDescription = dynamic_cast<const UIDescription*> (description);
+	return uiDescription ? uiDescription->getProfiler () : 0;
+}
+
 //-----------------------------------------------------------------------------
 static ViewCreatorRegistry& getCreatorRegistry ()
 {
@@ -179,23 +227,24 @@ UIViewFactory::~UIViewFactory ()
 //-----------------------------------------------------------------------------
 CView* UIViewFactory::createViewByName (const std::string* className, const UIAttributes& attributes, const IUIDescription* description) const
 {
-	ViewCreatorRegistry& registry = getCreatorRegistry ();
-	ViewCreatorRegistry::const_iterator iter = registry.find (className->c_str ());
-	if (iter != registry.end ())
+	const ViewCreatorChain* chain = getCreatorRegistry ().findChain (className->c_str ());
+	if (chain)
 	{
-		CView* view = (*iter).second->create (attributes, description);
+		const IViewCreator* creator = chain->front ();
+		UIDescriptionProfiler* profiler = getProfiler (description);
+		CView* view;
+		{
+			UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kViewCreatorCreate, className->c_str ());
+			view = creator->create (attributes, description);
+		}
 		if (view)
 		{
-			IdStringPtr viewName = (*iter).second->getViewName ();
+			IdStringPtr viewName = creator->getViewName ();
 			view->setAttribute (kViewNameAttribute, sizeof (IdStringPtr), &viewName);
+			UIDescriptionProfiler::Scope scope (profiler, UIDescriptionProfiler::kViewCreatorApply, className->c_str ());
 			UIAttributes evaluatedAttributes;
 			evaluateAttributesAndRemember (view, attributes, evaluatedAttributes, description);
-			while (iter != registry.end () && (*iter).second->apply (view, evaluatedAttributes, description))
-			{
-				if ((*iter).second->getBaseViewName () == 0)
-					break;
-				iter = registry.find ((*iter).second->getBaseViewName ());
-			}
+			applyViewCreatorChain (*chain, view, evaluatedAttributes, description);
 			return view;
 		}
 	}
@@ -221,38 +270,29 @@ CView* UIViewFactory::createView (const UIAttributes& attributes, const IUIDescr
 //-----------------------------------------------------------------------------
 bool UIViewFactory::applyAttributeValues (CView* view, const UIAttributes& attributes, const IUIDescription* desc) const
 {
-	bool result = false;
-	ViewCreatorRegistry& registry = getCreatorRegistry ();
-	ViewCreatorRegistry::const_iterator iter = registry.find (getViewName (view));
+	IdStringPtr viewName = getViewName (view);
+	const ViewCreatorChain* chain = getCreatorRegistry ().findChain (viewName);
 
+	UIDescriptionProfiler::Scope scope (getProfiler (desc), UIDescriptionProfiler::kViewCreatorApply, viewName);
 	UIAttributes evaluatedAttributes;
 	evaluateAttributesAndRemember (view, attributes, evaluatedAttributes, desc);
-	
-	while (iter != registry.end () && (result = (*iter).second->apply (view, evaluatedAttributes, desc)) && (*iter).second->getBaseViewName ())
-	{
-		iter = registry.find ((*iter).second->getBaseViewName ());
-	}
-	return result;
+
+	return chain ? applyViewCreatorChain (*chain, view, evaluatedAttributes, desc) : false;
 }
 
 //-----------------------------------------------------------------------------
 bool UIViewFactory::applyCustomViewAttributeValues (CView* customView, IdStringPtr baseViewName, const UIAttributes& attributes, const IUIDescription* desc) const
 {
-	bool result = false;
-	ViewCreatorRegistry& registry = getCreatorRegistry ();
-	ViewCreatorRegistry::const_iterator iter = registry.find (baseViewName);
-	if (iter != registry.end ())
+	const ViewCreatorChain* chain = getCreatorRegistry ().findChain (baseViewName);
+	if (chain)
 	{
-		IdStringPtr viewName = (*iter).second->getViewName ();
+		IdStringPtr viewName = chain->front ()->getViewName ();
 		customView->setAttribute (kViewNameAttribute, sizeof (IdStringPtr), &viewName);
 	}
+	UIDescriptionProfiler::Scope scope (getProfiler (desc), UIDescriptionProfiler::kViewCreatorApply, baseViewName);
 	UIAttributes evaluatedAttributes;
 	evaluateAttributesAndRemember (customView, attributes, evaluatedAttributes, desc);
-	while (iter != registry.end () && (result = (*iter).second->apply (customView, evaluatedAttributes, desc)) && (*iter).second->getBaseViewName ())
-	{
-		iter = registry.find ((*iter).second->getBaseViewName ());
-	}
-	return result;
+	return chain ? applyViewCreatorChain (*chain, customView, evaluatedAttributes, desc) : false;
 }
 
 //-----------------------------------------------------------------------------
@@ -268,8 +308,7 @@ IdStringPtr UIViewFactory::getViewName (CView* view) const
 void UIViewFactory::evaluateAttributesAndRemember (CView* view, const UIAttributes& attributes, UIAttributes& evaluatedAttributes, const IUIDescription* description) const
 {
 	std::string evaluatedValue;
-	typedef std::pair<std::string, std::string> StringPair;
-	VSTGUI_RANGE_BASED_FOR_LOOP (UIAttributesMap, attributes, StringPair, attr)
+	VSTGUI_RANGE_BASED_FOR_LOOP (UIAttributes, attributes, const UIAttributes::Attribute&, attr)
 		const std::string& value = attr.second;
 		if (description && description->getVariable (value.c_str (), evaluatedValue))
 		{
@@ -33,6 +33,9 @@
 //-----------------------------------------------------------------------------
 
 #include "lib/cbitmap.cpp"
+#include "lib/cbitmapatlas.cpp"
+#include "lib/cbitmapcache.cpp"
+#include "lib/cbitmapcodec.cpp"
 #include "lib/cbitmapfilter.cpp"
 #include "lib/ccolor.cpp"
 #include "lib/cdatabrowser.cpp"
@@ -40,6 +43,7 @@
 #include "lib/cdrawmethods.cpp"
 #include "lib/cdropsource.cpp"
 #include "lib/cfileselector.cpp"
+#include "lib/cfilmstripbitmap.cpp"
 #include "lib/cfont.cpp"
 #include "lib/cframe.cpp"
 #include "lib/cgradientview.cpp"
@@ -48,8 +52,10 @@
 #include "lib/clinestyle.cpp"
 #include "lib/coffscreencontext.cpp"
 #include "lib/copenglview.cpp"
+#include "lib/cpixelspan.cpp"
 #include "lib/cpoint.cpp"
 #include "lib/crect.cpp"
+#include "lib/cresourcepack.cpp"
 #include "lib/crowcolumnview.cpp"
 #include "lib/cscrollview.cpp"
 #include "lib/cshadowviewcontainer.cpp"
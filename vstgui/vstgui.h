@@ -37,6 +37,8 @@
 
 #include "lib/vstguibase.h"
 #include "lib/cbitmap.h"
+#include "lib/cbitmapatlas.h"
+#include "lib/cbitmapcodec.h"
 #include "lib/cbitmapfilter.h"
 #include "lib/cbuttonstate.h"
 #include "lib/ccolor.h"
@@ -45,6 +47,7 @@
 #include "lib/cdrawmethods.h"
 #include "lib/cdropsource.h"
 #include "lib/cfileselector.h"
+#include "lib/cfilmstripbitmap.h"
 #include "lib/cfont.h"
 #include "lib/cframe.h"
 #include "lib/cgradient.h"
@@ -56,6 +59,7 @@
 #include "lib/copenglview.h"
 #include "lib/cpoint.h"
 #include "lib/crect.h"
+#include "lib/cresourcepack.h"
 #include "lib/crowcolumnview.h"
 #include "lib/cscrollview.h"
 #include "lib/cshadowviewcontainer.h"